@@ -0,0 +1,1606 @@
+/**
+ * @file  background.cpp
+ * @brief Implementation file for the utility functions that load the background of the keyboard.
+ */
+
+#ifdef _WIN64
+#define zoomSurface GFX_zoomSurface
+#else
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fb.h>
+#endif // __linux__
+
+#endif // _WIN64
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <SDL_image.h>
+#include <SDL2_rotozoom.h>
+
+#ifdef SCALED_DECODE
+
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#include <png.h>
+
+#endif // SCALED_DECODE
+
+#include "background.h"
+#include "resourcePack.h"
+#include "sdlUtils.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of a prepared background.
+     */
+    const char s_magic[4] = { 'V', 'K', 'B', 'G' };
+
+    /**
+     * @struct SHeader
+     * @brief  Header of a prepared background, followed by the pixels. The key identifies the background and the effects
+     *         a cached background was made from (0 for the backgrounds made by the converter).
+     */
+    struct SHeader
+    {
+        char m_magic[4];
+        Uint16 m_version;
+        Uint16 m_compression;
+        Uint32 m_width;
+        Uint32 m_height;
+        Uint32 m_format;
+        Uint32 m_pitch;
+        Uint32 m_payloadSize;
+        Uint32 m_key;
+    };
+
+    /**
+     * @brief Opcodes and sizes of the QOI format (see https://qoiformat.org/qoi-specification.pdf).
+     */
+    constexpr Uint8 s_qoiIndex = 0x00;
+    constexpr Uint8 s_qoiDiff = 0x40;
+    constexpr Uint8 s_qoiLuma = 0x80;
+    constexpr Uint8 s_qoiRun = 0xC0;
+    constexpr Uint8 s_qoiRgb = 0xFE;
+    constexpr Uint8 s_qoiRgba = 0xFF;
+    constexpr Uint8 s_qoiMask = 0xC0;
+    constexpr size_t s_qoiHeaderSize = 14;
+    constexpr Uint8 s_qoiPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    /**
+     * @struct SQoiPixel
+     * @brief  A pixel, as QOI sees it.
+     */
+    struct SQoiPixel
+    {
+        Uint8 m_r;
+        Uint8 m_g;
+        Uint8 m_b;
+        Uint8 m_a;
+
+        inline bool operator==(const SQoiPixel& p_other) const { return m_r == p_other.m_r && m_g == p_other.m_g && m_b == p_other.m_b && m_a == p_other.m_a; }
+        inline bool operator!=(const SQoiPixel& p_other) const { return !(*this == p_other); }
+        inline unsigned int hash(void) const { return (m_r * 3 + m_g * 5 + m_b * 7 + m_a * 11) % 64; }
+    };
+
+    /**
+     * @brief         Writes a 32-bit big-endian value, as the QOI header stores them.
+     * @param p_value The value.
+     * @param p_data  The encoded image.
+     */
+    void putBigEndian(const Uint32 p_value, std::vector<Uint8>& p_data)
+    {
+        p_data.push_back(static_cast<Uint8>(p_value >> 24));
+        p_data.push_back(static_cast<Uint8>(p_value >> 16));
+        p_data.push_back(static_cast<Uint8>(p_value >> 8));
+        p_data.push_back(static_cast<Uint8>(p_value));
+    }
+
+    /**
+     * @brief           Encodes the pixels of a surface of 16 or 32 bits as a QOI image.
+     * @param p_surface The surface.
+     * @param p_data    Output: the QOI image.
+     */
+    void encodeQoi(const SDL_Surface* p_surface, std::vector<Uint8>& p_data)
+    {
+        // 1. Write the QOI header: size, 4 channels, sRGB.
+        // 2. Encode each pixel against the previous one: a run of the same pixel, a pixel seen recently (by its hash),
+        //    a small difference, or the whole pixel.
+        // 3. End the stream with the padding.
+
+        const int l_bytesPerPixel = p_surface->format->BytesPerPixel;
+
+        p_data.clear();
+        p_data.reserve(s_qoiHeaderSize + static_cast<size_t>(p_surface->w) * p_surface->h + sizeof(s_qoiPadding));
+        p_data.insert(p_data.end(), { 'q', 'o', 'i', 'f' });
+        putBigEndian(static_cast<Uint32>(p_surface->w), p_data);
+        putBigEndian(static_cast<Uint32>(p_surface->h), p_data);
+        p_data.push_back(4);
+        p_data.push_back(0);
+
+        SQoiPixel l_index[64];
+        SQoiPixel l_previous{ 0, 0, 0, 255 };
+        int l_run(0);
+
+        std::memset(l_index, 0, sizeof(l_index));
+
+        for (int l_y = 0; l_y < p_surface->h; ++l_y)
+        {
+            const Uint8* l_row = static_cast<const Uint8*>(p_surface->pixels) + static_cast<size_t>(l_y) * p_surface->pitch;
+
+            for (int l_x = 0; l_x < p_surface->w; ++l_x)
+            {
+                Uint32 l_value(0);
+                SQoiPixel l_pixel{};
+
+                if (l_bytesPerPixel == 2)
+                {
+                    Uint16 l_short(0);
+                    std::memcpy(&l_short, l_row + l_x * 2, sizeof(l_short));
+                    l_value = l_short;
+                }
+                else
+                {
+                    std::memcpy(&l_value, l_row + l_x * 4, sizeof(l_value));
+                }
+
+                SDL_GetRGBA(l_value, p_surface->format, &l_pixel.m_r, &l_pixel.m_g, &l_pixel.m_b, &l_pixel.m_a);
+
+                if (l_pixel == l_previous)
+                {
+                    if (++l_run == 62)
+                    {
+                        p_data.push_back(static_cast<Uint8>(s_qoiRun | (l_run - 1)));
+                        l_run = 0;
+                    }
+
+                    continue;
+                }
+
+                if (l_run > 0)
+                {
+                    p_data.push_back(static_cast<Uint8>(s_qoiRun | (l_run - 1)));
+                    l_run = 0;
+                }
+
+                const unsigned int l_hash = l_pixel.hash();
+
+                if (l_index[l_hash] == l_pixel)
+                {
+                    p_data.push_back(static_cast<Uint8>(s_qoiIndex | l_hash));
+                }
+                else if (l_pixel.m_a != l_previous.m_a)
+                {
+                    l_index[l_hash] = l_pixel;
+                    p_data.insert(p_data.end(), { s_qoiRgba, l_pixel.m_r, l_pixel.m_g, l_pixel.m_b, l_pixel.m_a });
+                }
+                else
+                {
+                    const int l_dr = static_cast<Sint8>(l_pixel.m_r - l_previous.m_r);
+                    const int l_dg = static_cast<Sint8>(l_pixel.m_g - l_previous.m_g);
+                    const int l_db = static_cast<Sint8>(l_pixel.m_b - l_previous.m_b);
+                    const int l_drg = l_dr - l_dg;
+                    const int l_dbg = l_db - l_dg;
+
+                    l_index[l_hash] = l_pixel;
+
+                    if (l_dr >= -2 && l_dr <= 1 && l_dg >= -2 && l_dg <= 1 && l_db >= -2 && l_db <= 1)
+                    {
+                        p_data.push_back(static_cast<Uint8>(s_qoiDiff | (l_dr + 2) << 4 | (l_dg + 2) << 2 | (l_db + 2)));
+                    }
+                    else if (l_dg >= -32 && l_dg <= 31 && l_drg >= -8 && l_drg <= 7 && l_dbg >= -8 && l_dbg <= 7)
+                    {
+                        p_data.push_back(static_cast<Uint8>(s_qoiLuma | (l_dg + 32)));
+                        p_data.push_back(static_cast<Uint8>((l_drg + 8) << 4 | (l_dbg + 8)));
+                    }
+                    else
+                    {
+                        p_data.insert(p_data.end(), { s_qoiRgb, l_pixel.m_r, l_pixel.m_g, l_pixel.m_b });
+                    }
+                }
+
+                l_previous = l_pixel;
+            }
+        }
+
+        if (l_run > 0) p_data.push_back(static_cast<Uint8>(s_qoiRun | (l_run - 1)));
+
+        p_data.insert(p_data.end(), s_qoiPadding, s_qoiPadding + sizeof(s_qoiPadding));
+    }
+
+    /**
+     * @brief           Decodes a QOI image straight into the pixels of a surface of 16 or 32 bits, of the same size.
+     * @param p_data    The QOI image.
+     * @param p_size    The size of the image, in bytes.
+     * @param p_surface The surface.
+     * @return          TRUE if the image was decoded; otherwise, FALSE (the image is truncated or of another size).
+     */
+    const bool decodeQoi(const Uint8* p_data, const size_t p_size, SDL_Surface* p_surface)
+    {
+        // 1. Check the QOI header against the surface.
+        // 2. Decode the operations into pixels, and pack each one in the format of the surface as it is written (the
+        //    shifts and losses of the format are read once).
+
+        if (p_size < s_qoiHeaderSize + sizeof(s_qoiPadding) || std::memcmp(p_data, "qoif", 4) != 0) return false;
+
+        const Uint32 l_width = static_cast<Uint32>(p_data[4]) << 24 | p_data[5] << 16 | p_data[6] << 8 | p_data[7];
+        const Uint32 l_height = static_cast<Uint32>(p_data[8]) << 24 | p_data[9] << 16 | p_data[10] << 8 | p_data[11];
+
+        if (l_width != static_cast<Uint32>(p_surface->w) || l_height != static_cast<Uint32>(p_surface->h)) return false;
+
+        const SDL_PixelFormat* l_format = p_surface->format;
+        const bool l_shortPixels = (l_format->BytesPerPixel == 2);
+        const size_t l_end = p_size - sizeof(s_qoiPadding);
+        size_t l_position = s_qoiHeaderSize;
+        SQoiPixel l_index[64];
+        SQoiPixel l_pixel{ 0, 0, 0, 255 };
+        Uint32 l_value(0);
+        int l_run(0);
+
+        std::memset(l_index, 0, sizeof(l_index));
+
+        for (int l_y = 0; l_y < p_surface->h; ++l_y)
+        {
+            Uint8* l_row = static_cast<Uint8*>(p_surface->pixels) + static_cast<size_t>(l_y) * p_surface->pitch;
+
+            for (int l_x = 0; l_x < p_surface->w; ++l_x)
+            {
+                if (l_run > 0)
+                {
+                    --l_run;
+                }
+                else
+                {
+                    if (l_position >= l_end) return false;
+
+                    const Uint8 l_byte = p_data[l_position++];
+
+                    if (l_byte == s_qoiRgb)
+                    {
+                        l_pixel.m_r = p_data[l_position];
+                        l_pixel.m_g = p_data[l_position + 1];
+                        l_pixel.m_b = p_data[l_position + 2];
+                        l_position += 3;
+                    }
+                    else if (l_byte == s_qoiRgba)
+                    {
+                        l_pixel.m_r = p_data[l_position];
+                        l_pixel.m_g = p_data[l_position + 1];
+                        l_pixel.m_b = p_data[l_position + 2];
+                        l_pixel.m_a = p_data[l_position + 3];
+                        l_position += 4;
+                    }
+                    else if ((l_byte & s_qoiMask) == s_qoiIndex)
+                    {
+                        l_pixel = l_index[l_byte];
+                    }
+                    else if ((l_byte & s_qoiMask) == s_qoiDiff)
+                    {
+                        l_pixel.m_r += ((l_byte >> 4) & 0x03) - 2;
+                        l_pixel.m_g += ((l_byte >> 2) & 0x03) - 2;
+                        l_pixel.m_b += (l_byte & 0x03) - 2;
+                    }
+                    else if ((l_byte & s_qoiMask) == s_qoiLuma)
+                    {
+                        const Uint8 l_second = p_data[l_position++];
+                        const int l_dg = (l_byte & 0x3F) - 32;
+
+                        l_pixel.m_r += l_dg - 8 + ((l_second >> 4) & 0x0F);
+                        l_pixel.m_g += l_dg;
+                        l_pixel.m_b += l_dg - 8 + (l_second & 0x0F);
+                    }
+                    else
+                    {
+                        l_run = l_byte & 0x3F;
+                    }
+
+                    l_index[l_pixel.hash()] = l_pixel;
+                    l_value = static_cast<Uint32>(l_pixel.m_r >> l_format->Rloss) << l_format->Rshift
+                            | static_cast<Uint32>(l_pixel.m_g >> l_format->Gloss) << l_format->Gshift
+                            | static_cast<Uint32>(l_pixel.m_b >> l_format->Bloss) << l_format->Bshift
+                            | ((static_cast<Uint32>(l_pixel.m_a >> l_format->Aloss) << l_format->Ashift) & l_format->Amask);
+                }
+
+                if (l_shortPixels)
+                {
+                    const Uint16 l_short = static_cast<Uint16>(l_value);
+                    std::memcpy(l_row + l_x * 2, &l_short, sizeof(l_short));
+                }
+                else
+                {
+                    std::memcpy(l_row + l_x * 4, &l_value, sizeof(l_value));
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief        Loads a prepared background.
+     * @param p_file The stream of the background (closed here).
+     * @param p_path The path of the background, for the messages.
+     * @param p_key  Output: the key of the background (see SHeader).
+     * @return       Pointer to the background, or nullptr if it is invalid.
+     */
+    SDL_Surface* loadPrepared(SDL_RWops* p_file, const std::string& p_path, Uint32& p_key)
+    {
+        // 1. Read the header, and check the magic, the version, the size and the pixel format. Bound the pitch (the rows
+        //    are padded by a few bytes at most) and the payload (it must be in the file) before allocating anything, so
+        //    a truncated or damaged file is rejected instead of exhausting the memory.
+        // 2. Create the surface in that format, and read the pixels into it: raw pixels are read as they are (in one
+        //    go when the rows have the same pitch), and a QOI image is read and decoded into it.
+        // 3. The background is opaque: it is copied onto the screen, not blended.
+
+        SHeader l_header;
+        bool l_valid = (SDL_RWread(p_file, &l_header, sizeof(l_header), 1) == 1)
+                    && std::memcmp(l_header.m_magic, s_magic, sizeof(s_magic)) == 0
+                    && l_header.m_version == BACKGROUND_VERSION
+                    && l_header.m_width > 0 && l_header.m_width <= BACKGROUND_MAX_SIZE
+                    && l_header.m_height > 0 && l_header.m_height <= BACKGROUND_MAX_SIZE
+                    && !SDL_ISPIXELFORMAT_INDEXED(l_header.m_format)
+                    && (SDL_BYTESPERPIXEL(l_header.m_format) == 2 || SDL_BYTESPERPIXEL(l_header.m_format) == 4)
+                    && l_header.m_pitch >= l_header.m_width * SDL_BYTESPERPIXEL(l_header.m_format);
+
+        if (l_valid)
+        {
+            const Sint64 l_fileSize = SDL_RWsize(p_file);
+            const Uint64 l_available = (l_fileSize > static_cast<Sint64>(sizeof(l_header))) ? static_cast<Uint64>(l_fileSize) - sizeof(l_header) : 0;
+            const Uint64 l_rowSize = static_cast<Uint64>(l_header.m_width) * SDL_BYTESPERPIXEL(l_header.m_format);
+
+            l_valid = l_header.m_pitch <= l_rowSize + 64 && l_header.m_payloadSize <= l_available;
+        }
+
+        SDL_Surface* l_surface = l_valid ? SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(l_header.m_width), static_cast<int>(l_header.m_height), SDL_BITSPERPIXEL(l_header.m_format), l_header.m_format) : nullptr;
+
+        if (l_surface != nullptr && l_header.m_compression == static_cast<Uint16>(Background_Utils::ECompression::NONE))
+        {
+            const size_t l_rowSize = static_cast<size_t>(l_surface->w) * l_surface->format->BytesPerPixel;
+            Uint8* l_pixels = static_cast<Uint8*>(l_surface->pixels);
+
+            l_valid = (l_header.m_payloadSize == static_cast<Uint64>(l_header.m_pitch) * l_header.m_height);
+
+            if (l_valid && l_header.m_pitch == static_cast<Uint32>(l_surface->pitch))
+            {
+                l_valid = SDL_RWread(p_file, l_pixels, l_header.m_payloadSize, 1) == 1;
+            }
+            else
+            {
+                std::vector<Uint8> l_padding(l_header.m_pitch - l_rowSize);
+
+                for (int l_y = 0; l_valid && l_y < l_surface->h; ++l_y)
+                {
+                    l_valid = SDL_RWread(p_file, l_pixels + static_cast<size_t>(l_y) * l_surface->pitch, l_rowSize, 1) == 1
+                           && (l_padding.empty() || SDL_RWread(p_file, l_padding.data(), l_padding.size(), 1) == 1);
+                }
+            }
+        }
+        else if (l_surface != nullptr && l_header.m_compression == static_cast<Uint16>(Background_Utils::ECompression::QOI))
+        {
+            std::vector<Uint8> l_data(l_header.m_payloadSize);
+
+            l_valid = !l_data.empty()
+                   && SDL_RWread(p_file, l_data.data(), l_data.size(), 1) == 1
+                   && decodeQoi(l_data.data(), l_data.size(), l_surface);
+        }
+        else
+        {
+            l_valid = false;
+        }
+
+        SDL_RWclose(p_file);
+
+        if (!l_valid)
+        {
+            SDL_LogError(0, "Invalid background %s", p_path.c_str());
+            if (l_surface != nullptr) SDL_FreeSurface(l_surface);
+            return nullptr;
+        }
+
+        SDL_SetSurfaceBlendMode(l_surface, SDL_BLENDMODE_NONE);
+        p_key = l_header.m_key;
+
+        return l_surface;
+    }
+
+    /**
+     * @brief Largest amount of threads an effect is shared among.
+     */
+    constexpr int s_maxBands = 4;
+
+    /**
+     * @struct SBand
+     * @brief  A share of the work of an effect: a range of rows (or columns), and the task that processes it.
+     */
+    struct SBand
+    {
+        const std::function<void(const int, const int)>* m_task;
+        int m_first;
+        int m_last;
+    };
+
+    /**
+     * @brief        Processes a share of the work of an effect, on its thread.
+     * @param p_band The share (an SBand).
+     * @return       0.
+     */
+    int runBand(void* p_band)
+    {
+        const SBand* l_band = static_cast<const SBand*>(p_band);
+
+        (*l_band->m_task)(l_band->m_first, l_band->m_last);
+
+        return 0;
+    }
+
+    /**
+     * @brief         Shares a task among the cores: the range [0, p_count) is split in a band per core (up to
+     *                s_maxBands), each processed on a thread of its own but the first one, processed on the calling
+     *                thread meanwhile. A band whose thread cannot be created is processed on the calling thread too.
+     * @param p_count The size of the range (e.g. the amount of rows).
+     * @param p_task  The task, called with the first item of a band and the item after its last one.
+     */
+    void runInBands(const int p_count, const std::function<void(const int, const int)>& p_task)
+    {
+        const int l_bandCount = std::max(1, std::min(std::min(SDL_GetCPUCount(), s_maxBands), p_count));
+        std::vector<SBand> l_bands(l_bandCount);
+        std::vector<SDL_Thread*> l_threads(l_bandCount, nullptr);
+
+        for (int l_i = 0; l_i < l_bandCount; ++l_i)
+        {
+            l_bands[l_i].m_task = &p_task;
+            l_bands[l_i].m_first = p_count * l_i / l_bandCount;
+            l_bands[l_i].m_last = p_count * (l_i + 1) / l_bandCount;
+
+            if (l_i > 0) l_threads[l_i] = SDL_CreateThread(runBand, "effects", &l_bands[l_i]);
+        }
+
+        for (int l_i = 0; l_i < l_bandCount; ++l_i)
+        {
+            if (l_threads[l_i] == nullptr) runBand(&l_bands[l_i]);
+        }
+
+        for (SDL_Thread* l_thread : l_threads)
+        {
+            if (l_thread != nullptr) SDL_WaitThread(l_thread, nullptr);
+        }
+    }
+
+    /**
+     * @brief           Gets the factor of the channels that darkens them by a percentage.
+     * @param p_percent How much to darken, in percent.
+     * @return          The factor, in [0, 256] (256 leaves the channels as they are).
+     */
+    Uint32 getDimFactor(const int p_percent)
+    {
+        return static_cast<Uint32>((100 - std::min(100, std::max(0, p_percent))) * 256 / 100);
+    }
+
+    /**
+     * @brief            Copies a row of 32-bit pixels of 8-bit channels, darkened: all the channels (whatever their
+     *                   order) are scaled, out = (p * f) >> 8, then the channels of a mask are kept from the source and
+     *                   the bits of another one are set. Blocks of 4 pixels are darkened at once with SSE2 or NEON.
+     * @param p_source   The pixels.
+     * @param p_target   Output: the darkened pixels (it may be the source).
+     * @param p_count    The amount of pixels.
+     * @param p_factor   The factor, in [0, 256].
+     * @param p_keepMask The bits kept from the source (e.g. the alpha channel).
+     * @param p_setMask  The bits set (e.g. an alpha channel to make opaque).
+     */
+    void dimRow(const Uint32* p_source, Uint32* p_target, const int p_count, const Uint32 p_factor, const Uint32 p_keepMask, const Uint32 p_setMask)
+    {
+        int l_i(0);
+
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i l_zero = _mm_setzero_si128();
+        const __m128i l_factor = _mm_set1_epi16(static_cast<short>(p_factor));
+        const __m128i l_keep = _mm_set1_epi32(static_cast<int>(p_keepMask));
+        const __m128i l_set = _mm_set1_epi32(static_cast<int>(p_setMask));
+
+        for (; l_i + 4 <= p_count; l_i += 4)
+        {
+            const __m128i l_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_source + l_i));
+            const __m128i l_low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(l_pixels, l_zero), l_factor), 8);
+            const __m128i l_high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(l_pixels, l_zero), l_factor), 8);
+            const __m128i l_result = _mm_or_si128(_mm_or_si128(_mm_andnot_si128(l_keep, _mm_packus_epi16(l_low, l_high)), _mm_and_si128(l_pixels, l_keep)), l_set);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p_target + l_i), l_result);
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const uint16_t l_factor = static_cast<uint16_t>(p_factor);
+        const uint32x4_t l_keep = vdupq_n_u32(p_keepMask);
+        const uint32x4_t l_set = vdupq_n_u32(p_setMask);
+
+        for (; l_i + 4 <= p_count; l_i += 4)
+        {
+            const uint8x16_t l_pixels = vld1q_u8(reinterpret_cast<const uint8_t*>(p_source + l_i));
+            const uint8x8_t l_low = vshrn_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(l_pixels)), l_factor), 8);
+            const uint8x8_t l_high = vshrn_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(l_pixels)), l_factor), 8);
+            const uint32x4_t l_dimmed = vreinterpretq_u32_u8(vcombine_u8(l_low, l_high));
+            const uint32x4_t l_result = vorrq_u32(vbslq_u32(l_keep, vreinterpretq_u32_u8(l_pixels), l_dimmed), l_set);
+
+            vst1q_u32(p_target + l_i, l_result);
+        }
+#endif
+
+        for (; l_i < p_count; ++l_i)
+        {
+            const Uint32 l_pixel = p_source[l_i];
+            Uint32 l_result(0);
+
+            for (unsigned int l_shift = 0; l_shift < 32; l_shift += 8)
+            {
+                l_result |= ((((l_pixel >> l_shift) & 0xFF) * p_factor) >> 8) << l_shift;
+            }
+
+            p_target[l_i] = (l_result & ~p_keepMask) | (l_pixel & p_keepMask) | p_setMask;
+        }
+    }
+
+    /**
+     * @brief           Converts a frame of the screen to a background in the format of the screen, darkened. When both
+     *                  formats have the same color channels (they only differ in alpha, if at all), each row is copied
+     *                  by the darkening kernel itself, made opaque (the rows shared among the cores); otherwise, SDL
+     *                  converts the frame and it is then darkened, if asked.
+     * @param p_pixels  The first pixel of the frame.
+     * @param p_width   The width of the frame.
+     * @param p_height  The height of the frame.
+     * @param p_pitch   The distance between rows of the frame, in bytes.
+     * @param p_format  The pixel format of the frame.
+     * @param p_percent How much to darken it, in percent.
+     * @return          Pointer to the background, or nullptr if it could not be created.
+     */
+    SDL_Surface* convertFrame(const Uint8* p_pixels, const int p_width, const int p_height, const int p_pitch, const Uint32 p_format, const int p_percent)
+    {
+        const Uint32 l_targetFormat = (Globals::g_screen != nullptr) ? Globals::g_screen->format->format : p_format;
+        SDL_Surface* l_target = SDL_CreateRGBSurfaceWithFormat(0, p_width, p_height, SDL_BITSPERPIXEL(l_targetFormat), l_targetFormat);
+
+        if (l_target == nullptr) return nullptr;
+
+        int l_bitsPerPixel(0);
+        Uint32 l_red(0), l_green(0), l_blue(0), l_alpha(0);
+        SDL_PixelFormatEnumToMasks(p_format, &l_bitsPerPixel, &l_red, &l_green, &l_blue, &l_alpha);
+
+        const SDL_PixelFormat* l_format = l_target->format;
+
+        if (l_bitsPerPixel == 32 && l_format->BytesPerPixel == 4 && l_red == l_format->Rmask && l_green == l_format->Gmask && l_blue == l_format->Bmask && p_format != SDL_PIXELFORMAT_ARGB2101010)
+        {
+            runInBands(p_height, [&](const int p_first, const int p_last)
+            {
+                for (int l_y = p_first; l_y < p_last; ++l_y)
+                {
+                    const Uint32* l_source = reinterpret_cast<const Uint32*>(p_pixels + static_cast<size_t>(l_y) * p_pitch);
+                    Uint32* l_row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(l_target->pixels) + static_cast<size_t>(l_y) * l_target->pitch);
+
+                    dimRow(l_source, l_row, p_width, getDimFactor(p_percent), 0, l_format->Amask);
+                }
+            });
+        }
+        else
+        {
+            SDL_Surface* l_frame = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<Uint8*>(p_pixels), p_width, p_height, l_bitsPerPixel, p_pitch, p_format);
+
+            if (l_frame == nullptr)
+            {
+                SDL_FreeSurface(l_target);
+                return nullptr;
+            }
+
+            SDL_SetSurfaceBlendMode(l_frame, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(l_frame, nullptr, l_target, nullptr);
+            SDL_FreeSurface(l_frame);
+            l_target = Background_Utils::dim(l_target, p_percent);
+        }
+
+        if (l_target != nullptr) SDL_SetSurfaceBlendMode(l_target, SDL_BLENDMODE_NONE);
+
+        return l_target;
+    }
+
+    /**
+     * @brief           Converts a surface of other depth than 16 or 32 bits (or with a palette) to the format of the
+     *                  screen, so the effects work on its pixels.
+     * @param p_surface The surface (freed, if it is converted).
+     * @return          Pointer to the surface, or to the converted one (nullptr if it could not be converted).
+     */
+    SDL_Surface* toDirectColor(SDL_Surface* p_surface)
+    {
+        if ((p_surface->format->BytesPerPixel == 2 || p_surface->format->BytesPerPixel == 4) && p_surface->format->palette == nullptr) return p_surface;
+
+        SDL_Surface* l_converted = (Globals::g_screen != nullptr) ? SDL_ConvertSurface(p_surface, Globals::g_screen->format, 0) : SDL_ConvertSurfaceFormat(p_surface, SDL_PIXELFORMAT_XRGB8888, 0);
+
+        SDL_FreeSurface(p_surface);
+
+        return l_converted;
+    }
+
+    /**
+     * @brief               Blurs rows of 32-bit pixels of 8-bit channels horizontally, with a box filter: each pixel
+     *                      becomes the average of the 2r+1 pixels around it (the pixels of the edges are repeated past
+     *                      them). A window of sums slides along the row, adding the pixel entering it and removing the
+     *                      one leaving it, the 4 channels at once with SSE2 or NEON. The average is taken as
+     *                      (sum * inverse) >> 16, the sum starting at r so it is rounded.
+     * @param p_source      The first pixel of the source.
+     * @param p_sourcePitch The distance between rows of the source, in bytes.
+     * @param p_target      Output: the first pixel of the target (another buffer than the source).
+     * @param p_targetPitch The distance between rows of the target, in bytes.
+     * @param p_width       The width of the rows.
+     * @param p_first       The first row.
+     * @param p_last        The row after the last one.
+     * @param p_radius      The radius of the filter, r.
+     * @param p_inverse     The inverse of the width of the filter: 65536 / (2r+1), rounded up.
+     */
+    void blurRows(const Uint8* p_source, const int p_sourcePitch, Uint8* p_target, const int p_targetPitch, const int p_width, const int p_first, const int p_last, const int p_radius, const Uint16 p_inverse)
+    {
+        const int l_lastColumn = p_width - 1;
+
+        for (int l_y = p_first; l_y < p_last; ++l_y)
+        {
+            const Uint32* l_source = reinterpret_cast<const Uint32*>(p_source + static_cast<size_t>(l_y) * p_sourcePitch);
+            Uint32* l_target = reinterpret_cast<Uint32*>(p_target + static_cast<size_t>(l_y) * p_targetPitch);
+
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i l_zero = _mm_setzero_si128();
+            const __m128i l_inverse = _mm_set1_epi16(static_cast<short>(p_inverse));
+            auto l_load = [&l_zero](const Uint32 p_pixel) { return _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(p_pixel)), l_zero); };
+            __m128i l_sum = _mm_add_epi16(_mm_mullo_epi16(l_load(l_source[0]), _mm_set1_epi16(static_cast<short>(p_radius + 1))), _mm_set1_epi16(static_cast<short>(p_radius)));
+
+            for (int l_x = 1; l_x <= p_radius; ++l_x) l_sum = _mm_add_epi16(l_sum, l_load(l_source[std::min(l_x, l_lastColumn)]));
+
+            for (int l_x = 0; l_x < p_width; ++l_x)
+            {
+                const __m128i l_average = _mm_mulhi_epu16(l_sum, l_inverse);
+
+                l_target[l_x] = static_cast<Uint32>(_mm_cvtsi128_si32(_mm_packus_epi16(l_average, l_average)));
+                l_sum = _mm_sub_epi16(_mm_add_epi16(l_sum, l_load(l_source[std::min(l_x + p_radius + 1, l_lastColumn)])), l_load(l_source[std::max(l_x - p_radius, 0)]));
+            }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+            const uint16x4_t l_inverse = vdup_n_u16(p_inverse);
+            auto l_load = [](const Uint32 p_pixel) { return vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(p_pixel)))); };
+            uint16x4_t l_sum = vadd_u16(vmul_n_u16(l_load(l_source[0]), static_cast<uint16_t>(p_radius + 1)), vdup_n_u16(static_cast<uint16_t>(p_radius)));
+
+            for (int l_x = 1; l_x <= p_radius; ++l_x) l_sum = vadd_u16(l_sum, l_load(l_source[std::min(l_x, l_lastColumn)]));
+
+            for (int l_x = 0; l_x < p_width; ++l_x)
+            {
+                const uint16x4_t l_average = vshrn_n_u32(vmull_u16(l_sum, l_inverse), 16);
+
+                l_target[l_x] = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(l_average, l_average))), 0);
+                l_sum = vsub_u16(vadd_u16(l_sum, l_load(l_source[std::min(l_x + p_radius + 1, l_lastColumn)])), l_load(l_source[std::max(l_x - p_radius, 0)]));
+            }
+#else
+            Uint32 l_sum[4];
+
+            for (unsigned int l_channel = 0; l_channel < 4; ++l_channel)
+            {
+                l_sum[l_channel] = ((l_source[0] >> (l_channel * 8)) & 0xFF) * (p_radius + 1) + p_radius;
+
+                for (int l_x = 1; l_x <= p_radius; ++l_x) l_sum[l_channel] += (l_source[std::min(l_x, l_lastColumn)] >> (l_channel * 8)) & 0xFF;
+            }
+
+            for (int l_x = 0; l_x < p_width; ++l_x)
+            {
+                const Uint32 l_entering = l_source[std::min(l_x + p_radius + 1, l_lastColumn)];
+                const Uint32 l_leaving = l_source[std::max(l_x - p_radius, 0)];
+                Uint32 l_result(0);
+
+                for (unsigned int l_channel = 0; l_channel < 4; ++l_channel)
+                {
+                    l_result |= ((l_sum[l_channel] * p_inverse) >> 16) << (l_channel * 8);
+                    l_sum[l_channel] += ((l_entering >> (l_channel * 8)) & 0xFF) - ((l_leaving >> (l_channel * 8)) & 0xFF);
+                }
+
+                l_target[l_x] = l_result;
+            }
+#endif
+        }
+    }
+
+    /**
+     * @brief               Blurs columns of 32-bit pixels of 8-bit channels vertically, with the box filter of
+     *                      blurRows. The window slides down a row at a time, keeping a sum per channel of the columns:
+     *                      16 channels (4 pixels) are averaged and updated at once with SSE2 or NEON.
+     * @param p_source      The first pixel of the source.
+     * @param p_sourcePitch The distance between rows of the source, in bytes.
+     * @param p_target      Output: the first pixel of the target (another buffer than the source).
+     * @param p_targetPitch The distance between rows of the target, in bytes.
+     * @param p_height      The height of the columns.
+     * @param p_first       The first column.
+     * @param p_last        The column after the last one.
+     * @param p_radius      The radius of the filter, r.
+     * @param p_inverse     The inverse of the width of the filter: 65536 / (2r+1), rounded up.
+     */
+    void blurColumns(const Uint8* p_source, const int p_sourcePitch, Uint8* p_target, const int p_targetPitch, const int p_height, const int p_first, const int p_last, const int p_radius, const Uint16 p_inverse)
+    {
+        // The columns are counted in pixels, the sums in channels
+        const size_t l_offset = static_cast<size_t>(p_first) * 4;
+        const int l_count = (p_last - p_first) * 4;
+        auto l_row = [&](const int p_y) { return p_source + static_cast<size_t>(std::min(std::max(p_y, 0), p_height - 1)) * p_sourcePitch + l_offset; };
+        std::vector<Uint16> l_sums(l_count);
+
+        for (int l_i = 0; l_i < l_count; ++l_i) l_sums[l_i] = static_cast<Uint16>(l_row(0)[l_i] * (p_radius + 1) + p_radius);
+
+        for (int l_y = 1; l_y <= p_radius; ++l_y)
+        {
+            const Uint8* l_source = l_row(l_y);
+
+            for (int l_i = 0; l_i < l_count; ++l_i) l_sums[l_i] = static_cast<Uint16>(l_sums[l_i] + l_source[l_i]);
+        }
+
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i l_zero = _mm_setzero_si128();
+        const __m128i l_inverse = _mm_set1_epi16(static_cast<short>(p_inverse));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const uint16x4_t l_inverse = vdup_n_u16(p_inverse);
+        auto l_average = [&l_inverse](const uint16x8_t p_sum) { return vmovn_u16(vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(p_sum), l_inverse), 16), vshrn_n_u32(vmull_u16(vget_high_u16(p_sum), l_inverse), 16))); };
+#endif
+
+        for (int l_y = 0; l_y < p_height; ++l_y)
+        {
+            const Uint8* l_entering = l_row(l_y + p_radius + 1);
+            const Uint8* l_leaving = l_row(l_y - p_radius);
+            Uint8* l_target = p_target + static_cast<size_t>(l_y) * p_targetPitch + l_offset;
+            Uint16* l_sum = l_sums.data();
+            int l_i(0);
+
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; l_i + 16 <= l_count; l_i += 16)
+            {
+                __m128i l_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_sum + l_i));
+                __m128i l_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_sum + l_i + 8));
+                const __m128i l_in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_entering + l_i));
+                const __m128i l_out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_leaving + l_i));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(l_target + l_i), _mm_packus_epi16(_mm_mulhi_epu16(l_low, l_inverse), _mm_mulhi_epu16(l_high, l_inverse)));
+
+                l_low = _mm_sub_epi16(_mm_add_epi16(l_low, _mm_unpacklo_epi8(l_in, l_zero)), _mm_unpacklo_epi8(l_out, l_zero));
+                l_high = _mm_sub_epi16(_mm_add_epi16(l_high, _mm_unpackhi_epi8(l_in, l_zero)), _mm_unpackhi_epi8(l_out, l_zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(l_sum + l_i), l_low);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(l_sum + l_i + 8), l_high);
+            }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+            for (; l_i + 16 <= l_count; l_i += 16)
+            {
+                const uint16x8_t l_low = vld1q_u16(l_sum + l_i);
+                const uint16x8_t l_high = vld1q_u16(l_sum + l_i + 8);
+                const uint8x16_t l_in = vld1q_u8(l_entering + l_i);
+                const uint8x16_t l_out = vld1q_u8(l_leaving + l_i);
+
+                vst1q_u8(l_target + l_i, vcombine_u8(l_average(l_low), l_average(l_high)));
+                vst1q_u16(l_sum + l_i, vsubw_u8(vaddw_u8(l_low, vget_low_u8(l_in)), vget_low_u8(l_out)));
+                vst1q_u16(l_sum + l_i + 8, vsubw_u8(vaddw_u8(l_high, vget_high_u8(l_in)), vget_high_u8(l_out)));
+            }
+#endif
+
+            for (; l_i < l_count; ++l_i)
+            {
+                l_target[l_i] = static_cast<Uint8>((static_cast<Uint32>(l_sum[l_i]) * p_inverse) >> 16);
+                l_sum[l_i] = static_cast<Uint16>(l_sum[l_i] + l_entering[l_i] - l_leaving[l_i]);
+            }
+        }
+    }
+
+    /**
+     * @brief          Scales an image, smoothly, to the size of the background, and flattens it onto an opaque surface
+     *                 in the pixel format of the background (as the keyboard draws it onto the screen, scaled to the
+     *                 same size).
+     * @param p_image  The image (freed).
+     * @param p_width  The width of the background.
+     * @param p_height The height of the background.
+     * @param p_format The pixel format of the background.
+     * @return         Pointer to the background, or nullptr if it could not be created.
+     */
+    SDL_Surface* fit(SDL_Surface* p_image, const int p_width, const int p_height, const Uint32 p_format)
+    {
+        SDL_Surface* l_scaled = p_image;
+
+        if (p_image->w != p_width || p_image->h != p_height)
+        {
+            l_scaled = zoomSurface(p_image, static_cast<double>(p_width) / p_image->w, static_cast<double>(p_height) / p_image->h, SMOOTHING_ON);
+            SDL_FreeSurface(p_image);
+        }
+
+        SDL_Surface* l_background = SDL_CreateRGBSurfaceWithFormat(0, p_width, p_height, SDL_BITSPERPIXEL(p_format), p_format);
+
+        if (l_scaled == nullptr || l_background == nullptr)
+        {
+            if (l_scaled != nullptr) SDL_FreeSurface(l_scaled);
+            if (l_background != nullptr) SDL_FreeSurface(l_background);
+            return nullptr;
+        }
+
+        // The zoom factors may round the scaled image a pixel off the background
+        SDL_FillRect(l_background, nullptr, SDL_MapRGBA(l_background->format, 0, 0, 0, 255));
+        SDL_BlitScaled(l_scaled, nullptr, l_background, nullptr);
+        SDL_FreeSurface(l_scaled);
+        SDL_SetSurfaceBlendMode(l_background, SDL_BLENDMODE_NONE);
+
+        return l_background;
+    }
+
+    /**
+     * @brief               Writes a prepared background.
+     * @param p_background  The background.
+     * @param p_destination The path of the prepared background.
+     * @param p_compression The encoding of the pixels.
+     * @param p_key         The key of the background (see SHeader).
+     * @return              TRUE if the background was written; otherwise, FALSE.
+     */
+    const bool writePrepared(const SDL_Surface* p_background, const std::string& p_destination, const Background_Utils::ECompression p_compression, const Uint32 p_key)
+    {
+        std::vector<Uint8> l_payload;
+
+        if (p_compression == Background_Utils::ECompression::QOI)
+        {
+            encodeQoi(p_background, l_payload);
+        }
+        else
+        {
+            const Uint8* l_pixels = static_cast<const Uint8*>(p_background->pixels);
+            l_payload.assign(l_pixels, l_pixels + static_cast<size_t>(p_background->pitch) * p_background->h);
+        }
+
+        SHeader l_header;
+        std::memcpy(l_header.m_magic, s_magic, sizeof(s_magic));
+        l_header.m_version = BACKGROUND_VERSION;
+        l_header.m_compression = static_cast<Uint16>(p_compression);
+        l_header.m_width = static_cast<Uint32>(p_background->w);
+        l_header.m_height = static_cast<Uint32>(p_background->h);
+        l_header.m_format = p_background->format->format;
+        l_header.m_pitch = static_cast<Uint32>(p_background->pitch);
+        l_header.m_payloadSize = static_cast<Uint32>(l_payload.size());
+        l_header.m_key = p_key;
+
+        SDL_RWops* l_file = SDL_RWFromFile(p_destination.c_str(), "wb");
+
+        if (l_file == nullptr)
+        {
+            SDL_LogError(0, "Could not create background %s: %s", p_destination.c_str(), SDL_GetError());
+            return false;
+        }
+
+        const bool l_written = SDL_RWwrite(l_file, &l_header, sizeof(l_header), 1) == 1
+                            && SDL_RWwrite(l_file, l_payload.data(), 1, l_payload.size()) == l_payload.size();
+        SDL_RWclose(l_file);
+
+        if (l_written == false) SDL_LogError(0, "Could not write background %s: %s", p_destination.c_str(), SDL_GetError());
+
+        return l_written;
+    }
+
+#ifdef SCALED_DECODE
+
+    /**
+     * @class CBoxFilter
+     * @brief Shrinks an image row by row, as it is decoded: each pixel of the target is the average of the pixels of
+     *        the source it covers, so only a row of sums is kept, whatever the size of the source.
+     */
+    class CBoxFilter
+    {
+        public:
+
+        /**
+         * @brief Constructor for the filter, without a target.
+         */
+        CBoxFilter(void) :
+            m_target(nullptr), m_sourceHeight(0), m_sourceRow(0), m_targetRow(0), m_rowCount(0), m_columns(), m_columnCounts(), m_sums()
+        {
+            // Nothing to do here. The filter is set up when the size of the source is known.
+        }
+
+        /**
+         * @brief                Sets up the filter for an image.
+         * @param p_target       The target, of RGBA32 format, no larger than the source.
+         * @param p_sourceWidth  The width of the source.
+         * @param p_sourceHeight The height of the source.
+         */
+        void reset(SDL_Surface* p_target, const int p_sourceWidth, const int p_sourceHeight)
+        {
+            // Map each column of the source to the column of the target it falls in.
+
+            m_target = p_target;
+            m_sourceHeight = p_sourceHeight;
+            m_sourceRow = 0;
+            m_targetRow = 0;
+            m_rowCount = 0;
+            m_columns.resize(p_sourceWidth);
+            m_columnCounts.assign(p_target->w, 0);
+            m_sums.assign(static_cast<size_t>(p_target->w) * 4, 0);
+
+            for (int l_x = 0; l_x < p_sourceWidth; ++l_x)
+            {
+                m_columns[l_x] = static_cast<int>(static_cast<Uint64>(l_x) * p_target->w / p_sourceWidth);
+                ++m_columnCounts[m_columns[l_x]];
+            }
+        }
+
+        /**
+         * @brief            Adds the next row of the source.
+         * @param p_row      The row: RGB or RGBA pixels, 8 bits per channel.
+         * @param p_channels The amount of channels (3 or 4; without alpha, the pixels are opaque).
+         */
+        void addRow(const Uint8* p_row, const int p_channels)
+        {
+            // 1. Write the row of the target being summed when this row of the source falls in the next one.
+            // 2. Add the pixels of the row to the sums of their columns. Write the last row after the last one.
+
+            const int l_targetRow = static_cast<int>(static_cast<Uint64>(m_sourceRow) * m_target->h / m_sourceHeight);
+
+            if (l_targetRow != m_targetRow) flush(l_targetRow);
+
+            for (size_t l_x = 0; l_x < m_columns.size(); ++l_x, p_row += p_channels)
+            {
+                Uint32* l_sum = &m_sums[static_cast<size_t>(m_columns[l_x]) * 4];
+
+                l_sum[0] += p_row[0];
+                l_sum[1] += p_row[1];
+                l_sum[2] += p_row[2];
+                l_sum[3] += (p_channels == 4) ? p_row[3] : 255;
+            }
+
+            ++m_rowCount;
+
+            if (++m_sourceRow == m_sourceHeight) flush(m_targetRow + 1);
+        }
+
+        private:
+
+        /**
+         * @brief             Writes the averages of the row of the target being summed, and starts another one.
+         * @param p_targetRow The next row of the target.
+         */
+        void flush(const int p_targetRow)
+        {
+            Uint8* l_pixel = static_cast<Uint8*>(m_target->pixels) + static_cast<size_t>(m_targetRow) * m_target->pitch;
+
+            for (int l_x = 0; l_x < m_target->w; ++l_x, l_pixel += 4)
+            {
+                const Uint32 l_count = m_columnCounts[l_x] * m_rowCount;
+                const Uint32* l_sum = &m_sums[static_cast<size_t>(l_x) * 4];
+
+                for (int l_channel = 0; l_channel < 4; ++l_channel)
+                {
+                    l_pixel[l_channel] = static_cast<Uint8>((l_sum[l_channel] + l_count / 2) / l_count);
+                }
+            }
+
+            std::fill(m_sums.begin(), m_sums.end(), 0);
+            m_rowCount = 0;
+            m_targetRow = p_targetRow;
+        }
+
+        /**
+         * @brief The target.
+         */
+        SDL_Surface* m_target;
+
+        /**
+         * @brief The height of the source, the next row of the source, the row of the target being summed, and the
+         *        amount of rows of the source summed into it.
+         */
+        int m_sourceHeight;
+        int m_sourceRow;
+        int m_targetRow;
+        Uint32 m_rowCount;
+
+        /**
+         * @brief The column of the target of each column of the source, and the amount of columns of the source
+         *        falling in each column of the target.
+         */
+        std::vector<int> m_columns;
+        std::vector<Uint32> m_columnCounts;
+
+        /**
+         * @brief The sums of the channels of the row of the target being summed.
+         */
+        std::vector<Uint32> m_sums;
+    };
+
+    /**
+     * @struct SJpegError
+     * @brief  Error handler of libjpeg, which jumps back to the decoder instead of exiting.
+     */
+    struct SJpegError
+    {
+        jpeg_error_mgr m_manager;
+        jmp_buf m_jump;
+    };
+
+    /**
+     * @brief        Jumps back to the decoder on a fatal error of libjpeg.
+     * @param p_info The decompressor.
+     */
+    void exitJpeg(j_common_ptr p_info)
+    {
+        longjmp(reinterpret_cast<SJpegError*>(p_info->err)->m_jump, 1);
+    }
+
+    /**
+     * @brief          Decodes a JPEG image no smaller than a size, shrunk to it: the largest reduction (1/2, 1/4 or
+     *                 1/8) still larger than the size is done by the DCT itself, and the rest by a box filter.
+     * @param p_data   The image.
+     * @param p_size   The size of the image, in bytes.
+     * @param p_width  The width of the target.
+     * @param p_height The height of the target.
+     * @return         The image (RGBA32), or nullptr if it is invalid, unsupported or smaller than the target.
+     */
+    SDL_Surface* decodeJpeg(const Uint8* p_data, const size_t p_size, const int p_width, const int p_height)
+    {
+        // 1. Read the header.
+        // 2. Choose the reduction, and the fast settings (the image is filtered afterwards, so the fast DCT and
+        //    upsampling make no visible difference).
+        // 3. Decode the image row by row into the filter.
+
+        jpeg_decompress_struct l_info;
+        SJpegError l_error;
+        std::vector<Uint8> l_row;
+        CBoxFilter l_filter;
+        SDL_Surface* volatile l_target(nullptr);
+
+        l_info.err = jpeg_std_error(&l_error.m_manager);
+        l_error.m_manager.error_exit = exitJpeg;
+
+        if (setjmp(l_error.m_jump))
+        {
+            jpeg_destroy_decompress(&l_info);
+            if (l_target != nullptr) SDL_FreeSurface(l_target);
+            return nullptr;
+        }
+
+        jpeg_create_decompress(&l_info);
+        jpeg_mem_src(&l_info, const_cast<unsigned char*>(p_data), static_cast<unsigned long>(p_size));
+        jpeg_read_header(&l_info, TRUE);
+
+        if (l_info.image_width < static_cast<JDIMENSION>(p_width) || l_info.image_height < static_cast<JDIMENSION>(p_height))
+        {
+            jpeg_destroy_decompress(&l_info);
+            return nullptr;
+        }
+
+        unsigned int l_denominator(8);
+
+        while (l_denominator > 1 && ((l_info.image_width + l_denominator - 1) / l_denominator < static_cast<JDIMENSION>(p_width) || (l_info.image_height + l_denominator - 1) / l_denominator < static_cast<JDIMENSION>(p_height)))
+        {
+            l_denominator >>= 1;
+        }
+
+        l_info.scale_num = 1;
+        l_info.scale_denom = l_denominator;
+        l_info.out_color_space = JCS_RGB;
+        l_info.dct_method = JDCT_IFAST;
+        l_info.do_fancy_upsampling = FALSE;
+        jpeg_start_decompress(&l_info);
+
+        l_target = SDL_CreateRGBSurfaceWithFormat(0, p_width, p_height, 32, SDL_PIXELFORMAT_RGBA32);
+
+        if (l_target == nullptr)
+        {
+            jpeg_destroy_decompress(&l_info);
+            return nullptr;
+        }
+
+        l_row.resize(static_cast<size_t>(l_info.output_width) * l_info.output_components);
+        l_filter.reset(l_target, static_cast<int>(l_info.output_width), static_cast<int>(l_info.output_height));
+
+        while (l_info.output_scanline < l_info.output_height)
+        {
+            JSAMPROW l_rows[1] = { l_row.data() };
+
+            jpeg_read_scanlines(&l_info, l_rows, 1);
+            l_filter.addRow(l_row.data(), 3);
+        }
+
+        jpeg_finish_decompress(&l_info);
+        jpeg_destroy_decompress(&l_info);
+        SDL_SetSurfaceBlendMode(l_target, SDL_BLENDMODE_NONE);
+
+        return l_target;
+    }
+
+    /**
+     * @struct SPngReader
+     * @brief  Source of libpng: an image in memory, and the position read.
+     */
+    struct SPngReader
+    {
+        const Uint8* m_data;
+        size_t m_size;
+        size_t m_position;
+    };
+
+    /**
+     * @brief          Reads the next bytes of the image, for libpng.
+     * @param p_png    The decoder.
+     * @param p_buffer Output: the bytes.
+     * @param p_length The amount of bytes.
+     */
+    void readPng(png_structp p_png, png_bytep p_buffer, png_size_t p_length)
+    {
+        SPngReader* l_reader = static_cast<SPngReader*>(png_get_io_ptr(p_png));
+
+        if (p_length > l_reader->m_size - l_reader->m_position) png_error(p_png, "Truncated image");
+
+        std::memcpy(p_buffer, l_reader->m_data + l_reader->m_position, p_length);
+        l_reader->m_position += p_length;
+    }
+
+    /**
+     * @brief          Decodes a PNG image no smaller than a size, shrunk to it: the image is inflated row by row, and
+     *                 each row goes through a box filter.
+     * @param p_data   The image.
+     * @param p_size   The size of the image, in bytes.
+     * @param p_width  The width of the target.
+     * @param p_height The height of the target.
+     * @return         The image (RGBA32), or nullptr if it is invalid, interlaced or smaller than the target.
+     */
+    SDL_Surface* decodePng(const Uint8* p_data, const size_t p_size, const int p_width, const int p_height)
+    {
+        // 1. Read the header. Interlaced images cannot be read row by row.
+        // 2. Have libpng expand every kind of pixel to 8-bit RGBA.
+        // 3. Decode the image row by row into the filter. Images without transparency stay opaque.
+
+        png_structp l_png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop l_info = (l_png != nullptr) ? png_create_info_struct(l_png) : nullptr;
+        SPngReader l_reader{ p_data, p_size, 0 };
+        std::vector<Uint8> l_row;
+        CBoxFilter l_filter;
+        SDL_Surface* volatile l_target(nullptr);
+
+        if (l_info == nullptr)
+        {
+            png_destroy_read_struct(&l_png, nullptr, nullptr);
+            return nullptr;
+        }
+
+        if (setjmp(png_jmpbuf(l_png)))
+        {
+            png_destroy_read_struct(&l_png, &l_info, nullptr);
+            if (l_target != nullptr) SDL_FreeSurface(l_target);
+            return nullptr;
+        }
+
+        png_set_read_fn(l_png, &l_reader, readPng);
+        png_read_info(l_png, l_info);
+
+        const png_uint_32 l_width = png_get_image_width(l_png, l_info);
+        const png_uint_32 l_height = png_get_image_height(l_png, l_info);
+        const bool l_opaque = (png_get_color_type(l_png, l_info) & PNG_COLOR_MASK_ALPHA) == 0 && png_get_valid(l_png, l_info, PNG_INFO_tRNS) == 0;
+
+        if (l_width < static_cast<png_uint_32>(p_width) || l_height < static_cast<png_uint_32>(p_height) || png_get_interlace_type(l_png, l_info) != PNG_INTERLACE_NONE)
+        {
+            png_destroy_read_struct(&l_png, &l_info, nullptr);
+            return nullptr;
+        }
+
+        png_set_expand(l_png);
+        png_set_strip_16(l_png);
+        png_set_gray_to_rgb(l_png);
+        png_set_filler(l_png, 0xFF, PNG_FILLER_AFTER);
+        png_read_update_info(l_png, l_info);
+
+        l_target = SDL_CreateRGBSurfaceWithFormat(0, p_width, p_height, 32, SDL_PIXELFORMAT_RGBA32);
+
+        if (l_target == nullptr)
+        {
+            png_destroy_read_struct(&l_png, &l_info, nullptr);
+            return nullptr;
+        }
+
+        l_row.resize(png_get_rowbytes(l_png, l_info));
+        l_filter.reset(l_target, static_cast<int>(l_width), static_cast<int>(l_height));
+
+        for (png_uint_32 l_y = 0; l_y < l_height; ++l_y)
+        {
+            png_read_row(l_png, l_row.data(), nullptr);
+            l_filter.addRow(l_row.data(), 4);
+        }
+
+        png_destroy_read_struct(&l_png, &l_info, nullptr);
+
+        if (l_opaque) SDL_SetSurfaceBlendMode(l_target, SDL_BLENDMODE_NONE);
+
+        return l_target;
+    }
+
+    /**
+     * @brief          Loads an image shrunk to a size while it is decoded, if it is a JPEG or PNG image larger than
+     *                 it; otherwise, decodes it whole.
+     * @param p_file   The stream of the image (closed here).
+     * @param p_width  The width of the target.
+     * @param p_height The height of the target.
+     * @return         Pointer to the image, or nullptr if it could not be loaded (see IMG_GetError).
+     */
+    SDL_Surface* loadScaled(SDL_RWops* p_file, const int p_width, const int p_height)
+    {
+        // 1. Read the compressed image (much smaller than the decoded one).
+        // 2. Recognize JPEG and PNG images by their signature, and decode them shrunk.
+        // 3. Have SDL_image decode anything else, or anything they could not decode.
+
+        const Sint64 l_size = SDL_RWsize(p_file);
+        std::vector<Uint8> l_data(l_size > 0 ? static_cast<size_t>(l_size) : 0);
+        const bool l_read = !l_data.empty() && SDL_RWread(p_file, l_data.data(), l_data.size(), 1) == 1;
+
+        SDL_RWclose(p_file);
+
+        if (!l_read)
+        {
+            IMG_SetError("Could not read the image");
+            return nullptr;
+        }
+
+        const Uint8 l_jpegSignature[3] = { 0xFF, 0xD8, 0xFF };
+        const Uint8 l_pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        SDL_Surface* l_image(nullptr);
+
+        if (l_data.size() >= sizeof(l_jpegSignature) && std::memcmp(l_data.data(), l_jpegSignature, sizeof(l_jpegSignature)) == 0)
+        {
+            l_image = decodeJpeg(l_data.data(), l_data.size(), p_width, p_height);
+        }
+        else if (l_data.size() >= sizeof(l_pngSignature) && std::memcmp(l_data.data(), l_pngSignature, sizeof(l_pngSignature)) == 0)
+        {
+            l_image = decodePng(l_data.data(), l_data.size(), p_width, p_height);
+        }
+
+        return (l_image != nullptr) ? l_image : IMG_Load_RW(SDL_RWFromConstMem(l_data.data(), static_cast<int>(l_data.size())), 1);
+    }
+
+#endif // SCALED_DECODE
+} // namespace
+
+const bool Background_Utils::isPrepared(const std::string& p_path)
+{
+    const size_t l_length = std::strlen(BACKGROUND_EXT);
+
+    return p_path.size() > l_length && p_path.compare(p_path.size() - l_length, l_length, BACKGROUND_EXT) == 0;
+}
+
+SDL_Surface* Background_Utils::load(const std::string& p_path, const int p_width, const int p_height)
+{
+    // 1. Open the background (or the packed background, see CResourcePack).
+    // 2. Load a prepared background, converted to the format of the screen if it was prepared for another one (once,
+    //    so the background is still copied to the screen as is). Decode any other image (shrunk to the size it is
+    //    drawn at, if possible).
+    // 3. Return the pointer (a valid one or a null pointer).
+
+    SDL_RWops* l_file = CResourcePack::instance().open(p_path);
+
+    if (l_file == nullptr)
+    {
+        SDL_LogError(0, "Could not open background %s: %s", p_path.c_str(), SDL_GetError());
+        return nullptr;
+    }
+
+    if (isPrepared(p_path))
+    {
+        Uint32 l_key(0);
+        SDL_Surface* l_background = loadPrepared(l_file, p_path, l_key);
+
+        if (l_background != nullptr && Globals::g_screen != nullptr && l_background->format->format != Globals::g_screen->format->format)
+        {
+            SDL_Surface* l_converted = SDL_ConvertSurface(l_background, Globals::g_screen->format, 0);
+
+            if (l_converted != nullptr)
+            {
+                SDL_FreeSurface(l_background);
+                l_background = l_converted;
+                SDL_SetSurfaceBlendMode(l_background, SDL_BLENDMODE_NONE);
+            }
+        }
+
+        return l_background;
+    }
+
+#ifdef SCALED_DECODE
+    SDL_Surface* l_image = loadScaled(l_file, p_width, p_height);
+#else
+    SDL_Surface* l_image = IMG_Load_RW(l_file, 1);
+#endif // SCALED_DECODE
+
+    if (l_image == nullptr)
+    {
+        SDL_LogError(0, "Could not load background %s: %s", p_path.c_str(), IMG_GetError());
+    }
+
+    return l_image;
+}
+
+SDL_Surface* Background_Utils::capture(const std::string& p_path, const int p_width, const int p_height, const int p_dim)
+{
+    // 1. Open the framebuffer. A device tells the geometry and pixel format of its visible frame (it may be the second
+    //    page of a double-buffered framebuffer). A dump has the size of the screen, and its size tells its depth.
+    // 2. Map it (read it, where mapping is not supported), and check that the frame fits in it.
+    // 3. Convert the frame, darkened, and unmap it.
+
+    int l_width(p_width), l_height(p_height), l_pitch(0);
+    Uint32 l_format(SDL_PIXELFORMAT_UNKNOWN);
+    size_t l_offset(0), l_size(0);
+
+#ifdef _WIN64
+    Uint8* l_data = static_cast<Uint8*>(SDL_LoadFile(p_path.c_str(), &l_size));
+
+    if (l_data == nullptr)
+    {
+        SDL_LogError(0, "Could not capture the screen from %s: %s", p_path.c_str(), SDL_GetError());
+        return nullptr;
+    }
+
+    const Uint8* l_image = l_data;
+#else
+    const int l_file = ::open(p_path.c_str(), O_RDONLY);
+
+    if (l_file < 0)
+    {
+        SDL_LogError(0, "Could not capture the screen from %s", p_path.c_str());
+        return nullptr;
+    }
+
+    bool l_device(false);
+
+#ifdef __linux__
+    fb_var_screeninfo l_variable;
+    fb_fix_screeninfo l_fixed;
+
+    if (ioctl(l_file, FBIOGET_VSCREENINFO, &l_variable) == 0 && ioctl(l_file, FBIOGET_FSCREENINFO, &l_fixed) == 0)
+    {
+        l_device = true;
+        l_width = static_cast<int>(l_variable.xres);
+        l_height = static_cast<int>(l_variable.yres);
+        l_pitch = static_cast<int>(l_fixed.line_length);
+        l_offset = static_cast<size_t>(l_variable.yoffset) * l_fixed.line_length + static_cast<size_t>(l_variable.xoffset) * (l_variable.bits_per_pixel / 8);
+        l_size = l_fixed.smem_len;
+        l_format = SDL_MasksToPixelFormatEnum(static_cast<int>(l_variable.bits_per_pixel),
+                                              ((1u << l_variable.red.length) - 1) << l_variable.red.offset,
+                                              ((1u << l_variable.green.length) - 1) << l_variable.green.offset,
+                                              ((1u << l_variable.blue.length) - 1) << l_variable.blue.offset,
+                                              ((1u << l_variable.transp.length) - 1) << l_variable.transp.offset);
+    }
+#endif // __linux__
+
+    struct stat l_status;
+
+    if (!l_device && fstat(l_file, &l_status) == 0)
+    {
+        l_size = static_cast<size_t>(l_status.st_size);
+    }
+
+    void* l_mapping = (l_size > 0) ? mmap(nullptr, l_size, PROT_READ, MAP_SHARED, l_file, 0) : MAP_FAILED;
+    close(l_file);
+
+    if (l_mapping == MAP_FAILED)
+    {
+        SDL_LogError(0, "Could not map the screen from %s", p_path.c_str());
+        return nullptr;
+    }
+
+    const Uint8* l_image = static_cast<const Uint8*>(l_mapping);
+
+    if (!l_device)
+#endif // _WIN64
+    {
+        const size_t l_pixelCount = static_cast<size_t>(p_width) * p_height;
+
+        l_format = (l_size == l_pixelCount * 4) ? SDL_PIXELFORMAT_XRGB8888 : (l_size == l_pixelCount * 2) ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_UNKNOWN;
+        l_pitch = p_width * SDL_BYTESPERPIXEL(l_format);
+    }
+
+    const int l_bytesPerPixel = SDL_BYTESPERPIXEL(l_format);
+    SDL_Surface* l_background(nullptr);
+
+    if ((l_bytesPerPixel == 2 || l_bytesPerPixel == 4) && l_width > 0 && l_height > 0 && l_pitch >= l_width * l_bytesPerPixel
+        && l_offset + static_cast<size_t>(l_height - 1) * l_pitch + static_cast<size_t>(l_width) * l_bytesPerPixel <= l_size)
+    {
+        l_background = convertFrame(l_image + l_offset, l_width, l_height, l_pitch, l_format, p_dim);
+    }
+    else
+    {
+        SDL_LogError(0, "Unsupported screen format or size in %s", p_path.c_str());
+    }
+
+#ifdef _WIN64
+    SDL_free(l_data);
+#else
+    munmap(l_mapping, l_size);
+#endif // _WIN64
+
+    return l_background;
+}
+
+SDL_Surface* Background_Utils::dim(SDL_Surface* p_surface, const int p_percent)
+{
+    // 1. Convert a surface of other depth to the format of the screen.
+    // 2. Darken each row, the rows shared among the cores: 32-bit pixels of 8-bit channels with the SIMD kernel
+    //    (keeping alpha), and any other ones channel by channel.
+
+    if (p_surface == nullptr || p_percent <= 0) return p_surface;
+
+    p_surface = toDirectColor(p_surface);
+
+    if (p_surface == nullptr) return nullptr;
+
+    const SDL_PixelFormat* l_format = p_surface->format;
+    const Uint32 l_factor = getDimFactor(p_percent);
+
+    runInBands(p_surface->h, [&](const int p_first, const int p_last)
+    {
+        for (int l_y = p_first; l_y < p_last; ++l_y)
+        {
+            Uint8* l_row = static_cast<Uint8*>(p_surface->pixels) + static_cast<size_t>(l_y) * p_surface->pitch;
+
+            if (l_format->BytesPerPixel == 4 && l_format->format != SDL_PIXELFORMAT_ARGB2101010)
+            {
+                dimRow(reinterpret_cast<Uint32*>(l_row), reinterpret_cast<Uint32*>(l_row), p_surface->w, l_factor, l_format->Amask, 0);
+                continue;
+            }
+
+            for (int l_x = 0; l_x < p_surface->w; ++l_x)
+            {
+                Uint32 l_pixel(0);
+                std::memcpy(&l_pixel, l_row + l_x * l_format->BytesPerPixel, l_format->BytesPerPixel);
+
+                const Uint32 l_red = (((l_pixel & l_format->Rmask) >> l_format->Rshift) * l_factor >> 8) << l_format->Rshift;
+                const Uint32 l_green = (((l_pixel & l_format->Gmask) >> l_format->Gshift) * l_factor >> 8) << l_format->Gshift;
+                const Uint32 l_blue = (((l_pixel & l_format->Bmask) >> l_format->Bshift) * l_factor >> 8) << l_format->Bshift;
+
+                l_pixel = l_red | l_green | l_blue | (l_pixel & l_format->Amask);
+                std::memcpy(l_row + l_x * l_format->BytesPerPixel, &l_pixel, l_format->BytesPerPixel);
+            }
+        }
+    });
+
+    return p_surface;
+}
+
+SDL_Surface* Background_Utils::blur(SDL_Surface* p_surface, const int p_radius)
+{
+    // 1. Convert a surface of other depth to the format of the screen. Other pixels than 32-bit ones of 8-bit
+    //    channels (e.g. RGB565) are blurred in an ARGB8888 copy, converted back afterwards.
+    // 2. Blur it three times: horizontally into a buffer, the rows shared among the cores, then vertically back into
+    //    the surface, the columns shared among the cores.
+
+    if (p_surface == nullptr || p_radius <= 0) return p_surface;
+
+    p_surface = toDirectColor(p_surface);
+
+    if (p_surface == nullptr) return nullptr;
+
+    if (p_surface->format->BytesPerPixel != 4 || p_surface->format->format == SDL_PIXELFORMAT_ARGB2101010)
+    {
+        SDL_Surface* l_copy = blur(SDL_ConvertSurfaceFormat(p_surface, SDL_PIXELFORMAT_ARGB8888, 0), p_radius);
+        SDL_Surface* l_blurred = (l_copy != nullptr) ? SDL_ConvertSurface(l_copy, p_surface->format, 0) : nullptr;
+
+        if (l_copy != nullptr) SDL_FreeSurface(l_copy);
+
+        if (l_blurred == nullptr)
+        {
+            SDL_LogError(0, "Could not blur the background: %s", SDL_GetError());
+            return p_surface;
+        }
+
+        SDL_FreeSurface(p_surface);
+        SDL_SetSurfaceBlendMode(l_blurred, SDL_BLENDMODE_NONE);
+
+        return l_blurred;
+    }
+
+    const int l_radius = std::min(p_radius, BACKGROUND_MAX_BLUR);
+    const Uint16 l_inverse = static_cast<Uint16>((65536 + 2 * l_radius) / (2 * l_radius + 1));
+    const int l_width(p_surface->w), l_height(p_surface->h), l_pitch(p_surface->pitch), l_bufferPitch(p_surface->w * 4);
+    std::vector<Uint8> l_buffer(static_cast<size_t>(l_bufferPitch) * l_height);
+    Uint8* l_pixels = static_cast<Uint8*>(p_surface->pixels);
+
+    for (int l_pass = 0; l_pass < 3; ++l_pass)
+    {
+        runInBands(l_height, [&](const int p_first, const int p_last) { blurRows(l_pixels, l_pitch, l_buffer.data(), l_bufferPitch, l_width, p_first, p_last, l_radius, l_inverse); });
+        runInBands(l_width, [&](const int p_first, const int p_last) { blurColumns(l_buffer.data(), l_bufferPitch, l_pixels, l_pitch, l_height, p_first, p_last, l_radius, l_inverse); });
+    }
+
+    return p_surface;
+}
+
+SDL_Surface* Background_Utils::loadWithEffects(const std::string& p_path, const int p_width, const int p_height, const int p_radius, const int p_dim)
+{
+    // 1. Without effects, load the background as it is.
+    // 2. Key the cache with the fingerprint of the background (its whole file: an image edited at the same size only
+    //    differs past its headers), the size and pixel format of the screen, and the effects, and read the cache back
+    //    if it has that key.
+    // 3. Otherwise, load the background, fit it to the screen, blur and darken it, and cache it (raw, the fastest to
+    //    read) for the next runs.
+
+    if (p_radius <= 0 && p_dim <= 0) return load(p_path, p_width, p_height);
+
+    const std::string l_cachePath = p_path + BACKGROUND_CACHE_EXT;
+    const Uint32 l_format = (Globals::g_screen != nullptr) ? Globals::g_screen->format->format : SDL_PIXELFORMAT_XRGB8888;
+    Uint32 l_size(0), l_hash(0), l_key(0);
+    const bool l_fingerprinted = SDL_Utils::getFingerprint(p_path, l_size, l_hash, true);
+
+    if (l_fingerprinted)
+    {
+        const Uint32 l_values[] = { l_size, l_hash, static_cast<Uint32>(p_width), static_cast<Uint32>(p_height), l_format, static_cast<Uint32>(p_radius), static_cast<Uint32>(p_dim) };
+
+        l_key = 2166136261u;
+
+        for (const Uint32 l_value : l_values)
+        {
+            for (unsigned int l_shift = 0; l_shift < 32; l_shift += 8) l_key = (l_key ^ ((l_value >> l_shift) & 0xFF)) * 16777619u;
+        }
+
+        // 0 is the key of the backgrounds made by the converter
+        if (l_key == 0) l_key = 1;
+
+        SDL_RWops* l_file = SDL_RWFromFile(l_cachePath.c_str(), "rb");
+        Uint32 l_cachedKey(0);
+        SDL_Surface* l_cached = (l_file != nullptr) ? loadPrepared(l_file, l_cachePath, l_cachedKey) : nullptr;
+
+        if (l_cached != nullptr && l_cachedKey == l_key && l_cached->w == p_width && l_cached->h == p_height && l_cached->format->format == l_format) return l_cached;
+
+        if (l_cached != nullptr) SDL_FreeSurface(l_cached);
+    }
+
+    SDL_Surface* l_image = load(p_path, p_width, p_height);
+
+    if (l_image == nullptr) return nullptr;
+
+    SDL_Surface* l_background = fit(l_image, p_width, p_height, l_format);
+
+    if (l_background == nullptr)
+    {
+        SDL_LogError(0, "Could not scale background %s: %s", p_path.c_str(), SDL_GetError());
+        return nullptr;
+    }
+
+    l_background = dim(blur(l_background, p_radius), p_dim);
+
+    if (l_background != nullptr && l_fingerprinted) writePrepared(l_background, l_cachePath, ECompression::NONE, l_key);
+
+    return l_background;
+}
+
+const bool Background_Utils::convert(const std::string& p_source, const std::string& p_destination, const int p_width, const int p_height, const Uint32 p_format, const ECompression p_compression)
+{
+    // 1. Check the size and the format.
+    // 2. Load the image and fit it to the background: scaled smoothly, onto an opaque surface in its pixel format.
+    // 3. Write the header and the pixels: raw, or as a QOI image.
+
+    if (p_width <= 0 || p_width > BACKGROUND_MAX_SIZE || p_height <= 0 || p_height > BACKGROUND_MAX_SIZE || SDL_ISPIXELFORMAT_INDEXED(p_format) || (SDL_BYTESPERPIXEL(p_format) != 2 && SDL_BYTESPERPIXEL(p_format) != 4))
+    {
+        SDL_LogError(0, "Invalid size or pixel format for background %s", p_destination.c_str());
+        return false;
+    }
+
+    SDL_Surface* l_image = IMG_Load(p_source.c_str());
+
+    if (l_image == nullptr)
+    {
+        SDL_LogError(0, "Could not load image %s: %s", p_source.c_str(), IMG_GetError());
+        return false;
+    }
+
+    SDL_Surface* l_background = fit(l_image, p_width, p_height, p_format);
+
+    if (l_background == nullptr)
+    {
+        SDL_LogError(0, "Could not scale image %s: %s", p_source.c_str(), SDL_GetError());
+        return false;
+    }
+
+    const bool l_written = writePrepared(l_background, p_destination, p_compression, 0);
+    SDL_FreeSurface(l_background);
+
+    return l_written;
+}
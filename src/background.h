@@ -0,0 +1,152 @@
+/**
+ * @file  background.h
+ * @brief Utility functions to load the background of the keyboard, and to prepare background files for fast loading.
+ */
+#ifndef _BACKGROUND_H_
+#define _BACKGROUND_H_
+
+#include <string>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the extension of the prepared background files.
+ *
+ * @param X The extension.
+ */
+#define BACKGROUND_EXT ".vkb"
+
+/**
+ * @brief Macro that indicates the version of the prepared background format. Files with another version are rejected.
+ *
+ * @param X The version.
+ */
+#define BACKGROUND_VERSION 1
+
+/**
+ * @brief Macro that indicates the largest width or height of a prepared background.
+ *
+ * @param X The size, in pixels.
+ */
+#define BACKGROUND_MAX_SIZE 8192
+
+/**
+ * @brief Macro that indicates the extension added to the path of a background to name the cache of its effects (the
+ *        background blurred and darkened, see Background_Utils::loadWithEffects).
+ *
+ * @param X The extension.
+ */
+#define BACKGROUND_CACHE_EXT ".fx" BACKGROUND_EXT
+
+/**
+ * @brief Macro that indicates the largest radius of the blur of the background (the sums of the box filter fit in 16
+ *        bits up to 127).
+ *
+ * @param X The radius, in pixels.
+ */
+#define BACKGROUND_MAX_BLUR 64
+
+/**
+ * @namespace Background_Utils
+ * @brief     Namespace containing the functions that load the background of the keyboard.
+ *
+ * Besides any image SDL_image reads, the background can be a prepared file (BACKGROUND_EXT): the image already scaled
+ * to the screen and converted to its pixel format by the converter mode of the program (--convert-bg), after a header
+ * recording its size and format. It is stored either raw, read straight into the pixels of the surface, or compressed
+ * with QOI, which decodes in a single pass several times faster than PNG inflates. Either way, nothing is scaled nor
+ * converted when the keyboard starts. The same format caches a background once it is blurred and darkened, so those
+ * effects cost nothing after the first run, nor when the keyboard is drawn.
+ */
+namespace Background_Utils
+{
+    /**
+     * @enum  ECompression
+     * @brief Enumeration for the encoding of the pixels of a prepared background.
+     */
+    enum class ECompression : Uint16
+    {
+        NONE = 0,   /**< Raw pixels, row by row */
+        QOI         /**< A QOI image ("Quite OK Image" format) */
+    };
+
+    /**
+     * @brief        Indicates whether a path names a prepared background.
+     * @param p_path The path.
+     * @return       TRUE if it has the extension of the prepared backgrounds; otherwise, FALSE.
+     */
+    const bool isPrepared(const std::string& p_path);
+
+    /**
+     * @brief          Loads a background: a prepared background, or any image (served from the resource pack if it is
+     *                 not a loose file, see CResourcePack). A prepared background in another pixel format than the
+     *                 screen is converted to it. In builds with SCALED_DECODE, a JPEG or PNG image larger than the
+     *                 size it is drawn at is shrunk to it while it is decoded, so the image is never decoded whole.
+     * @param p_path   The path of the background.
+     * @param p_width  The width the background is drawn at (the width of the screen).
+     * @param p_height The height the background is drawn at (the height of the screen).
+     * @return         Pointer to the background, or nullptr if it could not be loaded.
+     */
+    SDL_Surface* load(const std::string& p_path, const int p_width, const int p_height);
+
+    /**
+     * @brief          Captures the screen as a background, from a framebuffer device (e.g. /dev/fb0), or from a raw dump
+     *                 of it (a file of the size of the screen, with XRGB8888 or RGB565 pixels). The visible frame is
+     *                 mapped, and converted to the format of the screen and dimmed in a single pass over it.
+     * @param p_path   The path of the device or dump.
+     * @param p_width  The width of the screen (the width of a dump).
+     * @param p_height The height of the screen (the height of a dump).
+     * @param p_dim    How much to darken the capture, in percent (0 leaves it as it is).
+     * @return         Pointer to the background, or nullptr if the screen could not be captured.
+     */
+    SDL_Surface* capture(const std::string& p_path, const int p_width, const int p_height, const int p_dim);
+
+    /**
+     * @brief           Darkens a background, in place: each channel is scaled towards black (alpha is kept). Pixels of
+     *                  32 bits are darkened several at once with SSE2 or NEON.
+     * @param p_surface The background. One of other depth than 16 or 32 bits is converted to the format of the screen
+     *                  first, and freed.
+     * @param p_percent How much to darken it, in percent (0 leaves it as it is).
+     * @return          Pointer to the darkened background (nullptr if p_surface is nullptr or could not be converted).
+     */
+    SDL_Surface* dim(SDL_Surface* p_surface, const int p_percent);
+
+    /**
+     * @brief           Blurs a background, in place, so the keyboard stays readable over a busy image: three passes of
+     *                  a box filter, each horizontal then vertical, which together approximate a Gaussian blur. Each
+     *                  pass slides a window of sums, so its cost does not depend on the radius. The channels are
+     *                  summed with SSE2 or NEON, and the rows (then the columns) are shared among the cores.
+     * @param p_surface The background. One of other depth than 16 or 32 bits is converted to the format of the screen
+     *                  first, and freed.
+     * @param p_radius  The radius of the box filter, in pixels, up to BACKGROUND_MAX_BLUR (0 leaves it as it is).
+     * @return          Pointer to the blurred background (nullptr if p_surface is nullptr or could not be converted).
+     */
+    SDL_Surface* blur(SDL_Surface* p_surface, const int p_radius);
+
+    /**
+     * @brief          Loads a background (see load), blurred and darkened. The effects are computed once: the result,
+     *                 scaled to the screen and in its pixel format, is cached next to the background
+     *                 (BACKGROUND_CACHE_EXT) as a prepared background, and read back as is on the next runs, as long
+     *                 as the background, the screen and the effects are the same.
+     * @param p_path   The path of the background.
+     * @param p_width  The width the background is drawn at (the width of the screen).
+     * @param p_height The height the background is drawn at (the height of the screen).
+     * @param p_radius The radius of the blur, in pixels (0 not to blur it).
+     * @param p_dim    How much to darken it, in percent (0 not to darken it).
+     * @return         Pointer to the background, or nullptr if it could not be loaded.
+     */
+    SDL_Surface* loadWithEffects(const std::string& p_path, const int p_width, const int p_height, const int p_radius, const int p_dim);
+
+    /**
+     * @brief               Prepares a background: loads an image, scales it to a size, converts it to a pixel format
+     *                      and writes it as a prepared background.
+     * @param p_source      The path of the image (any format SDL_image reads, PNG and JPEG included).
+     * @param p_destination The path of the prepared background.
+     * @param p_width       The width of the background (the width of the screen).
+     * @param p_height      The height of the background (the height of the screen).
+     * @param p_format      The pixel format of the background (the format of the screen), of 16 or 32 bits.
+     * @param p_compression The encoding of the pixels.
+     * @return              TRUE if the background was written; otherwise, FALSE.
+     */
+    const bool convert(const std::string& p_source, const std::string& p_destination, const int p_width, const int p_height, const Uint32 p_format, const ECompression p_compression);
+}
+
+#endif // _BACKGROUND_H_
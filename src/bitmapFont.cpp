@@ -0,0 +1,181 @@
+/**
+ * @file  bitmapFont.cpp
+ * @brief Implementation file for the CBitmapFont class.
+ */
+
+#include "bitmapFont.h"
+#include "sdlUtils.h"
+#include "utf8.h"
+#include "extern/rotozoom/SDL2_gfxPrimitives_font.h"
+
+namespace
+{
+    /**
+     * @brief Code point drawn by each glyph of code page 437 (0 for the ones never drawn). The printable ASCII range
+     *        maps to itself.
+     */
+    const Uint16 s_codepage[256] =
+    {
+        0x0000, 0x263A, 0x263B, 0x2665, 0x2666, 0x2663, 0x2660, 0x2022, 0x25D8, 0x25CB, 0x25D9, 0x2642, 0x2640, 0x266A, 0x266B, 0x263C,
+        0x25BA, 0x25C4, 0x2195, 0x203C, 0x00B6, 0x00A7, 0x25AC, 0x21A8, 0x2191, 0x2193, 0x2192, 0x2190, 0x221F, 0x2194, 0x25B2, 0x25BC,
+        0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+        0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+        0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+        0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+        0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+        0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x2302,
+        0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7, 0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+        0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9, 0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+        0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA, 0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+        0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+        0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F, 0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+        0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B, 0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+        0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4, 0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+        0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
+    };
+
+    /**
+     * @brief Characters drawn with the glyph of a look-alike: typographic quotes and dashes.
+     */
+    const Uint16 s_lookAlikes[][2] =
+    {
+        { 0x2018, '\'' }, { 0x2019, '\'' }, { 0x201C, '"' }, { 0x201D, '"' }, { 0x2013, '-' }, { 0x2014, '-' }, { 0x2212, '-' }
+    };
+}
+
+CBitmapFont::CBitmapFont(void) :
+    m_strip(nullptr),
+    m_scale(1)
+{
+    // Nothing to do here. The glyphs are expanded by the resource manager.
+}
+
+CBitmapFont::~CBitmapFont(void)
+{
+    clear();
+}
+
+const bool CBitmapFont::init(const int p_scale)
+{
+    // 1. Create the strip in the format of the screen, filled with the color key.
+    // 2. Expand the bits of each glyph into white squares of the scaling factor.
+    // 3. Key out the background, so blits only write the glyph pixels.
+
+    clear();
+    m_scale = p_scale > 0 ? p_scale : 1;
+
+    const int l_size = BITMAPFONT_GLYPH_SIZE * m_scale;
+    const Uint32 l_key = SDL_MapRGB(Globals::g_screen->format, 0, 0, 0);
+
+    m_strip = SDL_Utils::createImage(256 * l_size, l_size, l_key);
+
+    if (m_strip == nullptr) return false;
+
+    const Uint32 l_white = SDL_MapRGB(m_strip->format, 255, 255, 255);
+
+    for (int l_glyph = 0; l_glyph < 256; ++l_glyph)
+    {
+        for (int l_row = 0; l_row < BITMAPFONT_GLYPH_SIZE; ++l_row)
+        {
+            const unsigned char l_bits = gfxPrimitivesFontdata[l_glyph * BITMAPFONT_GLYPH_SIZE + l_row];
+
+            for (int l_column = 0; l_column < BITMAPFONT_GLYPH_SIZE; ++l_column)
+            {
+                if ((l_bits & (0x80 >> l_column)) == 0) continue;
+
+                SDL_Rect l_pixel{ l_glyph * l_size + l_column * m_scale, l_row * m_scale, m_scale, m_scale };
+                SDL_FillRect(m_strip, &l_pixel, l_white);
+            }
+        }
+    }
+
+    SDL_SetColorKey(m_strip, SDL_TRUE, l_key);
+
+    return true;
+}
+
+void CBitmapFont::clear(void)
+{
+    if (m_strip != nullptr)
+    {
+        SDL_FreeSurface(m_strip);
+        m_strip = nullptr;
+    }
+}
+
+int CBitmapFont::measure(const std::string& p_text) const
+{
+    // Every glyph has the same advance; combining marks have none.
+
+    int l_count(0);
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        if (!UTF8_Utils::isGraphemeExtend(UTF8_Utils::decode(p_text, l_position, l_length))) ++l_count;
+    }
+
+    return l_count * BITMAPFONT_GLYPH_SIZE * m_scale;
+}
+
+SDL_Surface* CBitmapFont::render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const
+{
+    // Fill a line as wide as the text with the background color, and draw the text over it.
+
+    const int l_width = measure(p_text);
+
+    if (l_width == 0 || m_strip == nullptr) return nullptr;
+
+    SDL_Surface* l_line = SDL_Utils::createImage(l_width, getHeight(), SDL_MapRGB(Globals::g_screen->format, p_backgroundColor.r, p_backgroundColor.g, p_backgroundColor.b));
+
+    if (l_line != nullptr) draw(p_text, 0, 0, p_foregroundColor, l_line);
+
+    return l_line;
+}
+
+void CBitmapFont::draw(const std::string& p_text, const int p_x, const int p_y, const SDL_Color& p_color, SDL_Surface* p_destination) const
+{
+    // 1. Tint the white glyphs with the color.
+    // 2. Blit the glyph of each character from the strip, skipping combining marks.
+
+    if (m_strip == nullptr) return;
+
+    const int l_size = BITMAPFONT_GLYPH_SIZE * m_scale;
+    int l_x = p_x;
+    size_t l_length(0);
+
+    SDL_SetSurfaceColorMod(m_strip, p_color.r, p_color.g, p_color.b);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        const Uint32 l_codepoint = UTF8_Utils::decode(p_text, l_position, l_length);
+
+        if (UTF8_Utils::isGraphemeExtend(l_codepoint)) continue;
+
+        SDL_Rect l_source{ getGlyph(l_codepoint) * l_size, 0, l_size, l_size };
+        SDL_Rect l_target{ l_x, p_y, l_size, l_size };
+        SDL_BlitSurface(m_strip, &l_source, p_destination, &l_target);
+
+        l_x += l_size;
+    }
+}
+
+Uint8 CBitmapFont::getGlyph(const Uint32 p_codepoint)
+{
+    // 1. Printable ASCII characters are their own glyphs.
+    // 2. Look the rest up in the code page, and then among the look-alikes.
+
+    if (p_codepoint >= 0x20 && p_codepoint < 0x7F) return static_cast<Uint8>(p_codepoint);
+
+    for (int l_glyph = 1; l_glyph < 256; ++l_glyph)
+    {
+        if (s_codepage[l_glyph] == p_codepoint) return static_cast<Uint8>(l_glyph);
+    }
+
+    for (const auto& l_lookAlike : s_lookAlikes)
+    {
+        if (l_lookAlike[0] == p_codepoint) return static_cast<Uint8>(l_lookAlike[1]);
+    }
+
+    return '?';
+}
@@ -0,0 +1,122 @@
+/**
+ * @file  bitmapFont.h
+ * @brief Header file for the CBitmapFont class, which draws text with the 8x8 font built in SDL2_gfx.
+ */
+#ifndef _BITMAPFONT_H_
+#define _BITMAPFONT_H_
+
+#include <string>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the size of the glyphs of the built-in font, before scaling.
+ *
+ * @param X The width and height, in pixels.
+ */
+#define BITMAPFONT_GLYPH_SIZE 8
+
+/**
+ * @class CBitmapFont
+ * @brief Ultra-light font: the 8x8 code page 437 font built in SDL2_gfx, expanded once into a strip of glyphs in the
+ *        format of the screen and scaled by an integer factor, so drawing a character is a color-keyed blit.
+ *
+ * It needs neither SDL_ttf nor any font file. Text is mapped from Unicode to code page 437 (Latin-1 letters, box
+ * drawing, some Greek letters and symbols); characters it lacks are drawn as '?', and combining marks are skipped.
+ */
+class CBitmapFont
+{
+    public:
+
+    /**
+     * @brief Constructor for the font, empty.
+     */
+    CBitmapFont(void);
+
+    /**
+     * @brief Destructor for the font, which frees its glyphs.
+     */
+    ~CBitmapFont(void);
+
+    /**
+     * @brief          Copy constructor for the font (forbidden).
+     * @param p_source The source font to copy.
+     */
+    CBitmapFont(const CBitmapFont& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the font (forbidden).
+     * @param p_source The source font to move resources from.
+     */
+    CBitmapFont(const CBitmapFont&& p_source) = delete;
+
+    /**
+     * @brief         Expands the glyphs, scaled, into a strip in the format of the screen.
+     * @param p_scale The scaling factor (at least 1).
+     * @return        TRUE if the glyphs were expanded; otherwise, FALSE.
+     */
+    const bool init(const int p_scale);
+
+    /**
+     * @brief Frees the glyphs.
+     */
+    void clear(void);
+
+    /**
+     * @brief  Indicates whether the glyphs are expanded.
+     * @return TRUE if the font can draw; otherwise, FALSE.
+     */
+    inline bool isLoaded(void) const { return m_strip != nullptr; }
+
+    /**
+     * @brief  Gets the height of a line.
+     * @return The height, in pixels.
+     */
+    inline int getHeight(void) const { return BITMAPFONT_GLYPH_SIZE * m_scale; }
+
+    /**
+     * @brief        Measures a text.
+     * @param p_text The text.
+     * @return       The width, in pixels.
+     */
+    int measure(const std::string& p_text) const;
+
+    /**
+     * @brief                   Renders a text over a solid background.
+     * @param p_text            The text.
+     * @param p_foregroundColor The foreground color.
+     * @param p_backgroundColor The background color.
+     * @return                  Pointer to the rendered SDL surface (nullptr if the text is empty).
+     */
+    SDL_Surface* render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const;
+
+    /**
+     * @brief               Draws a text over a surface, leaving the background as it is.
+     * @param p_text        The text.
+     * @param p_x           The left of the text.
+     * @param p_y           The top of the text.
+     * @param p_color       The color of the text.
+     * @param p_destination The surface to draw on.
+     */
+    void draw(const std::string& p_text, const int p_x, const int p_y, const SDL_Color& p_color, SDL_Surface* p_destination) const;
+
+    private:
+
+    /**
+     * @brief             Gets the glyph of a code point in code page 437.
+     * @param p_codepoint The code point.
+     * @return            The index of the glyph ('?' if the font lacks it).
+     */
+    static Uint8 getGlyph(const Uint32 p_codepoint);
+
+    /**
+     * @brief The glyphs, side by side, white on a color key.
+     */
+    SDL_Surface* m_strip;
+
+    /**
+     * @brief The scaling factor of the glyphs.
+     */
+    int m_scale;
+};
+
+#endif // _BITMAPFONT_H_
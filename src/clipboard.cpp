@@ -0,0 +1,176 @@
+/**
+ * @file  clipboard.cpp
+ * @brief Implementation file for the CClipboard class.
+ */
+
+#ifndef _WIN64
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN64
+
+#include <cstring>
+#include "clipboard.h"
+#include "utf8.h"
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of the clipboard file.
+     */
+    const char s_magic[4] = { 'V', 'K', 'C', 'B' };
+
+    /**
+     * @brief Offset of the text length in the file (right after the magic bytes).
+     */
+    constexpr size_t s_lengthOffset = sizeof(s_magic);
+
+    /**
+     * @brief Offset of the text in the file (right after the header).
+     */
+    constexpr size_t s_textOffset = s_lengthOffset + sizeof(Uint32);
+
+    /**
+     * @brief Maximum size of the text, in bytes.
+     */
+    constexpr size_t s_capacity = CLIPBOARD_FILE_SIZE - s_textOffset;
+}
+
+CClipboard& CClipboard::instance(void)
+{
+    // 1. Create the static instance of the clipboard.
+    // 2. Return the singleton.
+
+    static CClipboard l_singleton;
+    return l_singleton;
+}
+
+CClipboard::CClipboard(void) :
+    m_mapping(nullptr)
+{
+    // Nothing to do here. The clipboard stays in memory unless a file is mapped.
+}
+
+CClipboard::~CClipboard(void)
+{
+    // Unmap the file; the text was already written to it by each call to set().
+
+#ifndef _WIN64
+    if (m_mapping != nullptr)
+    {
+        munmap(m_mapping, CLIPBOARD_FILE_SIZE);
+        m_mapping = nullptr;
+    }
+#endif // _WIN64
+}
+
+const bool CClipboard::init(const std::string& p_path)
+{
+    // 1. Open (or create) the file. Only a new (empty) file is sized; a file of any other size is not a clipboard,
+    //    and is left untouched.
+    // 2. Map it as shared memory, so writes reach the file without explicit I/O. The descriptor is not needed afterwards.
+    // 3. If it is new, write an empty header. If it has no valid magic, it is not a clipboard either: unmap it and keep
+    //    the clipboard in memory. Otherwise, load its text (sanitized, since any process may have written it).
+
+#ifdef _WIN64
+    SDL_LogWarn(0, "The clipboard cannot be persisted on this platform: %s", p_path.c_str());
+    return false;
+#else
+    const int l_file = open(p_path.c_str(), O_RDWR | O_CREAT, 0600);
+
+    if (l_file < 0)
+    {
+        SDL_LogError(0, "Could not open clipboard file %s", p_path.c_str());
+        return false;
+    }
+
+    struct stat l_status;
+
+    if (fstat(l_file, &l_status) != 0)
+    {
+        SDL_LogError(0, "Could not read the size of clipboard file %s", p_path.c_str());
+        close(l_file);
+        return false;
+    }
+
+    const bool l_created = (l_status.st_size == 0);
+
+    if (!l_created && l_status.st_size != CLIPBOARD_FILE_SIZE)
+    {
+        SDL_LogError(0, "Not a clipboard file (unexpected size %ld): %s", static_cast<long>(l_status.st_size), p_path.c_str());
+        close(l_file);
+        return false;
+    }
+
+    if (l_created && ftruncate(l_file, CLIPBOARD_FILE_SIZE) != 0)
+    {
+        SDL_LogError(0, "Could not resize clipboard file %s", p_path.c_str());
+        close(l_file);
+        return false;
+    }
+
+    void* l_mapping = mmap(nullptr, CLIPBOARD_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, l_file, 0);
+    close(l_file);
+
+    if (l_mapping == MAP_FAILED)
+    {
+        SDL_LogError(0, "Could not map clipboard file %s", p_path.c_str());
+        return false;
+    }
+
+    if (!l_created && std::memcmp(l_mapping, s_magic, sizeof(s_magic)) != 0)
+    {
+        SDL_LogError(0, "Not a clipboard file (missing magic): %s", p_path.c_str());
+        munmap(l_mapping, CLIPBOARD_FILE_SIZE);
+        return false;
+    }
+
+    m_mapping = static_cast<char*>(l_mapping);
+
+    Uint32 l_length(0);
+    std::memcpy(&l_length, m_mapping + s_lengthOffset, sizeof(l_length));
+
+    if (!l_created && l_length <= s_capacity)
+    {
+        UTF8_Utils::sanitize(m_mapping + s_textOffset, l_length, m_text);
+    }
+    else
+    {
+        std::memcpy(m_mapping, s_magic, sizeof(s_magic));
+        set(m_text);
+    }
+
+    return true;
+#endif // _WIN64
+}
+
+void CClipboard::set(const std::string& p_text)
+{
+    // 1. Keep the text, truncated to the capacity of the file at a character boundary: the cut moves back from the
+    //    capacity while it falls on a continuation byte, so a character straddling the capacity is left out whole.
+    // 2. If persisted, write the text and then its length to the mapping.
+
+    if (p_text.size() > s_capacity)
+    {
+        size_t l_cut = s_capacity;
+
+        while (l_cut > 0 && UTF8_Utils::isContinuation(static_cast<unsigned char>(p_text[l_cut]))) --l_cut;
+
+        m_text = p_text.substr(0, l_cut);
+    }
+    else
+    {
+        m_text = p_text;
+    }
+
+    if (m_mapping != nullptr)
+    {
+        const Uint32 l_length = static_cast<Uint32>(m_text.size());
+
+        std::memcpy(m_mapping + s_textOffset, m_text.data(), m_text.size());
+        std::memcpy(m_mapping + s_lengthOffset, &l_length, sizeof(l_length));
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file  clipboard.h
+ * @brief Header file for the CClipboard class, the internal clipboard of the keyboard.
+ */
+#ifndef _CLIPBOARD_H_
+#define _CLIPBOARD_H_
+
+#include <string>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the size of the file where the clipboard is persisted (header included).
+ *
+ * @param X The size, in bytes.
+ */
+#define CLIPBOARD_FILE_SIZE 65536
+
+/**
+ * @class Singleton used as the clipboard of cut, copy and paste.
+ * @brief Keeps the copied text in memory and, optionally, in a small memory-mapped file, so it survives across
+ *        invocations of the program without any IPC.
+ *
+ * The file holds a fixed-size header (magic and length) followed by the text. Writes go straight to the mapping,
+ * and the length is written last, so a reader never sees a partially written text as valid.
+ */
+class CClipboard
+{
+    public:
+
+    /**
+     * @brief  Gets the singleton instance of the clipboard.
+     * @return Reference to the unique clipboard instance.
+     */
+    static CClipboard& instance(void);
+
+    /**
+     * @brief        Maps the file where the clipboard is persisted, creating it if needed, and loads its text.
+     *               An existing file without the size and magic of a clipboard file is never modified.
+     * @param p_path The path of the file.
+     * @return       TRUE if the file was mapped; otherwise, FALSE (the clipboard is kept in memory only).
+     */
+    const bool init(const std::string& p_path);
+
+    /**
+     * @brief        Sets the text of the clipboard (truncated to the capacity of the file, at a character boundary).
+     * @param p_text The text.
+     */
+    void set(const std::string& p_text);
+
+    /**
+     * @brief  Gets the text of the clipboard.
+     * @return Reference to the text.
+     */
+    inline const std::string& get(void) const { return m_text; }
+
+    private:
+
+    /**
+     * @brief Constructor for the clipboard.
+     */
+    CClipboard(void);
+
+    /**
+     * @brief Destructor for the clipboard, which unmaps the file.
+     */
+    ~CClipboard(void);
+
+    /**
+     * @brief          Copy constructor for the clipboard (forbidden).
+     * @param p_source The source clipboard to copy.
+     */
+    CClipboard(const CClipboard& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the clipboard (forbidden).
+     * @param p_source The source clipboard to move resources from.
+     */
+    CClipboard(const CClipboard&& p_source) = delete;
+
+    /**
+     * @brief The text of the clipboard.
+     */
+    std::string m_text;
+
+    /**
+     * @brief The mapped file (nullptr if the clipboard is not persisted).
+     */
+    char* m_mapping;
+};
+
+#endif // _CLIPBOARD_H_
@@ -41,6 +41,20 @@
  */
 #define CARETTICKTIME 500
 
+/**
+ * @brief Macro that indicates how long the last typed character stays visible in confidential (password) mode.
+ *
+ * @param X Specifies the amount of milliseconds before the character is masked.
+ */
+#define UNMASKTIME 500
+
+/**
+ * @brief Macro that indicates how long the keyboard waits before closing, to let the exit sound play.
+ *
+ * @param X Specifies the amount of milliseconds to wait.
+ */
+#define EXITSOUNDDELAY 300
+
 /**
  * @brief Macro that indicates whether the keyboard must autoscale when the initial resolution differs from the default one.
  *
@@ -95,6 +109,13 @@
 #define DIALOG_BORDER 2
 #define DIALOG_MARGIN 8
 
+/**
+ * @brief Macro that indicates the amount of lines shown by the text field in multiline mode.
+ *
+ * @param X The amount of lines.
+ */
+#define MULTILINE_VISIBLE_LINES 5
+
 /**
  * @brief Macros that set colors to used in different parts of the keyboard.
  *
@@ -0,0 +1,131 @@
+/**
+ * @file  editHistory.cpp
+ * @brief Implementation file for the CEditHistory class.
+ */
+
+#include "editHistory.h"
+
+namespace
+{
+    /**
+     * @brief        Checks whether a byte separates words (so a new insertion starts at it).
+     * @param p_byte The byte.
+     * @return       TRUE if it is a space or a line break; otherwise, FALSE.
+     */
+    inline bool isWordSeparator(const char p_byte) { return p_byte == ' ' || p_byte == '\n'; }
+}
+
+CEditHistory::CEditHistory(void) :
+    m_current(0),
+    m_bytes(0),
+    m_sealed(true)
+{
+    // Nothing to do here. Edits are recorded as the text changes.
+}
+
+void CEditHistory::recordInsert(const size_t p_position, const size_t p_characters, const std::string& p_bytes)
+{
+    // 1. Merge with the last edit if it is an insertion that ends where this one starts (typing continues),
+    //    unless this one starts a new word, and keep the limits.
+    // 2. Otherwise, add a new edit.
+
+    if (p_bytes.empty()) return;
+
+    if (!m_sealed && m_current == m_edits.size() && m_current > 0)
+    {
+        SEdit& l_last = m_edits.back();
+
+        if (l_last.m_insert && l_last.m_position + l_last.m_bytes.size() == p_position && !(isWordSeparator(p_bytes.front()) && !isWordSeparator(l_last.m_bytes.back())))
+        {
+            l_last.m_bytes += p_bytes;
+            m_bytes += p_bytes.size();
+            trim();
+            return;
+        }
+    }
+
+    push(SEdit{ p_position, p_characters, p_bytes, true });
+}
+
+void CEditHistory::recordErase(const size_t p_position, const size_t p_characters, const std::string& p_bytes)
+{
+    // 1. Merge with the last edit if it is a deletion that starts where this one ends (backspace continues), and
+    //    keep the limits.
+    // 2. Otherwise, add a new edit.
+
+    if (p_bytes.empty()) return;
+
+    if (!m_sealed && m_current == m_edits.size() && m_current > 0)
+    {
+        SEdit& l_last = m_edits.back();
+
+        if (!l_last.m_insert && p_position + p_bytes.size() == l_last.m_position)
+        {
+            l_last.m_bytes.insert(0, p_bytes);
+            l_last.m_position = p_position;
+            l_last.m_characters = p_characters;
+            m_bytes += p_bytes.size();
+            trim();
+            return;
+        }
+    }
+
+    push(SEdit{ p_position, p_characters, p_bytes, false });
+}
+
+const CEditHistory::SEdit* CEditHistory::undo(void)
+{
+    // Step back one edit; the next edit will not be merged with the one before it.
+
+    m_sealed = true;
+
+    if (m_current == 0) return nullptr;
+
+    return &m_edits[--m_current];
+}
+
+const CEditHistory::SEdit* CEditHistory::redo(void)
+{
+    // Step forward one edit; the next edit will not be merged with it.
+
+    m_sealed = true;
+
+    if (m_current == m_edits.size()) return nullptr;
+
+    return &m_edits[m_current++];
+}
+
+void CEditHistory::push(const SEdit& p_edit)
+{
+    // 1. Drop the edits that could be redone, since the text diverges from them.
+    // 2. Add the edit, allowing the next one to be merged with it.
+    // 3. Keep the limits.
+
+    while (m_edits.size() > m_current)
+    {
+        m_bytes -= m_edits.back().m_bytes.size();
+        m_edits.pop_back();
+    }
+
+    m_edits.push_back(p_edit);
+    m_bytes += p_edit.m_bytes.size();
+    m_sealed = false;
+    trim();
+}
+
+void CEditHistory::trim(void)
+{
+    // 1. Drop the oldest edits while the limits are exceeded. Only the last edit is left when the byte budget is
+    //    still exceeded, and it is dropped too: the text cannot be taken back past it.
+    // 2. All the edits left can be undone (trimming only follows a new or merged edit).
+
+    while (!m_edits.empty() && (m_edits.size() > EDITHISTORY_MAX_EDITS || m_bytes > EDITHISTORY_MAX_BYTES))
+    {
+        m_bytes -= m_edits.front().m_bytes.size();
+        m_edits.pop_front();
+    }
+
+    if (m_edits.empty()) m_sealed = true;
+
+    m_current = m_edits.size();
+}
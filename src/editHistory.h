@@ -0,0 +1,134 @@
+/**
+ * @file  editHistory.h
+ * @brief Header file for the CEditHistory class, which keeps the edits of the input text to undo and redo them.
+ */
+#ifndef _EDITHISTORY_H_
+#define _EDITHISTORY_H_
+
+#include <deque>
+#include <string>
+
+/**
+ * @brief Macros that indicate the maximum amount of edits and bytes kept by the history, respectively.
+ *
+ * @param X The amount of edits, or the amount of bytes, respectively.
+ */
+#define EDITHISTORY_MAX_EDITS 256
+#define EDITHISTORY_MAX_BYTES 65536
+
+/**
+ * @class CEditHistory
+ * @brief Log of insertions and deletions, stored as (offset, bytes) operations, to undo and redo them.
+ *
+ * Consecutive insertions (typing) and consecutive deletions (backspace, even when repeated by holding the button)
+ * are merged into a single operation, until the caret is moved or a word ends. When the limits are reached, the
+ * oldest operations are dropped, so memory is bounded; an operation larger than the whole byte budget (e.g. a huge
+ * paste) is not kept at all, and the operations before it cannot be undone anymore. Each operation keeps the amount of
+ * characters before its offset, so the caret is restored without scanning the text: undoing or redoing an operation
+ * costs the size of its bytes.
+ */
+class CEditHistory
+{
+    public:
+
+    /**
+     * @struct SEdit
+     * @brief  An insertion or deletion of bytes at a given offset of the text.
+     */
+    struct SEdit
+    {
+        /**
+         * @brief Position of the edit, in bytes.
+         */
+        size_t m_position;
+
+        /**
+         * @brief Amount of characters (graphemes) before the position of the edit.
+         */
+        size_t m_characters;
+
+        /**
+         * @brief Inserted or deleted bytes.
+         */
+        std::string m_bytes;
+
+        /**
+         * @brief TRUE if the bytes were inserted; FALSE, if they were deleted.
+         */
+        bool m_insert;
+    };
+
+    /**
+     * @brief Constructor for the CEditHistory class.
+     */
+    CEditHistory(void);
+
+    /**
+     * @brief              Records an insertion, merging it with the previous one when it continues it.
+     * @param p_position   The position, in bytes.
+     * @param p_characters The amount of characters before the position.
+     * @param p_bytes      The inserted bytes.
+     */
+    void recordInsert(const size_t p_position, const size_t p_characters, const std::string& p_bytes);
+
+    /**
+     * @brief              Records a deletion, merging it with the previous one when it continues it (backwards).
+     * @param p_position   The position, in bytes.
+     * @param p_characters The amount of characters before the position.
+     * @param p_bytes      The deleted bytes.
+     */
+    void recordErase(const size_t p_position, const size_t p_characters, const std::string& p_bytes);
+
+    /**
+     * @brief Prevents the next edit from being merged with the last one (e.g. when the caret moves).
+     */
+    inline void seal(void) { m_sealed = true; }
+
+    /**
+     * @brief  Gets the edit to revert, and moves it to the redo side.
+     * @return Pointer to the edit, or nullptr if there is nothing to undo.
+     */
+    const SEdit* undo(void);
+
+    /**
+     * @brief  Gets the edit to apply again, and moves it to the undo side.
+     * @return Pointer to the edit, or nullptr if there is nothing to redo.
+     */
+    const SEdit* redo(void);
+
+    private:
+
+    /**
+     * @brief         Adds a new edit, dropping the ones that could be redone and the oldest ones over the limits.
+     * @param p_edit  The edit.
+     */
+    void push(const SEdit& p_edit);
+
+    /**
+     * @brief Drops the oldest edits while the limits are exceeded, and the last one too if it exceeds the byte budget
+     *        by itself (nothing can be undone past it then).
+     */
+    void trim(void);
+
+    /**
+     * @brief The edits: the ones before m_current can be undone, and the rest can be redone.
+     */
+    std::deque<SEdit> m_edits;
+
+    /**
+     * @brief Amount of edits that can be undone.
+     */
+    size_t m_current;
+
+    /**
+     * @brief Total amount of bytes kept by the edits.
+     */
+    size_t m_bytes;
+
+    /**
+     * @brief Indicates whether the last edit must not be merged with the next one.
+     */
+    bool m_sealed;
+};
+
+#endif // _EDITHISTORY_H_
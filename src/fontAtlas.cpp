@@ -0,0 +1,149 @@
+/**
+ * @file  fontAtlas.cpp
+ * @brief Implementation file for the CFontAtlas class.
+ */
+
+#include <algorithm>
+#include "fontAtlas.h"
+#include "utf8.h"
+
+#ifdef EMBEDDED_FONT_ATLAS
+
+namespace
+{
+    // Generated by tools/atlasgen (see the Makefile): s_atlasSize, s_atlasLineHeight, s_atlasLineSkip, s_atlasWidth,
+    // s_atlasGlyphs and s_atlasPixels.
+    #include "fontAtlasData.h"
+}
+
+CFontAtlas::CFontAtlas(void) :
+    m_glyphs(s_atlasGlyphs),
+    m_glyphCount(sizeof(s_atlasGlyphs) / sizeof(s_atlasGlyphs[0])),
+    m_pixels(s_atlasPixels),
+    m_width(s_atlasWidth),
+    m_size(s_atlasSize),
+    m_lineHeight(s_atlasLineHeight),
+    m_lineSkip(s_atlasLineSkip)
+{
+    // Nothing to do here. The glyphs are compiled in.
+}
+
+#else
+
+CFontAtlas::CFontAtlas(void) :
+    m_glyphs(nullptr),
+    m_glyphCount(0),
+    m_pixels(nullptr),
+    m_width(0),
+    m_size(0),
+    m_lineHeight(0),
+    m_lineSkip(0)
+{
+    // Nothing to do here. The program was built without an atlas.
+}
+
+#endif
+
+const bool CFontAtlas::covers(const std::string& p_text) const
+{
+    // Look up every code point of the text.
+
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        if (getGlyph(UTF8_Utils::decode(p_text, l_position, l_length)) == nullptr) return false;
+    }
+
+    return true;
+}
+
+int CFontAtlas::measure(const std::string& p_text) const
+{
+    // Add up the advances of the glyphs.
+
+    int l_width(0);
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        const SGlyph* l_glyph = getGlyph(UTF8_Utils::decode(p_text, l_position, l_length));
+
+        if (l_glyph != nullptr) l_width += l_glyph->m_advance;
+    }
+
+    return l_width;
+}
+
+SDL_Surface* CFontAtlas::render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const
+{
+    // 1. Create an 8-bit line as wide as the text, whose palette blends the background into the foreground color, so
+    //    the coverage of the glyphs is copied as is (index 0 is the background).
+    // 2. Put each glyph after the previous one, clipped to the line. Where glyphs overlap, the highest coverage wins.
+
+    const int l_width = measure(p_text);
+
+    if (l_width <= 0) return nullptr;
+
+    SDL_Surface* l_line = SDL_CreateRGBSurfaceWithFormat(0, l_width, m_lineHeight, 8, SDL_PIXELFORMAT_INDEX8);
+
+    if (l_line == nullptr)
+    {
+        SDL_LogError(0, "Could not create the line of text: %s", SDL_GetError());
+        return nullptr;
+    }
+
+    SDL_Color l_colors[256];
+
+    for (int l_i = 0; l_i < 256; ++l_i)
+    {
+        l_colors[l_i].r = static_cast<Uint8>(p_backgroundColor.r + (p_foregroundColor.r - p_backgroundColor.r) * l_i / 255);
+        l_colors[l_i].g = static_cast<Uint8>(p_backgroundColor.g + (p_foregroundColor.g - p_backgroundColor.g) * l_i / 255);
+        l_colors[l_i].b = static_cast<Uint8>(p_backgroundColor.b + (p_foregroundColor.b - p_backgroundColor.b) * l_i / 255);
+        l_colors[l_i].a = 255;
+    }
+
+    SDL_SetPaletteColors(l_line->format->palette, l_colors, 0, 256);
+    SDL_memset(l_line->pixels, 0, static_cast<size_t>(l_line->pitch) * l_line->h);
+
+    Uint8* const l_pixels = static_cast<Uint8*>(l_line->pixels);
+    int l_pen(0);
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        const SGlyph* l_glyph = getGlyph(UTF8_Utils::decode(p_text, l_position, l_length));
+
+        if (l_glyph == nullptr) continue;
+
+        const int l_left = l_pen + l_glyph->m_offsetX;
+        const int l_firstColumn = std::max(0, -l_left);
+        const int l_lastColumn = std::min(static_cast<int>(l_glyph->m_width), l_width - l_left);
+        const int l_lastRow = std::min(static_cast<int>(l_glyph->m_height), m_lineHeight - l_glyph->m_offsetY);
+
+        for (int l_row = std::max(0, -static_cast<int>(l_glyph->m_offsetY)); l_row < l_lastRow; ++l_row)
+        {
+            const Uint8* l_source = m_pixels + static_cast<size_t>(l_glyph->m_y + l_row) * m_width + l_glyph->m_x;
+            Uint8* l_target = l_pixels + static_cast<size_t>(l_glyph->m_offsetY + l_row) * l_line->pitch + l_left;
+
+            for (int l_column = l_firstColumn; l_column < l_lastColumn; ++l_column)
+            {
+                if (l_source[l_column] > l_target[l_column]) l_target[l_column] = l_source[l_column];
+            }
+        }
+
+        l_pen += l_glyph->m_advance;
+    }
+
+    return l_line;
+}
+
+const CFontAtlas::SGlyph* CFontAtlas::getGlyph(const Uint32 p_codepoint) const
+{
+    // Binary search among the glyphs, sorted by code point.
+
+    const SGlyph* l_end = m_glyphs + m_glyphCount;
+    const SGlyph* l_found = std::lower_bound(m_glyphs, l_end, p_codepoint, [](const SGlyph& p_glyph, const Uint32 p_value) { return p_glyph.m_codepoint < p_value; });
+
+    return (l_found != l_end && l_found->m_codepoint == p_codepoint) ? l_found : nullptr;
+}
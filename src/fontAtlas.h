@@ -0,0 +1,138 @@
+/**
+ * @file  fontAtlas.h
+ * @brief Header file for the CFontAtlas class, which draws text from glyphs pre-rasterized at build time and compiled
+ *        into the program.
+ */
+#ifndef _FONTATLAS_H_
+#define _FONTATLAS_H_
+
+#include <string>
+#include <SDL.h>
+
+/**
+ * @class CFontAtlas
+ * @brief Font atlas embedded in the program: the glyphs of the keysets, footer and buttons, rasterized from the keyboard
+ *        font at the size it has at the reference resolution by tools/atlasgen, as 8-bit coverage.
+ *
+ * When the keyboard font has that size, text made only of these glyphs is drawn from the atlas, without opening any
+ * font file. The atlas is empty if the program was built without it (ATLAS=0).
+ */
+class CFontAtlas
+{
+    public:
+
+    /**
+     * @struct SGlyph
+     * @brief  A glyph of the atlas, as it is generated.
+     */
+    struct SGlyph
+    {
+        Uint32 m_codepoint;     /**< The code point */
+        Sint16 m_x;             /**< Left of the glyph in the atlas */
+        Sint16 m_y;             /**< Top of the glyph in the atlas */
+        Sint16 m_width;         /**< Width of the glyph */
+        Sint16 m_height;        /**< Height of the glyph */
+        Sint16 m_offsetX;       /**< Left of the glyph relative to the pen */
+        Sint16 m_offsetY;       /**< Top of the glyph relative to the top of the line */
+        Sint16 m_advance;       /**< Advance of the pen */
+    };
+
+    /**
+     * @brief Constructor for the atlas, bound to the embedded glyphs.
+     */
+    CFontAtlas(void);
+
+    /**
+     * @brief          Copy constructor for the atlas (forbidden).
+     * @param p_source The source atlas to copy.
+     */
+    CFontAtlas(const CFontAtlas& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the atlas (forbidden).
+     * @param p_source The source atlas to move resources from.
+     */
+    CFontAtlas(const CFontAtlas&& p_source) = delete;
+
+    /**
+     * @brief  Indicates whether the program has an embedded atlas.
+     * @return TRUE if it has glyphs; otherwise, FALSE.
+     */
+    inline bool isLoaded(void) const { return m_glyphCount > 0; }
+
+    /**
+     * @brief  Gets the size the glyphs were rasterized at.
+     * @return The size, in points (0 without an atlas).
+     */
+    inline int getSize(void) const { return m_size; }
+
+    /**
+     * @brief  Gets the height of a line.
+     * @return The height, in pixels.
+     */
+    inline int getHeight(void) const { return m_lineHeight; }
+
+    /**
+     * @brief  Gets the distance between the tops of consecutive lines.
+     * @return The distance, in pixels.
+     */
+    inline int getLineSkip(void) const { return m_lineSkip; }
+
+    /**
+     * @brief        Checks whether the atlas has every character of a text.
+     * @param p_text The text.
+     * @return       TRUE if the text can be drawn; otherwise, FALSE.
+     */
+    const bool covers(const std::string& p_text) const;
+
+    /**
+     * @brief        Measures a text (characters missing from the atlas are skipped).
+     * @param p_text The text.
+     * @return       The width, in pixels.
+     */
+    int measure(const std::string& p_text) const;
+
+    /**
+     * @brief                   Renders a text over a solid background, like TTF_RenderUTF8_Shaded (8-bit surface whose
+     *                          palette goes from the background to the foreground color).
+     * @param p_text            The text.
+     * @param p_foregroundColor The foreground color.
+     * @param p_backgroundColor The background color.
+     * @return                  Pointer to the rendered SDL surface (nullptr if the text is empty or the rendering fails).
+     */
+    SDL_Surface* render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const;
+
+    private:
+
+    /**
+     * @brief             Gets the glyph of a code point.
+     * @param p_codepoint The code point.
+     * @return            Pointer to the glyph, or nullptr if it is not in the atlas.
+     */
+    const SGlyph* getGlyph(const Uint32 p_codepoint) const;
+
+    /**
+     * @brief The glyphs, sorted by code point, and their amount.
+     */
+    const SGlyph* m_glyphs;
+    size_t m_glyphCount;
+
+    /**
+     * @brief The coverage of the glyphs (255 inside), row by row, and the width of a row.
+     */
+    const Uint8* m_pixels;
+    int m_width;
+
+    /**
+     * @brief The size the glyphs were rasterized at, in points.
+     */
+    int m_size;
+
+    /**
+     * @brief The height of a line, and the distance between lines, in pixels.
+     */
+    int m_lineHeight;
+    int m_lineSkip;
+};
+
+#endif // _FONTATLAS_H_
@@ -0,0 +1,376 @@
+/**
+ * @file  fontChain.cpp
+ * @brief Implementation file for the CFontChain class.
+ */
+
+#include <cstring>
+#include "fontChain.h"
+#include "def.h"
+#include "resourcePack.h"
+#include "sdlUtils.h"
+#include "utf8.h"
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of a coverage file.
+     */
+    const char s_magic[4] = { 'V', 'K', 'F', 'C' };
+
+    /**
+     * @brief Version of the coverage file format.
+     */
+    constexpr Uint32 s_version = 1;
+
+    /**
+     * @brief Size of the header of a coverage file: magic, version, and size and hash of the font file.
+     */
+    constexpr size_t s_headerSize = sizeof(s_magic) + 3 * sizeof(Uint32);
+
+    /**
+     * @brief Size of a coverage bitmap, in bytes.
+     */
+    constexpr size_t s_coverageSize = FONTCHAIN_CODEPOINTS / 8;
+}
+
+CFontChain::CFontChain(void) :
+    m_lineHeight(0),
+    m_lineSkip(0),
+    m_bitmapFont(nullptr),
+    m_atlas(nullptr)
+{
+    // Nothing to do here. The fonts are added by the resource manager.
+}
+
+void CFontChain::add(TTF_Font* p_font, const std::string& p_path, const bool p_scaled)
+{
+    // 1. Skip missing fonts. The first font sets the height of the lines and the distance between them.
+    // 2. Load its coverage from the cache, or build it and cache it.
+
+    if (p_font == nullptr) return;
+
+    if (m_fonts.empty())
+    {
+        m_lineHeight = TTF_FontHeight(p_font);
+        m_lineSkip = TTF_FontLineSkip(p_font);
+    }
+
+    m_fonts.push_back(SFont{ p_font, p_path, 0, p_scaled, std::vector<Uint8>() });
+    index(m_fonts.back());
+}
+
+void CFontChain::add(const std::string& p_path, const int p_size, const bool p_scaled)
+{
+    // Only remember the font: it is opened by the first lookup that reaches it.
+
+    m_fonts.push_back(SFont{ nullptr, p_path, p_size, p_scaled, std::vector<Uint8>() });
+}
+
+void CFontChain::setBitmapFont(const CBitmapFont* p_font)
+{
+    m_bitmapFont = p_font;
+}
+
+void CFontChain::setAtlas(const CFontAtlas* p_atlas)
+{
+    m_atlas = p_atlas;
+
+    if (m_atlas != nullptr)
+    {
+        m_lineHeight = m_atlas->getHeight();
+        m_lineSkip = m_atlas->getLineSkip();
+    }
+}
+
+void CFontChain::clear(void)
+{
+    // Close the deferred fonts that were opened; the other ones belong to the resource manager.
+
+    for (SFont& l_font : m_fonts)
+    {
+        if (l_font.m_size > 0 && l_font.m_font != nullptr) TTF_CloseFont(l_font.m_font);
+    }
+
+    m_fonts.clear();
+    m_lineHeight = 0;
+    m_lineSkip = 0;
+    m_bitmapFont = nullptr;
+    m_atlas = nullptr;
+}
+
+TTF_Font* CFontChain::getFont(const unsigned int p_index) const
+{
+    return (p_index < m_fonts.size() && open(m_fonts[p_index])) ? m_fonts[p_index].m_font : nullptr;
+}
+
+const unsigned int CFontChain::getFontOf(const Uint32 p_codepoint) const
+{
+    // Probe the bitmap of each font, in order, opening the deferred ones on the way. Code points beyond the index go to
+    // the first font.
+
+    if (p_codepoint >= FONTCHAIN_CODEPOINTS) return 0;
+
+    const size_t l_byte = p_codepoint >> 3;
+    const Uint8 l_bit = static_cast<Uint8>(1 << (p_codepoint & 7));
+
+    for (unsigned int l_i = 0; l_i < m_fonts.size(); ++l_i)
+    {
+        if (open(m_fonts[l_i]) && (m_fonts[l_i].m_coverage[l_byte] & l_bit)) return l_i;
+    }
+
+    return 0;
+}
+
+void CFontChain::split(const std::string& p_text, std::vector<SRun>& p_runs) const
+{
+    // 1. Walk the text grapheme by grapheme, so combining marks and joined emoji stay with their base character.
+    // 2. Choose the font by the first code point of each grapheme, and extend the last run if it has the same font.
+
+    p_runs.clear();
+
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size();)
+    {
+        const size_t l_next = UTF8_Utils::nextGrapheme(p_text, l_position);
+        const unsigned int l_font = getFontOf(UTF8_Utils::decode(p_text, l_position, l_length));
+
+        if (!p_runs.empty() && p_runs.back().m_font == l_font)
+        {
+            p_runs.back().m_length += l_next - l_position;
+        }
+        else
+        {
+            p_runs.push_back(SRun{ l_position, l_next - l_position, l_font });
+        }
+
+        l_position = l_next;
+    }
+}
+
+int CFontChain::measure(const std::string& p_text) const
+{
+    // Add up the widths of the runs (a single run is measured at once). A bitmap font, or the atlas if it has all the
+    // characters, measures the whole text.
+
+    if (m_bitmapFont != nullptr) return m_bitmapFont->measure(p_text);
+    if (isInAtlas(p_text)) return m_atlas->measure(p_text);
+    if (p_text.empty() || m_fonts.empty()) return 0;
+
+    std::vector<SRun> l_runs;
+    split(p_text, l_runs);
+
+    if (l_runs.size() == 1) return measureRun(l_runs[0].m_font, p_text);
+
+    int l_width(0);
+
+    for (const SRun& l_run : l_runs)
+    {
+        l_width += measureRun(l_run.m_font, p_text.substr(l_run.m_start, l_run.m_length));
+    }
+
+    return l_width;
+}
+
+SDL_Surface* CFontChain::render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const
+{
+    // 1. Split the text into runs. A single run of the first font is rendered as before, straight by that font.
+    // 2. Otherwise, fill a line as wide as the text with the background color.
+    // 3. Render each run with its font and put it after the previous one: scaled fonts are blended and scaled to the
+    //    height of the line, the other ones are shaded over the background.
+    //    A bitmap font, or the atlas if it has all the characters, renders the whole text instead.
+
+    if (m_bitmapFont != nullptr) return m_bitmapFont->render(p_text, p_foregroundColor, p_backgroundColor);
+    if (isInAtlas(p_text)) return m_atlas->render(p_text, p_foregroundColor, p_backgroundColor);
+    if (p_text.empty() || m_fonts.empty()) return nullptr;
+
+    std::vector<SRun> l_runs;
+    split(p_text, l_runs);
+
+    if (l_runs.size() == 1 && l_runs[0].m_font == 0)
+    {
+        TTF_Font* l_first = getFont(0);
+        return l_first != nullptr ? SDL_Utils::renderText(l_first, p_text, p_foregroundColor, p_backgroundColor) : nullptr;
+    }
+
+    const int l_width = measure(p_text);
+
+    if (l_width <= 0) return nullptr;
+
+    SDL_Surface* l_line = SDL_Utils::createImage(l_width, m_lineHeight, SDL_MapRGB(Globals::g_screen->format, p_backgroundColor.r, p_backgroundColor.g, p_backgroundColor.b));
+
+    if (l_line == nullptr) return nullptr;
+
+    int l_x(0);
+
+    for (const SRun& l_run : l_runs)
+    {
+        const SFont& l_font = m_fonts[l_run.m_font];
+        const std::string l_text = p_text.substr(l_run.m_start, l_run.m_length);
+        const int l_runWidth = measureRun(l_run.m_font, l_text);
+
+        if (!open(m_fonts[l_run.m_font])) continue;
+
+        SDL_Surface* l_surface = l_font.m_scaled ? TTF_RenderUTF8_Blended(l_font.m_font, l_text.c_str(), p_foregroundColor) : TTF_RenderUTF8_Shaded(l_font.m_font, l_text.c_str(), p_foregroundColor, p_backgroundColor);
+
+        if (l_surface == nullptr)
+        {
+            SDL_Log("Error getting TTF surface: %s", TTF_GetError());
+            SDL_ClearError();
+        }
+        else if (l_font.m_scaled)
+        {
+            SDL_Rect l_target{ l_x, 0, l_runWidth, m_lineHeight };
+            SDL_BlitScaled(l_surface, nullptr, l_line, &l_target);
+        }
+        else
+        {
+            SDL_Utils::applySurface(static_cast<Sint16>(l_x), 0, l_surface, l_line);
+        }
+
+        if (l_surface != nullptr) SDL_FreeSurface(l_surface);
+
+        l_x += l_runWidth;
+    }
+
+    return l_line;
+}
+
+const bool CFontChain::open(SFont& p_font) const
+{
+    // 1. A font is open once it has its coverage. A deferred font that could not be opened has no path anymore.
+    // 2. Open the deferred font and load its coverage.
+
+    if (!p_font.m_coverage.empty()) return true;
+    if (p_font.m_path.empty()) return false;
+
+    if (p_font.m_font == nullptr)
+    {
+        p_font.m_font = TTF_OpenFontRW(CResourcePack::instance().open(p_font.m_path), 1, p_font.m_size);
+
+        if (p_font.m_font == nullptr)
+        {
+            INHIBIT(SDL_Log("Skipping font %s: %s", p_font.m_path.c_str(), TTF_GetError());)
+            p_font.m_path.clear();
+            return false;
+        }
+
+        if (m_atlas != nullptr) TTF_SetFontKerning(p_font.m_font, 0);
+    }
+
+    index(p_font);
+
+    return true;
+}
+
+void CFontChain::index(SFont& p_font)
+{
+    // 1. Load the coverage from the cache, if it belongs to this font file.
+    // 2. Otherwise, build it and cache it for the next runs.
+
+    const std::string l_cachePath = p_font.m_path + FONTCHAIN_COVERAGE_EXT;
+    Uint32 l_size(0);
+    Uint32 l_hash(0);
+    const bool l_fingerprinted = SDL_Utils::getFingerprint(p_font.m_path, l_size, l_hash);
+
+    if (l_fingerprinted && loadCoverage(l_cachePath, l_size, l_hash, p_font)) return;
+
+    INHIBIT(SDL_Log("Building the coverage of font %s", p_font.m_path.c_str());)
+
+    buildCoverage(p_font);
+
+    if (l_fingerprinted) saveCoverage(l_cachePath, l_size, l_hash, p_font);
+}
+
+const bool CFontChain::loadCoverage(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash, SFont& p_font)
+{
+    // 1. Read the header and check its magic, version and fingerprint.
+    // 2. Read the bitmap.
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_path.c_str(), "rb");
+
+    if (l_file == nullptr) return false;
+
+    char l_header[s_headerSize];
+    const Uint32 l_expected[3] = { s_version, p_size, p_hash };
+    bool l_valid = SDL_RWread(l_file, l_header, 1, sizeof(l_header)) == sizeof(l_header)
+                && std::memcmp(l_header, s_magic, sizeof(s_magic)) == 0
+                && std::memcmp(l_header + sizeof(s_magic), l_expected, sizeof(l_expected)) == 0;
+
+    if (l_valid)
+    {
+        p_font.m_coverage.resize(s_coverageSize);
+        l_valid = SDL_RWread(l_file, p_font.m_coverage.data(), 1, s_coverageSize) == s_coverageSize;
+    }
+
+    SDL_RWclose(l_file);
+
+    if (!l_valid) p_font.m_coverage.clear();
+
+    return l_valid;
+}
+
+void CFontChain::buildCoverage(SFont& p_font)
+{
+    // Ask the font for the glyph of every code point but the surrogates, which are not characters.
+
+    p_font.m_coverage.assign(s_coverageSize, 0);
+
+    for (Uint32 l_codepoint = 0; l_codepoint < FONTCHAIN_CODEPOINTS; ++l_codepoint)
+    {
+        if (l_codepoint == 0xD800) l_codepoint = 0xE000;
+
+        if (TTF_GlyphIsProvided32(p_font.m_font, l_codepoint))
+        {
+            p_font.m_coverage[l_codepoint >> 3] |= static_cast<Uint8>(1 << (l_codepoint & 7));
+        }
+    }
+}
+
+void CFontChain::saveCoverage(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash, const SFont& p_font)
+{
+    // Write the header and the bitmap. The cache is optional, so a failure is only a warning.
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_path.c_str(), "wb");
+
+    if (l_file == nullptr)
+    {
+        SDL_LogWarn(0, "Could not create coverage file %s: %s", p_path.c_str(), SDL_GetError());
+        return;
+    }
+
+    const Uint32 l_fingerprint[3] = { s_version, p_size, p_hash };
+    const bool l_written = SDL_RWwrite(l_file, s_magic, 1, sizeof(s_magic)) == sizeof(s_magic)
+                        && SDL_RWwrite(l_file, l_fingerprint, 1, sizeof(l_fingerprint)) == sizeof(l_fingerprint)
+                        && SDL_RWwrite(l_file, p_font.m_coverage.data(), 1, s_coverageSize) == s_coverageSize;
+    SDL_RWclose(l_file);
+
+    if (!l_written) SDL_LogWarn(0, "Could not write coverage file %s: %s", p_path.c_str(), SDL_GetError());
+}
+
+int CFontChain::measureRun(const unsigned int p_font, const std::string& p_text) const
+{
+    // Measure the run with its font (nothing if it cannot be opened) and, if its glyphs are scaled, scale its width
+    // like them.
+
+    int l_width(0);
+
+    if (!open(m_fonts[p_font])) return 0;
+
+    const SFont& l_font = m_fonts[p_font];
+
+    if (TTF_SizeUTF8(l_font.m_font, p_text.c_str(), &l_width, nullptr) != 0)
+    {
+        SDL_LogWarn(0, "Could not measure UTF8 string: %s", TTF_GetError());
+        return 0;
+    }
+
+    if (l_font.m_scaled)
+    {
+        const int l_height = TTF_FontHeight(l_font.m_font);
+
+        if (l_height > 0) l_width = l_width * m_lineHeight / l_height;
+    }
+
+    return l_width;
+}
@@ -0,0 +1,262 @@
+/**
+ * @file  fontChain.h
+ * @brief Header file for the CFontChain class, an ordered list of fonts where each character is drawn with the first
+ *        one that provides it.
+ */
+#ifndef _FONTCHAIN_H_
+#define _FONTCHAIN_H_
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "bitmapFont.h"
+#include "fontAtlas.h"
+
+/**
+ * @brief Macro that indicates the amount of code points whose coverage is indexed (the basic and the supplementary
+ *        multilingual planes). Characters beyond them are drawn with the first font.
+ *
+ * @param X The amount of code points.
+ */
+#define FONTCHAIN_CODEPOINTS 0x20000
+
+/**
+ * @brief Macro that indicates the extension of the file where the coverage of a font is cached, next to the font.
+ *
+ * @param X The extension.
+ */
+#define FONTCHAIN_COVERAGE_EXT ".coverage"
+
+/**
+ * @class CFontChain
+ * @brief Fallback chain of fonts: text is split into runs of characters provided by the same font, the first one of
+ *        the chain providing them, and each run is drawn with its font.
+ *
+ * The coverage of each font is a bitmap with one bit per code point, built once by asking the font for every glyph
+ * and cached in a file next to it (recognized by the size and a hash of the head of the font file). Choosing the font
+ * of a character is then a probe of the bitmaps, instead of asking each font in turn.
+ *
+ * Fonts may be deferred: they are opened, and their coverage loaded, the first time a character is looked up in them.
+ * Text made only of glyphs of the embedded atlas (see setAtlas) is drawn from it, without any font.
+ */
+class CFontChain
+{
+    public:
+
+    /**
+     * @struct SRun
+     * @brief  Range of a text drawn with the same font.
+     */
+    struct SRun
+    {
+        size_t m_start;         /**< Position of the run in the text, in bytes */
+        size_t m_length;        /**< Length of the run, in bytes */
+        unsigned int m_font;    /**< Index of the font in the chain */
+    };
+
+    /**
+     * @brief Constructor for the chain, empty.
+     */
+    CFontChain(void);
+
+    /**
+     * @brief          Copy constructor for the chain (forbidden).
+     * @param p_source The source chain to copy.
+     */
+    CFontChain(const CFontChain& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the chain (forbidden).
+     * @param p_source The source chain to move resources from.
+     */
+    CFontChain(const CFontChain&& p_source) = delete;
+
+    /**
+     * @brief          Appends a font to the chain, loading its coverage from the cache or building (and caching) it.
+     *                 The first font sets the height of the lines; the chain does not take ownership of the fonts.
+     * @param p_font   The font.
+     * @param p_path   The path of the font file.
+     * @param p_scaled TRUE if the glyphs of the font must be scaled to the height of the lines (e.g. colour fonts,
+     *                 which have a single size); otherwise, FALSE.
+     */
+    void add(TTF_Font* p_font, const std::string& p_path, const bool p_scaled = false);
+
+    /**
+     * @brief          Appends a deferred font to the chain: it is opened the first time a character is looked up in it
+     *                 (and skipped from then on if it cannot be opened), and closed by the chain. The first font of the
+     *                 chain may only be deferred if an atlas sets the height of the lines.
+     * @param p_path   The path of the font file.
+     * @param p_size   The size to open the font at, in points.
+     * @param p_scaled TRUE if the glyphs of the font must be scaled to the height of the lines; otherwise, FALSE.
+     */
+    void add(const std::string& p_path, const int p_size, const bool p_scaled = false);
+
+    /**
+     * @brief         Makes the chain draw text from an atlas when it has all its characters, instead of opening fonts.
+     *                The atlas sets the height of the lines, so it must have been rasterized from the first font, at
+     *                its size.
+     * @param p_atlas The atlas (nullptr to draw with the fonts of the chain only).
+     */
+    void setAtlas(const CFontAtlas* p_atlas);
+
+    /**
+     * @brief        Makes the chain draw all text with a bitmap font instead of its fonts (see --bitmap-font).
+     * @param p_font The bitmap font (nullptr to draw with the fonts of the chain again).
+     */
+    void setBitmapFont(const CBitmapFont* p_font);
+
+    /**
+     * @brief Removes all the fonts of the chain, closing the deferred ones.
+     */
+    void clear(void);
+
+    /**
+     * @brief  Gets the height of a line of text.
+     * @return The height, in pixels.
+     */
+    inline int getLineHeight(void) const { return m_bitmapFont != nullptr ? m_bitmapFont->getHeight() : m_lineHeight; }
+
+    /**
+     * @brief  Gets the distance between the tops of consecutive lines of text.
+     * @return The distance, in pixels.
+     */
+    inline int getLineSkip(void) const { return m_bitmapFont != nullptr ? m_bitmapFont->getHeight() + 1 : m_lineSkip; }
+
+    /**
+     * @brief  Gets the amount of fonts of the chain.
+     * @return The amount of fonts.
+     */
+    inline size_t getFontCount(void) const { return m_fonts.size(); }
+
+    /**
+     * @brief         Gets a font of the chain, opening it if it is deferred.
+     * @param p_index The index of the font.
+     * @return        The font, or nullptr if it cannot be opened.
+     */
+    TTF_Font* getFont(const unsigned int p_index) const;
+
+    /**
+     * @brief        Indicates whether a text is drawn from the atlas, so without opening any font.
+     * @param p_text The text.
+     * @return       TRUE if the atlas has all its characters; otherwise, FALSE.
+     */
+    inline bool isInAtlas(const std::string& p_text) const { return m_bitmapFont == nullptr && m_atlas != nullptr && m_atlas->covers(p_text); }
+
+    /**
+     * @brief             Gets the first font of the chain providing a code point, opening the deferred fonts it is
+     *                    looked up in.
+     * @param p_codepoint The code point.
+     * @return            The index of the font (0 if none provides it).
+     */
+    const unsigned int getFontOf(const Uint32 p_codepoint) const;
+
+    /**
+     * @brief        Splits a text into runs of graphemes drawn with the same font (chosen by their first code point).
+     * @param p_text The text.
+     * @param p_runs Output: the runs, in order.
+     */
+    void split(const std::string& p_text, std::vector<SRun>& p_runs) const;
+
+    /**
+     * @brief        Measures a text as it is rendered by the chain.
+     * @param p_text The text.
+     * @return       The width, in pixels.
+     */
+    int measure(const std::string& p_text) const;
+
+    /**
+     * @brief                   Renders a text over a solid background, each run with its font.
+     * @param p_text            The text.
+     * @param p_foregroundColor The foreground color.
+     * @param p_backgroundColor The background color.
+     * @return                  Pointer to the rendered SDL surface (nullptr if the text is empty or the rendering fails).
+     */
+    SDL_Surface* render(const std::string& p_text, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor) const;
+
+    private:
+
+    /**
+     * @struct SFont
+     * @brief  A font of the chain and its coverage.
+     */
+    struct SFont
+    {
+        TTF_Font* m_font;               /**< The font (nullptr until a deferred font is opened) */
+        std::string m_path;             /**< The path of the font file (emptied if it cannot be opened) */
+        int m_size;                     /**< The size of a deferred font, in points (0 for a font added opened) */
+        bool m_scaled;                  /**< Whether its glyphs are scaled to the height of the lines */
+        std::vector<Uint8> m_coverage;  /**< One bit per code point, set if the font provides it */
+    };
+
+    /**
+     * @brief        Opens a deferred font, if it is not yet, and loads its coverage. With an atlas, which has no
+     *               kerning, its kerning is turned off, so a text measures the same drawn from either.
+     * @param p_font The font.
+     * @return       TRUE if the font is open; otherwise, FALSE.
+     */
+    const bool open(SFont& p_font) const;
+
+    /**
+     * @brief        Loads the coverage of a font from the cache or, if there is none for this font file, builds it and
+     *               caches it.
+     * @param p_font The font whose coverage is loaded.
+     */
+    static void index(SFont& p_font);
+
+    /**
+     * @brief          Loads the cached coverage of a font, if it matches the fingerprint of the font file.
+     * @param p_path   The path of the cache file.
+     * @param p_size   The size of the font file.
+     * @param p_hash   The hash of the head of the font file.
+     * @param p_font   The font whose coverage is loaded.
+     * @return         TRUE if the coverage was loaded; otherwise, FALSE.
+     */
+    static const bool loadCoverage(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash, SFont& p_font);
+
+    /**
+     * @brief        Builds the coverage of a font, asking it for every indexed code point.
+     * @param p_font The font whose coverage is built.
+     */
+    static void buildCoverage(SFont& p_font);
+
+    /**
+     * @brief        Writes the coverage of a font to its cache file.
+     * @param p_path The path of the cache file.
+     * @param p_size The size of the font file.
+     * @param p_hash The hash of the head of the font file.
+     * @param p_font The font whose coverage is written.
+     */
+    static void saveCoverage(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash, const SFont& p_font);
+
+    /**
+     * @brief        Measures a run with its font, scaled to the height of the lines if needed.
+     * @param p_font The index of the font of the run.
+     * @param p_text The text of the run.
+     * @return       The width, in pixels.
+     */
+    int measureRun(const unsigned int p_font, const std::string& p_text) const;
+
+    /**
+     * @brief The fonts of the chain, in order (deferred fonts are opened while drawing).
+     */
+    mutable std::vector<SFont> m_fonts;
+
+    /**
+     * @brief The height of the lines, and the distance between them (the ones of the first font), in pixels.
+     */
+    int m_lineHeight;
+    int m_lineSkip;
+
+    /**
+     * @brief The bitmap font that draws all text, if any.
+     */
+    const CBitmapFont* m_bitmapFont;
+
+    /**
+     * @brief The atlas text is drawn from when it has all its characters, if any.
+     */
+    const CFontAtlas* m_atlas;
+};
+
+#endif // _FONTCHAIN_H_
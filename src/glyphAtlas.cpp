@@ -0,0 +1,109 @@
+/**
+ * @file  glyphAtlas.cpp
+ * @brief Implementation file for the CGlyphAtlas class.
+ */
+
+#include <algorithm>
+#include "glyphAtlas.h"
+
+CGlyphAtlas::CGlyphAtlas(const CFontChain& p_fonts, const unsigned int p_font, const int p_height) :
+    m_fonts(&p_fonts),
+    m_font(p_font),
+    m_height(p_height > 0 ? p_height : 1),
+    m_atlas(nullptr),
+    m_nextX(0),
+    m_nextY(0)
+{
+    // Nothing to do here. The surface is created when the first glyph is rendered.
+}
+
+CGlyphAtlas::~CGlyphAtlas(void)
+{
+    // Free the surface.
+
+    if (m_atlas != nullptr)
+    {
+        SDL_FreeSurface(m_atlas);
+        m_atlas = nullptr;
+    }
+}
+
+const bool CGlyphAtlas::draw(const std::string& p_grapheme, const Sint16 p_x, const Sint16 p_y, SDL_Surface* p_destination)
+{
+    // 1. Get the glyph, rendering it if needed.
+    // 2. Blend it over the destination, centered horizontally.
+
+    const SDL_Rect* l_glyph = getGlyph(p_grapheme);
+
+    if (l_glyph == nullptr) return false;
+
+    SDL_Rect l_source = *l_glyph;
+    SDL_Rect l_target{ p_x - l_glyph->w / 2, p_y, l_glyph->w, l_glyph->h };
+
+    return SDL_BlitSurface(m_atlas, &l_source, p_destination, &l_target) == 0;
+}
+
+const SDL_Rect* CGlyphAtlas::getGlyph(const std::string& p_grapheme)
+{
+    // 1. Return the glyph if it is in the atlas.
+    // 2. Render it with its colours and alpha (colour fonts have fixed sizes, so it is scaled to the height of the atlas).
+    // 3. Find room for it: on the current shelf, on the next one, or in the emptied atlas if it is full.
+    // 4. Copy it, alpha included, and remember its rectangle.
+
+    const auto l_found = m_glyphs.find(p_grapheme);
+
+    if (l_found != m_glyphs.end()) return &l_found->second;
+    if (!isEnabled() || p_grapheme.empty()) return nullptr;
+
+    TTF_Font* l_font = m_fonts->getFont(m_font);
+
+    if (l_font == nullptr) return nullptr;
+
+    if (m_atlas == nullptr)
+    {
+        m_atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPHATLAS_WIDTH, GLYPHATLAS_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+
+        if (m_atlas == nullptr)
+        {
+            SDL_LogError(0, "Could not create the glyph atlas: %s", SDL_GetError());
+            m_fonts = nullptr;
+            return nullptr;
+        }
+
+        SDL_SetSurfaceBlendMode(m_atlas, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Surface* l_rendered = TTF_RenderUTF8_Blended(l_font, p_grapheme.c_str(), SDL_Color{ 255, 255, 255, 255 });
+
+    if (l_rendered == nullptr || l_rendered->h <= 0)
+    {
+        if (l_rendered != nullptr) SDL_FreeSurface(l_rendered);
+        return nullptr;
+    }
+
+    const int l_width = std::max(1, std::min(GLYPHATLAS_WIDTH, l_rendered->w * m_height / l_rendered->h));
+
+    if (m_nextX + l_width > GLYPHATLAS_WIDTH)
+    {
+        m_nextX = 0;
+        m_nextY += m_height;
+    }
+
+    if (m_nextY + m_height > GLYPHATLAS_HEIGHT)
+    {
+        m_glyphs.clear();
+        SDL_FillRect(m_atlas, nullptr, 0);
+        m_nextX = 0;
+        m_nextY = 0;
+    }
+
+    SDL_Rect l_rect{ m_nextX, m_nextY, l_width, m_height };
+
+    SDL_SetSurfaceBlendMode(l_rendered, SDL_BLENDMODE_NONE);
+    SDL_BlitScaled(l_rendered, nullptr, m_atlas, &l_rect);
+    SDL_FreeSurface(l_rendered);
+
+    m_nextX += l_width;
+
+    return &(m_glyphs[p_grapheme] = SDL_Rect{ l_rect.x, l_rect.y, l_width, m_height });
+}
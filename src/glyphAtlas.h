@@ -0,0 +1,113 @@
+/**
+ * @file  glyphAtlas.h
+ * @brief Header file for the CGlyphAtlas class, which keeps glyphs rendered from a font in a single surface.
+ */
+#ifndef _GLYPHATLAS_H_
+#define _GLYPHATLAS_H_
+
+#include <string>
+#include <unordered_map>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "fontChain.h"
+
+/**
+ * @brief Macro that indicates the size of the surface of a glyph atlas.
+ *
+ * @param X The width or the height, in pixels.
+ */
+#define GLYPHATLAS_WIDTH 1024
+#define GLYPHATLAS_HEIGHT 512
+
+/**
+ * @class CGlyphAtlas
+ * @brief Atlas of graphemes (e.g. colour emoji) rendered once, at first use, and scaled to a fixed height.
+ *
+ * The glyphs are packed left to right in shelves as tall as a glyph, with their alpha channel, so they can be
+ * blended over any background. When the atlas is full, it is emptied and filled again from the next glyph.
+ */
+class CGlyphAtlas
+{
+    public:
+
+    /**
+     * @brief          Constructor for the atlas.
+     * @param p_fonts  The fallback chain of fonts.
+     * @param p_font   The index of the font of the chain the glyphs are rendered with (out of the chain disables the
+     *                 atlas). It is only opened when the first glyph is rendered.
+     * @param p_height The height of the glyphs in the atlas, in pixels.
+     */
+    CGlyphAtlas(const CFontChain& p_fonts, const unsigned int p_font, const int p_height);
+
+    /**
+     * @brief Destructor for the atlas, which frees its surface.
+     */
+    ~CGlyphAtlas(void);
+
+    /**
+     * @brief          Copy constructor for the atlas (forbidden).
+     * @param p_source The source atlas to copy.
+     */
+    CGlyphAtlas(const CGlyphAtlas& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the atlas (forbidden).
+     * @param p_source The source atlas to move resources from.
+     */
+    CGlyphAtlas(const CGlyphAtlas&& p_source) = delete;
+
+    /**
+     * @brief  Indicates whether the atlas has a font to render glyphs with.
+     * @return TRUE if it has a font; otherwise, FALSE.
+     */
+    inline bool isEnabled(void) const { return m_fonts != nullptr && m_font < m_fonts->getFontCount(); }
+
+    /**
+     * @brief               Draws a grapheme, rendering it into the atlas first if needed.
+     * @param p_grapheme    The grapheme.
+     * @param p_x           The horizontal center of the glyph.
+     * @param p_y           The top of the glyph.
+     * @param p_destination The surface to draw on.
+     * @return              TRUE if the glyph was drawn; otherwise, FALSE (e.g. the font cannot render it).
+     */
+    const bool draw(const std::string& p_grapheme, const Sint16 p_x, const Sint16 p_y, SDL_Surface* p_destination);
+
+    private:
+
+    /**
+     * @brief            Gets the rectangle of a glyph in the atlas, rendering it on first use.
+     * @param p_grapheme The grapheme.
+     * @return           The rectangle, or nullptr if the glyph could not be rendered.
+     */
+    const SDL_Rect* getGlyph(const std::string& p_grapheme);
+
+    /**
+     * @brief The chain of fonts (nullptr once the atlas is disabled), and the index of the font the glyphs are rendered
+     *        with.
+     */
+    const CFontChain* m_fonts;
+    unsigned int m_font;
+
+    /**
+     * @brief The height of the glyphs, in pixels.
+     */
+    int m_height;
+
+    /**
+     * @brief The surface of the atlas (created at first use).
+     */
+    SDL_Surface* m_atlas;
+
+    /**
+     * @brief The rectangle of each glyph in the atlas.
+     */
+    std::unordered_map<std::string, SDL_Rect> m_glyphs;
+
+    /**
+     * @brief Position where the next glyph is packed.
+     */
+    int m_nextX;
+    int m_nextY;
+};
+
+#endif // _GLYPHATLAS_H_
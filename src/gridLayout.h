@@ -0,0 +1,159 @@
+/**
+ * @file  gridLayout.h
+ * @brief Header file for the TGridLayout template, which generates the tables of a grid layout at compile time.
+ *
+ * @note This file should be compiled using C++11.
+ */
+#ifndef _GRIDLAYOUT_H_
+#define _GRIDLAYOUT_H_
+
+#include "layout.h"
+
+namespace GridLayout_Utils
+{
+    /**
+     * @brief Sequence of indexes, used to expand a table at compile time.
+     */
+    template<unsigned int... Is>
+    struct TIndices {};
+
+    /**
+     * @brief Builds the sequence of indexes [0, N).
+     */
+    template<unsigned int N, unsigned int... Is>
+    struct TMakeIndices : TMakeIndices<N - 1, N - 1, Is...> {};
+
+    template<unsigned int... Is>
+    struct TMakeIndices<0, Is...>
+    {
+        typedef TIndices<Is...> type;
+    };
+
+    /**
+     * @brief Table of N records, so it can be returned by a constexpr function.
+     */
+    template<typename T, unsigned int N>
+    struct TTable
+    {
+        T m_records[N];
+    };
+}
+
+/**
+ * @class TGridLayout
+ * @brief Geometry and navigation of a grid of keys, with a row of buttons under it, computed at compile time.
+ *
+ * The keys are laid out like the description compiled by CLayout::compile: rows of equal keys separated by one
+ * reference pixel horizontally and two vertically, and the buttons sharing the width of the grid. The neighbour of a
+ * key in the previous or next row is the one it overlaps the most (in a grid of equal keys, the one nearest to its
+ * center, the later one on a tie), wrapping around at the edges. The tables are constant expressions, so the layout
+ * costs no code to build and lives in read-only memory.
+ *
+ * @tparam Rows      Amount of rows of the grid.
+ * @tparam Columns   Amount of keys in each row of the grid.
+ * @tparam Buttons   Amount of buttons under the grid: the first one cancels, and the last one confirms.
+ * @tparam Backspace Key of the grid that erases the character before the caret, or LAYOUT_NO_KEY.
+ * @tparam KeyWidth  Width of the keys of the grid, in reference pixels.
+ * @tparam KeyHeight Height of the keys (and the buttons), in reference pixels.
+ */
+template<unsigned int Rows, unsigned int Columns, unsigned int Buttons, unsigned int Backspace = LAYOUT_NO_KEY, int KeyWidth = 19, int KeyHeight = 18>
+class TGridLayout
+{
+    public:
+
+    static_assert(Rows > 0 && Columns > 0 && Buttons > 0, "The grid needs keys and buttons");
+    static_assert(Rows * Columns + Buttons < LAYOUT_NO_KEY, "Too many keys for the layout format");
+    static_assert(Backspace == LAYOUT_NO_KEY || Backspace < Rows * Columns, "The backspace key must be in the grid");
+
+    /**
+     * @brief Amount of keys of the grid, amount of keys (buttons included), and amount of rows (buttons included).
+     */
+    static constexpr unsigned int GRID_KEYS = Rows * Columns;
+    static constexpr unsigned int KEYS = GRID_KEYS + Buttons;
+    static constexpr unsigned int ROWS = Rows + 1;
+
+    /**
+     * @brief Margin around the keys, and distance between consecutive keys and rows, in reference pixels.
+     */
+    static constexpr int MARGIN = 3;
+    static constexpr int PITCH_X = KeyWidth + 1;
+    static constexpr int PITCH_Y = KeyHeight + 2;
+
+    /**
+     * @brief Size of the keyboard, and width of the buttons, in reference pixels.
+     */
+    static constexpr int WIDTH = 2 * MARGIN + Columns * PITCH_X - 1;
+    static constexpr int HEIGHT = 2 * MARGIN + Rows * PITCH_Y + KeyHeight;
+    static constexpr int BUTTON_WIDTH = (Columns * PITCH_X - 1 - (static_cast<int>(Buttons) - 1)) / static_cast<int>(Buttons);
+
+    /**
+     * @brief Gets the tables of the keys and the rows.
+     */
+    static constexpr GridLayout_Utils::TTable<CLayout::SKey, KEYS> getKeys(void) { return makeKeys(typename GridLayout_Utils::TMakeIndices<KEYS>::type()); }
+    static constexpr GridLayout_Utils::TTable<CLayout::SRow, ROWS> getRows(void) { return makeRows(typename GridLayout_Utils::TMakeIndices<ROWS>::type()); }
+
+    private:
+
+    // Position of a key: its row, its column (or button), and whether it is a button.
+    static constexpr bool isButton(const unsigned int p_key) { return p_key >= GRID_KEYS; }
+    static constexpr unsigned int rowOf(const unsigned int p_key) { return isButton(p_key) ? Rows : p_key / Columns; }
+    static constexpr unsigned int columnOf(const unsigned int p_key) { return isButton(p_key) ? p_key - GRID_KEYS : p_key % Columns; }
+
+    // Rectangle of a key, in reference pixels.
+    static constexpr int xOf(const unsigned int p_key) { return MARGIN + static_cast<int>(columnOf(p_key)) * (isButton(p_key) ? BUTTON_WIDTH + 1 : PITCH_X); }
+    static constexpr int yOf(const unsigned int p_key) { return MARGIN + static_cast<int>(rowOf(p_key)) * PITCH_Y; }
+    static constexpr int widthOf(const unsigned int p_key) { return isButton(p_key) ? BUTTON_WIDTH : KeyWidth; }
+
+    // Center of a key, doubled to keep half pixels, and relative to the margin.
+    static constexpr int centreOf(const unsigned int p_key) { return 2 * (xOf(p_key) - MARGIN) + widthOf(p_key); }
+
+    // Key of the grid row, or button, nearest to a doubled center (the gap after a key is split between its neighbours).
+    static constexpr unsigned int nearestInGrid(const unsigned int p_row, const int p_centre) { return p_row * Columns + ((p_centre + 1) / (2 * PITCH_X) < static_cast<int>(Columns) ? (p_centre + 1) / (2 * PITCH_X) : Columns - 1); }
+    static constexpr unsigned int nearestButton(const int p_centre) { return GRID_KEYS + ((p_centre + 1) / (2 * (BUTTON_WIDTH + 1)) < static_cast<int>(Buttons) ? (p_centre + 1) / (2 * (BUTTON_WIDTH + 1)) : Buttons - 1); }
+
+    // First and last key of the row of a key.
+    static constexpr unsigned int firstOf(const unsigned int p_key) { return isButton(p_key) ? GRID_KEYS : rowOf(p_key) * Columns; }
+    static constexpr unsigned int lastOf(const unsigned int p_key) { return isButton(p_key) ? KEYS - 1 : rowOf(p_key) * Columns + Columns - 1; }
+
+    // Neighbours of a key, wrapping around at the edges (the buttons are the last row).
+    static constexpr unsigned int upOf(const unsigned int p_key) { return isButton(p_key) ? nearestInGrid(Rows - 1, centreOf(p_key)) : (rowOf(p_key) == 0 ? nearestButton(centreOf(p_key)) : p_key - Columns); }
+    static constexpr unsigned int downOf(const unsigned int p_key) { return isButton(p_key) ? nearestInGrid(0, centreOf(p_key)) : (rowOf(p_key) == Rows - 1 ? nearestButton(centreOf(p_key)) : p_key + Columns); }
+    static constexpr unsigned int leftOf(const unsigned int p_key) { return firstOf(p_key) == lastOf(p_key) ? LAYOUT_NO_KEY : (p_key == firstOf(p_key) ? lastOf(p_key) : p_key - 1); }
+    static constexpr unsigned int rightOf(const unsigned int p_key) { return firstOf(p_key) == lastOf(p_key) ? LAYOUT_NO_KEY : (p_key == lastOf(p_key) ? firstOf(p_key) : p_key + 1); }
+
+    // Directions whose neighbour is reached by wrapping around.
+    static constexpr unsigned int wrapsOf(const unsigned int p_key)
+    {
+        return ((rowOf(p_key) == 0) << CLayout::UP) | (isButton(p_key) << CLayout::DOWN) | ((p_key == firstOf(p_key)) << CLayout::LEFT) | ((p_key == lastOf(p_key)) << CLayout::RIGHT);
+    }
+
+    // Action of a key.
+    static constexpr CLayout::EKeyAction actionOf(const unsigned int p_key)
+    {
+        return isButton(p_key) ? (p_key == KEYS - 1 ? CLayout::EKeyAction::OK : CLayout::EKeyAction::CANCEL) : (p_key == Backspace ? CLayout::EKeyAction::BACKSPACE : CLayout::EKeyAction::TEXT);
+    }
+
+    // Records of a key and a row.
+    static constexpr CLayout::SKey makeKey(const unsigned int p_key)
+    {
+        return CLayout::SKey{ static_cast<Sint16>(xOf(p_key)), static_cast<Sint16>(yOf(p_key)), static_cast<Sint16>(widthOf(p_key)), static_cast<Sint16>(KeyHeight),
+                              static_cast<Sint16>(xOf(p_key) + ((widthOf(p_key) + 1) >> 1)), static_cast<Sint16>(yOf(p_key) + LAYOUT_LABEL_OFFSET),
+                              static_cast<Uint8>(rowOf(p_key)), static_cast<Uint8>(actionOf(p_key)),
+                              { static_cast<Uint8>(upOf(p_key)), static_cast<Uint8>(downOf(p_key)), static_cast<Uint8>(leftOf(p_key)), static_cast<Uint8>(rightOf(p_key)) },
+                              static_cast<Uint8>(wrapsOf(p_key)), 0 };
+    }
+
+    static constexpr CLayout::SRow makeRow(const unsigned int p_row)
+    {
+        return CLayout::SRow{ static_cast<Uint8>(p_row == Rows ? GRID_KEYS : p_row * Columns), static_cast<Uint8>(p_row == Rows ? KEYS - 1 : p_row * Columns + Columns - 1) };
+    }
+
+    // Expansion of the records into tables.
+    template<unsigned int... Is>
+    static constexpr GridLayout_Utils::TTable<CLayout::SKey, KEYS> makeKeys(GridLayout_Utils::TIndices<Is...>) { return GridLayout_Utils::TTable<CLayout::SKey, KEYS>{ { makeKey(Is)... } }; }
+
+    template<unsigned int... Is>
+    static constexpr GridLayout_Utils::TTable<CLayout::SRow, ROWS> makeRows(GridLayout_Utils::TIndices<Is...>) { return GridLayout_Utils::TTable<CLayout::SRow, ROWS>{ { makeRow(Is)... } }; }
+};
+
+#endif // _GRIDLAYOUT_H_
@@ -0,0 +1,394 @@
+/**
+ * @file  inputMapper.cpp
+ * @brief Implementation file for the CInputMapper class.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "inputMapper.h"
+#include "def.h"
+
+namespace
+{
+    /**
+     * @struct SActionName
+     * @brief  Associates the name used in profiles with a key code.
+     */
+    struct SActionName
+    {
+        const char* m_name;
+        SDL_Keycode m_key;
+    };
+
+    /**
+     * @brief Names accepted in the profiles file for each action (the suffix of the MYKEY_xx macros).
+     */
+    const SActionName s_actionNames[] =
+    {
+        { "UP", MYKEY_UP },
+        { "RIGHT", MYKEY_RIGHT },
+        { "DOWN", MYKEY_DOWN },
+        { "LEFT", MYKEY_LEFT },
+        { "SYSTEM", MYKEY_SYSTEM },
+        { "PAGEUP", MYKEY_PAGEUP },
+        { "PAGEDOWN", MYKEY_PAGEDOWN },
+        { "OPEN", MYKEY_OPEN },
+        { "PARENT", MYKEY_PARENT },
+        { "OPERATION", MYKEY_OPERATION },
+        { "START", MYKEY_START },
+        { "TRANSFER", MYKEY_TRANSFER },
+        { "CARETLEFT", MYKEY_CARETLEFT },
+        { "CARETRIGHT", MYKEY_CARETRIGHT },
+        { "SELECT", MYKEY_SELECT }
+    };
+
+    /**
+     * @brief       Gets the key code for an action name.
+     * @param p_name The action name.
+     * @return      The key code, or SDLK_UNKNOWN if the name is not valid.
+     */
+    SDL_Keycode keyFromName(const std::string& p_name)
+    {
+        for (const SActionName& l_action : s_actionNames)
+        {
+            if (p_name == l_action.m_name) return l_action.m_key;
+        }
+
+        return SDLK_UNKNOWN;
+    }
+
+    /**
+     * @brief       Indicates whether an action repeats while its input is held (as the keyboard does for D-pad, A, X, Y, L, R and SELECT).
+     * @param p_key The key code of the action.
+     * @return      TRUE if the action repeats; otherwise, FALSE.
+     */
+    const bool isHoldAction(const SDL_Keycode p_key)
+    {
+        switch (p_key)
+        {
+        case MYKEY_UP:
+        case MYKEY_RIGHT:
+        case MYKEY_DOWN:
+        case MYKEY_LEFT:
+        case MYKEY_OPEN:
+        case MYKEY_SYSTEM:
+        case MYKEY_OPERATION:
+        case MYKEY_CARETLEFT:
+        case MYKEY_CARETRIGHT:
+        case MYKEY_SELECT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief        Parses a button, axis or hat index, which must be a whole decimal number.
+     * @param p_text The text to parse.
+     * @return       The index, or -1 if not valid.
+     */
+    const int indexFromText(const std::string& p_text)
+    {
+        char* l_end = nullptr;
+        const long l_value = std::strtol(p_text.c_str(), &l_end, 10);
+        return (l_end != p_text.c_str() && *l_end == '\0' && l_value >= 0 && l_value <= 255) ? static_cast<int>(l_value) : -1;
+    }
+
+    /**
+     * @brief        Parses a hat value, either as a number or as a direction name.
+     * @param p_text The text to parse.
+     * @return       The hat value, or -1 if not valid.
+     */
+    const int hatFromName(const std::string& p_text)
+    {
+        if (p_text == "up") return SDL_HAT_UP;
+        if (p_text == "right") return SDL_HAT_RIGHT;
+        if (p_text == "down") return SDL_HAT_DOWN;
+        if (p_text == "left") return SDL_HAT_LEFT;
+
+        return indexFromText(p_text);
+    }
+
+    /**
+     * @brief        Indicates whether the game-controller database lists a GUID (SDL also generates mappings for
+     *               devices it does not list, which map buttons by position, whatever their labels).
+     * @param p_path The path of the database.
+     * @param p_guid The GUID.
+     * @return       TRUE if a mapping of the database starts with the GUID; otherwise, FALSE.
+     */
+    const bool isInDatabase(const std::string& p_path, const std::string& p_guid)
+    {
+        std::ifstream l_file(p_path);
+        std::string l_line;
+
+        while (std::getline(l_file, l_line))
+        {
+            if (l_line.compare(0, p_guid.size(), p_guid) == 0 && l_line.size() > p_guid.size() && l_line[p_guid.size()] == ',') return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief              Indicates whether the face buttons of a controller have the Nintendo labels (A on the
+     *                     right, B at the bottom, X on top and Y on the left), swapped from the positions of SDL.
+     * @param p_controller The controller.
+     * @return             TRUE if the labels are the Nintendo ones; otherwise, FALSE.
+     */
+    const bool hasNintendoLabels(SDL_GameController* p_controller)
+    {
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+        switch (SDL_GameControllerGetType(p_controller))
+        {
+        case SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_PRO:
+        case SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_LEFT:
+        case SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_RIGHT:
+        case SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_PAIR:
+            return true;
+        default:
+            return false;
+        }
+#elif SDL_VERSION_ATLEAST(2, 0, 12)
+        return SDL_GameControllerGetType(p_controller) == SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_PRO;
+#else
+        return false;
+#endif
+    }
+} // namespace
+
+CInputMapper& CInputMapper::instance(void)
+{
+    // 1. Create the static instance of the input mapper.
+    // 2. Return the singleton.
+
+    static CInputMapper l_singleton;
+    return l_singleton;
+}
+
+CInputMapper::CInputMapper(void)
+{
+    // Start with the built-in mapping, so events are mapped even if no joystick is initialized.
+
+    loadBuiltIn();
+}
+
+void CInputMapper::init(SDL_Joystick* p_joystick, const int p_deviceIndex)
+{
+    // 1. Get the GUID of the joystick as a string.
+    // 2. Load the (optional) game-controller database shipped with the resources.
+    // 3. Try, in order, the GUID profile, the game-controller database (only if it lists the GUID: the mappings
+    //    SDL generates for other devices, e.g. the TSP, would replace the built-in one) and the default profile.
+    // 4. If none applies, fall back to the built-in mapping.
+
+    char l_guid[33] = { 0 };
+    SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(p_joystick), l_guid, sizeof(l_guid));
+    SDL_Log("  GUID: %s", l_guid);
+
+    if (SDL_GameControllerAddMappingsFromFile(RES_DIR CONTROLLER_DATABASE_FILE) < 0)
+    {
+        INHIBIT(SDL_Log("No game-controller database loaded: %s", SDL_GetError());)
+        SDL_ClearError();
+    }
+
+    const std::string l_profilesPath(RES_DIR CONTROLLER_PROFILES_FILE);
+    const bool l_inDatabase = isInDatabase(RES_DIR CONTROLLER_DATABASE_FILE, l_guid);
+
+    if (loadProfile(l_profilesPath, l_guid))
+    {
+        SDL_Log("Using controller profile for GUID %s.", l_guid);
+    }
+    else if (l_inDatabase && loadGameController(p_deviceIndex))
+    {
+        SDL_Log("Using game-controller database mapping.");
+    }
+    else if (loadProfile(l_profilesPath, "default"))
+    {
+        SDL_Log("Using default controller profile.");
+    }
+    else
+    {
+        loadBuiltIn();
+        SDL_Log("Using built-in controller mapping.");
+    }
+}
+
+void CInputMapper::clear(void)
+{
+    // Unbind every button, axis and hat value.
+
+    for (SBinding& l_binding : m_buttons) l_binding = SBinding{ SDLK_UNKNOWN, false };
+    for (SDL_Keycode& l_key : m_axesPositive) l_key = SDLK_UNKNOWN;
+    for (SDL_Keycode& l_key : m_axesNegative) l_key = SDLK_UNKNOWN;
+    for (SBinding& l_binding : m_hats) l_binding = SBinding{ SDLK_UNKNOWN, false };
+}
+
+void CInputMapper::loadBuiltIn(void)
+{
+    // 1. Clear the tables.
+    // 2. Bind the buttons of the TSP (or the XBox controller on Windows), except for the platform-specific ones.
+    // 3. Bind the triggers and the D-pad hat.
+
+    clear();
+
+    bindButton(0, MYKEY_TRANSFER);   // B
+    bindButton(1, MYKEY_OPEN);       // A
+    bindButton(2, MYKEY_SYSTEM);     // Y
+    bindButton(3, MYKEY_OPERATION);  // X
+    bindButton(4, MYKEY_CARETLEFT);  // L
+    bindButton(5, MYKEY_CARETRIGHT); // R
+    bindButton(6, MYKEY_SELECT);     // SELECT (Trimui Smart Pro)
+    bindButton(7, MYKEY_START);      // Start
+
+#ifdef _WIN64
+
+    bindButton(10, MYKEY_PARENT);    // Menu in XBox Controller
+    m_axesPositive[4] = MYKEY_PAGEDOWN; // LT in XBox Controller
+
+#else
+
+    bindButton(8, MYKEY_PARENT);     // Menu in TSP
+    m_axesPositive[2] = MYKEY_PAGEDOWN; // L2 in TSP
+
+#endif // _WIN64
+
+    m_axesPositive[5] = MYKEY_PAGEUP; // R2
+
+    bindHat(SDL_HAT_UP, MYKEY_UP);
+    bindHat(SDL_HAT_RIGHT, MYKEY_RIGHT);
+    bindHat(SDL_HAT_DOWN, MYKEY_DOWN);
+    bindHat(SDL_HAT_LEFT, MYKEY_LEFT);
+}
+
+const bool CInputMapper::loadProfile(const std::string& p_path, const std::string& p_guid)
+{
+    // 1. Open the profiles file and early exit if not found (return FALSE).
+    // 2. Read it line by line, skipping comments, empty lines and entries for other devices.
+    //    Each entry has the form: <guid|default> <button|axis+|axis-|hat> <index> <ACTION>
+    // 3. Clear the tables on the first matching entry and bind the input to the action.
+    // 4. Log malformed entries and ignore them.
+    // 5. Return whether any entry was found for the device.
+
+    std::ifstream l_file(p_path);
+
+    if (!l_file.is_open()) return false;
+
+    bool l_found(false);
+    std::string l_line;
+    unsigned int l_lineNumber(0);
+
+    while (std::getline(l_file, l_line))
+    {
+        ++l_lineNumber;
+
+        std::istringstream l_stream(l_line);
+        std::string l_guid, l_kind, l_index, l_action;
+
+        if (!(l_stream >> l_guid) || l_guid[0] == '#' || l_guid != p_guid) continue;
+
+        const SDL_Keycode l_key = (l_stream >> l_kind >> l_index >> l_action) ? keyFromName(l_action) : SDLK_UNKNOWN;
+        const int l_value = (l_kind == "hat") ? hatFromName(l_index) : indexFromText(l_index);
+
+        if (l_key == SDLK_UNKNOWN || l_value < 0 || l_value > 255)
+        {
+            SDL_LogWarn(0, "%s:%u: invalid controller mapping ignored.", p_path.c_str(), l_lineNumber);
+            continue;
+        }
+
+        if (!l_found)
+        {
+            clear();
+            l_found = true;
+        }
+
+        if (l_kind == "button") bindButton(l_value, l_key);
+        else if (l_kind == "axis+") m_axesPositive[l_value] = l_key;
+        else if (l_kind == "axis-") m_axesNegative[l_value] = l_key;
+        else if (l_kind == "hat") bindHat(l_value, l_key);
+        else SDL_LogWarn(0, "%s:%u: unknown input kind '%s'.", p_path.c_str(), l_lineNumber, l_kind.c_str());
+    }
+
+    return l_found;
+}
+
+const bool CInputMapper::loadGameController(const int p_deviceIndex)
+{
+    // 1. Early exit if the joystick is not in the game-controller database (return FALSE).
+    // 2. Open the controller to query its bindings (by position: SDL must not swap them for the labels) and clear
+    //    the tables.
+    // 3. For each controller button, translate its binding (a joystick button or hat) to the corresponding action.
+    //    The face buttons are translated by their labels, like the built-in mapping (A types, B switches the key set).
+    // 4. Translate the trigger axes to the edge actions.
+    // 5. Close the controller (the joystick stays open) and return TRUE.
+
+    if (SDL_IsGameController(p_deviceIndex) == SDL_FALSE) return false;
+
+#ifdef SDL_HINT_GAMECONTROLLER_USE_BUTTON_LABELS
+    SDL_SetHint(SDL_HINT_GAMECONTROLLER_USE_BUTTON_LABELS, "0");
+#endif
+
+    SDL_GameController* l_controller = SDL_GameControllerOpen(p_deviceIndex);
+
+    if (l_controller == nullptr)
+    {
+        SDL_LogWarn(0, "Could not open game controller: %s", SDL_GetError());
+        return false;
+    }
+
+    SDL_Log("  Controller: %s", SDL_GameControllerName(l_controller));
+    clear();
+
+    // SDL names the face buttons by position (A at the bottom, B on the right, X on the left and Y on top)
+    const bool l_nintendo = hasNintendoLabels(l_controller);
+
+    const struct { SDL_GameControllerButton m_button; SDL_Keycode m_key; } l_buttons[] =
+    {
+        { SDL_CONTROLLER_BUTTON_A, l_nintendo ? MYKEY_TRANSFER : MYKEY_OPEN },
+        { SDL_CONTROLLER_BUTTON_B, l_nintendo ? MYKEY_OPEN : MYKEY_TRANSFER },
+        { SDL_CONTROLLER_BUTTON_X, l_nintendo ? MYKEY_SYSTEM : MYKEY_OPERATION },
+        { SDL_CONTROLLER_BUTTON_Y, l_nintendo ? MYKEY_OPERATION : MYKEY_SYSTEM },
+        { SDL_CONTROLLER_BUTTON_BACK, MYKEY_SELECT },
+        { SDL_CONTROLLER_BUTTON_GUIDE, MYKEY_PARENT },
+        { SDL_CONTROLLER_BUTTON_START, MYKEY_START },
+        { SDL_CONTROLLER_BUTTON_LEFTSHOULDER, MYKEY_CARETLEFT },
+        { SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, MYKEY_CARETRIGHT },
+        { SDL_CONTROLLER_BUTTON_DPAD_UP, MYKEY_UP },
+        { SDL_CONTROLLER_BUTTON_DPAD_DOWN, MYKEY_DOWN },
+        { SDL_CONTROLLER_BUTTON_DPAD_LEFT, MYKEY_LEFT },
+        { SDL_CONTROLLER_BUTTON_DPAD_RIGHT, MYKEY_RIGHT }
+    };
+
+    for (const auto& l_entry : l_buttons)
+    {
+        const SDL_GameControllerButtonBind l_bind = SDL_GameControllerGetBindForButton(l_controller, l_entry.m_button);
+
+        if (l_bind.bindType == SDL_CONTROLLER_BINDTYPE_BUTTON) bindButton(l_bind.value.button, l_entry.m_key);
+        else if (l_bind.bindType == SDL_CONTROLLER_BINDTYPE_HAT) bindHat(l_bind.value.hat.hat_mask, l_entry.m_key);
+    }
+
+    const SDL_GameControllerButtonBind l_leftTrigger = SDL_GameControllerGetBindForAxis(l_controller, SDL_CONTROLLER_AXIS_TRIGGERLEFT);
+    const SDL_GameControllerButtonBind l_rightTrigger = SDL_GameControllerGetBindForAxis(l_controller, SDL_CONTROLLER_AXIS_TRIGGERRIGHT);
+
+    if (l_leftTrigger.bindType == SDL_CONTROLLER_BINDTYPE_AXIS) m_axesPositive[l_leftTrigger.value.axis & 0xFF] = MYKEY_PAGEDOWN;
+    else if (l_leftTrigger.bindType == SDL_CONTROLLER_BINDTYPE_BUTTON) bindButton(l_leftTrigger.value.button, MYKEY_PAGEDOWN);
+
+    if (l_rightTrigger.bindType == SDL_CONTROLLER_BINDTYPE_AXIS) m_axesPositive[l_rightTrigger.value.axis & 0xFF] = MYKEY_PAGEUP;
+    else if (l_rightTrigger.bindType == SDL_CONTROLLER_BINDTYPE_BUTTON) bindButton(l_rightTrigger.value.button, MYKEY_PAGEUP);
+
+    SDL_GameControllerClose(l_controller);
+    return true;
+}
+
+void CInputMapper::bindButton(const int p_index, const SDL_Keycode p_key)
+{
+    // Store the key code and whether it repeats, so the dispatch does not need to compute it.
+
+    m_buttons[p_index & 0xFF] = SBinding{ p_key, isHoldAction(p_key) };
+}
+
+void CInputMapper::bindHat(const int p_hatValue, const SDL_Keycode p_key)
+{
+    // Store the key code and whether it repeats, so the dispatch does not need to compute it.
+
+    m_hats[p_hatValue & 0x0F] = SBinding{ p_key, isHoldAction(p_key) };
+}
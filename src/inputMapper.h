@@ -0,0 +1,179 @@
+/**
+ * @file  inputMapper.h
+ * @brief Header file for the CInputMapper class, which maps joystick input to keyboard actions.
+ */
+#ifndef _INPUTMAPPER_H_
+#define _INPUTMAPPER_H_
+
+#include <string>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the file holding the per-device controller profiles.
+ *
+ * @param X The filename, relative to the resources folder.
+ */
+#define CONTROLLER_PROFILES_FILE "controllers.cfg"
+
+/**
+ * @brief Macro that indicates the (optional) SDL game-controller database to load at startup.
+ *
+ * @param X The filename, relative to the resources folder.
+ */
+#define CONTROLLER_DATABASE_FILE "gamecontrollerdb.txt"
+
+/**
+ * @brief Macro that indicates the value an axis must exceed to be considered as pressed.
+ *
+ * @param X The threshold, in SDL axis units.
+ */
+#define AXIS_PRESS_THRESHOLD 30000
+
+/**
+ * @class Singleton used to map joystick buttons, axes and hats to keyboard actions (MYKEY_xx).
+ * @brief Compiles a controller profile into flat lookup tables, so dispatching an input is a single array index.
+ */
+class CInputMapper
+{
+    public:
+
+    /**
+     * @struct SBinding
+     * @brief  Action bound to a joystick input.
+     */
+    struct SBinding
+    {
+        /**
+         * @brief The key code sent to the window (SDLK_UNKNOWN if unbound).
+         */
+        SDL_Keycode m_key;
+
+        /**
+         * @brief Indicates whether the action repeats while the input is held.
+         */
+        bool m_hold;
+    };
+
+    /**
+     * @brief  Gets the singleton instance of the input mapper.
+     * @return Reference to the unique input-mapper instance.
+     */
+    static CInputMapper& instance(void);
+
+    /**
+     * @brief               Builds the lookup tables for the given joystick.
+     * @param p_joystick    The opened joystick.
+     * @param p_deviceIndex The device index used to open the joystick.
+     *
+     * The first source found is used: a profile matching the joystick GUID in CONTROLLER_PROFILES_FILE,
+     * the SDL game-controller database (if CONTROLLER_DATABASE_FILE lists the GUID), the "default" profile in
+     * CONTROLLER_PROFILES_FILE and, finally, the built-in mapping.
+     */
+    void init(SDL_Joystick* p_joystick, const int p_deviceIndex);
+
+    /**
+     * @brief          Gets the action bound to a joystick button.
+     * @param p_button The joystick button index.
+     * @return         The binding (m_key is SDLK_UNKNOWN if the button is not bound).
+     */
+    inline const SBinding& getButton(const Uint8 p_button) const { return m_buttons[p_button]; }
+
+    /**
+     * @brief         Gets the action bound to a joystick axis moved past the press threshold.
+     * @param p_axis  The joystick axis index.
+     * @param p_value The axis value.
+     * @return        The bound key code, or SDLK_UNKNOWN if the axis is not pressed or not bound.
+     */
+    inline SDL_Keycode getAxis(const Uint8 p_axis, const Sint16 p_value) const
+    {
+        return p_value > AXIS_PRESS_THRESHOLD ? m_axesPositive[p_axis] : (p_value < -AXIS_PRESS_THRESHOLD ? m_axesNegative[p_axis] : SDLK_UNKNOWN);
+    }
+
+    /**
+     * @brief         Gets the action bound to a joystick hat value.
+     * @param p_value The hat value (SDL_HAT_xx mask).
+     * @return        The binding (m_key is SDLK_UNKNOWN if the value is not bound).
+     */
+    inline const SBinding& getHat(const Uint8 p_value) const { return m_hats[p_value & 0x0F]; }
+
+    private:
+
+    /**
+     * @brief Constructor for the input mapper.
+     */
+    CInputMapper(void);
+
+    /**
+     * @brief          Copy constructor for the input mapper (forbidden).
+     * @param p_source The source input mapper to copy.
+     */
+    CInputMapper(const CInputMapper& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the input mapper (forbidden).
+     * @param p_source The source input mapper to move resources from.
+     */
+    CInputMapper(const CInputMapper&& p_source) = delete;
+
+    /**
+     * @brief Clears all the lookup tables.
+     */
+    void clear(void);
+
+    /**
+     * @brief Fills the lookup tables with the built-in mapping (TSP, or XBox controller on Windows).
+     */
+    void loadBuiltIn(void);
+
+    /**
+     * @brief          Fills the lookup tables with the profile entries for a given GUID.
+     * @param p_path   The path to the profiles file.
+     * @param p_guid   The GUID (or "default") of the profile to load.
+     * @return         TRUE if at least one entry was found; otherwise, FALSE.
+     */
+    const bool loadProfile(const std::string& p_path, const std::string& p_guid);
+
+    /**
+     * @brief               Fills the lookup tables with the bindings of the SDL game-controller database (the face
+     *                      buttons by their labels).
+     * @param p_deviceIndex The device index of the joystick.
+     * @return              TRUE if the joystick is a known game controller; otherwise, FALSE.
+     */
+    const bool loadGameController(const int p_deviceIndex);
+
+    /**
+     * @brief        Binds a joystick button to a key code.
+     * @param p_index The button index.
+     * @param p_key   The key code.
+     */
+    void bindButton(const int p_index, const SDL_Keycode p_key);
+
+    /**
+     * @brief            Binds a joystick hat value to a key code.
+     * @param p_hatValue The hat value (SDL_HAT_xx mask).
+     * @param p_key      The key code.
+     */
+    void bindHat(const int p_hatValue, const SDL_Keycode p_key);
+
+    /**
+     * @brief Lookup table of button bindings, indexed by button.
+     */
+    SBinding m_buttons[256];
+
+    /**
+     * @brief Lookup table of key codes for axes moved in the positive direction, indexed by axis.
+     */
+    SDL_Keycode m_axesPositive[256];
+
+    /**
+     * @brief Lookup table of key codes for axes moved in the negative direction, indexed by axis.
+     */
+    SDL_Keycode m_axesNegative[256];
+
+    /**
+     * @brief Lookup table of hat bindings, indexed by hat value.
+     */
+    SBinding m_hats[16];
+};
+
+#endif // _INPUTMAPPER_H_
@@ -7,21 +7,16 @@
 #include "keyboard.h"
 #include "screen.h"
 #include "sdlUtils.h"
+#include "utf8.h"
 #include "resourceManager.h"
+#include "resourcePack.h"
 #include "def.h"
 
- /*
-  * @brief Constant expressions used to properly render the virtual keeyboard on screen.
-  */
-constexpr auto KEYROWS = 4;
-constexpr auto KEYCOLUMNS = 13;
-constexpr auto TOTALKEYS = KEYROWS * KEYCOLUMNS;
-
 /*
  * @brief Macros used to properly render the virtual keeyboard on screen.
  */
-#define KB_WIDTH	   static_cast<Sint16>(265 * Globals::g_Screen.getAdjustedPpuX())
-#define KB_HEIGHT	   static_cast<Sint16>(104 * Globals::g_Screen.getAdjustedPpuY())
+#define KB_WIDTH	   static_cast<Sint16>(CLayout::instance().getWidth() * Globals::g_Screen.getAdjustedPpuX())
+#define KB_HEIGHT	   static_cast<Sint16>(CLayout::instance().getHeight() * Globals::g_Screen.getAdjustedPpuY())
 #define KB_X           static_cast<Sint16>((Globals::g_Screen.m_logicalWidth - KB_WIDTH) >> 1)
 #define KB_Y           static_cast<Sint16>((Globals::g_Screen.m_logicalHeight - KB_HEIGHT - (10 + FOOTER_HEIGHT) * Globals::g_Screen.getAdjustedPpuY()))
 #define FIELD_WIDTH    static_cast<Sint16>(KB_WIDTH - 8 * Globals::g_Screen.getAdjustedPpuX())
@@ -29,29 +24,16 @@ constexpr auto TOTALKEYS = KEYROWS * KEYCOLUMNS;
 
 namespace
 {
-    /*
-     * @brief Indicates the last key that was selected on the first row of keys. Used for vertical looping.
-     */
-	int m_lastKeySelectedFirstRow = 0;
-
-    /*
-     * @brief Indicates the last key that was selected on the last row of keys. Used for vertical looping.
-     */
-    int m_lastKeySelectedLastRow = TOTALKEYS - KEYCOLUMNS;
-
 #if CARETTICKS == true
 
     /*
-     * @brief Timer used to make the caret blink. It is overriden when the caret must be shown.
+     * @brief Timer used to make the caret blink (run by the window's timer wheel). It is overriden when the caret must be shown.
      */
 	SDL_TimerID m_timerId = 0;
 
 #endif
 }
 
-// Prototype for the confidential timer
-Uint32 hideCharacters(Uint32 interval, void* param);
-
 #if CARETTICKS == true
 
 static Uint32 changeCaretVisibility(Uint32 interval, void* param)
@@ -70,167 +52,84 @@ static Uint32 changeCaretVisibility(Uint32 interval, void* param)
 
     l_thisKeyboard->m_showCaret = l_thisKeyboard->m_mustShowCaret ? true : !(l_thisKeyboard->m_showCaret);
 
-    /*
-     * Thise code does not run in the main thread so it fails on the TSP (that is why we need a show caret variable)
-     * 
-    CWindow* l_thisWindow = static_cast<CWindow*>(param);
-
-    if (l_thisWindow == nullptr)
-    {
-        return CARETTICK;
-    }
-
-    l_thisWindow->render(true);
-    SDL_UpdateWindowSurface(Globals::g_sdlwindow);
-    SDL_Log("Timer Ok: %d", l_thisKeyboard->m_showCaret);
-    */
+    // Note: this runs on the main thread (from the window's timer wheel), so the main loop renders the change.
 
     return CARETTICKTIME;
 }
 
 #endif
 
-CKeyboard::CKeyboard(const std::string &p_inputText):
+CKeyboard::CKeyboard(const std::string &p_inputText, const bool p_multiline, const UTF8_Utils::SCodepointIndex* p_index):
     CWindow(),
-    m_imageKeyboard(nullptr),
+    m_bakedLayouts(),
+    m_layoutCacheBudget(0),
+    m_emojiAtlas(CResourceManager::instance().getFontChain(), CResourceManager::instance().getEmojiFontIndex(), CResourceManager::instance().getFontChain().getLineHeight()),
     m_textField(nullptr),
     m_inputText(p_inputText),
     m_selected(0),
     m_footer(nullptr),
+    m_layout(CLayout::instance()),
+    m_rememberedColumn(-1),
     m_keySet(0),
 	m_showCaret(true),
     m_mustShowCaret(false),
     m_caretPosition(p_inputText.length()),
+    m_multiline(p_multiline),
+    m_firstVisibleLine(0),
+    m_selectHeld(false),
+    m_searchMode(ESearchMode::NONE),
+    m_searchAnchor(0),
+    m_searchEdited(false),
+    m_selectionAnchor(std::string::npos),
+    m_fieldY(0),
     m_confidentialMode(false),
-    m_confidentialTimer(0),
-    m_displayText(p_inputText),
+    m_revealText(false),
+    m_maskLength(0),
+    m_maskCaret(0),
+    m_initialIndex(p_index != nullptr ? *p_index : UTF8_Utils::SCodepointIndex()),
+    m_unmaskedIndex(0),
+    m_unmaskTimer(0),
+    m_unmaskedGlyph(nullptr),
+    m_maskGlyph(nullptr),
+    m_maskAdvance(0),
     m_message(""),
     m_navClickSound(nullptr),
     m_selectClickSound(nullptr),
     m_exitSound(nullptr),
     m_exitDelayTimer(0),
-    m_font(CResourceManager::instance().getFont())
+    m_exitValue(0),
+    m_fonts(CResourceManager::instance().getFontChain())
 {
     // Steps:
-    // 1. Define key sets for the keyboard (lowercase and uppercase with special characters).
-    // 2. Retrieve screen-scaling factors (adjusted PPU values) and keyboard dimensions.
-    // 3. Create the keyboard background image:
-    //    a. Attempt to load a predefined background image.
-    //    b. If unavailable, create an alternative background with a solid color.
+    // 1. Scale the geometry of the layout (the key sets, their texts and the navigation come from the layout).
+    // 2. Retrieve screen-scaling factors (adjusted PPU values).
+    // 3. Draw the background image (a solid color, if it is unavailable).
     // 4. Create the caret image for text input.
-    // 5. Create the keyboard surface and fill it with a border and background color.
-    // 6. Render individual keys on the keyboard by looping through rows and columns to position and style each key.
-    // 7. Create the "Cancel" button background and style it.
-    // 8. Create the "OK" button background and style it.
-    // 9. Create the text-field image for displaying input text.
-    // 10. Create the footer image and add instructional text.
-    // 11. If caret blinking is enabled, initialize a timer for caret visibility toggling.
-
-    // Key sets
-    m_keySets[0] = "1234567890-=«qwertyuiop[]`asdfghjkl;'\\©zxcvbnm,./£ñ ";
-    m_keySets[1] = "!@#$%^&*()_+«QWERTYUIOP{}~ASDFGHJKL:\"|®ZXCVBNM<>?¿Ñ ";
+    // 5. Create the text-field image for displaying input text (taller in multiline mode, growing upwards).
+    //    The keyboard itself is baked on first render, for each layout and key set (see getBakedKeyboard), within a
+    //    budget that follows its size.
+    // 6. Create the footer image and add instructional text.
+    // 7. Cache the glyph used to mask characters in confidential mode and count the characters of the initial text
+    //    (from its code point index, if it was given).
+    //    Index the lines of the initial text and scroll to the caret.
+    // 8. If caret blinking is enabled, initialize a timer for caret visibility toggling.
 
     const float l_adjustedPpuX = Globals::g_Screen.getAdjustedPpuX();
     const float l_adjustedPpuY = Globals::g_Screen.getAdjustedPpuY();
-    const int l_keyboardWidth = KB_WIDTH;
-    const int l_keyboardHeight = KB_HEIGHT;
-
-    // Create keyboard image
-    {
-        SDL_Rect l_rect{};
-        l_rect.w = Globals::g_Screen.m_logicalWidth;
-        l_rect.h = Globals::g_Screen.m_logicalHeight;
-        l_rect.x = 0;
-        l_rect.y = 0;
-        SDL_Surface* l_imageBakground = CResourceManager::instance().getSurface(CResourceManager::T_SURFACE_BACKGROUND);
-
-        if (l_imageBakground != nullptr)
-        {
-            SDL_BlitScaled(l_imageBakground, nullptr, Globals::g_screen, &l_rect);
-        }
-        else
-        {
-            SDL_Surface* l_imageAlternativeBackground = SDL_Utils::createImage(l_rect.w, l_rect.h, SDL_MapRGB(Globals::g_screen->format, COLOR_BG_3));
-            SDL_Utils::applySurface(0, 0, l_imageAlternativeBackground, Globals::g_screen);
-            SDL_FreeSurface(l_imageAlternativeBackground);
-            l_imageAlternativeBackground = nullptr;
-        }
+    CLayout::instance().scale(l_adjustedPpuX, l_adjustedPpuY);
 
-        m_caret = SDL_Utils::createImage(static_cast<Sint16>(1 * l_adjustedPpuX), static_cast<int>((3 + FONT_SIZE) * l_adjustedPpuY), SDL_MapRGB(Globals::g_screen->format, COLOR_BG_3));
+    drawBackground();
 
-        m_imageKeyboard = SDL_Utils::createImage(l_keyboardWidth, l_keyboardHeight, SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
-        l_rect.w = l_keyboardWidth - static_cast<int>(4 * l_adjustedPpuX);
-        l_rect.h = static_cast<int>(100 * l_adjustedPpuY);
-        l_rect.x = static_cast<int>(2 * l_adjustedPpuX);
-        l_rect.y = static_cast<int>(2 * l_adjustedPpuY);
-
-        SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BG_2));
-        
-        // Create Keys
-        for (unsigned int l_y = 0; l_y < KEYROWS; ++l_y)
-        {
-            for (unsigned int l_x = 0; l_x < KEYCOLUMNS; ++l_x)
-            {
-                l_rect.x = (3 + 20 * l_x) * static_cast<int>(l_adjustedPpuX);
-                l_rect.y = (3 + 20 * l_y) * static_cast<int>(l_adjustedPpuY);
-                l_rect.w = static_cast<int>(19 * l_adjustedPpuX);
-                l_rect.h = static_cast<int>(18 * l_adjustedPpuY);
-                SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BORDER));
-
-                l_rect.x += static_cast<int>(1 * l_adjustedPpuX);
-                l_rect.y += static_cast<int>(1 * l_adjustedPpuY);
-                l_rect.w -= static_cast<int>(2 * l_adjustedPpuX);
-                l_rect.h -= static_cast<int>(2 * l_adjustedPpuY);
-                SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BG_1));
-            }
-        }
+    m_caret = SDL_Utils::createImage(static_cast<Sint16>(1 * l_adjustedPpuX), static_cast<int>((3 + FONT_SIZE) * l_adjustedPpuY), SDL_MapRGB(Globals::g_screen->format, COLOR_BG_3));
 
-        // Create button "Cancel" (background only)
-        l_rect.x = static_cast<int>(3 * l_adjustedPpuX);
-        l_rect.y = static_cast<int>(83 * l_adjustedPpuY);
-        l_rect.w = static_cast<int>(0.5f * l_keyboardWidth - 3.5f * l_adjustedPpuX);
-        l_rect.h = static_cast<int>(18 * l_adjustedPpuY);
-        SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BORDER));
-
-        l_rect.x += static_cast<int>(1 * l_adjustedPpuX);
-        l_rect.y += static_cast<int>(1 * l_adjustedPpuY);
-        l_rect.w -= static_cast<int>(2 * l_adjustedPpuX);
-        l_rect.h -= static_cast<int>(2 * l_adjustedPpuY);
-        SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BG_1));
-
-        // Create button "OK" (background only)
-        l_rect.w = static_cast<int>(0.5f * l_keyboardWidth - 3.5f * l_adjustedPpuX);
-        l_rect.h = static_cast<int>(18 * l_adjustedPpuY);
-        l_rect.x = static_cast<int>(l_rect.w + 4 * l_adjustedPpuX);
-        l_rect.y = static_cast<int>(83 * l_adjustedPpuY);
-        SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BORDER));
-
-        l_rect.x += static_cast<int>(1 * l_adjustedPpuX);
-        l_rect.y += static_cast<int>(1 * l_adjustedPpuY);
-        l_rect.w -= static_cast<int>(2 * l_adjustedPpuX);
-        l_rect.h -= static_cast<int>(2 * l_adjustedPpuY);
-        SDL_FillRect(m_imageKeyboard, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BG_1));
-
-        // Create the text field image
-        m_textField = SDL_Utils::createImage(l_keyboardWidth, static_cast<int>(static_cast<int>(19 * Globals::g_Screen.getAdjustedPpuY())), SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
-        l_rect.x = static_cast<int>(2 * l_adjustedPpuX);
-        l_rect.y = static_cast<int>(2 * l_adjustedPpuY);
-        l_rect.w = static_cast<int>(l_keyboardWidth - 4 * l_adjustedPpuX);
-        l_rect.h = static_cast<int>(15 * l_adjustedPpuY);
-        SDL_FillRect(m_textField, &l_rect, SDL_MapRGB(m_imageKeyboard->format, COLOR_BG_1));
-    }
+    createTextField();
+    fitLayoutCache();
 
     // Create the footer with instructions
     m_footer = SDL_Utils::createImage(Globals::g_Screen.m_logicalWidth, static_cast<int>(FOOTER_HEIGHT * l_adjustedPpuY), SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
     
-    // Footer text depends on confidential mode
-    std::string footerText = "A-Press  B-Keyset  Menu-Cancel  L/R-Caret  L2/R2-Edges  Y-Backspace  X-Space  Start-OK";
-    if (m_confidentialMode) {
-        footerText += "  SEL.-Show";
-    }
-    
-    SDL_Utils::applyText(Globals::g_Screen.m_logicalWidth >> 1, 6, m_footer, m_font, footerText.c_str(), 
-                         Globals::g_colorTextTitle, {COLOR_TITLE_BG}, SDL_Utils::ETextAlign::CENTER);
+    // Footer text depends on confidential and multiline modes
+    drawCenteredText(getFooterText(), Globals::g_Screen.m_logicalWidth >> 1, 6, 1.0f, Globals::g_colorTextTitle, {COLOR_TITLE_BG}, m_footer);
     
     // Initialize SDL_mixer if not already initialized
     if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
@@ -243,7 +142,7 @@ CKeyboard::CKeyboard(const std::string &p_inputText):
         std::string keyClickPath = std::string(RES_DIR) + "key_click.wav";
         std::string exitSoundPath = std::string(RES_DIR) + "exit.wav";
         
-        SDL_RWops* navRw = SDL_RWFromFile(navClickPath.c_str(), "rb");
+        SDL_RWops* navRw = CResourcePack::instance().open(navClickPath);
         if (navRw != nullptr) {
             m_navClickSound = Mix_LoadWAV_RW(navRw, 1); // 1 means free the SDL_RWops when done
             if (m_navClickSound == nullptr) {
@@ -254,7 +153,7 @@ CKeyboard::CKeyboard(const std::string &p_inputText):
             m_navClickSound = nullptr;
         }
         
-        SDL_RWops* keyRw = SDL_RWFromFile(keyClickPath.c_str(), "rb");
+        SDL_RWops* keyRw = CResourcePack::instance().open(keyClickPath);
         if (keyRw != nullptr) {
             m_selectClickSound = Mix_LoadWAV_RW(keyRw, 1); // 1 means free the SDL_RWops when done
             if (m_selectClickSound == nullptr) {
@@ -265,7 +164,7 @@ CKeyboard::CKeyboard(const std::string &p_inputText):
             m_selectClickSound = nullptr;
         }
         
-        SDL_RWops* exitRw = SDL_RWFromFile(exitSoundPath.c_str(), "rb");
+        SDL_RWops* exitRw = CResourcePack::instance().open(exitSoundPath);
         if (exitRw != nullptr) {
             m_exitSound = Mix_LoadWAV_RW(exitRw, 1); // 1 means free the SDL_RWops when done
             if (m_exitSound == nullptr) {
@@ -277,10 +176,19 @@ CKeyboard::CKeyboard(const std::string &p_inputText):
         }
     }
 
+    // Cache the mask glyph, so confidential mode never rasterizes text per frame
+    m_maskGlyph = m_fonts.render("*", Globals::g_colorTextNormal, { COLOR_BG_1 });
+    m_maskAdvance = m_fonts.measure("*");
+
+    maskInitialText();
+
+    m_lineIndex.rebuild(p_inputText);
+    scrollToCaret();
+
     #if CARETTICKS == true
 
     // If the caret is set for ticking, add a timer.
-    m_timerId = SDL_AddTimer(CARETTICKTIME, changeCaretVisibility, this);
+    m_timerId = m_timers.addTimer(CARETTICKTIME, changeCaretVisibility, this);
 
     #endif
 }
@@ -290,14 +198,12 @@ CKeyboard::~CKeyboard(void)
     // 1. Remove the timer.
     // 2. Free all SDL resources.
 
-	SDL_RemoveTimer(m_timerId);
-    SDL_RemoveTimer(m_confidentialTimer);
+#if CARETTICKS == true
+	m_timers.removeTimer(m_timerId);
+#endif
+    m_timers.removeTimer(m_exitDelayTimer);
 
-    if (m_imageKeyboard != nullptr)
-    {
-        SDL_FreeSurface(m_imageKeyboard);
-        m_imageKeyboard = nullptr;
-    }
+    m_bakedLayouts.clear();
 
     if (m_textField != nullptr)
     {
@@ -311,6 +217,14 @@ CKeyboard::~CKeyboard(void)
         m_caret = nullptr;
     }
 
+    if (m_maskGlyph != nullptr)
+    {
+        SDL_FreeSurface(m_maskGlyph);
+        m_maskGlyph = nullptr;
+    }
+
+    maskCharacter();
+
     // Free sound resources
     if (m_navClickSound != nullptr)
     {
@@ -347,34 +261,30 @@ CKeyboard::~CKeyboard(void)
 
 void CKeyboard::render(const bool p_focus) const
 {
-    // 1. Draw the input text field on the screen.
-    // 2. Render the input text, ensuring it fits within the text field.
+    // 1. If a message is set, draw it above the keyboard.
+    // 2. Draw the input text field on the screen.
+    // 3. Render the input text, ensuring it fits within the text field.
     //    a. If the text is too long, clip it to fit the visible area.
     //    b. Calculate the caret position based on the visible text.
-    // 3. If the caret is visible, draw it at the calculated position.
-    // 4. Draw the keyboard background image.
-    // 5. Highlight the currently selected key or button.
-    //    a. Determine the row and column of the selected key.
-    //    b. If either of the buttons 'Cancel' or 'OK' is selected, highlight it instead.
-    // 6. Render the text for each key on the keyboard.
-    //    a. Handle UTF-8 characters that may require multiple bytes.
-    //    b. Highlight the text of the selected key.
-    // 7. Render the text for the 'Cancel' and 'OK' buttons.
-    // 8. Draw the footer with the instructions to use the keyboard.
-    // 9. If a message is set, draw it above the keyboard.
+    //    c. In multiline mode, render only the visible lines.
+    //    d. Highlight the current match of the search, and draw the search bar above the text field.
+    // 4. If the caret is visible, draw it at the calculated position.
+    // 5. Draw the keyboard of the current layout and key set, with the labels of its keys (baked on first use).
+    // 6. Highlight the currently selected key or button, with its label (baked on first use).
+    // 7. Draw the footer with the instructions to use the keyboard.
 
     INHIBIT(SDL_Log("CKeyboard::render  fullscreen: %s  focus: %s", isFullScreen(), p_focus);)
 
-    const static int l_keyboardX = KB_X;
-    const static int l_keyboardY = KB_Y;
-    const static int l_keyboardWidth = KB_WIDTH;
-    const static int l_keyboardHeight = KB_HEIGHT;
-    const static int l_fieldY = FIELD_Y;
-    const static int l_fieldWidth = FIELD_WIDTH;
+    // The size of the keyboard follows the selected layout
+    const int l_keyboardX = KB_X;
+    const int l_keyboardY = KB_Y;
+    const int l_keyboardWidth = KB_WIDTH;
+    const int l_fieldY = m_fieldY;
+    const int l_fieldWidth = FIELD_WIDTH;
     const static float l_adjustedPpuX = Globals::g_Screen.getAdjustedPpuX();
     const static float l_adjustedPpuY = Globals::g_Screen.getAdjustedPpuY();
     
-    // If a message is set, render it above the keyboard
+    // 1. If a message is set, render it above the keyboard
     if (!m_message.empty()) {
         // Create a message bar like the footer but bigger
         int messageHeight = static_cast<int>(FOOTER_HEIGHT * 2 * l_adjustedPpuY + 20); // Twice as tall
@@ -387,46 +297,13 @@ void CKeyboard::render(const bool p_focus) const
             SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER)
         );
         
-        // Use the ResourceManager's font (m_font) directly but create a larger version (2.5x larger)
-        TTF_Font* largeFont = TTF_OpenFont(RES_DIR "DejaVuSans.ttf", static_cast<int>(FONT_SIZE * 2.5 * Globals::g_Screen.getAdjustedPpuY()));
-        
-        // Get text size to calculate better vertical centering
-        int textWidth = 0, textHeight = 0;
-        
-        if (largeFont != nullptr) {
-            // Get text dimensions to help with proper centering
-            TTF_SizeText(largeFont, m_message.c_str(), &textWidth, &textHeight);
-            
-            // Apply the text to the message bar with centered alignment
-            // Adjust y position to ensure true vertical centering based on actual text height
-            SDL_Utils::applyText(
-                Globals::g_Screen.m_logicalWidth >> 1,
-                ((messageHeight - textHeight) >> 1) - 5, // True vertical center based on text height
-                messageBar, 
-                largeFont, 
-                m_message.c_str(), 
-                Globals::g_colorTextTitle, 
-                SDL_Color{COLOR_TITLE_BG}, 
-                SDL_Utils::ETextAlign::CENTER
-            );
-            TTF_CloseFont(largeFont);
-        } else {
-            // Fallback to regular font from resourceManager if large font can't be loaded
-            // Get text dimensions for proper centering
-            TTF_SizeText(m_font, m_message.c_str(), &textWidth, &textHeight);
-            
-            // Apply text with better vertical centering
-            SDL_Utils::applyText(
-                Globals::g_Screen.m_logicalWidth >> 1,
-                (messageHeight - textHeight) >> 1, // True vertical center based on text height
-                messageBar, 
-                m_font, 
-                m_message.c_str(), 
-                Globals::g_colorTextTitle, 
-                SDL_Color{COLOR_TITLE_BG}, 
-                SDL_Utils::ETextAlign::CENTER
-            );
-        }
+        // Draw the message 2.5x larger than the keyboard font, from the distance field (so no other font is opened),
+        // centered vertically. If the field lacks a character, it is drawn at the size of the keyboard font instead.
+        const CSdfFont& l_sdfFont = CResourceManager::instance().getSdfFont();
+        const bool l_large = l_sdfFont.isLoaded() && l_sdfFont.covers(m_message);
+        const int textHeight = l_large ? l_sdfFont.getHeight(FONT_SIZE * 2.5f * l_adjustedPpuY) : m_fonts.getLineHeight();
+
+        drawCenteredText(m_message, Globals::g_Screen.m_logicalWidth >> 1, (messageHeight - textHeight) >> 1, l_large ? 2.5f : 1.0f, Globals::g_colorTextTitle, SDL_Color{COLOR_TITLE_BG}, messageBar);
         
         // Draw the message bar to the screen
         SDL_Utils::applySurface(0, messageY, messageBar, Globals::g_screen);
@@ -435,63 +312,42 @@ void CKeyboard::render(const bool p_focus) const
         SDL_FreeSurface(messageBar);
     }
 
-    // 1. Draw input text field
+    // 2. Draw input text field
     SDL_Utils::applySurface(l_keyboardX, l_fieldY, m_textField, Globals::g_screen);
 
     const float l_textAreaLenght = l_fieldWidth - 3 * l_adjustedPpuX;
     int l_caretPositionTmp = m_caretPosition;
+    int l_caretLineY(0);
     SDL_Rect l_rect{};
     l_rect.y = 0;
     l_rect.w = l_fieldWidth;
 
-    // 2. Draw main parts of the keyboard
+    // 3. Draw main parts of the keyboard
     {
-        // 2a. Render input text
-        if (m_confidentialMode) {
-            if (!m_displayText.empty()) {
-                SDL_Surface* l_surfaceTmp = SDL_Utils::renderText(m_font, m_displayText, Globals::g_colorTextNormal, { COLOR_BG_1 });
-
-                const std::string l_subString = m_displayText.substr(0, l_caretPositionTmp);
-
-                if (TTF_SizeUTF8(m_font, l_subString.c_str(), &l_caretPositionTmp, nullptr) != 0)
-                {
-                    SDL_LogWarn(0, "Could not measure UTF8 string: %s", TTF_GetError());
-                }
-
-                l_rect.w = l_fieldWidth;
-                l_rect.h = l_surfaceTmp->h;
-
-                if (l_caretPositionTmp > l_textAreaLenght)
-                {
-                    // 2b. Clip text if too long
-                    const int l_areaDiffOffset = static_cast<int>(l_textAreaLenght - l_caretPositionTmp);
-                    l_caretPositionTmp = std::min(static_cast<int>(l_textAreaLenght), l_caretPositionTmp);
-                    l_rect.x = -l_areaDiffOffset;
-                    SDL_Utils::applySurface(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), l_surfaceTmp, Globals::g_screen, &l_rect);
-                }
-                else
-                {
-                    l_rect.x = 0;
-                    l_caretPositionTmp = std::min(l_surfaceTmp->w, l_caretPositionTmp);
-                    SDL_Utils::applySurface(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), l_surfaceTmp, Globals::g_screen, &l_rect);
-                }
-            }
+        // 3a. Render input text (masked in confidential mode, unless SELECT is held)
+        if (m_confidentialMode && !m_revealText) {
+            l_caretPositionTmp = renderMaskedText(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), static_cast<int>(l_textAreaLenght));
+        } else if (m_multiline) {
+            // 3c. Render the visible lines only
+            l_caretPositionTmp = renderLines(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), static_cast<int>(l_textAreaLenght), l_caretLineY);
         } else if (!m_inputText.empty()) {
-            SDL_Surface* l_surfaceTmp = SDL_Utils::renderText(m_font, m_inputText, Globals::g_colorTextNormal, { COLOR_BG_1 });
+            const std::string& l_text = m_inputText.str();
+            SDL_Surface* l_surfaceTmp = m_fonts.render(l_text, Globals::g_colorTextNormal, { COLOR_BG_1 });
 
-            const std::string l_subString = m_inputText.substr(0, l_caretPositionTmp);
-
-            if (TTF_SizeUTF8(m_font, l_subString.c_str(), &l_caretPositionTmp, nullptr) != 0)
-            {
-                SDL_LogWarn(0, "Could not measure UTF8 string: %s", TTF_GetError());
-            }
+            l_caretPositionTmp = m_fonts.measure(l_text.substr(0, l_caretPositionTmp));
 
             l_rect.w = l_fieldWidth;
-            l_rect.h = l_surfaceTmp->h;
+            l_rect.h = (l_surfaceTmp != nullptr) ? l_surfaceTmp->h : 0;
 
-            if (l_caretPositionTmp > l_textAreaLenght)
+            if (l_surfaceTmp == nullptr)
+            {
+                // The text could not be rendered: leave the field empty, with the caret where the text would put it
+                l_rect.x = 0;
+                l_caretPositionTmp = std::min(static_cast<int>(l_textAreaLenght), l_caretPositionTmp);
+            }
+            else if (l_caretPositionTmp > l_textAreaLenght)
             {
-                // 2b. Clip text if too long
+                // 3b. Clip text if too long
                 const int l_areaDiffOffset = static_cast<int>(l_textAreaLenght - l_caretPositionTmp);
                 l_caretPositionTmp = std::min(static_cast<int>(l_textAreaLenght), l_caretPositionTmp);
                 l_rect.x = -l_areaDiffOffset;
@@ -503,187 +359,176 @@ void CKeyboard::render(const bool p_focus) const
                 l_caretPositionTmp = std::min(l_surfaceTmp->w, l_caretPositionTmp);
                 SDL_Utils::applySurface(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), l_surfaceTmp, Globals::g_screen, &l_rect);
             }
+
+            SDL_FreeSurface(l_surfaceTmp);
+
+            // 3d. Highlight the current match, if any
+            size_t l_highlightStart(0);
+            size_t l_highlightEnd(0);
+
+            if (getHighlight(l_highlightStart, l_highlightEnd))
+            {
+                renderHighlight(l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), l_rect.x, static_cast<int>(l_textAreaLenght), 0, l_text.size(), l_highlightStart, l_highlightEnd);
+            }
         }
 
-        // 3. Draw caret if visible
+        // 4. Draw caret if visible
         if (m_showCaret)
         {
             l_rect.x = 0;
             l_rect.y = 0;
             l_rect.h = m_caret->h;
-            SDL_Utils::applySurface(l_caretPositionTmp + l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + static_cast<Sint16>(4 * l_adjustedPpuY), m_caret, Globals::g_screen, &l_rect);
+            SDL_Utils::applySurface(l_caretPositionTmp + l_keyboardX + static_cast<Sint16>(5 * l_adjustedPpuX), l_fieldY + l_caretLineY + static_cast<Sint16>(4 * l_adjustedPpuY), m_caret, Globals::g_screen, &l_rect);
         }
 
-        // 4. Draw keyboard background
-        SDL_Utils::applySurface(l_keyboardX, l_keyboardY, m_imageKeyboard, Globals::g_screen);
-    }
-
-    unsigned int selected_letter_x = -1;
-    unsigned int selected_letter_y = -1;
-
-    // 5. Highlight selected key or button
-    {
-        SDL_Rect l_rect{};
-
-        if (m_selected < TOTALKEYS)
-        {
-            // 5a. Determine selected key's row and column
-            if (m_selected >= 3 * KEYCOLUMNS)
-            {
-                selected_letter_x = m_selected - (3 * KEYCOLUMNS);
-                selected_letter_y = 3;
-            }
-            else if (m_selected >= 2 * KEYCOLUMNS)
-            {
-                selected_letter_x = m_selected - (2 * KEYCOLUMNS);
-                selected_letter_y = 2;
-            }
-            else if (m_selected >= KEYCOLUMNS)
-            {
-                selected_letter_x = m_selected - KEYCOLUMNS;
-                selected_letter_y = 1;
-            }
-            else
-            {
-                selected_letter_x = m_selected;
-                selected_letter_y = 0;
-            }
-
-            l_rect.x = l_keyboardX + static_cast<int>((4 + selected_letter_x * 20) * l_adjustedPpuX);
-            l_rect.y = l_keyboardY + static_cast<int>((4 + selected_letter_y * 20) * l_adjustedPpuY);
-            l_rect.w = static_cast<int>(17 * l_adjustedPpuX);
-            l_rect.h = static_cast<int>(16 * l_adjustedPpuY);
-        }
-        else
-        {
-            // 5b. Highlight Cancel or OK button
-            l_rect.x = l_keyboardX + static_cast<int>((4 * l_adjustedPpuX + (m_selected == 1 + TOTALKEYS) * (0.5f * l_keyboardWidth - 2.5f * l_adjustedPpuX)));
-            l_rect.y = l_keyboardY + static_cast<int>(84 * l_adjustedPpuY);
-            l_rect.w = static_cast<int>(0.5f * l_keyboardWidth - 5.5f * l_adjustedPpuX);
-            l_rect.h = static_cast<int>(16 * l_adjustedPpuY);
-        }
+        if (m_searchMode != ESearchMode::NONE) renderSearchBar(l_keyboardX, l_fieldY, l_keyboardWidth);
 
-        SDL_FillRect(Globals::g_screen, &l_rect, SDL_MapRGB(Globals::g_screen->format, COLOR_CURSOR));
+        // 5. Draw the keyboard (each surface is drawn before baking the next one, which may free it)
+        SDL_Surface* l_keyboard = getBakedKeyboard();
+        if (l_keyboard != nullptr) SDL_Utils::applySurface(l_keyboardX, l_keyboardY, l_keyboard, Globals::g_screen);
     }
 
-    // 6. Render keys' text
+    // 6. Highlight selected key or button
     {
-        unsigned int l_i(0);
-        std::string l_text("");
-
-        for (unsigned int l_y = 0; l_y < KEYROWS; ++l_y)
-        {
-            for (unsigned int l_x = 0; l_x < KEYCOLUMNS; ++l_x)
-            {
-                if (checkUtf8Code(m_keySets[m_keySet].at(l_i)))
-                {
-                    l_text = m_keySets[m_keySet].substr(l_i, 2);
-                    l_i += 2;
-                }
-                else
-                {
-                    l_text = m_keySets[m_keySet].substr(l_i, 1);
-                    l_i += 1;
-                }
-
-                const auto p_x = l_keyboardX + static_cast<int>((13 + 20 * l_x) * l_adjustedPpuX);
-                const auto p_y = l_keyboardY + static_cast<int>((7 + 20 * l_y) * l_adjustedPpuY);
+        const SDL_Rect& l_face = m_layout.getGeometry(m_selected).m_face;
+        SDL_Surface* l_highlight = getBakedHighlight();
 
-                SDL_Utils::applyText(p_x, p_y, Globals::g_screen, m_font, l_text, Globals::g_colorTextNormal,
-                    selected_letter_x == l_x && selected_letter_y == l_y ? SDL_Color{ COLOR_CURSOR } : SDL_Color{ COLOR_BG_1 }, SDL_Utils::ETextAlign::CENTER);
-            }
-        }
+        if (l_highlight != nullptr) SDL_Utils::applySurface(l_keyboardX + l_face.x, l_keyboardY + l_face.y, l_highlight, Globals::g_screen);
     }
 
-    // 7. Render 'Cancel' and 'OK' buttons' text
-    const Sint16 p_yb = l_keyboardY + static_cast<Sint16>(87 * l_adjustedPpuY);
-    SDL_Utils::applyText(l_keyboardX + static_cast<Sint16>(0.25f * l_keyboardWidth + 3 * l_adjustedPpuX), p_yb, Globals::g_screen, m_font, "Cancel", Globals::g_colorTextNormal,
-        m_selected == TOTALKEYS ? SDL_Color{ COLOR_CURSOR } : SDL_Color{ COLOR_BG_1 }, SDL_Utils::ETextAlign::CENTER);
-    SDL_Utils::applyText(l_keyboardX + static_cast<Sint16>(0.75f * l_keyboardWidth - 3 * l_adjustedPpuX), p_yb, Globals::g_screen, m_font, "OK", Globals::g_colorTextNormal,
-        m_selected == 1 + TOTALKEYS ? SDL_Color{ COLOR_CURSOR } : SDL_Color{ COLOR_BG_1 }, SDL_Utils::ETextAlign::CENTER);
-
-    // 8. Draw the footer
+    // 7. Draw the footer
     SDL_Utils::applySurface(0, (Globals::g_Screen.m_logicalHeight - m_footer->h), m_footer, Globals::g_screen);
 }
 
-void CKeyboard::renderField(void) const
-{
-    // If you are in confidential mode, use m_displayText instead of m_inputText
-    const std::string& textToRender = m_confidentialMode ? m_displayText : m_inputText;
-    
-    // Create text surface
-    SDL_Color textColor = {0, 0, 0, 0};
-    SDL_Surface* textSurface = TTF_RenderUTF8_Blended(m_font, textToRender.c_str(), textColor);
-    
-    if (textSurface != nullptr) {
-        // ...existing rendering code...
-    }
-}
-
 const bool CKeyboard::keyPress(const SDL_Event& p_event)
 {
     // 1. Call the base class' method to handle any generic key press logic.
     // 2. Initialize a return value to FALSE to indicate no key press was handled yet.
     // 3. Handle different supported key-press events based on the key symbol of the passed event.
-    // 4. Update the last selected key in the first or last row for vertical looping, if applicable.
-    // 5. Return the result indicating whether the key press was handled (TRUE) or not (FALSE).
+    // 4. Return the result indicating whether the key press was handled (TRUE) or not (FALSE).
 
     CWindow::keyPress(p_event);
     bool l_returnValue(false);
 
-    static constexpr int s_keyColumnsMinusOneRow = KEYCOLUMNS * (KEYROWS - 1);
-    static constexpr int s_keyColumnsMinusOne = KEYCOLUMNS - 1;
-    static constexpr int s_totalKeysPlusOne = 1 + TOTALKEYS;
+    // Ignore any input while waiting for the exit sound to finish
+    if (m_exitDelayTimer != 0) return false;
+
+    const CLayout::EKeyAction l_action = getSelectedAction();
 
     switch (p_event.key.keysym.sym)
     {
     case MYKEY_UP:
-        l_returnValue = moveCursorUp(LOOP_ONKEYPRESS);
+        l_returnValue = moveCursor(CLayout::UP, LOOP_ONKEYPRESS);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_DOWN:
-        l_returnValue = moveCursorDown(LOOP_ONKEYPRESS);
+        l_returnValue = moveCursor(CLayout::DOWN, LOOP_ONKEYPRESS);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_LEFT:
-        l_returnValue = moveCursorLeft(LOOP_ONKEYPRESS);
+        // SELECT + LEFT => Previous layout
+        if (m_selectHeld)
+        {
+            l_returnValue = switchLayout(false);
+            if (l_returnValue) playNavigationSound();
+            break;
+        }
+
+        l_returnValue = moveCursor(CLayout::LEFT, LOOP_ONKEYPRESS);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_RIGHT:
-        l_returnValue = moveCursorRight(LOOP_ONKEYPRESS);
+        // SELECT + RIGHT => Next layout
+        if (m_selectHeld)
+        {
+            l_returnValue = switchLayout(true);
+            if (l_returnValue) playNavigationSound();
+            break;
+        }
+
+        l_returnValue = moveCursor(CLayout::RIGHT, LOOP_ONKEYPRESS);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_SYSTEM:
+        // SELECT + Y => Cut
+        if (m_selectHeld)
+        {
+            l_returnValue = copySelection(true);
+            if (l_returnValue) playSelectionSound();
+            break;
+        }
+
         // Y => Backspace
         l_returnValue = pressBackspace();
         if (l_returnValue) playSelectionSound();
         break;
     case MYKEY_OPERATION:
+        // SELECT + X => Copy
+        if (m_selectHeld)
+        {
+            l_returnValue = copySelection(false);
+            if (l_returnValue) playSelectionSound();
+            break;
+        }
+
         // X => Space
         l_returnValue = typeChar(true);
         if (l_returnValue) playSelectionSound();
         break;
     case MYKEY_OPEN:
+        // SELECT + A => Mark the start of the selection, or clear it
+        if (m_selectHeld)
+        {
+            l_returnValue = toggleSelection();
+            if (l_returnValue) playNavigationSound();
+            break;
+        }
+
         // A => Button pressed
-        if (m_selected == s_keyColumnsMinusOne)
+        if (l_action == CLayout::EKeyAction::BACKSPACE)
         {
             l_returnValue = pressBackspace(); // Backspace letter selected
             if (l_returnValue) playSelectionSound();
         }
-        else if (m_selected == TOTALKEYS)
+        else if (l_action == CLayout::EKeyAction::CANCEL && m_searchMode != ESearchMode::NONE)
+        {
+            // Button Cancel (search mode) => Leave the search
+            l_returnValue = cancelSearch();
+            if (l_returnValue) playSelectionSound();
+        }
+        else if (l_action == CLayout::EKeyAction::CANCEL)
         {
             // Button Cancel
             m_returnValue = -1;
             l_returnValue = true;
             playSelectionSound();
         }
-        else if (m_selected == s_totalKeysPlusOne)
+        else if (l_action == CLayout::EKeyAction::OK && m_searchMode != ESearchMode::NONE)
+        {
+            // Button OK (search mode) => Accept the pattern, or the replacement
+            l_returnValue = acceptSearch();
+            if (l_returnValue) playSelectionSound();
+        }
+        else if (l_action == CLayout::EKeyAction::OK && m_multiline)
+        {
+            // Button Enter (multiline mode) => New line
+            l_returnValue = insertAtCaret("\n");
+            if (l_returnValue) playSelectionSound();
+        }
+        else if (l_action == CLayout::EKeyAction::OK)
         {
             // Button OK
             m_returnValue = 1;
             l_returnValue = true;
             playSelectionSound();
         }
+        else if (l_action == CLayout::EKeyAction::PAGE)
+        {
+            // Page button (e.g. "Shift") => Change keyset
+            m_keySet = (m_keySet + 1) % m_layout.getPageCount();
+            l_returnValue = true;
+            playNavigationSound();
+        }
         else
         {
             // A letter button
@@ -692,79 +537,113 @@ const bool CKeyboard::keyPress(const SDL_Event& p_event)
         }
         break;
     case MYKEY_CARETLEFT:
-        // L => Moves the caret to the left
-        l_returnValue = moveCaret(true);
+        // L => Moves the caret to the left (SELECT + L => Undo)
+        l_returnValue = pressCaretKey(true);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_CARETRIGHT:
-        // R => Moves the caret to the right
-        l_returnValue = moveCaret(false);
+        // R => Moves the caret to the right (SELECT + R => Redo)
+        l_returnValue = pressCaretKey(false);
         if (l_returnValue) playNavigationSound();
         break;
     case MYKEY_PAGEDOWN:
-        // L2 => Change keys to the top-most left
-        if (m_selected == s_totalKeysPlusOne)
+        // SELECT + L2 => Find
+        if (m_selectHeld)
         {
-            --m_selected;
+            l_returnValue = startSearch(ESearchMode::FIND);
+            if (l_returnValue) playNavigationSound();
+            break;
         }
-        else if (m_selected != TOTALKEYS)
+
+        // L2 => Moves the caret one line up (multiline mode), or change keys to the left-most one of the row
+        if (m_multiline)
         {
-            int row = static_cast<int>(floor(m_selected / (float)KEYCOLUMNS));
-            m_selected = row * KEYCOLUMNS;
+            l_returnValue = moveCaretLine(true);
+            if (l_returnValue) playNavigationSound();
+            break;
         }
+
+        m_selected = m_layout.getRow(m_layout.getKey(m_selected).m_row).m_first;
+        m_rememberedColumn = -1;
         l_returnValue = true;
         playNavigationSound();
         break;
     case MYKEY_PAGEUP:
-        // R2 => Change keys to the top-most right
-        if (m_selected == TOTALKEYS)
+        // SELECT + R2 => Replace
+        if (m_selectHeld)
         {
-            ++m_selected;
+            l_returnValue = startSearch(ESearchMode::REPLACE_PATTERN);
+            if (l_returnValue) playNavigationSound();
+            break;
         }
-        else if (m_selected != s_totalKeysPlusOne)
+
+        // R2 => Moves the caret one line down (multiline mode), or change keys to the right-most one of the row
+        if (m_multiline)
         {
-            int row = static_cast<int>(floor(m_selected / (float)KEYCOLUMNS));
-            m_selected = (KEYCOLUMNS - 1) + row * KEYCOLUMNS;
+            l_returnValue = moveCaretLine(false);
+            if (l_returnValue) playNavigationSound();
+            break;
         }
+
+        m_selected = m_layout.getRow(m_layout.getKey(m_selected).m_row).m_last;
+        m_rememberedColumn = -1;
         l_returnValue = true;
         playNavigationSound();
         break;
     case MYKEY_START:
+        // START => Accept the pattern, or the replacement (search mode)
+        if (m_searchMode != ESearchMode::NONE)
+        {
+            l_returnValue = acceptSearch();
+            if (l_returnValue) playSelectionSound();
+            break;
+        }
+
         // START => Button OK
-        m_returnValue = 1;
         l_returnValue = true;
         playSelectionSound();
         
         // Add delay before actually exiting to let sound play
-        SDL_Delay(300);
+        exitAfterDelay(1);
         break;
     case MYKEY_TRANSFER:
+        // SELECT + B => Paste
+        if (m_selectHeld)
+        {
+            l_returnValue = pasteClipboard();
+            if (l_returnValue) playSelectionSound();
+            break;
+        }
+
         // B => Change keyset
-        m_keySet = (m_keySet + 1) % NB_KEY_SETS;
+        m_keySet = (m_keySet + 1) % m_layout.getPageCount();
         l_returnValue = true;
         playNavigationSound();
         break;
     case MYKEY_PARENT:
+        // MENU => Leave the search (search mode)
+        if (m_searchMode != ESearchMode::NONE)
+        {
+            l_returnValue = cancelSearch();
+            if (l_returnValue) playNavigationSound();
+            break;
+        }
+
         // MENU => Button Cancel
-        m_returnValue = -1;
         l_returnValue = true;
         playExitSound(); // Use exit sound instead of selection sound
         
         // Add delay before actually exiting to let sound play
-        SDL_Delay(300);
+        exitAfterDelay(-1);
         break;
     case MYKEY_SELECT:
+        // Enables the SELECT combos while held
+        m_selectHeld = true;
+
         // Displays password as long as button is pressed, but only in confidential mode
         if (m_confidentialMode) {
-            // Temporarily disable the confidential timer
-            if (m_confidentialTimer != 0) {
-                SDL_RemoveTimer(m_confidentialTimer);
-                m_confidentialTimer = 0;
-            }
-            
             // Show the password text, will be masked again on key release
-            m_displayText = m_inputText;
-            renderField();
+            m_revealText = true;
             l_returnValue = true;
             playNavigationSound();
         }
@@ -773,15 +652,6 @@ const bool CKeyboard::keyPress(const SDL_Event& p_event)
         break;
     }
 
-    if (m_selected >= 0 && m_selected < KEYCOLUMNS)
-    {
-        m_lastKeySelectedFirstRow = m_selected;
-    }
-    else if (m_selected >= s_keyColumnsMinusOneRow && m_selected < TOTALKEYS)
-    {
-        m_lastKeySelectedLastRow = m_selected;
-    }
-
     return l_returnValue;
 }
 
@@ -805,7 +675,7 @@ const bool CKeyboard::keyHold(void)
         case MYKEY_UP:
             if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_UP)]))
             {
-                l_returnValue = moveCursorUp(LOOP_ONJOYDOWN);
+                l_returnValue = moveCursor(CLayout::UP, LOOP_ONJOYDOWN);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = false;
             }
@@ -813,30 +683,30 @@ const bool CKeyboard::keyHold(void)
         case MYKEY_DOWN:
             if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_DOWN)]))
             {
-                l_returnValue = moveCursorDown(LOOP_ONJOYDOWN);
+                l_returnValue = moveCursor(CLayout::DOWN, LOOP_ONJOYDOWN);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = false;
             }
             break;
         case MYKEY_LEFT:
-            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_LEFT)]))
+            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_LEFT)]) && !m_selectHeld)
             {
-                l_returnValue = moveCursorLeft(LOOP_ONJOYDOWN);
+                l_returnValue = moveCursor(CLayout::LEFT, LOOP_ONJOYDOWN);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = false;
             }
             break;
         case MYKEY_RIGHT:
-            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_RIGHT)]))
+            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_RIGHT)]) && !m_selectHeld)
             {
-                l_returnValue = moveCursorRight(LOOP_ONJOYDOWN);
+                l_returnValue = moveCursor(CLayout::RIGHT, LOOP_ONJOYDOWN);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = false;
             }
             break;
         case MYKEY_SYSTEM:
             // Y => Backspace
-            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_SYSTEM)]))
+            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_SYSTEM)]) && !m_selectHeld)
             {
                 l_returnValue = pressBackspace();
                 if (l_returnValue) playSelectionSound(); // Play sound on repeat
@@ -845,7 +715,7 @@ const bool CKeyboard::keyHold(void)
             break;
         case MYKEY_OPERATION:
             // X => Space
-            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_OPERATION)]))
+            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_OPERATION)]) && !m_selectHeld)
             {
                 l_returnValue = typeChar(true);
                 if (l_returnValue) playSelectionSound(); // Play sound on repeat
@@ -854,14 +724,14 @@ const bool CKeyboard::keyHold(void)
             break;
         case MYKEY_OPEN:
             // A => Add letter
-            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_OPEN)]))
+            if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_OPEN)]) && !m_selectHeld)
             {
-                if (m_selected == KEYCOLUMNS - 1)
+                if (getSelectedAction() == CLayout::EKeyAction::BACKSPACE)
                 {
                     l_returnValue = pressBackspace(); // Backspace letter selected
                     if (l_returnValue) playSelectionSound(); // Play sound on repeat
                 }
-                else
+                else if (getSelectedAction() == CLayout::EKeyAction::TEXT)
                 {
                     l_returnValue = typeChar();
                     if (l_returnValue) playSelectionSound(); // Play sound on repeat
@@ -871,19 +741,19 @@ const bool CKeyboard::keyHold(void)
             }
             break;
         case MYKEY_CARETLEFT:
-            // L => Moves the caret to the left
+            // L => Moves the caret to the left (SELECT + L => Undo)
             if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_CARETLEFT)]))
             {
-                l_returnValue = moveCaret(true);
+                l_returnValue = pressCaretKey(true);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = l_returnValue;
             }
             break;
         case MYKEY_CARETRIGHT:
-            // R => Moves the caret to the right
+            // R => Moves the caret to the right (SELECT + R => Redo)
             if (tick(l_isJoyButtonDown | SDL_GetKeyboardState(nullptr)[SDL_GetScancodeFromKey(MYKEY_CARETRIGHT)]))
             {
-                l_returnValue = moveCaret(false);
+                l_returnValue = pressCaretKey(false);
                 if (l_returnValue) playNavigationSound(); // Play sound on repeat
                 m_mustShowCaret = l_returnValue;
             }
@@ -896,318 +766,441 @@ const bool CKeyboard::keyHold(void)
     return l_returnValue;
 }
 
-const bool CKeyboard::moveCursorUp(const bool p_loop)
+const bool CKeyboard::moveCursor(const CLayout::EDirection p_direction, const bool p_loop)
 {
-    // 1. By default, set the result to return as FALSE (the cursor was not moved).
-    // 2. Check if the currently selected key is beyond the total number of keys:
-    //    a. Move the selection to the last key in the last row.
-    //    b. Set the return value to TRUE to indicate movement.
-    // 3. Check if the currently selected key is in the second or subsequent rows:
-    //    a. Move the selection up by one row.
-    //    b. Set the return value to TRUE.
-    // 4. Check if the currently selected key is in the lower half of the first row:
-    //    a. If looping is enabled, move the selection to the "OK" button.
-    //    b. Update the last selected key in the last row.
-    //    c. Set the return value to TRUE.
-    // 5. For all other cases (upper half of the first row):
-    //    a. If looping is enabled, move the selection to the "Cancel" button.
-    //    b. Update the last selected key in the last row.
-    //    c. Set the return value to TRUE.
-    // 6. Return the result indicating whether the cursor was moved (TRUE) or not (FALSE).
+    // 1. Get the neighbour of the selected key in the direction, as precomputed by the layout.
+    // 2. Do not move if there is none, or if reaching it wraps around the keyboard and looping is disabled.
+    // 3. When moving vertically, keep the column the vertical moves started from, and use the key of the target row
+    //    under it (e.g. from a letter down to a wide "Space" key and up again, the cursor goes back to that letter).
+    //    If the column falls between two keys, or out of the row, keep the neighbour. Moving horizontally forgets it.
+    // 4. Select the key.
+    // 5. Return the result indicating whether the cursor was moved (TRUE) or not (FALSE).
 
-    bool l_returnValue(false);
+    const CLayout::SKey& l_key = m_layout.getKey(m_selected);
+    Uint8 l_target = l_key.m_neighbours[p_direction];
 
-    static constexpr int s_totalKeysPlusOne = 1 + TOTALKEYS;
-    static constexpr int s_keyColumnsMinusOneRow = KEYCOLUMNS * (KEYROWS - 1);
-    static int s_halfSetDown = std::floor(0.5f * KEYCOLUMNS);
+    if (l_target == LAYOUT_NO_KEY || (!p_loop && (l_key.m_wraps & (1 << p_direction)))) return false;
 
-    if (m_selected >= TOTALKEYS)
+    if (p_direction == CLayout::UP || p_direction == CLayout::DOWN)
     {
-        m_selected = m_lastKeySelectedLastRow;
-        l_returnValue = true;
-    }
-    else if (m_selected >= KEYCOLUMNS)
-    {
-        m_selected -= KEYCOLUMNS;
-        l_returnValue = true;
-    }
-    else if (m_selected >= s_halfSetDown)
-    {
-        if (p_loop)
-        {
-            m_lastKeySelectedLastRow = m_selected + s_keyColumnsMinusOneRow;
-            m_selected = s_totalKeysPlusOne;
-            l_returnValue = true;
-        }
+        if (m_rememberedColumn < 0) m_rememberedColumn = l_key.m_x + l_key.m_w / 2;
+
+        const Uint8 l_column = m_layout.getKeyAt(m_layout.getKey(l_target).m_row, m_rememberedColumn);
+
+        if (l_column != LAYOUT_NO_KEY) l_target = l_column;
     }
     else
     {
-        if (p_loop)
-        {
-            m_lastKeySelectedLastRow = m_selected + s_keyColumnsMinusOneRow;
-            m_selected = TOTALKEYS;
-            l_returnValue = true;
-        }
+        m_rememberedColumn = -1;
     }
 
-    return l_returnValue;
+    m_selected = l_target;
+
+    return true;
 }
 
-const bool CKeyboard::moveCursorDown(const bool p_loop)
+const bool CKeyboard::switchLayout(const bool p_next)
 {
-    // 1. By default, set the result to return as FALSE (the cursor was not moved).
-    // 2. Check if the currently selected key is beyond the total number of keys:
-    //    a. If looping is enabled, move the selection to the first key of the first row.
-    //    b. Set the return value to TRUE to indicate movement.
-    // 3. Check if the currently selected key is in the upper half of the keyboard:
-    //    a. Move the selection to the "OK" button.
-    //    b. Update the last selected key in the first row.
-    //    c. Set the return value to TRUE.
-    // 4. Check if the currently selected key is in the last row:
-    //    a. Move the selection to the "Cancel" button.
-    //    b. Update the last selected key in the first row.
-    //    c. Set the return value to TRUE.
-    // 5. For all other cases, move the selection down by one row and set the return value to TRUE.
-    // 6. Return the result indicating whether the cursor was moved (TRUE) or not (FALSE).
+    // 1. Do nothing if there is a single layout.
+    // 2. Select the previous/next installed layout (wrapping around), and start on its first key and key set.
+    // 3. If the size of the keyboard changed, redraw the background and recreate the text field, which follow it.
+    //    Fit the budget of the baked keyboards to the new layout.
+    // 4. Return TRUE (the layout was switched). Its keyboard is baked when first rendered, unless it is cached.
 
-    bool l_returnValue(false);
+    const unsigned int l_count = m_layout.getLayoutCount();
 
-    static constexpr int s_keyRowsMinusOne = KEYROWS - 1;
-    static constexpr int s_keyColumnsMinusOneRow = KEYCOLUMNS * (KEYROWS - 1);
-    static constexpr int s_keyInLastRow = TOTALKEYS - (KEYCOLUMNS - 1);
-    static int s_halfSetUp = TOTALKEYS - std::ceil(0.5f * KEYCOLUMNS);
+    if (l_count < 2) return false;
 
-    if (m_selected >= TOTALKEYS)
-    {
-        if (p_loop)
-        {
-            m_selected = m_lastKeySelectedFirstRow;
-            l_returnValue = true;
-        }
-    }
-    else if (m_selected >= s_halfSetUp)
+    const Sint16 l_width = m_layout.getWidth();
+    const Sint16 l_height = m_layout.getHeight();
+
+    CLayout::instance().select((m_layout.getSelected() + (p_next ? 1 : l_count - 1)) % l_count);
+    m_selected = 0;
+    m_keySet = 0;
+    m_rememberedColumn = -1;
+
+    if (m_layout.getWidth() != l_width || m_layout.getHeight() != l_height)
     {
-        m_lastKeySelectedFirstRow = m_selected - s_keyColumnsMinusOneRow;
-        m_selected = 1 + TOTALKEYS;
-        l_returnValue = true;
+        drawBackground();
+        createTextField();
     }
-    else if (m_selected >= s_keyInLastRow)
+
+    fitLayoutCache();
+
+    return true;
+}
+
+void CKeyboard::drawBackground(void) const
+{
+    // Stretch the background image over the screen, or fill it with a solid color if it is unavailable.
+
+    SDL_Rect l_rect{};
+    l_rect.w = Globals::g_Screen.m_logicalWidth;
+    l_rect.h = Globals::g_Screen.m_logicalHeight;
+    l_rect.x = 0;
+    l_rect.y = 0;
+    SDL_Surface* l_imageBakground = CResourceManager::instance().getSurface(CResourceManager::T_SURFACE_BACKGROUND);
+
+    if (l_imageBakground != nullptr)
     {
-        m_lastKeySelectedFirstRow = m_selected - s_keyColumnsMinusOneRow;
-        m_selected = TOTALKEYS;
-        l_returnValue = true;
+        SDL_BlitScaled(l_imageBakground, nullptr, Globals::g_screen, &l_rect);
     }
     else
     {
-        m_selected += KEYCOLUMNS;
-        l_returnValue = true;
+        SDL_Surface* l_imageAlternativeBackground = SDL_Utils::createImage(l_rect.w, l_rect.h, SDL_MapRGB(Globals::g_screen->format, COLOR_BG_3));
+        SDL_Utils::applySurface(0, 0, l_imageAlternativeBackground, Globals::g_screen);
+        SDL_FreeSurface(l_imageAlternativeBackground);
+        l_imageAlternativeBackground = nullptr;
     }
-
-    return l_returnValue;
 }
 
-const bool CKeyboard::moveCursorLeft(const bool p_loop)
+void CKeyboard::createTextField(void)
 {
-    // 1. By default, set the result to return as FALSE (the cursor was not moved).
-    // 2. Check if the selected key is at the left-most column of any row or the first key in the keyboard.
-    // 3. If it is and looping is enabled:
-    //    a. Move the selection to the right-most key of the same row.
-    //    b. Set the return value to TRUE to indicate the cursor was moved.
-    // 4. If the selected key is the "Cancel" button and looping is enabled:
-    //    a. Move the selection to the "OK" button.
-    //    b. Set the return value to TRUE.
-    // 5. For all other cases:
-    //    a. Decrement the selected key index to move the cursor to the left.
-    //    b. Set the return value to TRUE.
-    // 6. Return the result indicating whether the cursor was moved (TRUE) or not (FALSE).
-
-    bool l_returnValue(false);
+    // 1. Free the previous image, if any.
+    // 2. Place the field above the keyboard (taller in multiline mode, growing upwards), and fill it with a border.
 
-    static constexpr int s_keyColumnsMinusOne = KEYCOLUMNS - 1;
-    static constexpr int s_secondRow = 2 * KEYCOLUMNS;
-    static constexpr int s_thirdRow = 3 * KEYCOLUMNS;
-
-    switch (m_selected)
+    if (m_textField != nullptr)
     {
-        case 0:
-        case KEYCOLUMNS:
-        case s_secondRow:
-        case s_thirdRow:
-            if (p_loop)
-            {
-                m_selected += s_keyColumnsMinusOne;
-                l_returnValue = true;
-            }
-            break;
-        case TOTALKEYS:
-            if (p_loop)
-            {
-                m_selected += 1;
-                l_returnValue = true;
-            }
-            break;
-        default:
-            --m_selected;
-            l_returnValue = true;
-            break;
+        SDL_FreeSurface(m_textField);
+        m_textField = nullptr;
     }
 
-    return l_returnValue;
-}
+    const float l_adjustedPpuX = Globals::g_Screen.getAdjustedPpuX();
+    const float l_adjustedPpuY = Globals::g_Screen.getAdjustedPpuY();
+    const int l_keyboardWidth = KB_WIDTH;
+    const int l_extraLinesHeight = m_multiline ? (MULTILINE_VISIBLE_LINES - 1) * m_fonts.getLineSkip() : 0;
+    m_fieldY = FIELD_Y - l_extraLinesHeight;
 
-const bool CKeyboard::moveCursorRight(const bool p_loop)
-{
-    // 1. By default, set the result to return as FALSE (the cursor was not moved).
-    // 2. Check if the selected key is at the right-most column of any row or the last key in the keyboard.
-    // 3. If it is and looping is enabled:
-    //    a. Move the selection to the left-most key of the same row.
-    //    b. Set the return value to TRUE to indicate the cursor was moved.
-    // 4. If the selected key is the "OK" button and looping is enabled:
-    //    a. Move the selection to the "Cancel" button.
-    //    b. Set the return value to TRUE.
-    // 5. For all other cases:
-    //    a. Increment the selected key index to move the cursor to the right.
-    //    b. Set the return value to TRUE.
-    // 6. Return the result indicating whether the cursor was moved (TRUE) or not (FALSE).
+    m_textField = SDL_Utils::createImage(l_keyboardWidth, static_cast<int>(static_cast<int>(19 * l_adjustedPpuY)) + l_extraLinesHeight, SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
 
-    bool l_returnValue(false);
+    SDL_Rect l_rect{};
+    l_rect.x = static_cast<int>(2 * l_adjustedPpuX);
+    l_rect.y = static_cast<int>(2 * l_adjustedPpuY);
+    l_rect.w = static_cast<int>(l_keyboardWidth - 4 * l_adjustedPpuX);
+    l_rect.h = static_cast<int>(15 * l_adjustedPpuY) + l_extraLinesHeight;
+    SDL_FillRect(m_textField, &l_rect, SDL_MapRGB(m_textField->format, COLOR_BG_1));
+}
 
-    static constexpr int s_keyColumnsMinusOne = KEYCOLUMNS - 1;
-    static constexpr int s_secondColumnMinusOne = 2 * KEYCOLUMNS - 1;
-    static constexpr int s_thirdColumnMinusOne = 3 * KEYCOLUMNS - 1;
+void CKeyboard::fitLayoutCache(void)
+{
+    // 1. Keep the budget set explicitly, if any.
+    // 2. Otherwise, size one baked keyboard like the screen surfaces (rows aligned to 4 bytes), and allow one per key
+    //    set of the layout plus one more, so going through the key sets never bakes them again.
 
-    switch (m_selected)
+    if (m_layoutCacheBudget != 0)
     {
-        case s_keyColumnsMinusOne:
-        case s_secondColumnMinusOne:
-        case s_thirdColumnMinusOne:
-        case TOTALKEYS - 1:
-            if (p_loop)
-            {
-                m_selected -= s_keyColumnsMinusOne;
-                l_returnValue = true;
-            }
-            break;
-        case 1 + TOTALKEYS:
-            if (p_loop)
-            {
-                m_selected -= 1;
-                l_returnValue = true;
-            }
-            break;
-        default:
-            ++m_selected;
-            l_returnValue = true;
-            break;
+        m_bakedLayouts.setBudget(m_layoutCacheBudget);
+        return;
     }
 
-    return l_returnValue;
+    const size_t l_pitch = (static_cast<size_t>(KB_WIDTH) * Globals::g_screen->format->BytesPerPixel + 3) & ~static_cast<size_t>(3);
+    const size_t l_keyboardBytes = l_pitch * static_cast<size_t>(KB_HEIGHT);
+
+    m_bakedLayouts.setBudget(std::max(static_cast<size_t>(SURFACECACHE_DEFAULT_BUDGET), (m_layout.getPageCount() + 1) * l_keyboardBytes));
 }
 
-const bool CKeyboard::typeChar(const bool p_addSpace)
+SDL_Surface* CKeyboard::getBakedKeyboard(void) const
 {
-    // 1. Determine the current size of the input text and initialize the caret advance to 1.
-    // 2. Check if a space needs to be added (parameter equals TRUE).
-    //    a. If true, insert a space at the current caret position.
-    //    b. If false, proceed to add the selected character (step 3).
-    // 3. If adding a character:
-    //    a. Verify that the selected key index lays within the valid range of keys.
-    //    b. Calculate the real index of the selected key in the key set, accounting for UTF-8 characters.
-    //    c. Extract the substring representing the selected key from the key set.
-    //    d. Insert the extracted substring at the current caret position in the input text.
-    //    e. Update the caret advance based on the size of the inserted substring.
-    // 4. If the selected key index is invalid, log an error and return FALSE.
-    // 5. Update the caret position by adding the caret advance.
-    // 6. Return TRUE to indicate successful insertion of the corresponding char.
-
-    const size_t l_currentSize = m_inputText.size();
-    size_t l_caretAdvance = 1;
-
-    if (p_addSpace == false)
+    // 1. Return the keyboard of the current layout and key set, if it is cached.
+    // 2. Otherwise, bake it: fill it with a border and background color, then draw the frame, the face and the label
+    //    of each key (the "Cancel" and "OK" buttons included), using the rectangles of the layout.
+    // 3. Cache it, which frees the least recently used baked surfaces if the budget is exceeded.
+
+    const Uint32 l_cacheKey = getBakedKey(LAYOUT_NO_KEY);
+    SDL_Surface* l_keyboard = m_bakedLayouts.get(l_cacheKey);
+
+    if (l_keyboard != nullptr) return l_keyboard;
+
+    const float l_adjustedPpuX = Globals::g_Screen.getAdjustedPpuX();
+    const float l_adjustedPpuY = Globals::g_Screen.getAdjustedPpuY();
+    const int l_keyboardWidth = KB_WIDTH;
+    const int l_keyboardHeight = KB_HEIGHT;
+
+    l_keyboard = SDL_Utils::createImage(l_keyboardWidth, l_keyboardHeight, SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
+
+    if (l_keyboard == nullptr) return nullptr;
+
+    SDL_Rect l_rect{};
+    l_rect.w = l_keyboardWidth - static_cast<int>(4 * l_adjustedPpuX);
+    l_rect.h = l_keyboardHeight - static_cast<int>(4 * l_adjustedPpuY);
+    l_rect.x = static_cast<int>(2 * l_adjustedPpuX);
+    l_rect.y = static_cast<int>(2 * l_adjustedPpuY);
+
+    SDL_FillRect(l_keyboard, &l_rect, SDL_MapRGB(l_keyboard->format, COLOR_BG_2));
+
+    for (unsigned int l_key = 0; l_key < m_layout.getKeyCount(); ++l_key)
     {
-        if (m_selected < TOTALKEYS)
-        {
-            unsigned char l_index(0);
+        const CLayout::SGeometry& l_geometry = m_layout.getGeometry(l_key);
 
-            for (unsigned char l_c = 0; l_c < m_selected; ++l_c)
-            {
-                l_index += 1 + checkUtf8Code(m_keySets[m_keySet].at(l_index));
-            }
+        l_rect = l_geometry.m_frame;
+        SDL_FillRect(l_keyboard, &l_rect, SDL_MapRGB(l_keyboard->format, COLOR_BORDER));
 
-            size_t l_size = static_cast<size_t>(1 + checkUtf8Code(m_keySets[m_keySet].at(l_index)));
-            const std::string subString = m_keySets[m_keySet].substr(l_index, l_size);
-            m_inputText.insert(m_caretPosition, subString);
-            l_caretAdvance = l_size;
-        }
-        else
-        {
-            SDL_LogError(0, "Unexpected keyboard value: %c", m_selected);
-            return false;
-        }
+        l_rect = l_geometry.m_face;
+        SDL_FillRect(l_keyboard, &l_rect, SDL_MapRGB(l_keyboard->format, COLOR_BG_1));
+
+        drawKeyLabel(l_key, l_geometry.m_labelX, l_geometry.m_labelY, l_keyboard, SDL_Color{ COLOR_BG_1 });
     }
-    else
+
+    return m_bakedLayouts.put(l_cacheKey, l_keyboard);
+}
+
+SDL_Surface* CKeyboard::getBakedHighlight(void) const
+{
+    // 1. Return the highlighted face of the selected key, in the current layout and key set, if it is cached.
+    // 2. Otherwise, bake it: fill the face with the cursor color and draw the label where the keyboard has it.
+    // 3. Cache it, which frees the least recently used baked surfaces if the budget is exceeded.
+
+    const Uint32 l_cacheKey = getBakedKey(m_selected);
+    SDL_Surface* l_highlight = m_bakedLayouts.get(l_cacheKey);
+
+    if (l_highlight != nullptr) return l_highlight;
+
+    const CLayout::SGeometry& l_geometry = m_layout.getGeometry(m_selected);
+
+    l_highlight = SDL_Utils::createImage(l_geometry.m_face.w, l_geometry.m_face.h, SDL_MapRGB(Globals::g_screen->format, COLOR_CURSOR));
+
+    if (l_highlight == nullptr) return nullptr;
+
+    drawKeyLabel(m_selected, static_cast<Sint16>(l_geometry.m_labelX - l_geometry.m_face.x), static_cast<Sint16>(l_geometry.m_labelY - l_geometry.m_face.y), l_highlight, SDL_Color{ COLOR_CURSOR });
+
+    return m_bakedLayouts.put(l_cacheKey, l_highlight);
+}
+
+std::string CKeyboard::getKeyLabel(const unsigned int p_key) const
+{
+    // In multiline mode, the 'OK' button inserts a line break, so it is labelled 'Enter'.
+
+    if (m_multiline && static_cast<CLayout::EKeyAction>(m_layout.getKey(p_key).m_action) == CLayout::EKeyAction::OK) return "Enter";
+
+    return m_layout.getLabel(m_keySet, p_key);
+}
+
+void CKeyboard::drawKeyLabel(const unsigned int p_key, const Sint16 p_x, const Sint16 p_y, SDL_Surface* p_destination, const SDL_Color& p_background) const
+{
+    // 1. Skip keys without label.
+    // 2. Draw emoji from the atlas, if there is a colour font (it renders each of them once).
+    // 3. Otherwise, or if the colour font cannot draw it, draw the label like any text.
+
+    const std::string l_label = getKeyLabel(p_key);
+
+    if (l_label.empty()) return;
+
+    if (m_emojiAtlas.isEnabled() && UTF8_Utils::isEmoji(l_label) && m_emojiAtlas.draw(l_label, p_x, p_y, p_destination)) return;
+
+    drawCenteredText(l_label, p_x, p_y, 1.0f, Globals::g_colorTextNormal, p_background, p_destination);
+}
+
+void CKeyboard::drawCenteredText(const std::string& p_text, const Sint16 p_x, const Sint16 p_y, const float p_scale, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor, SDL_Surface* p_destination) const
+{
+    // 1. At the size of the keyboard font, text in the embedded atlas is rendered from it by the fallback chain, with
+    //    no font file read.
+    // 2. Otherwise, draw the text from the distance field, at the given size, if it has all the characters.
+    // 3. Otherwise, render it with the fallback chain of fonts (at the size of the keyboard font) and center it.
+
+    if (p_scale != 1.0f || !m_fonts.isInAtlas(p_text))
+    {
+        const CSdfFont& l_sdfFont = CResourceManager::instance().getSdfFont();
+        const float l_size = FONT_SIZE * Globals::g_Screen.getAdjustedPpuY() * p_scale;
+
+        if (l_sdfFont.isLoaded() && l_sdfFont.covers(p_text) && l_sdfFont.draw(p_text, p_x - l_sdfFont.measure(p_text, l_size) / 2, p_y, l_size, p_foregroundColor, p_destination)) return;
+    }
+
+    SDL_Surface* l_text = m_fonts.render(p_text, p_foregroundColor, p_backgroundColor);
+
+    if (l_text == nullptr) return;
+
+    SDL_Utils::applySurface(p_x - l_text->w / 2, p_y, l_text, p_destination);
+    SDL_FreeSurface(l_text);
+}
+
+const bool CKeyboard::typeChar(const bool p_addSpace)
+{
+    // 1. Check if a space needs to be added (parameter equals TRUE).
+    //    a. If true, insert a space at the current caret position.
+    //    b. If false, proceed to add the selected character (step 2).
+    // 2. If adding a character:
+    //    a. Verify that the selected key types text (it is not an action key, like 'OK').
+    //    b. Get the text of the selected key from the layout, for the current key set.
+    //    c. Skip keys without text.
+    //    d. Insert the text of the key at the current caret position in the input text.
+    // 3. If the selected key does not type text, log an error and return FALSE.
+    // 4. Return TRUE to indicate successful insertion of the corresponding char.
+    // Note: in search mode, the char is added to the pattern (or replacement) instead of the text.
+
+    if (p_addSpace)
+    {
+        return m_searchMode != ESearchMode::NONE ? extendSearch(" ") : insertAtCaret(" ");
+    }
+
+    if (getSelectedAction() == CLayout::EKeyAction::TEXT)
     {
-        m_inputText.insert(m_caretPosition, " ");
+        const std::string l_keyText = getKeyText(m_selected);
+
+        if (l_keyText.empty()) return false;
+
+        return m_searchMode != ESearchMode::NONE ? extendSearch(l_keyText) : insertAtCaret(l_keyText);
     }
 
-    m_caretPosition += l_caretAdvance;
+    SDL_LogError(0, "Unexpected keyboard value: %c", m_selected);
+    return false;
+}
+
+const bool CKeyboard::insertAtCaret(const std::string& p_text)
+{
+    // 1. Insert the text at the current caret position, updating the line index.
+    // 2. Move the caret after the inserted text and keep it visible.
+    // 3. In confidential mode, leave the typed character visible until its deadline, if it is a single one (a key
+    //    may type several characters, which are masked right away).
+    // 4. Update the character counters with the characters of the text.
+
+    const size_t l_characters = UTF8_Utils::countGraphemes(p_text);
+
+    insertText(m_caretPosition, p_text);
+    m_caretPosition += p_text.size();
+    scrollToCaret();
     INHIBIT(SDL_Log("Caret Position after insertion: %d", m_caretPosition);)
 
-    if (m_confidentialMode) {
-        m_charTimestamps.resize(m_inputText.length());
-        m_charTimestamps[m_caretPosition - 1] = SDL_GetTicks();
-        if (m_confidentialTimer == 0) {
-            m_confidentialTimer = SDL_AddTimer(100, hideCharacters, this);
-        }
-        // Hide all characters except the last
-        m_displayText = std::string(m_inputText.length(), '*');
-        if (!m_inputText.empty()) {
-            m_displayText[m_inputText.length() - 1] = m_inputText[m_inputText.length() - 1];
-        }
-        renderField();
+    // Only the typed character is left visible; everything else is drawn with the mask glyph
+    if (m_confidentialMode)
+    {
+        if (l_characters == 1) unmaskCharacter(p_text);
+        else maskCharacter();
     }
 
+    m_maskLength += l_characters;
+    m_maskCaret += l_characters;
+
+    return true;
+}
+
+void CKeyboard::insertText(const size_t p_position, const std::string& p_text, const bool p_record)
+{
+    // Every edit goes through here, so the line index never needs to scan the text again,
+    // and the history gets each edit as (offset, characters before it, bytes) without snapshotting the text.
+    // Edits are made at the caret, so the characters before it are already counted.
+
+    // Any edit clears the selection, since its range no longer matches the text, and the index of the initial text.
+
+    if (p_record) m_history.recordInsert(p_position, m_maskCaret, p_text);
+
+    dropInitialIndex();
+    m_selectionAnchor = std::string::npos;
+    m_inputText.insert(p_position, p_text);
+    m_lineIndex.insert(p_position, p_text);
+}
+
+void CKeyboard::eraseText(const size_t p_position, const size_t p_length, const bool p_record)
+{
+    // Every edit goes through here, so the line index never needs to scan the text again,
+    // and the history gets each edit as (offset, characters before it, bytes) without snapshotting the text.
+    // Edits are made at the caret, so the characters before it are already counted.
+
+    // Any edit clears the selection, since its range no longer matches the text, and the index of the initial text.
+
+    if (p_record) m_history.recordErase(p_position, m_maskCaret, m_inputText.substr(p_position, p_length));
+
+    dropInitialIndex();
+    m_selectionAnchor = std::string::npos;
+    m_inputText.erase(p_position, p_length);
+    m_lineIndex.erase(p_position, p_length);
+}
+
+const bool CKeyboard::undoEdit(void)
+{
+    // Revert the last edit, if any.
+
+    const CEditHistory::SEdit* l_edit = m_history.undo();
+
+    if (l_edit == nullptr) return false;
+
+    applyEdit(*l_edit, true);
     return true;
 }
 
+const bool CKeyboard::redoEdit(void)
+{
+    // Apply the last reverted edit again, if any.
+
+    const CEditHistory::SEdit* l_edit = m_history.redo();
+
+    if (l_edit == nullptr) return false;
+
+    applyEdit(*l_edit, false);
+    return true;
+}
+
+void CKeyboard::applyEdit(const CEditHistory::SEdit& p_edit, const bool p_revert)
+{
+    // 1. Mask the visible character, since characters may shift.
+    // 2. Place the caret where the edit happened, with the amount of characters before it from the record (no scan).
+    // 3. Insert the bytes (applying an insertion or reverting a deletion) and leave the caret after them,
+    //    or erase them (reverting an insertion or applying a deletion). The cost is the size of the edit.
+    // 4. Update the amount of characters of the text.
+
+    maskCharacter();
+    m_caretPosition = p_edit.m_position;
+    m_maskCaret = p_edit.m_characters;
+
+    const size_t l_characters = UTF8_Utils::countGraphemes(p_edit.m_bytes);
+
+    if (p_edit.m_insert != p_revert)
+    {
+        insertText(p_edit.m_position, p_edit.m_bytes, false);
+        m_caretPosition += p_edit.m_bytes.size();
+        m_maskCaret += l_characters;
+        m_maskLength += l_characters;
+    }
+    else
+    {
+        eraseText(p_edit.m_position, p_edit.m_bytes.size(), false);
+        m_maskLength -= std::min(m_maskLength, l_characters);
+    }
+
+    scrollToCaret();
+}
+
+void CKeyboard::placeCaret(const size_t p_position)
+{
+    // 1. Count the graphemes between the caret and the position (only the distance moved is scanned).
+    // 2. Move the caret and update the amount of characters before it.
+    // 3. Keep the caret visible.
+
+    const size_t l_from = std::min(p_position, m_caretPosition);
+    const size_t l_to = std::max(p_position, m_caretPosition);
+    size_t l_crossed(0);
+
+    for (size_t l_position = l_from; l_position < l_to; l_position = UTF8_Utils::nextGrapheme(m_inputText, l_position)) ++l_crossed;
+
+    m_maskCaret = (p_position < m_caretPosition) ? m_maskCaret - std::min(m_maskCaret, l_crossed) : m_maskCaret + l_crossed;
+    m_caretPosition = p_position;
+    scrollToCaret();
+}
+
 const bool CKeyboard::pressBackspace(void)
 {
     // 1. Check whether there is any text input and the caret position is not at the begining.
-    // 2. If ok, check whether one or two character must be removed from the text.
-    // 3. Removed the corresponding amount of characters.
-    // 4. Return the corresponding value.
+    // 2. If ok, find where the grapheme before the caret starts (it may span several code points and bytes).
+    // 3. Remove the whole grapheme.
+    // 4. Update the character counters and mask the visible character, so backspace never reveals one.
+    // 5. Return the corresponding value.
+    // Note: in search mode, the last char of the pattern (or replacement) is removed instead.
+
+    if (m_searchMode != ESearchMode::NONE) return shrinkSearch();
 
     bool l_returnValue(false);
 
     if (m_inputText.empty() == false && m_caretPosition > 0)
     {
-        const size_t l_currentSize(m_inputText.size());
-		size_t l_caretAdvance(1);
+        const size_t l_caretAdvance = m_caretPosition - UTF8_Utils::previousGrapheme(m_inputText, m_caretPosition);
 
-        if (m_caretPosition > 1 && checkUtf8Code(m_inputText.at(m_caretPosition - 2)))
-        {
-            l_caretAdvance = 2;
-        }
-        
-		m_inputText.erase(m_caretPosition - l_caretAdvance, l_caretAdvance);
 		m_caretPosition -= l_caretAdvance;
+        --m_maskCaret;
+		eraseText(m_caretPosition, l_caretAdvance);
+        scrollToCaret();
         l_returnValue = true;
 
-        // Update displayText for confidential mode
-        if (m_confidentialMode) {
-            // Ensure displayText is updated to match inputText length
-            m_displayText = std::string(m_inputText.length(), '*');
-            // Update timestamps vector to match new length
-            m_charTimestamps.resize(m_inputText.length());
-            
-            // Only show the last character if:
-            // 1. The input text is not empty
-            // 2. We're not currently deleting a character (backspace operation)
-            // This ensures backspace doesn't accidentally reveal characters
-            if (!m_inputText.empty() && l_currentSize < m_inputText.length()) {
-                m_displayText[m_inputText.length() - 1] = m_inputText[m_inputText.length() - 1];
-            }
-        }
+        --m_maskLength;
+        maskCharacter();
 
         INHIBIT(SDL_Log("Caret Position after deletion: %d", m_caretPosition);)
     }
@@ -1219,34 +1212,34 @@ const bool CKeyboard::moveCaret(const bool goLeft)
 {
     // 1. Check whether there is any text input.
     // 2. If there is, check whether the user intends to move the caret to the left or right.
-    // 3. If going left:
-    //       a. Check whether the previous character needs 1 or 2 bytes in memory for proper visualization.
-    //       b. Move the caret to the left by the calculated amount, without surpassing index 0.
-    // 4. If going right:
-    //       a. Check whether the next character needs 1 or 2 bytes in memory for proper visualization.
-    //       b. Move the caret to the right by the calculated amount, without surpassin the end of the string.
-    // 5. For both cases indicate success (TRUE), because the caret was moved.
-    // 6. Return the corresponding value (TRUE if moved; otherwise, FALSE).
+    // 3. If going left, move the caret to the start of the previous grapheme (it stays at index 0 at the start).
+    // 4. If going right, move the caret to the start of the next grapheme (it stays at the end of the string at the end).
+    // 5. Update the amount of characters before the caret, if it moved, and do not merge the next edit with the previous one.
+    // 6. For both cases indicate success (TRUE), because the caret was moved.
+    // 7. Return the corresponding value (TRUE if moved; otherwise, FALSE).
 
     bool l_returnValue(false);
 
     if (m_inputText.empty() == false)
     {
 		const size_t l_currentSize(m_inputText.size());
+        const size_t l_previousPosition(m_caretPosition);
 
         if (goLeft)
         {
-            const size_t l_caretAdvance = 1 + ((m_caretPosition < 2) ? 0 : checkUtf8Code(m_inputText.at(m_caretPosition - 2)));
-            
-            if (m_caretPosition > 0) m_caretPosition = std::max(size_t(0), m_caretPosition - l_caretAdvance);
+            m_caretPosition = UTF8_Utils::previousGrapheme(m_inputText, m_caretPosition);
         }
         else if(m_caretPosition < l_currentSize)
         {
-            const size_t l_caretAdvance = 1 + ((m_caretPosition > l_currentSize - 2) ? 0 : checkUtf8Code(m_inputText.at(m_caretPosition)));
-
-            m_caretPosition = std::min(l_currentSize, m_caretPosition + l_caretAdvance);
+            m_caretPosition = UTF8_Utils::nextGrapheme(m_inputText, m_caretPosition);
         }
 
+        // Keep the character count before the caret in sync, to place the caret after the mask glyphs
+        if (m_caretPosition < l_previousPosition) --m_maskCaret;
+        else if (m_caretPosition > l_previousPosition) ++m_maskCaret;
+
+        scrollToCaret();
+        m_history.seal();
         l_returnValue = true;
     }
 
@@ -1255,67 +1248,233 @@ const bool CKeyboard::moveCaret(const bool goLeft)
     return l_returnValue;
 }
 
+const bool CKeyboard::moveCaretLine(const bool p_goUp)
+{
+    // 1. Find the line of the caret and early exit (return FALSE) if there is no line above/below.
+    // 2. Count the graphemes between the start of the line and the caret (the column).
+    // 3. Walk the same amount of graphemes in the target line, stopping at its end.
+    // 4. Place the caret there (the next edit is not merged with the previous one) and return TRUE.
+
+    const size_t l_line = m_lineIndex.lineOf(m_caretPosition);
+
+    if ((p_goUp && l_line == 0) || (!p_goUp && l_line + 1 >= m_lineIndex.lineCount())) return false;
+
+    size_t l_column(0);
+
+    for (size_t l_position = m_lineIndex.lineStart(l_line); l_position < m_caretPosition; l_position = UTF8_Utils::nextGrapheme(m_inputText, l_position)) ++l_column;
+
+    const size_t l_targetLine = p_goUp ? l_line - 1 : l_line + 1;
+    const size_t l_targetEnd = m_lineIndex.lineEnd(l_targetLine, m_inputText.size());
+    size_t l_target = m_lineIndex.lineStart(l_targetLine);
+
+    for (; l_column > 0 && l_target < l_targetEnd; --l_column) l_target = UTF8_Utils::nextGrapheme(m_inputText, l_target);
+
+    placeCaret(l_target);
+    m_history.seal();
+
+    return true;
+}
+
+void CKeyboard::scrollToCaret(void)
+{
+    // Scroll the visible lines the least needed to show the line of the caret.
+
+    const size_t l_line = m_lineIndex.lineOf(m_caretPosition);
+
+    if (l_line < m_firstVisibleLine)
+    {
+        m_firstVisibleLine = l_line;
+    }
+    else if (l_line >= m_firstVisibleLine + MULTILINE_VISIBLE_LINES)
+    {
+        m_firstVisibleLine = l_line + 1 - MULTILINE_VISIBLE_LINES;
+    }
+}
+
+int CKeyboard::renderLines(const Sint16 p_x, const Sint16 p_y, const int p_textAreaLength, int& p_caretY) const
+{
+    // 1. Measure the caret offset within its line, and scroll all lines horizontally when it goes beyond the text area.
+    // 2. Render only the visible lines (at most MULTILINE_VISIBLE_LINES), so the cost does not depend on the amount of lines,
+    //    highlighting the current match of the search, if any.
+    // 3. Return the caret offset relative to the visible text, and its vertical offset through the output parameter.
+
+    const int l_lineSkip = m_fonts.getLineSkip();
+    const size_t l_caretLine = m_lineIndex.lineOf(m_caretPosition);
+    const size_t l_lastLine = std::min(m_lineIndex.lineCount(), m_firstVisibleLine + MULTILINE_VISIBLE_LINES);
+
+    const std::string l_caretPrefix = m_inputText.substr(m_lineIndex.lineStart(l_caretLine), m_caretPosition - m_lineIndex.lineStart(l_caretLine));
+
+    const int l_caretX = m_fonts.measure(l_caretPrefix);
+
+    const int l_scroll = std::max(0, l_caretX - p_textAreaLength);
+    size_t l_highlightStart(0);
+    size_t l_highlightEnd(0);
+    const bool l_highlight = getHighlight(l_highlightStart, l_highlightEnd);
+
+    for (size_t l_line = m_firstVisibleLine; l_line < l_lastLine; ++l_line)
+    {
+        const size_t l_start = m_lineIndex.lineStart(l_line);
+        const size_t l_end = m_lineIndex.lineEnd(l_line, m_inputText.size());
+
+        if (l_end == l_start) continue;
+
+        SDL_Surface* l_surfaceTmp = m_fonts.render(m_inputText.substr(l_start, l_end - l_start), Globals::g_colorTextNormal, { COLOR_BG_1 });
+
+        if (l_surfaceTmp == nullptr) continue;
+
+        SDL_Rect l_rect{ l_scroll, 0, p_textAreaLength, l_surfaceTmp->h };
+        SDL_Utils::applySurface(p_x, p_y + static_cast<int>(l_line - m_firstVisibleLine) * l_lineSkip, l_surfaceTmp, Globals::g_screen, &l_rect);
+        SDL_FreeSurface(l_surfaceTmp);
+
+        if (l_highlight) renderHighlight(p_x, p_y + static_cast<int>(l_line - m_firstVisibleLine) * l_lineSkip, l_scroll, p_textAreaLength, l_start, l_end, l_highlightStart, l_highlightEnd);
+    }
+
+    p_caretY = static_cast<int>(l_caretLine - m_firstVisibleLine) * l_lineSkip;
+    return l_caretX - l_scroll;
+}
+
 void CKeyboard::handleUnsupportedEvent(void)
 {
 	m_mustShowCaret = m_showCaret = false; // Always set it to false.
 }
 
-const bool CKeyboard::checkUtf8Code(const unsigned char p_char) const
+void CKeyboard::backgroundChanged(void)
 {
-    // Check whether the passed character in UTF8 coding requires 1 or 2 bytes
-    // in memory to be visually represented.
+    // Replace the solid color the keyboard was first drawn over (the main loop renders the keyboard again over it).
 
-    return (p_char >= 194 && p_char <= 198) || p_char == 208 || p_char == 209;
+    drawBackground();
 }
 
-/*
- * @brief Timer callback for hiding characters in confidential mode
- */
-Uint32 hideCharacters(Uint32 interval, void* param)
+std::string CKeyboard::getKeyText(const unsigned int p_key) const
 {
-    CKeyboard* keyboard = static_cast<CKeyboard*>(param);
-    if (keyboard == nullptr) return 0;
-
-    Uint32 currentTime = SDL_GetTicks();
-    std::string newDisplay(keyboard->m_inputText.length(), '*');
-    bool changed = false;
-
-    // Only the last unmasked character must be masked after 500ms
-    if (!keyboard->m_inputText.empty()) {
-        size_t lastIdx = keyboard->m_inputText.length() - 1;
-        if (currentTime - keyboard->m_charTimestamps[lastIdx] < 500) {
-            newDisplay[lastIdx] = keyboard->m_inputText[lastIdx];
-        } else {
-            changed = true;
-        }
-    }
+    // The layout keeps the text of each key of each key set as a range of its string data.
 
-    if (keyboard->m_displayText != newDisplay) {
-        keyboard->m_displayText = newDisplay;
-        keyboard->renderField();
-    }
+    if (p_key >= m_layout.getKeyCount()) return std::string();
 
-    return interval;
+    return m_layout.getText(m_keySet, p_key);
 }
 
 void CKeyboard::maskInitialText()
 {
-    m_displayText = std::string(m_inputText.length(), '*');
-    m_charTimestamps.resize(m_inputText.length(), SDL_GetTicks() - 1000);
+    // 1. Mask the visible character, if any.
+    // 2. Count the characters of the text (graphemes), from the index built when it was sanitized while it is
+    //    current, and place the caret count at its end (where the caret starts).
+
+    maskCharacter();
+
+    m_maskLength = m_initialIndex.m_offsets.empty() ? UTF8_Utils::countGraphemes(m_inputText) : m_initialIndex.m_graphemes;
+    m_maskCaret = m_maskLength;
+}
+
+void CKeyboard::dropInitialIndex(void)
+{
+    // Release the offsets, which only describe the initial text.
+
+    if (!m_initialIndex.m_offsets.empty()) std::vector<size_t>().swap(m_initialIndex.m_offsets);
 }
 
 void CKeyboard::keyRelease(const SDL_Event& p_event)
 {
-    if (p_event.key.keysym.sym == MYKEY_SELECT && m_confidentialMode) {
-        // Restore confidential (hidden) mode only if we are in password mode
-        maskInitialText();
-        renderField();
-        
-        // Restart the confidential timer to mask new characters
-        if (m_confidentialTimer == 0) {
-            m_confidentialTimer = SDL_AddTimer(100, hideCharacters, this);
+    // Restore confidential (hidden) mode only if we are in password mode, and end the SELECT combos
+
+    if (p_event.key.keysym.sym == MYKEY_SELECT) {
+        m_selectHeld = false;
+
+        if (m_confidentialMode) m_revealText = false;
+    }
+}
+
+void CKeyboard::unmaskCharacter(const std::string& p_character)
+{
+    // 1. Replace the cached glyph of the previously visible character, if any.
+    // 2. Render the typed character once, so the frames until the deadline only blit it.
+    // 3. Start the timer that masks it again when the deadline is reached.
+
+    maskCharacter();
+
+    m_unmaskedGlyph = m_fonts.render(p_character, Globals::g_colorTextNormal, { COLOR_BG_1 });
+    m_unmaskedIndex = m_maskCaret;
+    m_unmaskTimer = m_timers.addTimer(UNMASKTIME, onUnmaskDeadline, this);
+}
+
+void CKeyboard::maskCharacter(void)
+{
+    // 1. Free the glyph of the visible character, so all characters are drawn with the mask glyph.
+    // 2. Stop the unmask timer, if running.
+
+    if (m_unmaskedGlyph != nullptr)
+    {
+        SDL_FreeSurface(m_unmaskedGlyph);
+        m_unmaskedGlyph = nullptr;
+    }
+
+    m_timers.removeTimer(m_unmaskTimer);
+    m_unmaskTimer = 0;
+}
+
+Uint32 CKeyboard::onUnmaskDeadline(Uint32 p_interval, void* p_param)
+{
+    // The deadline was reached: mask the character (the main loop renders the change).
+
+    CKeyboard* l_thisKeyboard = static_cast<CKeyboard*>(p_param);
+    l_thisKeyboard->m_unmaskTimer = 0;
+    l_thisKeyboard->maskCharacter();
+    return 0;
+}
+
+void CKeyboard::exitAfterDelay(const int p_value)
+{
+    // Keep the return value and start the timer that sets it, which ends the main loop.
+
+    m_exitValue = p_value;
+    m_exitDelayTimer = m_timers.addTimer(EXITSOUNDDELAY, onExitDelay, this);
+}
+
+Uint32 CKeyboard::onExitDelay(Uint32 p_interval, void* p_param)
+{
+    // The exit sound had time to play: set the return value, so the main loop ends.
+
+    CKeyboard* l_thisKeyboard = static_cast<CKeyboard*>(p_param);
+    l_thisKeyboard->m_exitDelayTimer = 0;
+    l_thisKeyboard->m_returnValue = l_thisKeyboard->m_exitValue;
+    return 0;
+}
+
+int CKeyboard::renderMaskedText(const Sint16 p_x, const Sint16 p_y, const int p_textAreaLength) const
+{
+    // 1. Compute the caret offset as the amount of characters before it times the mask-glyph advance.
+    // 2. Scroll the text when the caret goes beyond the text area, and find the first glyph to draw.
+    // 3. Blit the mask glyph once per visible character, stopping at the end of the text area.
+    // 4. Draw the unmasked character over its cell, if any (it is masked by a timer when its deadline is reached).
+    // 5. Return the caret offset relative to the visible text.
+
+    if (m_maskGlyph == nullptr || m_maskAdvance <= 0) return 0;
+
+    const int l_caretOffset = static_cast<int>(m_maskCaret) * m_maskAdvance;
+    const int l_scroll = std::max(0, l_caretOffset - p_textAreaLength);
+    const size_t l_first = static_cast<size_t>(l_scroll / m_maskAdvance);
+    const int l_lastX = p_textAreaLength + m_maskAdvance;
+
+    int l_x = static_cast<int>(l_first) * m_maskAdvance - l_scroll;
+
+    for (size_t l_i = l_first; l_i < m_maskLength && l_x < l_lastX; ++l_i, l_x += m_maskAdvance)
+    {
+        SDL_Utils::applySurface(p_x + l_x, p_y, m_maskGlyph, Globals::g_screen);
+    }
+
+    if (m_unmaskedGlyph != nullptr && m_unmaskedIndex >= l_first)
+    {
+        l_x = static_cast<int>(m_unmaskedIndex) * m_maskAdvance - l_scroll;
+
+        if (l_x < l_lastX)
+        {
+            SDL_Rect l_cell{ p_x + l_x, p_y, m_maskAdvance, m_maskGlyph->h };
+            SDL_FillRect(Globals::g_screen, &l_cell, SDL_MapRGB(Globals::g_screen->format, COLOR_BG_1));
+            SDL_Utils::applySurface(p_x + l_x, p_y, m_unmaskedGlyph, Globals::g_screen);
         }
     }
+
+    return l_caretOffset - l_scroll;
 }
 
 void CKeyboard::playNavigationSound()
@@ -1353,13 +1512,444 @@ void CKeyboard::setConfidentialMode(bool mode)
         m_footer = SDL_Utils::createImage(Globals::g_Screen.m_logicalWidth, static_cast<int>(FOOTER_HEIGHT * l_adjustedPpuY), 
                                          SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
         
-        std::string footerText = "A-Press  B-Keyset  Menu-Cancel  L/R-Caret  L2/R2-Edges  Y-Backspace  X-Space  Start-OK";
-        if (mode) {
-            footerText += "  SEL.-Show";
-        }
-        
-        SDL_Utils::applyText(Globals::g_Screen.m_logicalWidth >> 1, 6, m_footer, m_font, footerText.c_str(), 
-                         Globals::g_colorTextTitle, {COLOR_TITLE_BG}, SDL_Utils::ETextAlign::CENTER);
+        drawCenteredText(getFooterText(), Globals::g_Screen.m_logicalWidth >> 1, 6, 1.0f, Globals::g_colorTextTitle, {COLOR_TITLE_BG}, m_footer);
+    }
+}
+
+const bool CKeyboard::pressCaretKey(const bool p_left)
+{
+    // 1. In search mode, L/R go to the previous/next match; while typing the replacement, L skips the match
+    //    and R replaces it.
+    // 2. While SELECT is held, L/R undo/redo.
+    // 3. Otherwise, L/R move the caret.
+
+    switch (m_searchMode)
+    {
+    case ESearchMode::FIND:
+    case ESearchMode::REPLACE_PATTERN:
+        return findMatch(!p_left);
+    case ESearchMode::REPLACE_WITH:
+        return p_left ? findMatch(true) : replaceMatch();
+    default:
+        break;
+    }
+
+    if (m_selectHeld) return p_left ? undoEdit() : redoEdit();
+
+    return moveCaret(p_left);
+}
+
+const bool CKeyboard::startSearch(const ESearchMode p_mode)
+{
+    // 1. Searching is not available in confidential mode (the text is masked).
+    // 2. Start with an empty pattern, remembering where the caret was to restore it on cancel.
+
+    if (m_confidentialMode) return false;
+
+    m_searchMode = p_mode;
+    m_searchPattern.clear();
+    m_replacement.clear();
+    m_matches.clear();
+    m_searchAnchor = m_caretPosition;
+    m_searchEdited = false;
+    m_selectionAnchor = std::string::npos;
+    m_history.seal();
+
+    return true;
+}
+
+const bool CKeyboard::extendSearch(const std::string& p_text)
+{
+    // 1. While typing the replacement, just append the text to it.
+    // 2. Otherwise, append the text to the pattern and look for the new match incrementally:
+    //    a. If the previous pattern had no match, the new one cannot have any either.
+    //    b. If the previous match also matches the new pattern, keep it (the cost is the size of the pattern).
+    //    c. Otherwise, search from the previous match onwards, wrapping around at the end of the text.
+    // 3. Keep the match of each pattern length, so removing chars from the pattern does not search again.
+
+    if (m_searchMode == ESearchMode::REPLACE_WITH)
+    {
+        m_replacement += p_text;
+        return true;
+    }
+
+    const std::string& l_text = m_inputText.str();
+    const size_t l_previous = m_matches.empty() ? m_searchAnchor : m_matches.back().m_position;
+
+    m_searchPattern += p_text;
+
+    size_t l_match(std::string::npos);
+
+    if (l_previous == std::string::npos)
+    {
+        l_match = std::string::npos;
+    }
+    else if (l_text.compare(l_previous, m_searchPattern.size(), m_searchPattern) == 0)
+    {
+        l_match = l_previous;
+    }
+    else
+    {
+        l_match = UTF8_Utils::find(l_text, m_searchPattern, l_previous);
+        if (l_match == std::string::npos) l_match = UTF8_Utils::find(l_text, m_searchPattern);
+    }
+
+    m_matches.push_back(SMatch{ m_searchPattern.size(), l_match });
+    showMatch();
+
+    return true;
+}
+
+const bool CKeyboard::shrinkSearch(void)
+{
+    // 1. While typing the replacement, remove its last char.
+    // 2. Otherwise, go back to the previous length of the pattern and its match (nothing is searched).
+
+    if (m_searchMode == ESearchMode::REPLACE_WITH)
+    {
+        if (m_replacement.empty()) return false;
+
+        m_replacement.erase(UTF8_Utils::previousGrapheme(m_replacement, m_replacement.size()));
+        return true;
+    }
+
+    if (m_matches.empty()) return false;
+
+    m_matches.pop_back();
+    m_searchPattern.resize(m_matches.empty() ? 0 : m_matches.back().m_patternLength);
+    showMatch();
+
+    return true;
+}
+
+const bool CKeyboard::findMatch(const bool p_forward)
+{
+    // Look for the next (or previous) occurrence of the pattern from the current match, wrapping around.
+
+    if (m_matches.empty() || m_matches.back().m_position == std::string::npos) return false;
+
+    const std::string& l_text = m_inputText.str();
+    const size_t l_current = m_matches.back().m_position;
+    size_t l_match(std::string::npos);
+
+    if (p_forward)
+    {
+        l_match = UTF8_Utils::find(l_text, m_searchPattern, l_current + 1);
+        if (l_match == std::string::npos) l_match = UTF8_Utils::find(l_text, m_searchPattern);
+    }
+    else
+    {
+        l_match = l_current > 0 ? l_text.rfind(m_searchPattern, l_current - 1) : std::string::npos;
+        if (l_match == std::string::npos) l_match = l_text.rfind(m_searchPattern);
+    }
+
+    m_matches.back().m_position = l_match;
+    showMatch();
+
+    return true;
+}
+
+const bool CKeyboard::replaceMatch(void)
+{
+    // 1. Replace the current match (the caret is placed at its start, so the character counters stay right).
+    // 2. Look for the next match after the replacement, wrapping around.
+
+    if (m_matches.empty() || m_matches.back().m_position == std::string::npos) return false;
+
+    const size_t l_position = m_matches.back().m_position;
+
+    const size_t l_patternCharacters = UTF8_Utils::countGraphemes(m_searchPattern);
+    const size_t l_replacementCharacters = UTF8_Utils::countGraphemes(m_replacement);
+
+    placeCaret(l_position);
+    eraseText(l_position, m_searchPattern.size());
+    insertText(l_position, m_replacement);
+    m_maskLength = m_maskLength - std::min(m_maskLength, l_patternCharacters) + l_replacementCharacters;
+    m_searchEdited = true;
+
+    const std::string& l_text = m_inputText.str();
+    size_t l_match = UTF8_Utils::find(l_text, m_searchPattern, l_position + m_replacement.size());
+    if (l_match == std::string::npos) l_match = UTF8_Utils::find(l_text, m_searchPattern);
+
+    m_matches.back().m_position = l_match;
+    showMatch();
+
+    return true;
+}
+
+const bool CKeyboard::acceptSearch(void)
+{
+    // 1. When finding, leave the caret after the match and end the search.
+    // 2. When typing the pattern to replace, go on with the replacement (if there is a pattern).
+    // 3. When typing the replacement, replace all the remaining matches and end the search.
+
+    switch (m_searchMode)
+    {
+    case ESearchMode::REPLACE_PATTERN:
+        if (m_searchPattern.empty()) return false;
+        m_searchMode = ESearchMode::REPLACE_WITH;
+        return true;
+    case ESearchMode::REPLACE_WITH:
+        replaceAll();
+        break;
+    default:
+        break;
     }
+
+    m_searchMode = ESearchMode::NONE;
+    m_history.seal();
+    return true;
+}
+
+const bool CKeyboard::cancelSearch(void)
+{
+    // End the search, restoring the caret if the text was not modified meanwhile.
+
+    if (!m_searchEdited) placeCaret(m_searchAnchor);
+
+    m_searchMode = ESearchMode::NONE;
+    m_history.seal();
+    return true;
+}
+
+void CKeyboard::replaceAll(void)
+{
+    // 1. Find all the matches in a single pass over the text, counting the characters before each one.
+    // 2. Replace them from the last one to the first one, so the positions found stay valid and the gap of the
+    //    buffer only travels the text once. The caret is placed at each match, so the history records it.
+    // 3. Recount the characters and leave the caret after the last replacement.
+
+    const std::string& l_text = m_inputText.str();
+    std::vector<size_t> l_matches;
+    std::vector<size_t> l_characters;
+    size_t l_previous(0);
+    size_t l_count(0);
+
+    for (size_t l_match = UTF8_Utils::find(l_text, m_searchPattern); l_match != std::string::npos; l_match = UTF8_Utils::find(l_text, m_searchPattern, l_match + m_searchPattern.size()))
+    {
+        l_count += UTF8_Utils::countGraphemes(l_text.substr(l_previous, l_match - l_previous));
+        l_previous = l_match;
+        l_matches.push_back(l_match);
+        l_characters.push_back(l_count);
+    }
+
+    if (l_matches.empty()) return;
+
+    for (size_t l_index = l_matches.size(); l_index-- > 0;)
+    {
+        m_caretPosition = l_matches[l_index];
+        m_maskCaret = l_characters[l_index];
+        eraseText(l_matches[l_index], m_searchPattern.size());
+        insertText(l_matches[l_index], m_replacement);
+    }
+
+    m_caretPosition = l_matches.back() + (l_matches.size() - 1) * m_replacement.size() - (l_matches.size() - 1) * m_searchPattern.size() + m_replacement.size();
+    m_maskLength = UTF8_Utils::countGraphemes(m_inputText);
+    m_maskCaret = UTF8_Utils::countGraphemes(m_inputText.substr(0, m_caretPosition));
+    m_searchEdited = true;
+    scrollToCaret();
+}
+
+void CKeyboard::showMatch(void)
+{
+    // Place the caret after the current match, so it is scrolled into view.
+
+    if (!m_matches.empty() && m_matches.back().m_position != std::string::npos)
+    {
+        placeCaret(m_matches.back().m_position + m_searchPattern.size());
+    }
+}
+
+const bool CKeyboard::toggleSelection(void)
+{
+    // 1. Selecting is not available in confidential mode (the text is masked), nor while searching.
+    // 2. Clear the selection if there is one; otherwise, anchor it at the caret (moving the caret extends it).
+
+    if (m_confidentialMode || m_searchMode != ESearchMode::NONE) return false;
+
+    m_selectionAnchor = (m_selectionAnchor == std::string::npos) ? m_caretPosition : std::string::npos;
+    return true;
+}
+
+const bool CKeyboard::getSelection(size_t& p_start, size_t& p_end) const
+{
+    // The selection spans from the anchor to the caret, in either direction.
+
+    if (m_selectionAnchor == std::string::npos || m_selectionAnchor == m_caretPosition) return false;
+
+    p_start = std::min(m_selectionAnchor, m_caretPosition);
+    p_end = std::max(m_selectionAnchor, m_caretPosition);
+    return true;
+}
+
+const bool CKeyboard::copySelection(const bool p_erase)
+{
+    // 1. Copy the selected bytes to the clipboard (which persists them, if it has a file).
+    // 2. When cutting, place the caret at the start of the selection and erase it as a single edit,
+    //    so the character counters stay right and undo restores the whole selection.
+
+    size_t l_start(0);
+    size_t l_end(0);
+
+    if (m_confidentialMode || !getSelection(l_start, l_end)) return false;
+
+    const std::string l_text = m_inputText.substr(l_start, l_end - l_start);
+    CClipboard::instance().set(l_text);
+
+    if (p_erase)
+    {
+        placeCaret(l_start);
+        m_history.seal();
+        eraseText(l_start, l_text.size());
+        m_history.seal();
+        m_maskLength -= std::min(m_maskLength, UTF8_Utils::countGraphemes(l_text));
+        scrollToCaret();
+    }
+    else
+    {
+        m_selectionAnchor = std::string::npos;
+    }
+
+    return true;
+}
+
+const bool CKeyboard::pasteClipboard(void)
+{
+    // 1. Insert the text of the clipboard at the caret as a single edit (replacing the selection, if any).
+    // 2. Move the caret after it and update the character counters.
+    // Note: in search mode, the text is added to the pattern (or replacement) instead.
+
+    const std::string& l_text = CClipboard::instance().get();
+
+    if (l_text.empty()) return false;
+
+    if (m_searchMode != ESearchMode::NONE) return extendSearch(l_text);
+
+    size_t l_start(0);
+    size_t l_end(0);
+
+    m_history.seal();
+
+    if (getSelection(l_start, l_end))
+    {
+        const size_t l_characters = UTF8_Utils::countGraphemes(m_inputText.substr(l_start, l_end - l_start));
+
+        placeCaret(l_start);
+        eraseText(l_start, l_end - l_start);
+        m_history.seal();
+        m_maskLength -= std::min(m_maskLength, l_characters);
+    }
+
+    const size_t l_characters = UTF8_Utils::countGraphemes(l_text);
+
+    maskCharacter();
+    insertText(m_caretPosition, l_text);
+    m_history.seal();
+    m_caretPosition += l_text.size();
+    m_maskLength += l_characters;
+    m_maskCaret += l_characters;
+    scrollToCaret();
+
+    return true;
+}
+
+const bool CKeyboard::getHighlight(size_t& p_start, size_t& p_end) const
+{
+    // The current match of the search is highlighted; otherwise, the selection is.
+
+    if (m_searchMode == ESearchMode::NONE || m_matches.empty() || m_matches.back().m_position == std::string::npos) return getSelection(p_start, p_end);
+
+    p_start = m_matches.back().m_position;
+    p_end = p_start + m_searchPattern.size();
+    return true;
+}
+
+void CKeyboard::renderHighlight(const Sint16 p_x, const Sint16 p_y, const int p_scroll, const int p_textAreaLength, const size_t p_lineStart, const size_t p_lineEnd, const size_t p_start, const size_t p_end) const
+{
+    // 1. Clamp the range to the line, and early exit if nothing is left.
+    // 2. Measure where the range starts, relative to the start of the line.
+    // 3. Render the range with the cursor color as background, over the text, clipped to the text area.
+
+    const size_t l_start = std::max(p_start, p_lineStart);
+    const size_t l_end = std::min(p_end, p_lineEnd);
+
+    if (l_start >= l_end) return;
+
+    const int l_offset = m_fonts.measure(m_inputText.substr(p_lineStart, l_start - p_lineStart));
+    SDL_Surface* l_surface = m_fonts.render(m_inputText.substr(l_start, l_end - l_start), Globals::g_colorTextNormal, { COLOR_CURSOR });
+
+    if (l_surface == nullptr) return;
+
+    const int l_left = l_offset - p_scroll;
+    SDL_Rect l_clip{ std::max(0, -l_left), 0, 0, l_surface->h };
+    l_clip.w = std::min(l_surface->w, p_textAreaLength - l_left) - l_clip.x;
+
+    if (l_clip.w > 0)
+    {
+        SDL_Utils::applySurface(p_x + l_left + l_clip.x, p_y, l_surface, Globals::g_screen, &l_clip);
+    }
+
+    SDL_FreeSurface(l_surface);
+}
+
+void CKeyboard::renderSearchBar(const Sint16 p_x, const Sint16 p_fieldY, const int p_width) const
+{
+    // 1. Draw a bar like the text field right above it.
+    // 2. Write the pattern (and the replacement) being typed, and whether the pattern was not found.
+
+    const float l_adjustedPpuX = Globals::g_Screen.getAdjustedPpuX();
+    const float l_adjustedPpuY = Globals::g_Screen.getAdjustedPpuY();
+    const int l_height = static_cast<int>(19 * l_adjustedPpuY);
+
+    SDL_Rect l_rect{ p_x, p_fieldY - l_height - static_cast<int>(2 * l_adjustedPpuY), p_width, l_height };
+    SDL_FillRect(Globals::g_screen, &l_rect, SDL_MapRGB(Globals::g_screen->format, COLOR_BORDER));
+
+    l_rect.x += static_cast<int>(2 * l_adjustedPpuX);
+    l_rect.y += static_cast<int>(2 * l_adjustedPpuY);
+    l_rect.w -= static_cast<int>(4 * l_adjustedPpuX);
+    l_rect.h -= static_cast<int>(4 * l_adjustedPpuY);
+    SDL_FillRect(Globals::g_screen, &l_rect, SDL_MapRGB(Globals::g_screen->format, COLOR_BG_1));
+
+    std::string l_label;
+
+    switch (m_searchMode)
+    {
+    case ESearchMode::FIND:
+        l_label = "Find: " + m_searchPattern;
+        break;
+    case ESearchMode::REPLACE_PATTERN:
+        l_label = "Replace: " + m_searchPattern;
+        break;
+    default:
+        l_label = "Replace \"" + m_searchPattern + "\" with: " + m_replacement;
+        break;
+    }
+
+    if (!m_searchPattern.empty() && (m_matches.empty() || m_matches.back().m_position == std::string::npos))
+    {
+        l_label += "   (not found)";
+    }
+
+    SDL_Surface* l_text = m_fonts.render(l_label, Globals::g_colorTextNormal, { COLOR_BG_1 });
+
+    if (l_text != nullptr)
+    {
+        SDL_Rect l_clip{ 0, 0, std::max(0, l_rect.w - static_cast<int>(3 * l_adjustedPpuX)), l_text->h };
+        SDL_Utils::applySurface(l_rect.x + static_cast<Sint16>(3 * l_adjustedPpuX), l_rect.y + static_cast<Sint16>(2 * l_adjustedPpuY), l_text, Globals::g_screen, &l_clip);
+        SDL_FreeSurface(l_text);
+    }
+}
+
+std::string CKeyboard::getFooterText(void) const
+{
+    // The instructions depend on the confidential and multiline modes.
+
+    std::string l_footerText = m_multiline ?
+        "A-Press  B-Keyset  Menu-Cancel  L/R-Caret  L2/R2-Line  Y-Backspace  X-Space  Start-OK" :
+        "A-Press  B-Keyset  Menu-Cancel  L/R-Caret  L2/R2-Edges  Y-Backspace  X-Space  Start-OK";
+
+    if (m_confidentialMode) l_footerText += "  SEL.-Show";
+
+    return l_footerText;
 }
 
@@ -11,13 +11,18 @@
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
 #include "window.h"
+#include "textBuffer.h"
+#include "lineIndex.h"
+#include "editHistory.h"
+#include "clipboard.h"
+#include "layout.h"
+#include "surfaceCache.h"
+#include "glyphAtlas.h"
+#include "fontChain.h"
+#include "sdfFont.h"
+#include "utf8.h"
 #include <vector>
 
- /*
-  * @brief Constant expression that specifies the amount of key sets in the keyboard.
-  */
-static constexpr auto NB_KEY_SETS = 2;
-
 /*
  * @brief Constant expressions used to control cursor's looping on the keyboard.
  */
@@ -38,8 +43,11 @@ class CKeyboard : public CWindow
     /**
      * @brief             Constructor for the CKeyboard class.
      * @param p_inputText The initial input text for the keyboard.
+     * @param p_multiline TRUE to edit several lines of text (OK inserts a line break and START confirms); otherwise, FALSE.
+     * @param p_index     The code point index of the initial text, built when it was sanitized, which gives its amount
+     *                    of characters without scanning it again (optional).
      */
-    CKeyboard(const std::string &p_inputText);
+    CKeyboard(const std::string &p_inputText, const bool p_multiline = false, const UTF8_Utils::SCodepointIndex* p_index = nullptr);
 
     /**
      * @brief Destructor for the CKeyboard class.
@@ -50,7 +58,7 @@ class CKeyboard : public CWindow
      * @brief  Gets the current input text.
      * @return A reference to the input text string.
      */
-    inline const std::string& getInputText(void) const { return m_inputText; }
+    inline const std::string& getInputText(void) const { return m_inputText.str(); }
 
     /**
      * @brief  Checks if the window is in fullscreen mode.
@@ -74,7 +82,6 @@ class CKeyboard : public CWindow
     /**
      * @brief Set confidential mode for password input
      */
-    void renderField(void) const;
     void setConfidentialMode(bool mode);
 
     /**
@@ -83,19 +90,52 @@ class CKeyboard : public CWindow
     inline void setMessage(const std::string &message) { m_message = message; }
 
     /**
-     * @brief        Hides the initial text if in password mode.
+     * @brief          Sets the memory budget of the keyboards and labels baked for each layout and key set.
+     * @param p_budget The budget, in bytes (0 derives it from the size of the keyboard, as by default).
+     */
+    inline void setLayoutCacheBudget(const size_t p_budget) { m_layoutCacheBudget = p_budget; fitLayoutCache(); }
+
+    /**
+     * @brief        Hides the initial text if in password mode (no character is left unmasked).
      */
     void maskInitialText();
 
     /**
      * @brief         Manages key-release events.
      * @param p_event The SDL event.
-     * @return        TRUE if the key release was handled; otherwise, FALSE.
      */
-    void keyRelease(const SDL_Event& p_event);
+    virtual void keyRelease(const SDL_Event& p_event) override;
 
     private:
 
+    /**
+     * @brief Sub-modes of the keyboard: normal edition, or typing the pattern (or the replacement) of a search.
+     */
+    enum class ESearchMode : Uint8
+    {
+        NONE = 0,        /**< Normal edition */
+        FIND,            /**< Typing the pattern to find */
+        REPLACE_PATTERN, /**< Typing the pattern to replace */
+        REPLACE_WITH     /**< Typing the replacement */
+    };
+
+    /**
+     * @struct SMatch
+     * @brief  Match of the pattern of the search, for a given length of the pattern.
+     */
+    struct SMatch
+    {
+        /**
+         * @brief Length of the pattern, in bytes.
+         */
+        size_t m_patternLength;
+
+        /**
+         * @brief Position of the match, in bytes (std::string::npos if not found).
+         */
+        size_t m_position;
+    };
+
     /**
      * @brief Default constructor (forbidden).
      */
@@ -138,32 +178,97 @@ class CKeyboard : public CWindow
     virtual void handleUnsupportedEvent(void) override;
 
     /**
-     * @brief        Moves the cursor up.
-     * @param p_loop Indicates whether the cursor should loop around.
-     * @return       TRUE if the cursor was moved; otherwise, FALSE.
+     * @brief Draws the background, once it is loaded, under the keyboard.
+     */
+    virtual void backgroundChanged(void) override;
+
+    /**
+     * @brief             Moves the cursor to the neighbour of the selected key, as precomputed by the layout.
+     * @param p_direction The direction.
+     * @param p_loop      Indicates whether the cursor should loop around.
+     * @return            TRUE if the cursor was moved; otherwise, FALSE.
+     */
+    const bool moveCursor(const CLayout::EDirection p_direction, const bool p_loop);
+
+    /**
+     * @brief        Switches to the previous or next installed layout, starting on its first key and key set.
+     * @param p_next TRUE to switch to the next layout; FALSE, to the previous one.
+     * @return       TRUE if the layout was switched; otherwise, FALSE (there is a single layout).
+     */
+    const bool switchLayout(const bool p_next);
+
+    /**
+     * @brief Draws the background image on the screen (or a solid color, if there is none).
+     */
+    void drawBackground(void) const;
+
+    /**
+     * @brief Creates the image of the input text field, which follows the size of the keyboard.
+     */
+    void createTextField(void);
+
+    /**
+     * @brief Sets the budget of the baked keyboards, unless it was set explicitly: enough for every key set of the
+     *        current layout at the size of the screen, plus one more keyboard for the highlighted labels and the
+     *        previous layout (never less than SURFACECACHE_DEFAULT_BUDGET).
      */
-    const bool moveCursorUp(const bool p_loop);
+    void fitLayoutCache(void);
 
     /**
-     * @brief        Moves the cursor down.
-     * @param p_loop Indicates whether the cursor should loop around.
-     * @return       TRUE if the cursor was moved; otherwise, FALSE.
+     * @brief  Gets the keyboard of the current layout and key set, baking it on first use: its keys and their labels.
+     * @return The keyboard (valid until the next surface is baked).
      */
-    const bool moveCursorDown(const bool p_loop);
+    SDL_Surface* getBakedKeyboard(void) const;
 
     /**
-     * @brief        Moves the cursor left.
-     * @param p_loop Indicates whether the cursor should loop around.
-     * @return       TRUE if the cursor was moved; otherwise, FALSE.
+     * @brief  Gets the highlighted face of the selected key, with its label, baking it on first use.
+     * @return The face (valid until the next surface is baked).
      */
-    const bool moveCursorLeft(const bool p_loop);
+    SDL_Surface* getBakedHighlight(void) const;
 
     /**
-     * @brief        Moves the cursor right.
-     * @param p_loop Indicates whether the cursor should loop around.
-     * @return       TRUE if the cursor was moved; otherwise, FALSE.
+     * @brief       Gets the key of a baked surface in the cache: the current layout and key set, and the key.
+     * @param p_key The key, or LAYOUT_NO_KEY for the whole keyboard.
+     * @return      The key in the cache.
      */
-    const bool moveCursorRight(const bool p_loop);
+    inline Uint32 getBakedKey(const unsigned int p_key) const { return (m_layout.getSelected() << 16) | (static_cast<Uint32>(m_keySet) << 8) | p_key; }
+
+    /**
+     * @brief       Gets the label of a key in the current key set ('OK' is labelled 'Enter' in multiline mode).
+     * @param p_key The key.
+     * @return      The label.
+     */
+    std::string getKeyLabel(const unsigned int p_key) const;
+
+    /**
+     * @brief                   Draws a line of text centered on a point: from the distance field of the font, at any size,
+     *                          if it has all its characters; otherwise, with the fallback chain of fonts, at their size.
+     * @param p_text            The text.
+     * @param p_x               The horizontal center of the text.
+     * @param p_y               The top of the text.
+     * @param p_scale           The size of the text, relative to the font of the keyboard.
+     * @param p_foregroundColor The color of the text.
+     * @param p_backgroundColor The background color (only used by the fallback chain).
+     * @param p_destination     The surface to draw on.
+     */
+    void drawCenteredText(const std::string& p_text, const Sint16 p_x, const Sint16 p_y, const float p_scale, const SDL_Color& p_foregroundColor, const SDL_Color& p_backgroundColor, SDL_Surface* p_destination) const;
+
+    /**
+     * @brief               Draws the label of a key: emoji come from the atlas of the colour font, if any, and the rest
+     *                      is drawn like any text (see drawCenteredText).
+     * @param p_key         The key.
+     * @param p_x           The horizontal center of the label.
+     * @param p_y           The top of the label.
+     * @param p_destination The surface to draw on.
+     * @param p_background  The background color of the label.
+     */
+    void drawKeyLabel(const unsigned int p_key, const Sint16 p_x, const Sint16 p_y, SDL_Surface* p_destination, const SDL_Color& p_background) const;
+
+    /**
+     * @brief  Gets the action of the selected key.
+     * @return The action.
+     */
+    inline CLayout::EKeyAction getSelectedAction(void) const { return static_cast<CLayout::EKeyAction>(m_layout.getKey(m_selected).m_action); }
 
     /**
      * @brief            Types a letter or string.
@@ -172,6 +277,59 @@ class CKeyboard : public CWindow
      */
     const bool typeChar(const bool p_addSpace = false);
 
+    /**
+     * @brief        Inserts the text of a key (one or more characters) at the caret and moves the caret after it.
+     * @param p_text The UTF-8 bytes of the text.
+     * @return       TRUE if the text was inserted; otherwise, FALSE.
+     */
+    const bool insertAtCaret(const std::string& p_text);
+
+    /**
+     * @brief            Inserts text in the input text, keeping the line index and the edit history up to date.
+     * @param p_position The position, in bytes (the caret, since the history records the characters before it).
+     * @param p_text     The text to insert.
+     * @param p_record   TRUE to record the edit to undo it; FALSE, when undoing or redoing (optional).
+     */
+    void insertText(const size_t p_position, const std::string& p_text, const bool p_record = true);
+
+    /**
+     * @brief            Erases text from the input text, keeping the line index and the edit history up to date.
+     * @param p_position The position, in bytes (the caret, since the history records the characters before it).
+     * @param p_length   The amount of bytes to erase.
+     * @param p_record   TRUE to record the edit to undo it; FALSE, when undoing or redoing (optional).
+     */
+    void eraseText(const size_t p_position, const size_t p_length, const bool p_record = true);
+
+    /**
+     * @brief Drops the code point index of the initial text, which the first edit makes stale.
+     */
+    void dropInitialIndex(void);
+
+    /**
+     * @brief  Reverts the last edit (SELECT + L).
+     * @return TRUE if an edit was reverted; otherwise, FALSE.
+     */
+    const bool undoEdit(void);
+
+    /**
+     * @brief  Applies again the last reverted edit (SELECT + R).
+     * @return TRUE if an edit was applied; otherwise, FALSE.
+     */
+    const bool redoEdit(void);
+
+    /**
+     * @brief          Applies an edit of the history, or reverts it, and leaves the caret at its end.
+     * @param p_edit   The edit.
+     * @param p_revert TRUE to revert the edit; FALSE, to apply it.
+     */
+    void applyEdit(const CEditHistory::SEdit& p_edit, const bool p_revert);
+
+    /**
+     * @brief            Places the caret at a given position, updating the amount of characters before it.
+     * @param p_position The position, in bytes (a grapheme boundary).
+     */
+    void placeCaret(const size_t p_position);
+
     /**
      * @brief  Removes the last letter from the input text.
      * @return TRUE if a letter was removed; otherwise, FALSE.
@@ -186,11 +344,178 @@ class CKeyboard : public CWindow
     const bool moveCaret(const bool goLeft);
 
     /**
-     * @brief        Checks if a character is a UTF-8 character.
-     * @param p_char The character to check.
-     * @return       TRUE if the character is a UTF-8 character; otherwise, false.
+     * @brief        Moves the caret to the previous or next line, keeping its column when possible (multiline mode).
+     * @param p_goUp Indicates whether the caret should move up; otherwise, it moves down.
+     * @return       TRUE if the caret was moved; otherwise, FALSE.
+     */
+    const bool moveCaretLine(const bool p_goUp);
+
+    /**
+     * @brief Scrolls the visible lines so the line of the caret is shown (multiline mode).
+     */
+    void scrollToCaret(void);
+
+    /**
+     * @brief Renders the visible lines of the input text in multiline mode.
+     * @param p_x              The coordinate on the horizontal axis where the text starts.
+     * @param p_y              The coordinate on the vertical axis where the first visible line starts.
+     * @param p_textAreaLength The width, in pixels, available for the text.
+     * @param p_caretY         Output: the offset of the caret, in pixels, from the first visible line.
+     * @return                 The offset of the caret, in pixels, from the start of the visible text.
      */
-    const bool checkUtf8Code(const unsigned char p_char) const;
+    int renderLines(const Sint16 p_x, const Sint16 p_y, const int p_textAreaLength, int& p_caretY) const;
+
+    /**
+     * @brief        Handles L/R: caret movement, undo/redo (SELECT held), or going through the matches (search mode).
+     * @param p_left Indicates whether L was pressed; otherwise, R was pressed.
+     * @return       TRUE if the key was handled; otherwise, FALSE.
+     */
+    const bool pressCaretKey(const bool p_left);
+
+    /**
+     * @brief        Starts a search (SELECT + L2 to find, SELECT + R2 to replace). Not available in confidential mode.
+     * @param p_mode The search mode.
+     * @return       TRUE if the search started; otherwise, FALSE.
+     */
+    const bool startSearch(const ESearchMode p_mode);
+
+    /**
+     * @brief        Adds text to the pattern (finding its match incrementally) or to the replacement.
+     * @param p_text The text typed.
+     * @return       TRUE if the text was added; otherwise, FALSE.
+     */
+    const bool extendSearch(const std::string& p_text);
+
+    /**
+     * @brief  Removes the last char of the pattern (restoring its previous match) or of the replacement.
+     * @return TRUE if a char was removed; otherwise, FALSE.
+     */
+    const bool shrinkSearch(void);
+
+    /**
+     * @brief           Goes to the next or previous match of the pattern, wrapping around.
+     * @param p_forward Indicates whether to go to the next match; otherwise, it goes to the previous one.
+     * @return          TRUE if there is a match; otherwise, FALSE.
+     */
+    const bool findMatch(const bool p_forward);
+
+    /**
+     * @brief  Replaces the current match and goes to the next one.
+     * @return TRUE if a match was replaced; otherwise, FALSE.
+     */
+    const bool replaceMatch(void);
+
+    /**
+     * @brief  Accepts the pattern (finding ends, or replacing goes on with the replacement) or the replacement (all matches are replaced).
+     * @return TRUE if it was accepted; otherwise, FALSE.
+     */
+    const bool acceptSearch(void);
+
+    /**
+     * @brief  Ends the search, restoring the caret if the text was not modified.
+     * @return TRUE, always.
+     */
+    const bool cancelSearch(void);
+
+    /**
+     * @brief Replaces all the matches of the pattern.
+     */
+    void replaceAll(void);
+
+    /**
+     * @brief  Marks the caret position as the anchor of the selection (SELECT + A), or clears the selection if already marked.
+     * @return TRUE if the selection changed; otherwise, FALSE.
+     */
+    const bool toggleSelection(void);
+
+    /**
+     * @brief         Gets the selected range of the input text (between the anchor and the caret).
+     * @param p_start Output: where the range starts, in bytes.
+     * @param p_end   Output: where the range ends, in bytes.
+     * @return        TRUE if there is a non-empty selection; otherwise, FALSE.
+     */
+    const bool getSelection(size_t& p_start, size_t& p_end) const;
+
+    /**
+     * @brief         Copies the selection to the clipboard (SELECT + X) and, if requested, removes it (SELECT + Y).
+     *                Not available in confidential mode.
+     * @param p_erase Indicates whether to remove the selection from the text (cut).
+     * @return        TRUE if there was a selection; otherwise, FALSE.
+     */
+    const bool copySelection(const bool p_erase);
+
+    /**
+     * @brief  Inserts the text of the clipboard at the caret (SELECT + B).
+     * @return TRUE if the clipboard had text; otherwise, FALSE.
+     */
+    const bool pasteClipboard(void);
+
+    /**
+     * @brief Places the caret after the current match, if any.
+     */
+    void showMatch(void);
+
+    /**
+     * @brief         Gets the range of the input text to highlight.
+     * @param p_start Output: where the range starts, in bytes.
+     * @param p_end   Output: where the range ends, in bytes.
+     * @return        TRUE if there is a range to highlight; otherwise, FALSE.
+     */
+    const bool getHighlight(size_t& p_start, size_t& p_end) const;
+
+    /**
+     * @brief Renders a highlighted range of a line of the input text over it.
+     * @param p_x              The coordinate on the horizontal axis where the line starts.
+     * @param p_y              The coordinate on the vertical axis where the line starts.
+     * @param p_scroll         The horizontal scroll of the text, in pixels.
+     * @param p_textAreaLength The width, in pixels, available for the text.
+     * @param p_lineStart      Where the line starts, in bytes.
+     * @param p_lineEnd        Where the line ends, in bytes.
+     * @param p_start          Where the range starts, in bytes.
+     * @param p_end            Where the range ends, in bytes.
+     */
+    void renderHighlight(const Sint16 p_x, const Sint16 p_y, const int p_scroll, const int p_textAreaLength, const size_t p_lineStart, const size_t p_lineEnd, const size_t p_start, const size_t p_end) const;
+
+    /**
+     * @brief          Renders the bar that shows the pattern and the replacement of the search.
+     * @param p_x      The coordinate on the horizontal axis of the text field.
+     * @param p_fieldY The coordinate on the vertical axis of the text field (the bar is drawn above it).
+     * @param p_width  The width of the text field.
+     */
+    void renderSearchBar(const Sint16 p_x, const Sint16 p_fieldY, const int p_width) const;
+
+    /**
+     * @brief  Gets the instructions shown in the footer, which depend on the current modes.
+     * @return The text of the footer.
+     */
+    std::string getFooterText(void) const;
+
+    /**
+     * @brief Renders the masked input text in confidential mode, by repeating the cached mask glyph.
+     * @param p_x              The coordinate on the horizontal axis where the text starts.
+     * @param p_y              The coordinate on the vertical axis where the text starts.
+     * @param p_textAreaLength The width, in pixels, available for the text.
+     * @return                 The offset of the caret, in pixels, from the start of the text.
+     */
+    int renderMaskedText(const Sint16 p_x, const Sint16 p_y, const int p_textAreaLength) const;
+
+    /**
+     * @brief             Leaves the character typed at a given position visible until the unmask deadline.
+     * @param p_character The UTF-8 bytes of the typed character.
+     */
+    void unmaskCharacter(const std::string& p_character);
+
+    /**
+     * @brief Masks the visible character, if any.
+     */
+    void maskCharacter(void);
+
+    /**
+     * @brief       Gets the text of a key of the current key set.
+     * @param p_key The index of the key.
+     * @return      The UTF-8 text of the key (empty if the key does not type text).
+     */
+    std::string getKeyText(const unsigned int p_key) const;
 
     /**
      * @brief The position of the caret in the input text.
@@ -198,9 +523,19 @@ class CKeyboard : public CWindow
     size_t m_caretPosition;
 
     /**
-     * @brief The image representing the keyboard.
+     * @brief The keyboards and highlighted labels baked for each layout and key set (built on first use).
+     */
+    mutable CSurfaceCache m_bakedLayouts;
+
+    /**
+     * @brief The budget of the baked keyboards set explicitly, in bytes (0 if it is derived from the keyboard).
      */
-    SDL_Surface* m_imageKeyboard;
+    size_t m_layoutCacheBudget;
+
+    /**
+     * @brief The emoji of the labels, rendered from the colour emoji font at first use.
+     */
+    mutable CGlyphAtlas m_emojiAtlas;
 
     /**
      * @brief The image representing the input text field.
@@ -213,9 +548,74 @@ class CKeyboard : public CWindow
     SDL_Surface* m_caret;
 
     /**
-     * @brief The input text.
+     * @brief The input text (a gap buffer, so edits at the caret do not move the rest of the text).
+     */
+    CTextBuffer m_inputText;
+
+    /**
+     * @brief Start of each line of the input text, updated on each edit.
+     */
+    CLineIndex m_lineIndex;
+
+    /**
+     * @brief Edits of the input text, to undo and redo them.
+     */
+    CEditHistory m_history;
+
+    /**
+     * @brief Indicates whether SELECT is held, which turns L/R into undo/redo and A/B/X/Y into the selection and clipboard actions.
+     */
+    bool m_selectHeld;
+
+    /**
+     * @brief Current search mode.
+     */
+    ESearchMode m_searchMode;
+
+    /**
+     * @brief Pattern of the search.
+     */
+    std::string m_searchPattern;
+
+    /**
+     * @brief Replacement of the pattern.
+     */
+    std::string m_replacement;
+
+    /**
+     * @brief Match for each length the pattern had while typing it, so removing chars does not search again.
+     */
+    std::vector<SMatch> m_matches;
+
+    /**
+     * @brief Position of the caret when the search started, in bytes.
      */
-    std::string m_inputText;
+    size_t m_searchAnchor;
+
+    /**
+     * @brief Indicates whether the text was modified by the search (the caret is not restored then).
+     */
+    bool m_searchEdited;
+
+    /**
+     * @brief Position where the selection starts (it ends at the caret), in bytes, or std::string::npos if nothing is selected.
+     */
+    size_t m_selectionAnchor;
+
+    /**
+     * @brief Indicates whether several lines of text can be edited.
+     */
+    bool m_multiline;
+
+    /**
+     * @brief First line shown by the text field in multiline mode.
+     */
+    size_t m_firstVisibleLine;
+
+    /**
+     * @brief Coordinate on the vertical axis of the text field (it grows upwards in multiline mode).
+     */
+    int m_fieldY;
 
     /**
      * @brief The index of the currently selected key.
@@ -228,24 +628,25 @@ class CKeyboard : public CWindow
     SDL_Surface* m_footer;
 
     /**
-     * @brief The key sets available on the keyboard.
+     * @brief The layout of the keys (geometry, texts of each key set, and navigation).
      */
-    std::string m_keySets[NB_KEY_SETS];
+    const CLayout& m_layout;
 
     /**
-     * @brief The currently active key set.
+     * @brief Column kept while moving vertically, in reference pixels (-1 if none), so leaving a wide key goes back
+     *        to the column the cursor came from.
      */
-    unsigned char m_keySet;
+    int m_rememberedColumn;
 
     /**
-     * @brief Pointer to the font used by the keyboard.
+     * @brief The currently active key set.
      */
-    TTF_Font* m_font;
+    unsigned char m_keySet;
 
     /**
-     * @brief Timer for confidential mode character hiding
+     * @brief Fallback chain of fonts, used to draw the text being edited and the labels of the keys.
      */
-    SDL_TimerID m_confidentialTimer;
+    const CFontChain& m_fonts;
 
     /**
      * @brief Confidential mode flag
@@ -253,9 +654,50 @@ class CKeyboard : public CWindow
     bool m_confidentialMode;
 
     /**
-     * @brief Displayed text (can be different from input text in confidential mode)
+     * @brief Indicates whether the whole text is shown in confidential mode (while SELECT is held).
+     */
+    bool m_revealText;
+
+    /**
+     * @brief Amount of characters (graphemes, not bytes) in the input text, used as the number of mask glyphs to draw.
+     */
+    size_t m_maskLength;
+
+    /**
+     * @brief Amount of characters (graphemes, not bytes) before the caret, used to place it after the mask glyphs.
+     */
+    size_t m_maskCaret;
+
+    /**
+     * @brief Code point index of the initial text, which sets the counters above without scanning it. It is dropped
+     *        on the first edit, which makes it stale (no offsets then).
      */
-    std::string m_displayText;
+    UTF8_Utils::SCodepointIndex m_initialIndex;
+
+    /**
+     * @brief Index (in characters) of the only character that may be shown unmasked.
+     */
+    size_t m_unmaskedIndex;
+
+    /**
+     * @brief Timer that masks the unmasked character again when its deadline is reached (0 if not running).
+     */
+    SDL_TimerID m_unmaskTimer;
+
+    /**
+     * @brief Cached glyph of the unmasked character (nullptr if all characters are masked).
+     */
+    SDL_Surface* m_unmaskedGlyph;
+
+    /**
+     * @brief Cached glyph used to mask each character.
+     */
+    SDL_Surface* m_maskGlyph;
+
+    /**
+     * @brief Horizontal advance, in pixels, of the mask glyph.
+     */
+    int m_maskAdvance;
 
     /**
      * @brief Message to display above keyboard
@@ -288,15 +730,35 @@ class CKeyboard : public CWindow
      * @brief Timer for exit delay
      */
     SDL_TimerID m_exitDelayTimer;
-    
-    // Ces variables ont été supprimées car nous voulons des répétitions de son à pleine vitesse
 
     /**
-     * @brief Timestamps for each character in confidential mode
+     * @brief Return value to set when the exit delay ends.
      */
-    std::vector<Uint32> m_charTimestamps;
+    int m_exitValue;
 
-    friend Uint32 hideCharacters(Uint32 interval, void* param);
+    /**
+     * @brief         Leaves the keyboard once the exit sound has had time to play (input is ignored meanwhile).
+     * @param p_value The return value of the keyboard.
+     */
+    void exitAfterDelay(const int p_value);
+
+    /**
+     * @brief            Callback of the exit-delay timer.
+     * @param p_interval The interval of the timer.
+     * @param p_param    The keyboard.
+     * @return           0, to stop the timer.
+     */
+    static Uint32 onExitDelay(Uint32 p_interval, void* p_param);
+
+    /**
+     * @brief            Callback of the unmask timer, called when the unmask deadline is reached.
+     * @param p_interval The interval of the timer.
+     * @param p_param    The keyboard.
+     * @return           0, to stop the timer.
+     */
+    static Uint32 onUnmaskDeadline(Uint32 p_interval, void* p_param);
+    
+    // Ces variables ont été supprimées car nous voulons des répétitions de son à pleine vitesse
 };
 
 #endif // _KEYBOARD_H_
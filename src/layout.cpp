@@ -0,0 +1,762 @@
+/**
+ * @file  layout.cpp
+ * @brief Implementation file for the CLayout class.
+ */
+
+#ifndef _WIN64
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN64
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include "layout.h"
+#include "gridLayout.h"
+#include "utf8.h"
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of the binary image.
+     */
+    const char s_magic[4] = { 'V', 'K', 'B', 'L' };
+
+    /**
+     * @brief Built-in layouts: QWERTY (4 rows of 13 keys, the last key of the first row erases), and a numeric pad
+     *        (4 rows of 3 wider keys, the last key erases). Their tables are generated at compile time.
+     */
+    typedef TGridLayout<4, 13, 2, 12> TQwertyLayout;
+    typedef TGridLayout<4, 3, 2, 11, 39> TNumericLayout;
+
+    static_assert(TQwertyLayout::WIDTH == 265 && TQwertyLayout::HEIGHT == 104, "The QWERTY layout must keep the size of the keyboard");
+
+    constexpr GridLayout_Utils::TTable<CLayout::SKey, TQwertyLayout::KEYS> s_qwertyKeys = TQwertyLayout::getKeys();
+    constexpr GridLayout_Utils::TTable<CLayout::SRow, TQwertyLayout::ROWS> s_qwertyRows = TQwertyLayout::getRows();
+    constexpr GridLayout_Utils::TTable<CLayout::SKey, TNumericLayout::KEYS> s_numericKeys = TNumericLayout::getKeys();
+    constexpr GridLayout_Utils::TTable<CLayout::SRow, TNumericLayout::ROWS> s_numericRows = TNumericLayout::getRows();
+
+    /**
+     * @brief Keyset pages of the built-in layouts, with one grapheme per key of the grid. The QWERTY layout has
+     *        lowercase, uppercase, symbol and emoji pages (one string per row for the last two).
+     */
+    const char* const s_qwertyPages[] = { "1234567890-=\xC2\xABqwertyuiop[]`asdfghjkl;'\\\xC2\xA9zxcvbnm,./\xC2\xA3\xC3\xB1 ",
+                                          "!@#$%^&*()_+\xC2\xABQWERTYUIOP{}~ASDFGHJKL:\"|\xC2\xAEZXCVBNM<>?\xC2\xBF\xC3\x91 ",
+                                          "\xC2\xA1\xC2\xB2\xC2\xB3\xC2\xA4\xE2\x82\xAC\xC2\xBC\xC2\xBD\xC2\xBE\xE2\x80\x98\xE2\x80\x99\xC2\xA5\xC3\x97\xC2\xAB"
+                                          "\xC2\xA7\xC2\xB6\xE2\x80\xA2\xE2\x80\xA6\xE2\x80\x94\xE2\x80\x93\xC2\xB1\xE2\x89\xA0\xE2\x89\x88\xE2\x89\xA4\xE2\x89\xA5\xC3\xB7\xC2\xB0"
+                                          "\xE2\x86\x90\xE2\x86\x91\xE2\x86\x92\xE2\x86\x93\xE2\x99\xA0\xE2\x99\xA3\xE2\x99\xA5\xE2\x99\xA6\xE2\x9C\x93\xE2\x9C\x97\xE2\x98\x85\xE2\x98\x86\xE2\x99\xAA"
+                                          "\xC2\xB5\xC2\xA2\xC2\xA6\xC2\xA8\xC2\xAF\xC2\xB4\xC2\xB8\xC2\xB9\xC2\xBA\xC2\xAA\xC2\xAC\xE2\x84\xA2 ",
+                                          "\xF0\x9F\x98\x80\xF0\x9F\x98\x83\xF0\x9F\x98\x84\xF0\x9F\x98\x81\xF0\x9F\x98\x86\xF0\x9F\x98\x85\xF0\x9F\x98\x82\xF0\x9F\x99\x82\xF0\x9F\x98\x89\xF0\x9F\x98\x8A\xF0\x9F\x98\x8D\xF0\x9F\x98\x98\xC2\xAB"
+                                          "\xF0\x9F\x98\x8E\xF0\x9F\xA4\x94\xF0\x9F\x98\x90\xF0\x9F\x98\xB4\xF0\x9F\x98\xA2\xF0\x9F\x98\xAD\xF0\x9F\x98\xA1\xF0\x9F\x98\xB1\xF0\x9F\xA4\x97\xF0\x9F\x99\x84\xF0\x9F\x98\x87\xF0\x9F\xA5\xB3\xF0\x9F\xA4\xA9"
+                                          "\xF0\x9F\x91\x8D\xF0\x9F\x91\x8E\xF0\x9F\x91\x8C\xF0\x9F\x91\x8F\xF0\x9F\x99\x8F\xF0\x9F\x92\xAA\xF0\x9F\x91\x8B\xE2\x9C\x8C\xEF\xB8\x8F\xE2\x9D\xA4\xEF\xB8\x8F\xF0\x9F\x92\x94\xF0\x9F\x94\xA5\xE2\xAD\x90\xEF\xB8\x8F\xF0\x9F\x8E\x89"
+                                          "\xF0\x9F\x90\xB6\xF0\x9F\x90\xB1\xF0\x9F\x8C\xB9\xF0\x9F\x8D\x95\xF0\x9F\x8D\xBA\xE2\x98\x95\xEF\xB8\x8F\xE2\x9A\xBD\xEF\xB8\x8F\xF0\x9F\x9A\x97\xE2\x9C\x88\xEF\xB8\x8F\xF0\x9F\x8F\xA0\xF0\x9F\x92\xA1\xE2\x9C\x85\xEF\xB8\x8F " };
+    const char* const s_numericPages[] = { "123456789.0\xC2\xAB", "+-*/()=%#,:\xC2\xAB" };
+
+    /**
+     * @brief Labels of the buttons of the built-in layouts.
+     */
+    const char* const s_buttonLabels[] = { "Cancel", "OK" };
+
+    /**
+     * @struct SKeySource
+     * @brief  A key being compiled: its record, and its label and text for each page.
+     */
+    struct SKeySource
+    {
+        CLayout::SKey m_key;
+        std::vector<std::string> m_labels;
+        std::vector<std::string> m_texts;
+    };
+
+    /**
+     * @brief         Parses a number.
+     * @param p_token The token.
+     * @param p_value Output: the number.
+     * @return        TRUE if the token is a number within [0, 32767]; otherwise, FALSE.
+     */
+    bool parseNumber(const std::string& p_token, int& p_value)
+    {
+        char* l_end(nullptr);
+        const long l_value = std::strtol(p_token.c_str(), &l_end, 10);
+
+        if (p_token.empty() || *l_end != '\0' || l_value < 0 || l_value > 32767) return false;
+
+        p_value = static_cast<int>(l_value);
+        return true;
+    }
+
+    /**
+     * @brief         Splits a line into tokens, dropping its comment.
+     * @param p_line  The line.
+     * @param p_tokens Output: the tokens, still escaped.
+     */
+    void tokenize(const std::string& p_line, std::vector<std::string>& p_tokens)
+    {
+        std::string l_token;
+
+        for (size_t l_index = 0; l_index < p_line.size(); ++l_index)
+        {
+            const char l_char = p_line[l_index];
+
+            if (l_char == '\\' && l_index + 1 < p_line.size())
+            {
+                l_token += l_char;
+                l_token += p_line[++l_index];
+            }
+            else if (l_char == '#')
+            {
+                break;
+            }
+            else if (l_char == ' ' || l_char == '\t' || l_char == '\r')
+            {
+                if (!l_token.empty()) p_tokens.push_back(l_token);
+                l_token.clear();
+            }
+            else
+            {
+                l_token += l_char;
+            }
+        }
+
+        if (!l_token.empty()) p_tokens.push_back(l_token);
+    }
+
+    /**
+     * @brief         Unescapes a key token, splitting it into label and text at its first unescaped '|'.
+     * @param p_token The token.
+     * @param p_label Output: the label (the text, if the token has no label).
+     * @param p_text  Output: the text.
+     */
+    void parseKeyToken(const std::string& p_token, std::string& p_label, std::string& p_text)
+    {
+        std::string l_part;
+        bool l_hasLabel(false);
+
+        for (size_t l_index = 0; l_index < p_token.size(); ++l_index)
+        {
+            if (p_token[l_index] == '\\' && l_index + 1 < p_token.size())
+            {
+                const char l_escaped = p_token[++l_index];
+                l_part += (l_escaped == 's') ? ' ' : l_escaped;
+            }
+            else if (p_token[l_index] == '|' && !l_hasLabel)
+            {
+                p_label = l_part;
+                l_part.clear();
+                l_hasLabel = true;
+            }
+            else
+            {
+                l_part += p_token[l_index];
+            }
+        }
+
+        p_text = l_part;
+        if (!l_hasLabel) p_label = l_part;
+    }
+
+    /**
+     * @brief          Measures how far a horizontal position is from the span of a key (doubled, to keep half pixels).
+     * @param p_centre The doubled position.
+     * @param p_key    The key.
+     * @return         The doubled distance (0 if the position lays on the key).
+     */
+    int spanDistance(const int p_centre, const CLayout::SKey& p_key)
+    {
+        const int l_start = 2 * p_key.m_x;
+        const int l_end = 2 * (p_key.m_x + p_key.m_w);
+
+        return p_centre < l_start ? l_start - p_centre : (p_centre >= l_end ? p_centre - l_end + 1 : 0);
+    }
+
+    /**
+     * @brief          Measures how much two keys overlap horizontally.
+     * @param p_first  The first key.
+     * @param p_second The second key.
+     * @return         The overlap, in reference pixels (0 if they do not overlap).
+     */
+    int overlap(const CLayout::SKey& p_first, const CLayout::SKey& p_second)
+    {
+        const int l_overlap = std::min(p_first.m_x + p_first.m_w, p_second.m_x + p_second.m_w) - std::max(p_first.m_x, p_second.m_x);
+        return l_overlap > 0 ? l_overlap : 0;
+    }
+
+    /**
+     * @brief         Finds the key of a row that a key should go to vertically: the one it overlaps the most, then
+     *                the one nearest to its center, then the later one.
+     * @param p_keys  The keys.
+     * @param p_row   The row.
+     * @param p_key   The key.
+     * @return        The key of the row.
+     */
+    Uint8 nearestKey(const std::vector<SKeySource>& p_keys, const CLayout::SRow& p_row, const CLayout::SKey& p_key)
+    {
+        const int l_centre = 2 * p_key.m_x + p_key.m_w;
+        Uint8 l_nearest(p_row.m_first);
+
+        for (unsigned int l_key = p_row.m_first; l_key <= p_row.m_last; ++l_key)
+        {
+            const CLayout::SKey& l_candidate = p_keys[l_key].m_key;
+            const CLayout::SKey& l_best = p_keys[l_nearest].m_key;
+            const int l_candidateOverlap = overlap(p_key, l_candidate);
+            const int l_bestOverlap = overlap(p_key, l_best);
+
+            if (l_candidateOverlap != l_bestOverlap)
+            {
+                if (l_candidateOverlap > l_bestOverlap) l_nearest = static_cast<Uint8>(l_key);
+            }
+            else if (spanDistance(l_centre, l_candidate) != spanDistance(l_centre, l_best))
+            {
+                if (spanDistance(l_centre, l_candidate) < spanDistance(l_centre, l_best)) l_nearest = static_cast<Uint8>(l_key);
+            }
+            else if (std::abs(2 * l_candidate.m_x + l_candidate.m_w - l_centre) <= std::abs(2 * l_best.m_x + l_best.m_w - l_centre))
+            {
+                l_nearest = static_cast<Uint8>(l_key);
+            }
+        }
+
+        return l_nearest;
+    }
+
+    /**
+     * @brief          Appends the bytes of a record to the binary image.
+     * @param p_image  The image.
+     * @param p_record The record.
+     */
+    template<typename T>
+    void append(std::vector<char>& p_image, const T& p_record)
+    {
+        const char* l_bytes = reinterpret_cast<const char*>(&p_record);
+        p_image.insert(p_image.end(), l_bytes, l_bytes + sizeof(T));
+    }
+}
+
+CLayout& CLayout::instance(void)
+{
+    // 1. Create the static instance of the layout.
+    // 2. Return the singleton.
+
+    static CLayout l_singleton;
+    return l_singleton;
+}
+
+CLayout::CLayout(void) :
+    m_selected(0),
+    m_header(nullptr),
+    m_texts(nullptr),
+    m_keys(nullptr),
+    m_rows(nullptr),
+    m_strings(nullptr),
+    m_columns(nullptr),
+    m_ppuX(0.0f),
+    m_ppuY(0.0f)
+{
+    // Install and select the built-in QWERTY layout, so there is always a layout.
+
+    installBuiltIn(EBuiltIn::QWERTY);
+    select(0);
+}
+
+CLayout::~CLayout(void)
+{
+    // Unmap the files, if any.
+
+#ifndef _WIN64
+    for (SInstalled& l_layout : m_installed)
+    {
+        if (l_layout.m_mapping != nullptr)
+        {
+            munmap(l_layout.m_mapping, l_layout.m_mappingSize);
+            l_layout.m_mapping = nullptr;
+        }
+    }
+#endif // _WIN64
+}
+
+const bool CLayout::compile(const std::string& p_source, std::vector<char>& p_image, std::string& p_error)
+{
+    // 1. Parse the directives line by line, placing each key after the previous one, and each row under the previous one.
+    // 2. Check the limits of the format, and that every key fits in the keyboard.
+    // 3. Link each key to its neighbours: the previous/next key of its row, and the key of the previous/next row it
+    //    overlaps the most, wrapping around at the edges of the keyboard.
+    // 4. Write the header, the texts, the keys, the rows and the string data.
+
+    std::vector<SKeySource> l_keys;
+    std::vector<SRow> l_rows;
+    std::vector<int> l_rowHeights;
+    int l_width(0), l_height(0), l_marginX(0), l_marginY(0), l_spacingX(0), l_spacingY(0), l_pages(1);
+    int l_x(0), l_y(0);
+
+    std::istringstream l_stream(p_source);
+    std::string l_line;
+    unsigned int l_lineNumber(0);
+
+    while (std::getline(l_stream, l_line))
+    {
+        ++l_lineNumber;
+
+        std::vector<std::string> l_tokens;
+        tokenize(l_line, l_tokens);
+
+        if (l_tokens.empty()) continue;
+
+        const std::string& l_directive = l_tokens[0];
+        std::ostringstream l_error;
+        l_error << "line " << l_lineNumber << ": ";
+
+        if (l_directive == "size" || l_directive == "margin" || l_directive == "spacing")
+        {
+            int l_first(0), l_second(0);
+
+            if (l_tokens.size() != 3 || !parseNumber(l_tokens[1], l_first) || !parseNumber(l_tokens[2], l_second))
+            {
+                p_error = l_error.str() + "expected '" + l_directive + " <x> <y>'";
+                return false;
+            }
+
+            if (l_directive == "size") { l_width = l_first; l_height = l_second; }
+            else if (l_directive == "margin") { l_marginX = l_first; l_marginY = l_second; }
+            else { l_spacingX = l_first; l_spacingY = l_second; }
+        }
+        else if (l_directive == "pages")
+        {
+            if (l_tokens.size() != 2 || !parseNumber(l_tokens[1], l_pages) || l_pages == 0 || !l_keys.empty())
+            {
+                p_error = l_error.str() + "expected 'pages <count>' before the keys";
+                return false;
+            }
+        }
+        else if (l_directive == "row")
+        {
+            int l_rowHeight(0);
+
+            if (l_tokens.size() != 2 || !parseNumber(l_tokens[1], l_rowHeight))
+            {
+                p_error = l_error.str() + "expected 'row <height>'";
+                return false;
+            }
+
+            if (!l_rows.empty() && l_rows.back().m_first == l_keys.size())
+            {
+                p_error = l_error.str() + "the previous row has no keys";
+                return false;
+            }
+
+            l_y = l_rows.empty() ? l_marginY : l_y + l_rowHeights.back() + l_spacingY;
+            l_x = l_marginX;
+            l_rows.push_back(SRow{ static_cast<Uint8>(l_keys.size()), static_cast<Uint8>(l_keys.size()) });
+            l_rowHeights.push_back(l_rowHeight);
+        }
+        else if (l_directive == "key" || l_directive == "backspace" || l_directive == "cancel" || l_directive == "ok" || l_directive == "page")
+        {
+            const bool l_isText = (l_directive == "key");
+            const size_t l_expected = l_isText ? 2 + l_pages : 3;
+            int l_keyWidth(0);
+
+            if (l_tokens.size() != l_expected || !parseNumber(l_tokens[1], l_keyWidth))
+            {
+                p_error = l_error.str() + (l_isText ? "expected 'key <width>' and one text per page" : "expected '" + l_directive + " <width> <label>'");
+                return false;
+            }
+
+            if (l_rows.empty())
+            {
+                p_error = l_error.str() + "keys must be placed in a row";
+                return false;
+            }
+
+            SKeySource l_source;
+            std::memset(&l_source.m_key, 0, sizeof(l_source.m_key));
+            l_source.m_key.m_x = static_cast<Sint16>(l_x);
+            l_source.m_key.m_y = static_cast<Sint16>(l_y);
+            l_source.m_key.m_w = static_cast<Sint16>(l_keyWidth);
+            l_source.m_key.m_h = static_cast<Sint16>(l_rowHeights.back());
+            l_source.m_key.m_labelX = static_cast<Sint16>(l_x + ((l_keyWidth + 1) >> 1));
+            l_source.m_key.m_labelY = static_cast<Sint16>(l_y + LAYOUT_LABEL_OFFSET);
+            l_source.m_key.m_row = static_cast<Uint8>(l_rows.size() - 1);
+            l_source.m_key.m_action = static_cast<Uint8>(l_isText ? EKeyAction::TEXT : (l_directive == "backspace" ? EKeyAction::BACKSPACE : (l_directive == "cancel" ? EKeyAction::CANCEL : (l_directive == "ok" ? EKeyAction::OK : EKeyAction::PAGE))));
+
+            for (int l_page = 0; l_page < l_pages; ++l_page)
+            {
+                std::string l_label, l_text;
+                parseKeyToken(l_tokens[l_isText ? 2 + l_page : 2], l_label, l_text);
+
+                l_source.m_labels.push_back(l_label);
+                l_source.m_texts.push_back(l_isText ? l_text : std::string());
+            }
+
+            l_keys.push_back(l_source);
+            l_rows.back().m_last = static_cast<Uint8>(l_keys.size() - 1);
+            l_x += l_keyWidth + l_spacingX;
+
+            if (l_keys.size() >= LAYOUT_NO_KEY)
+            {
+                p_error = l_error.str() + "too many keys";
+                return false;
+            }
+
+            if (l_x - l_spacingX > l_width || l_y + l_rowHeights.back() > l_height)
+            {
+                p_error = l_error.str() + "the key does not fit in the keyboard";
+                return false;
+            }
+        }
+        else
+        {
+            p_error = l_error.str() + "unknown directive '" + l_directive + "'";
+            return false;
+        }
+    }
+
+    if (l_keys.empty() || l_rows.back().m_first == l_keys.size() || l_rows.size() >= LAYOUT_NO_KEY)
+    {
+        p_error = "the layout must have keys in every row";
+        return false;
+    }
+
+    const unsigned int l_rowCount = static_cast<unsigned int>(l_rows.size());
+
+    for (SKeySource& l_source : l_keys)
+    {
+        SKey& l_key = l_source.m_key;
+        const SRow& l_row = l_rows[l_key.m_row];
+        const Uint8 l_index = static_cast<Uint8>(&l_source - &l_keys[0]);
+
+        l_key.m_neighbours[LEFT] = (l_row.m_first == l_row.m_last) ? LAYOUT_NO_KEY : (l_index > l_row.m_first ? l_index - 1 : l_row.m_last);
+        l_key.m_neighbours[RIGHT] = (l_row.m_first == l_row.m_last) ? LAYOUT_NO_KEY : (l_index < l_row.m_last ? l_index + 1 : l_row.m_first);
+        l_key.m_neighbours[UP] = (l_rowCount == 1) ? LAYOUT_NO_KEY : nearestKey(l_keys, l_rows[(l_key.m_row + l_rowCount - 1) % l_rowCount], l_key);
+        l_key.m_neighbours[DOWN] = (l_rowCount == 1) ? LAYOUT_NO_KEY : nearestKey(l_keys, l_rows[(l_key.m_row + 1) % l_rowCount], l_key);
+
+        l_key.m_wraps = static_cast<Uint8>(((l_key.m_row == 0) << UP) | ((l_key.m_row + 1u == l_rowCount) << DOWN) | ((l_index == l_row.m_first) << LEFT) | ((l_index == l_row.m_last) << RIGHT));
+    }
+
+    std::string l_strings;
+    std::vector<SText> l_texts;
+
+    for (int l_page = 0; l_page < l_pages; ++l_page)
+    {
+        for (const SKeySource& l_source : l_keys)
+        {
+            SText l_text;
+            l_text.m_textOffset = static_cast<Uint32>(l_strings.size());
+            l_text.m_textLength = static_cast<Uint16>(l_source.m_texts[l_page].size());
+            l_strings += l_source.m_texts[l_page];
+            l_text.m_labelOffset = static_cast<Uint32>(l_strings.size());
+            l_text.m_labelLength = static_cast<Uint16>(l_source.m_labels[l_page].size());
+            l_strings += l_source.m_labels[l_page];
+            l_texts.push_back(l_text);
+        }
+    }
+
+    SHeader l_header;
+    std::memcpy(l_header.m_magic, s_magic, sizeof(s_magic));
+    l_header.m_version = LAYOUT_VERSION;
+    l_header.m_keyCount = static_cast<Uint16>(l_keys.size());
+    l_header.m_rowCount = static_cast<Uint16>(l_rowCount);
+    l_header.m_pageCount = static_cast<Uint16>(l_pages);
+    l_header.m_width = static_cast<Sint16>(l_width);
+    l_header.m_height = static_cast<Sint16>(l_height);
+    l_header.m_stringsSize = static_cast<Uint32>(l_strings.size());
+
+    p_image.clear();
+    append(p_image, l_header);
+    for (const SText& l_text : l_texts) append(p_image, l_text);
+    for (const SKeySource& l_source : l_keys) append(p_image, l_source.m_key);
+    for (const SRow& l_row : l_rows) append(p_image, l_row);
+    p_image.insert(p_image.end(), l_strings.begin(), l_strings.end());
+
+    return true;
+}
+
+const bool CLayout::install(const std::string& p_path)
+{
+    // 1. Map the file (read it, where mapping is not supported).
+    // 2. Check it and point the tables of a new layout to it.
+    // 3. Build its navigation table, and install it after the other layouts.
+
+    SInstalled l_layout{};
+
+#ifdef _WIN64
+    size_t l_size(0);
+    char* l_data = static_cast<char*>(SDL_LoadFile(p_path.c_str(), &l_size));
+
+    if (l_data == nullptr)
+    {
+        SDL_LogError(0, "Could not read layout file %s: %s", p_path.c_str(), SDL_GetError());
+        return false;
+    }
+
+    l_layout.m_image.assign(l_data, l_data + l_size);
+    SDL_free(l_data);
+
+    if (attach(l_layout.m_image.data(), l_layout.m_image.size(), l_layout) == false)
+    {
+        SDL_LogError(0, "Invalid layout file %s", p_path.c_str());
+        return false;
+    }
+#else
+    const int l_file = open(p_path.c_str(), O_RDONLY);
+    struct stat l_status;
+
+    if (l_file < 0 || fstat(l_file, &l_status) != 0 || l_status.st_size <= 0)
+    {
+        SDL_LogError(0, "Could not open layout file %s", p_path.c_str());
+        if (l_file >= 0) close(l_file);
+        return false;
+    }
+
+    const size_t l_size = static_cast<size_t>(l_status.st_size);
+    void* l_mapping = mmap(nullptr, l_size, PROT_READ, MAP_PRIVATE, l_file, 0);
+    close(l_file);
+
+    if (l_mapping == MAP_FAILED)
+    {
+        SDL_LogError(0, "Could not map layout file %s", p_path.c_str());
+        return false;
+    }
+
+    if (attach(static_cast<const char*>(l_mapping), l_size, l_layout) == false)
+    {
+        SDL_LogError(0, "Invalid layout file %s", p_path.c_str());
+        munmap(l_mapping, l_size);
+        return false;
+    }
+
+    l_layout.m_mapping = l_mapping;
+    l_layout.m_mappingSize = l_size;
+#endif // _WIN64
+
+    // Moving the layout keeps the buffers its tables point to
+    buildColumns(l_layout);
+    m_installed.push_back(std::move(l_layout));
+
+    return true;
+}
+
+void CLayout::installBuiltIn(const EBuiltIn p_layout)
+{
+    // Install a layout whose tables are the ones generated at compile time.
+
+    switch (p_layout)
+    {
+    case EBuiltIn::NUMERIC:
+        installTables(s_numericKeys.m_records, TNumericLayout::KEYS, s_numericRows.m_records, TNumericLayout::ROWS, TNumericLayout::WIDTH, TNumericLayout::HEIGHT,
+                      s_numericPages, sizeof(s_numericPages) / sizeof(s_numericPages[0]), s_buttonLabels);
+        break;
+    default:
+        installTables(s_qwertyKeys.m_records, TQwertyLayout::KEYS, s_qwertyRows.m_records, TQwertyLayout::ROWS, TQwertyLayout::WIDTH, TQwertyLayout::HEIGHT,
+                      s_qwertyPages, sizeof(s_qwertyPages) / sizeof(s_qwertyPages[0]), s_buttonLabels);
+        break;
+    }
+}
+
+void CLayout::select(const unsigned int p_layout)
+{
+    // 1. Point the tables to the installed layout.
+    // 2. Scale its geometry, if the previous one was scaled.
+
+    const SInstalled& l_layout = m_installed[p_layout];
+
+    m_selected = p_layout;
+    m_header = l_layout.m_header;
+    m_texts = l_layout.m_texts;
+    m_keys = l_layout.m_keys;
+    m_rows = l_layout.m_rows;
+    m_strings = l_layout.m_strings;
+    m_columns = l_layout.m_columns.data();
+
+    m_geometry.clear();
+    if (m_ppuX > 0.0f) scale(m_ppuX, m_ppuY);
+}
+
+void CLayout::scale(const float p_ppuX, const float p_ppuY)
+{
+    // Scale the rectangles of each key, leaving a border of one reference pixel around its face.
+
+    const int l_borderX = static_cast<int>(1 * p_ppuX);
+    const int l_borderY = static_cast<int>(1 * p_ppuY);
+
+    m_ppuX = p_ppuX;
+    m_ppuY = p_ppuY;
+    m_geometry.resize(m_header->m_keyCount);
+
+    for (unsigned int l_key = 0; l_key < m_header->m_keyCount; ++l_key)
+    {
+        const SKey& l_record = m_keys[l_key];
+        SGeometry& l_geometry = m_geometry[l_key];
+
+        l_geometry.m_frame.x = static_cast<int>(l_record.m_x * p_ppuX);
+        l_geometry.m_frame.y = static_cast<int>(l_record.m_y * p_ppuY);
+        l_geometry.m_frame.w = static_cast<int>(l_record.m_w * p_ppuX);
+        l_geometry.m_frame.h = static_cast<int>(l_record.m_h * p_ppuY);
+
+        l_geometry.m_face.x = l_geometry.m_frame.x + l_borderX;
+        l_geometry.m_face.y = l_geometry.m_frame.y + l_borderY;
+        l_geometry.m_face.w = l_geometry.m_frame.w - 2 * l_borderX;
+        l_geometry.m_face.h = l_geometry.m_frame.h - 2 * l_borderY;
+
+        l_geometry.m_labelX = static_cast<Sint16>(l_record.m_labelX * p_ppuX);
+        l_geometry.m_labelY = static_cast<Sint16>(l_record.m_labelY * p_ppuY);
+    }
+}
+
+std::string CLayout::getText(const unsigned int p_page, const unsigned int p_key) const
+{
+    // The texts of a page are stored together, in the order of the keys.
+
+    const SText& l_text = m_texts[p_page * m_header->m_keyCount + p_key];
+    return std::string(m_strings + l_text.m_textOffset, l_text.m_textLength);
+}
+
+std::string CLayout::getLabel(const unsigned int p_page, const unsigned int p_key) const
+{
+    // The texts of a page are stored together, in the order of the keys.
+
+    const SText& l_text = m_texts[p_page * m_header->m_keyCount + p_key];
+    return std::string(m_strings + l_text.m_labelOffset, l_text.m_labelLength);
+}
+
+const bool CLayout::attach(const char* p_image, const size_t p_size, SInstalled& p_layout)
+{
+    // 1. Check the header, and that the image has the size its header announces.
+    // 2. Check that every string, neighbour and row lays within the image, so the tables can be used unchecked.
+    // 3. Point the tables of the layout to the image.
+
+    if (p_size < sizeof(SHeader)) return false;
+
+    const SHeader* l_header = reinterpret_cast<const SHeader*>(p_image);
+
+    if (std::memcmp(l_header->m_magic, s_magic, sizeof(s_magic)) != 0 || l_header->m_version != LAYOUT_VERSION) return false;
+    if (l_header->m_keyCount == 0 || l_header->m_keyCount >= LAYOUT_NO_KEY || l_header->m_rowCount == 0 || l_header->m_pageCount == 0) return false;
+
+    const size_t l_textCount = static_cast<size_t>(l_header->m_keyCount) * l_header->m_pageCount;
+    const size_t l_textsOffset = sizeof(SHeader);
+    const size_t l_keysOffset = l_textsOffset + l_textCount * sizeof(SText);
+    const size_t l_rowsOffset = l_keysOffset + l_header->m_keyCount * sizeof(SKey);
+    const size_t l_stringsOffset = l_rowsOffset + l_header->m_rowCount * sizeof(SRow);
+
+    if (p_size != l_stringsOffset + l_header->m_stringsSize) return false;
+
+    const SText* l_texts = reinterpret_cast<const SText*>(p_image + l_textsOffset);
+    const SKey* l_keys = reinterpret_cast<const SKey*>(p_image + l_keysOffset);
+    const SRow* l_rows = reinterpret_cast<const SRow*>(p_image + l_rowsOffset);
+
+    for (size_t l_text = 0; l_text < l_textCount; ++l_text)
+    {
+        if (l_texts[l_text].m_textOffset + static_cast<size_t>(l_texts[l_text].m_textLength) > l_header->m_stringsSize) return false;
+        if (l_texts[l_text].m_labelOffset + static_cast<size_t>(l_texts[l_text].m_labelLength) > l_header->m_stringsSize) return false;
+    }
+
+    for (unsigned int l_key = 0; l_key < l_header->m_keyCount; ++l_key)
+    {
+        if (l_keys[l_key].m_row >= l_header->m_rowCount || l_keys[l_key].m_action > static_cast<Uint8>(EKeyAction::PAGE) || l_keys[l_key].m_w <= 0 || l_keys[l_key].m_h <= 0) return false;
+
+        for (const Uint8 l_neighbour : l_keys[l_key].m_neighbours)
+        {
+            if (l_neighbour != LAYOUT_NO_KEY && l_neighbour >= l_header->m_keyCount) return false;
+        }
+    }
+
+    for (unsigned int l_row = 0; l_row < l_header->m_rowCount; ++l_row)
+    {
+        if (l_rows[l_row].m_first > l_rows[l_row].m_last || l_rows[l_row].m_last >= l_header->m_keyCount) return false;
+    }
+
+    p_layout.m_header = l_header;
+    p_layout.m_texts = l_texts;
+    p_layout.m_keys = l_keys;
+    p_layout.m_rows = l_rows;
+    p_layout.m_strings = p_image + l_stringsOffset;
+
+    return true;
+}
+
+void CLayout::installTables(const SKey* p_keys, const unsigned int p_keyCount, const SRow* p_rows, const unsigned int p_rowCount, const Sint16 p_width, const Sint16 p_height,
+                            const char* const* p_pages, const unsigned int p_pageCount, const char* const* p_buttonLabels)
+{
+    // 1. Split each page into one grapheme per key (erasing keys keep it as label only), and take the labels of the buttons.
+    // 2. Build an image with the header, the texts and the string data; the keys and the rows are used in place.
+    // 3. Build its navigation table, and install it after the other layouts.
+
+    std::vector<SText> l_texts;
+    std::string l_strings;
+
+    for (unsigned int l_page = 0; l_page < p_pageCount; ++l_page)
+    {
+        const std::string l_pageText(p_pages[l_page]);
+        size_t l_offset(0);
+
+        for (unsigned int l_key = 0; l_key < p_keyCount; ++l_key)
+        {
+            const EKeyAction l_action = static_cast<EKeyAction>(p_keys[l_key].m_action);
+            std::string l_label;
+
+            if (l_action == EKeyAction::CANCEL || l_action == EKeyAction::OK)
+            {
+                l_label = p_buttonLabels[l_action == EKeyAction::OK ? 1 : 0];
+            }
+            else
+            {
+                const size_t l_next = UTF8_Utils::nextGrapheme(l_pageText, l_offset);
+                l_label = l_pageText.substr(l_offset, l_next - l_offset);
+                l_offset = l_next;
+            }
+
+            SText l_text;
+            l_text.m_textOffset = static_cast<Uint32>(l_strings.size());
+            l_text.m_textLength = static_cast<Uint16>(l_action == EKeyAction::TEXT ? l_label.size() : 0);
+            l_text.m_labelOffset = l_text.m_textOffset;
+            l_text.m_labelLength = static_cast<Uint16>(l_label.size());
+            l_strings += l_label;
+            l_texts.push_back(l_text);
+        }
+    }
+
+    SHeader l_header;
+    std::memcpy(l_header.m_magic, s_magic, sizeof(s_magic));
+    l_header.m_version = LAYOUT_VERSION;
+    l_header.m_keyCount = static_cast<Uint16>(p_keyCount);
+    l_header.m_rowCount = static_cast<Uint16>(p_rowCount);
+    l_header.m_pageCount = static_cast<Uint16>(p_pageCount);
+    l_header.m_width = p_width;
+    l_header.m_height = p_height;
+    l_header.m_stringsSize = static_cast<Uint32>(l_strings.size());
+
+    SInstalled l_layout{};
+    append(l_layout.m_image, l_header);
+    for (const SText& l_text : l_texts) append(l_layout.m_image, l_text);
+    l_layout.m_image.insert(l_layout.m_image.end(), l_strings.begin(), l_strings.end());
+
+    l_layout.m_header = reinterpret_cast<const SHeader*>(l_layout.m_image.data());
+    l_layout.m_texts = reinterpret_cast<const SText*>(l_layout.m_image.data() + sizeof(SHeader));
+    l_layout.m_strings = l_layout.m_image.data() + sizeof(SHeader) + l_texts.size() * sizeof(SText);
+    l_layout.m_keys = p_keys;
+    l_layout.m_rows = p_rows;
+
+    // Moving the layout keeps the buffer its tables point to
+    buildColumns(l_layout);
+    m_installed.push_back(std::move(l_layout));
+}
+
+void CLayout::buildColumns(SInstalled& p_layout)
+{
+    // Fill the span of each key in the table of its row; positions between keys are left without key.
+
+    const unsigned int l_width = static_cast<unsigned int>(std::max<Sint16>(p_layout.m_header->m_width, 0));
+
+    p_layout.m_columns.assign(p_layout.m_header->m_rowCount * l_width, LAYOUT_NO_KEY);
+
+    for (unsigned int l_key = 0; l_key < p_layout.m_header->m_keyCount; ++l_key)
+    {
+        const SKey& l_record = p_layout.m_keys[l_key];
+        const int l_end = std::min<int>(l_record.m_x + l_record.m_w, l_width);
+
+        for (int l_x = std::max<int>(l_record.m_x, 0); l_x < l_end; ++l_x) p_layout.m_columns[l_record.m_row * l_width + l_x] = static_cast<Uint8>(l_key);
+    }
+}
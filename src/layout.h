@@ -0,0 +1,430 @@
+/**
+ * @file  layout.h
+ * @brief Header file for the CLayout class, which describes the keys of the keyboard: their geometry, labels,
+ *        emitted text and navigation.
+ */
+#ifndef _LAYOUT_H_
+#define _LAYOUT_H_
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the version of the binary layout format. Files with another version are rejected.
+ *
+ * @param X The version.
+ */
+#define LAYOUT_VERSION 2
+
+/**
+ * @brief Macro that indicates the value used for "no key" in the tables of the layout (e.g. a missing neighbour).
+ *
+ * @param X The value.
+ */
+#define LAYOUT_NO_KEY 0xFF
+
+/**
+ * @brief Macro that indicates the vertical offset of the labels from the top of their keys.
+ *
+ * @param X The offset, in reference pixels.
+ */
+#define LAYOUT_LABEL_OFFSET 4
+
+/**
+ * @class CLayout
+ * @brief Singleton with the layouts of the keyboard: built-in ones, and ones compiled from a text description into
+ *        a compact binary image. Several layouts may be installed; one of them is selected at a time.
+ *
+ * The binary image is made of fixed-size records that are used in place (it is memory-mapped when loaded from a
+ * file): a header, the text of each key for each page, the key records and the string data. Every rectangle and
+ * every navigation neighbour is computed by the compiler, so rendering and moving the cursor are table lookups.
+ * The image uses the byte order of the machine that compiled it. The tables of the built-in layouts are generated
+ * at compile time (see TGridLayout), so only their texts are built at startup. Installed layouts stay mapped, so
+ * selecting one only points the tables to it.
+ *
+ * The description is a text with one directive per line ('#' starts a comment):
+ *   size <width> <height>   Size of the keyboard, in reference pixels.
+ *   margin <x> <y>          Position of the first key.
+ *   spacing <x> <y>         Gap between keys, and between rows.
+ *   pages <count>           Amount of keyset pages (B goes through them).
+ *   row <height>            Starts a row of keys under the previous one.
+ *   key <width> <text>...   A key that types text, with one token per page. A token may be "label|text".
+ *   backspace <width> <label>, cancel <width> <label>, ok <width> <label>, page <width> <label>
+ *                           Keys that erase the character before the caret, cancel, confirm, and go to the next
+ *                           keyset page, respectively.
+ * Keys may have any width. The neighbour of a key in the previous or next row is the one it overlaps the most.
+ * In tokens, "\s" is a space, and "\\", "\#" and "\|" are the escaped characters.
+ */
+class CLayout
+{
+    public:
+
+    /**
+     * @brief Actions of the keys.
+     */
+    enum class EKeyAction : Uint8
+    {
+        TEXT,
+        BACKSPACE,
+        CANCEL,
+        OK,
+        PAGE
+    };
+
+    /**
+     * @brief Built-in layouts.
+     */
+    enum class EBuiltIn : Uint8
+    {
+        QWERTY,
+        NUMERIC
+    };
+
+    /**
+     * @brief Directions of the navigation, used as indexes of the neighbours of a key.
+     */
+    enum EDirection : Uint8
+    {
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT
+    };
+
+    /**
+     * @struct SKey
+     * @brief  Record of a key in the binary image. Coordinates are in reference pixels, relative to the keyboard.
+     */
+    struct SKey
+    {
+        /**
+         * @brief Rectangle of the key (border included).
+         */
+        Sint16 m_x;
+        Sint16 m_y;
+        Sint16 m_w;
+        Sint16 m_h;
+
+        /**
+         * @brief Position of the label (centered horizontally).
+         */
+        Sint16 m_labelX;
+        Sint16 m_labelY;
+
+        /**
+         * @brief Row of the key.
+         */
+        Uint8 m_row;
+
+        /**
+         * @brief Action of the key (an EKeyAction).
+         */
+        Uint8 m_action;
+
+        /**
+         * @brief Key reached in each direction (indexed by EDirection), or LAYOUT_NO_KEY.
+         */
+        Uint8 m_neighbours[4];
+
+        /**
+         * @brief Bit set for each direction whose neighbour is reached by wrapping around the keyboard.
+         */
+        Uint8 m_wraps;
+
+        /**
+         * @brief Unused (padding).
+         */
+        Uint8 m_reserved;
+    };
+
+    /**
+     * @struct SRow
+     * @brief  Record of a row in the binary image.
+     */
+    struct SRow
+    {
+        /**
+         * @brief First and last key of the row.
+         */
+        Uint8 m_first;
+        Uint8 m_last;
+    };
+
+    /**
+     * @struct SGeometry
+     * @brief  Rectangles and label position of a key, scaled to the screen, relative to the keyboard.
+     */
+    struct SGeometry
+    {
+        /**
+         * @brief Rectangle of the key, border included.
+         */
+        SDL_Rect m_frame;
+
+        /**
+         * @brief Rectangle of the key without its border (also used to highlight it).
+         */
+        SDL_Rect m_face;
+
+        /**
+         * @brief Position of the label.
+         */
+        Sint16 m_labelX;
+        Sint16 m_labelY;
+    };
+
+    /**
+     * @brief  Gets the singleton instance of the layout.
+     * @return Reference to the unique layout instance.
+     */
+    static CLayout& instance(void);
+
+    /**
+     * @brief          Compiles a layout description into its binary image.
+     * @param p_source The description.
+     * @param p_image  Output: the binary image.
+     * @param p_error  Output: the reason of the failure, with its line number, if any.
+     * @return         TRUE if the description was compiled; otherwise, FALSE.
+     */
+    static const bool compile(const std::string& p_source, std::vector<char>& p_image, std::string& p_error);
+
+    /**
+     * @brief        Maps a binary layout file, and installs it after the other layouts (without selecting it).
+     * @param p_path The path of the file.
+     * @return       TRUE if the file was mapped and is valid; otherwise, FALSE.
+     */
+    const bool install(const std::string& p_path);
+
+    /**
+     * @brief          Installs a built-in layout after the other layouts (without selecting it).
+     * @param p_layout The layout.
+     */
+    void installBuiltIn(const EBuiltIn p_layout);
+
+    /**
+     * @brief          Selects an installed layout (the first one, the built-in QWERTY layout, is selected at startup).
+     * @param p_layout The index of the layout.
+     */
+    void select(const unsigned int p_layout);
+
+    /**
+     * @brief  Gets the amount of installed layouts, and the index of the selected one, respectively.
+     * @return The amount, or the index.
+     */
+    inline unsigned int getLayoutCount(void) const { return static_cast<unsigned int>(m_installed.size()); }
+    inline unsigned int getSelected(void) const { return m_selected; }
+
+    /**
+     * @brief          Scales the geometry of the keys to the screen.
+     * @param p_ppuX   Pixels per unit on the horizontal axis.
+     * @param p_ppuY   Pixels per unit on the vertical axis.
+     */
+    void scale(const float p_ppuX, const float p_ppuY);
+
+    /**
+     * @brief  Gets the size of the keyboard, in reference pixels.
+     * @return The width or the height, respectively.
+     */
+    inline Sint16 getWidth(void) const { return m_header->m_width; }
+    inline Sint16 getHeight(void) const { return m_header->m_height; }
+
+    /**
+     * @brief  Gets the amount of keys, rows and pages, respectively.
+     * @return The amount.
+     */
+    inline unsigned int getKeyCount(void) const { return m_header->m_keyCount; }
+    inline unsigned int getRowCount(void) const { return m_header->m_rowCount; }
+    inline unsigned int getPageCount(void) const { return m_header->m_pageCount; }
+
+    /**
+     * @brief       Gets the record of a key.
+     * @param p_key The key.
+     * @return      Reference to the record.
+     */
+    inline const SKey& getKey(const unsigned int p_key) const { return m_keys[p_key]; }
+
+    /**
+     * @brief       Gets the record of a row.
+     * @param p_row The row.
+     * @return      Reference to the record.
+     */
+    inline const SRow& getRow(const unsigned int p_row) const { return m_rows[p_row]; }
+
+    /**
+     * @brief       Gets the key of a row at a horizontal position, so a column can be kept while moving vertically.
+     * @param p_row The row.
+     * @param p_x   The position, in reference pixels.
+     * @return      The key, or LAYOUT_NO_KEY if there is none at the position (e.g. between two keys).
+     */
+    inline Uint8 getKeyAt(const unsigned int p_row, const int p_x) const { return (p_x < 0 || p_x >= m_header->m_width) ? LAYOUT_NO_KEY : m_columns[p_row * m_header->m_width + p_x]; }
+
+    /**
+     * @brief       Gets the geometry of a key, scaled to the screen.
+     * @param p_key The key.
+     * @return      Reference to the geometry.
+     */
+    inline const SGeometry& getGeometry(const unsigned int p_key) const { return m_geometry[p_key]; }
+
+    /**
+     * @brief        Gets the text typed by a key.
+     * @param p_page The keyset page.
+     * @param p_key  The key.
+     * @return       The text (empty for keys that do not type text).
+     */
+    std::string getText(const unsigned int p_page, const unsigned int p_key) const;
+
+    /**
+     * @brief        Gets the label of a key.
+     * @param p_page The keyset page.
+     * @param p_key  The key.
+     * @return       The label.
+     */
+    std::string getLabel(const unsigned int p_page, const unsigned int p_key) const;
+
+    private:
+
+    /**
+     * @struct SHeader
+     * @brief  Header of the binary image.
+     */
+    struct SHeader
+    {
+        char m_magic[4];
+        Uint16 m_version;
+        Uint16 m_keyCount;
+        Uint16 m_rowCount;
+        Uint16 m_pageCount;
+        Sint16 m_width;
+        Sint16 m_height;
+        Uint32 m_stringsSize;
+    };
+
+    /**
+     * @struct SText
+     * @brief  Text and label of a key in a page, as ranges of the string data.
+     */
+    struct SText
+    {
+        Uint32 m_textOffset;
+        Uint32 m_labelOffset;
+        Uint16 m_textLength;
+        Uint16 m_labelLength;
+    };
+
+    /**
+     * @struct SInstalled
+     * @brief  An installed layout: where its image lives, and its tables.
+     */
+    struct SInstalled
+    {
+        /**
+         * @brief The image of a built-in layout (without its keys and rows, which are constant tables), or of a file,
+         *        where mapping is not supported.
+         */
+        std::vector<char> m_image;
+
+        /**
+         * @brief The mapped file, and its size (nullptr if the layout is not mapped).
+         */
+        void* m_mapping;
+        size_t m_mappingSize;
+
+        /**
+         * @brief Tables of the image.
+         */
+        const SHeader* m_header;
+        const SText* m_texts;
+        const SKey* m_keys;
+        const SRow* m_rows;
+        const char* m_strings;
+
+        /**
+         * @brief Key of each row at each horizontal position, in reference pixels (see getKeyAt).
+         */
+        std::vector<Uint8> m_columns;
+    };
+
+    /**
+     * @brief Constructor for the layout, which installs and selects the built-in QWERTY layout.
+     */
+    CLayout(void);
+
+    /**
+     * @brief Destructor for the layout, which unmaps the files, if any.
+     */
+    ~CLayout(void);
+
+    /**
+     * @brief          Copy constructor for the layout (forbidden).
+     * @param p_source The source layout to copy.
+     */
+    CLayout(const CLayout& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the layout (forbidden).
+     * @param p_source The source layout to move resources from.
+     */
+    CLayout(const CLayout&& p_source) = delete;
+
+    /**
+     * @brief          Checks a binary image and points the tables of a layout to it.
+     * @param p_image  The image.
+     * @param p_size   The size of the image, in bytes.
+     * @param p_layout Output: the layout.
+     * @return         TRUE if the image is valid; otherwise, FALSE (the tables are left untouched).
+     */
+    static const bool attach(const char* p_image, const size_t p_size, SInstalled& p_layout);
+
+    /**
+     * @brief                Installs a layout whose keys and rows are tables generated at compile time, building the texts
+     *                       of the keys.
+     * @param p_keys         The keys.
+     * @param p_keyCount     The amount of keys.
+     * @param p_rows         The rows.
+     * @param p_rowCount     The amount of rows.
+     * @param p_width        The width of the keyboard, in reference pixels.
+     * @param p_height       The height of the keyboard, in reference pixels.
+     * @param p_pages        The keyset pages: one grapheme per key, except for the buttons.
+     * @param p_pageCount    The amount of pages.
+     * @param p_buttonLabels The labels of the buttons that cancel and confirm, respectively.
+     */
+    void installTables(const SKey* p_keys, const unsigned int p_keyCount, const SRow* p_rows, const unsigned int p_rowCount, const Sint16 p_width, const Sint16 p_height,
+                       const char* const* p_pages, const unsigned int p_pageCount, const char* const* p_buttonLabels);
+
+    /**
+     * @brief          Builds the table of the key of each row at each horizontal position (once per layout).
+     * @param p_layout The layout.
+     */
+    static void buildColumns(SInstalled& p_layout);
+
+    /**
+     * @brief The installed layouts, and the index of the selected one.
+     */
+    std::vector<SInstalled> m_installed;
+    unsigned int m_selected;
+
+    /**
+     * @brief Tables of the selected layout.
+     */
+    const SHeader* m_header;
+    const SText* m_texts;
+    const SKey* m_keys;
+    const SRow* m_rows;
+    const char* m_strings;
+
+    const Uint8* m_columns;
+
+    /**
+     * @brief Geometry of the keys, scaled to the screen.
+     */
+    std::vector<SGeometry> m_geometry;
+
+    /**
+     * @brief Pixels per unit the geometry was scaled with (0 if it was not scaled yet).
+     */
+    float m_ppuX;
+    float m_ppuY;
+};
+
+#endif // _LAYOUT_H_
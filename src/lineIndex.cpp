@@ -0,0 +1,70 @@
+/**
+ * @file  lineIndex.cpp
+ * @brief Implementation file for the CLineIndex class.
+ */
+
+#include <algorithm>
+#include "lineIndex.h"
+
+CLineIndex::CLineIndex(void) :
+    m_starts(1, 0)
+{
+    // An empty text has one empty line.
+}
+
+void CLineIndex::rebuild(const std::string& p_text)
+{
+    // A line starts at the beginning of the text and after each line break.
+
+    m_starts.assign(1, 0);
+
+    for (size_t l_position = p_text.find('\n'); l_position != std::string::npos; l_position = p_text.find('\n', l_position + 1))
+    {
+        m_starts.push_back(l_position + 1);
+    }
+}
+
+void CLineIndex::insert(const size_t p_position, const std::string& p_text)
+{
+    // 1. Shift the lines that start after the position (a line starting right at it keeps its start).
+    // 2. Add the lines started by the inserted line breaks, right after the line that contains the position.
+
+    std::vector<size_t>::iterator l_next = std::upper_bound(m_starts.begin(), m_starts.end(), p_position);
+
+    for (std::vector<size_t>::iterator l_iterator = l_next; l_iterator != m_starts.end(); ++l_iterator)
+    {
+        *l_iterator += p_text.size();
+    }
+
+    std::vector<size_t> l_newStarts;
+
+    for (size_t l_offset = p_text.find('\n'); l_offset != std::string::npos; l_offset = p_text.find('\n', l_offset + 1))
+    {
+        l_newStarts.push_back(p_position + l_offset + 1);
+    }
+
+    m_starts.insert(l_next, l_newStarts.begin(), l_newStarts.end());
+}
+
+void CLineIndex::erase(const size_t p_position, const size_t p_length)
+{
+    // 1. Remove the lines whose line break was erased (they start in (position, position + length]).
+    // 2. Shift the lines that start after the erased range.
+
+    std::vector<size_t>::iterator l_first = std::upper_bound(m_starts.begin(), m_starts.end(), p_position);
+    std::vector<size_t>::iterator l_last = std::upper_bound(l_first, m_starts.end(), p_position + p_length);
+
+    l_last = m_starts.erase(l_first, l_last);
+
+    for (std::vector<size_t>::iterator l_iterator = l_last; l_iterator != m_starts.end(); ++l_iterator)
+    {
+        *l_iterator -= p_length;
+    }
+}
+
+size_t CLineIndex::lineOf(const size_t p_position) const
+{
+    // The line is the last one that starts at or before the position.
+
+    return static_cast<size_t>(std::upper_bound(m_starts.begin(), m_starts.end(), p_position) - m_starts.begin()) - 1;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file  lineIndex.h
+ * @brief Header file for the CLineIndex class, which keeps the start of each line of the input text.
+ */
+#ifndef _LINEINDEX_H_
+#define _LINEINDEX_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * @class CLineIndex
+ * @brief Sorted byte offsets where each line of a text starts, updated incrementally on each edit.
+ *
+ * Edits only shift the offsets after the edited position and add or remove the ones of the inserted or removed
+ * line breaks, so the text never needs to be scanned again. Looking the line of a position up is a binary search.
+ */
+class CLineIndex
+{
+    public:
+
+    /**
+     * @brief Constructor for the CLineIndex class (one empty line).
+     */
+    CLineIndex(void);
+
+    /**
+     * @brief        Builds the index scanning a whole text.
+     * @param p_text The text.
+     */
+    void rebuild(const std::string& p_text);
+
+    /**
+     * @brief            Updates the index after text was inserted.
+     * @param p_position The position where the text was inserted, in bytes.
+     * @param p_text     The inserted text.
+     */
+    void insert(const size_t p_position, const std::string& p_text);
+
+    /**
+     * @brief            Updates the index after text was erased.
+     * @param p_position The position where the text was erased, in bytes.
+     * @param p_length   The amount of erased bytes.
+     */
+    void erase(const size_t p_position, const size_t p_length);
+
+    /**
+     * @brief  Gets the amount of lines.
+     * @return The amount of lines (at least one).
+     */
+    inline size_t lineCount(void) const { return m_starts.size(); }
+
+    /**
+     * @brief          Gets the position where a line starts.
+     * @param p_line   The line.
+     * @return         The position, in bytes.
+     */
+    inline size_t lineStart(const size_t p_line) const { return m_starts[p_line]; }
+
+    /**
+     * @brief            Gets the position where a line ends (its line break, or the end of the text for the last line).
+     * @param p_line     The line.
+     * @param p_textSize The size of the text, in bytes.
+     * @return           The position, in bytes.
+     */
+    inline size_t lineEnd(const size_t p_line, const size_t p_textSize) const { return p_line + 1 < m_starts.size() ? m_starts[p_line + 1] - 1 : p_textSize; }
+
+    /**
+     * @brief            Gets the line that contains a position.
+     * @param p_position The position, in bytes.
+     * @return           The line.
+     */
+    size_t lineOf(const size_t p_position) const;
+
+    private:
+
+    /**
+     * @brief Position where each line starts, in bytes (the first one is always 0).
+     */
+    std::vector<size_t> m_starts;
+};
+
+#endif // _LINEINDEX_H_
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
@@ -26,14 +27,38 @@
 #include "sdlUtils.h"
 #include "resourceManager.h"
 #include "keyboard.h"
+#include "inputMapper.h"
+#include "utf8.h"
+#include "clipboard.h"
+#include "layout.h"
+#include "resourcePack.h"
+#include "background.h"
 #include "main.h"
 
 int main(int argc, char** argv)
 {
     std::string imagePath;
     std::string inputText;
+    std::string textPath;
+    std::string clipboardPath;
+    std::string layoutPath;
+    std::string layoutSource;
+    std::vector<std::string> layoutPaths;
+    std::string packPath;
+    std::vector<std::string> packFiles;
+    std::string backgroundSource;
+    std::string backgroundPath;
+    std::string backgroundSize;
+    std::vector<std::string> backgroundOptions;
+    std::string capturePath;
+    long backgroundDim = 0;
+    long backgroundBlur = 0;
+    long layoutCacheKiB = -1;
     std::string message;
     bool passwordMode = false;
+    bool multilineMode = false;
+    bool numericMode = false;
+    bool bitmapFontMode = false;
 
     // Nouveau parsing des arguments
     for (int i = 1; i < argc; ++i) {
@@ -41,13 +66,53 @@ int main(int argc, char** argv)
             imagePath = argv[++i];
         } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
             inputText = argv[++i];
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            textPath = argv[++i];
         } else if (strcmp(argv[i], "-p") == 0) {
             passwordMode = true;
+        } else if (strcmp(argv[i], "--multiline") == 0) {
+            multilineMode = true;
+        } else if (strcmp(argv[i], "--clipboard") == 0 && i + 1 < argc) {
+            clipboardPath = argv[++i];
+        } else if (strcmp(argv[i], "--numpad") == 0) {
+            numericMode = true;
+        } else if (strcmp(argv[i], "--bitmap-font") == 0) {
+            bitmapFontMode = true;
+        } else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            layoutPaths.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--layout-cache") == 0 && i + 1 < argc) {
+            layoutCacheKiB = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--compile-layout") == 0 && i + 2 < argc) {
+            layoutSource = argv[++i];
+            layoutPath = argv[++i];
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 2 < argc) {
+            packPath = argv[++i];
+            while (i + 1 < argc) packFiles.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--convert-bg") == 0 && i + 3 < argc) {
+            backgroundSource = argv[++i];
+            backgroundPath = argv[++i];
+            backgroundSize = argv[++i];
+            while (i + 1 < argc && argv[i + 1][0] != '-') backgroundOptions.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--capture-bg") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+        } else if (strcmp(argv[i], "--dim") == 0 && i + 1 < argc) {
+            backgroundDim = strtol(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--blur") == 0 && i + 1 < argc) {
+            backgroundBlur = strtol(argv[++i], nullptr, 10);
         } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
             message = argv[++i];
         }
     }
 
+    // Compile a layout description and exit, without opening the keyboard
+    if (!layoutSource.empty()) return compileLayoutFile(layoutSource, layoutPath) ? 0 : 1;
+
+    // Pack resource files into a resource pack and exit, without opening the keyboard
+    if (!packPath.empty()) return CResourcePack::create(packPath, packFiles) ? 0 : 1;
+
+    // Prepare a background for the screen and exit, without opening the keyboard
+    if (!backgroundPath.empty()) return convertBackgroundFile(backgroundSource, backgroundPath, backgroundSize, backgroundOptions) ? 0 : 1;
+
     // Préparer le chemin de l'image
     std::string imageArg;
     if (!imagePath.empty()) {
@@ -61,7 +126,8 @@ int main(int argc, char** argv)
     int resourceArgc = imageArg.empty() ? 1 : 2;
 
     if (initSDL() == false) return 1;
-    if (TTF_Init() == -1) {
+    // The bitmap font is built in, so SDL_ttf is only initialized for the TTF fonts
+    if (!bitmapFontMode && TTF_Init() == -1) {
         SDL_LogError(0, "Initialization of TTF failed: %s", SDL_GetError());
         return 1;
     }
@@ -71,12 +137,32 @@ int main(int argc, char** argv)
     }
     initJoystick();
     if (initScreen() == false) return 1;
+    CResourceManager::instance().setBitmapFontMode(bitmapFontMode);
+    CResourceManager::instance().setBackgroundCapture(capturePath);
+    CResourceManager::instance().setBackgroundDim(static_cast<int>(std::min(100L, std::max(0L, backgroundDim))));
+    CResourceManager::instance().setBackgroundBlur(static_cast<int>(std::min(static_cast<long>(BACKGROUND_MAX_BLUR), std::max(0L, backgroundBlur))));
     if (CResourceManager::instance().init(resourceArgc, const_cast<char**>(resourceArgv)) == false) return 1;
 
+    // Load the initial text (a file takes precedence over -t) and replace malformed UTF-8 sequences
+    // (the index of the sanitized text gives the keyboard its amount of characters without another scan)
+    if (!textPath.empty() && loadTextFile(textPath, inputText) == false) return 1;
+    UTF8_Utils::SCodepointIndex inputIndex;
+    sanitizeText(inputText, inputIndex);
+
+    // Map the file of the clipboard, if any (the clipboard stays in memory only if it cannot be mapped)
+    if (!clipboardPath.empty()) CClipboard::instance().init(clipboardPath);
+
+    // Install the built-in numeric pad and map the compiled layouts, if any, and start with the first of them
+    // (the built-in QWERTY layout stays installed, and a file that cannot be loaded is skipped)
+    if (numericMode) CLayout::instance().installBuiltIn(CLayout::EBuiltIn::NUMERIC);
+    for (const std::string& path : layoutPaths) CLayout::instance().install(path);
+    if (CLayout::instance().getLayoutCount() > 1) CLayout::instance().select(1);
+
     // Créer et initialiser le clavier
-    CKeyboard* keyboard = new CKeyboard(inputText);
+    CKeyboard* keyboard = new CKeyboard(inputText, multilineMode, &inputIndex);
     keyboard->setConfidentialMode(passwordMode);
     keyboard->setMessage(message);
+    if (layoutCacheKiB >= 0) keyboard->setLayoutCacheBudget(static_cast<size_t>(layoutCacheKiB) * 1024);
     if (passwordMode && !inputText.empty()) {
         keyboard->maskInitialText();
     }
@@ -114,7 +200,7 @@ const bool initSDL(void)
 		SDL_LogError(0, "Could not set SDL_NOMOUSE: %s", SDL_GetError());
 	}
 
-	if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK | SDL_INIT_TIMER) == 0)
+	if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER) == 0)
 	{
 		SDL_Log("SDL initialized successfully.");
 	}
@@ -133,8 +219,9 @@ void initJoystick(void)
 	// 1. Call SDL_NumJoysticks() to get the number of joysticks connected to the system.
 	// 2. If no joysticks are found, log a warning and return early.
 	// 3. Attempt to open the first joystick (index = 0).
-	// 4. If successful, log the joystick's name and its key characteristics. And return.
-	// 5. If it fails, log a warning indicating that the joystick could not be opened.
+	// 4. If successful, log the joystick's name and its key characteristics.
+	// 5. Build the controller mapping for the joystick. And return.
+	// 6. If it fails, log a warning indicating that the joystick could not be opened.
 
 	SDL_Log("Initializing joysticks ...");
 
@@ -151,6 +238,7 @@ void initJoystick(void)
 		SDL_Log("  Number of Axes: %d", SDL_JoystickNumAxes(l_joystick));
 		SDL_Log("  Number of Buttons: %d", SDL_JoystickNumButtons(l_joystick));
 		SDL_Log("  Number of Balls: %d", SDL_JoystickNumBalls(l_joystick));
+		CInputMapper::instance().init(l_joystick, 0);
 		return;
 	}
 
@@ -243,6 +331,45 @@ const bool initScreen(void)
 	return true;
 }
 
+const bool loadTextFile(const std::string& p_path, std::string& p_text)
+{
+	// 1. Load the whole file at once.
+	// 2. If it fails, log an error and early exit (return FALSE).
+	// 3. Copy its contents into the text and free the buffer.
+
+	size_t l_size(0);
+	void* l_data = SDL_LoadFile(p_path.c_str(), &l_size);
+
+	if (l_data == nullptr)
+	{
+		SDL_LogError(0, "Could not load text file %s: %s", p_path.c_str(), SDL_GetError());
+		return false;
+	}
+
+	p_text.assign(static_cast<const char*>(l_data), l_size);
+	SDL_free(l_data);
+	return true;
+}
+
+void sanitizeText(std::string& p_text, UTF8_Utils::SCodepointIndex& p_index)
+{
+	// 1. Validate the text, replacing each malformed byte, and build its code point index in the same pass.
+	// 2. Keep the valid text and log what was found.
+
+	std::string l_valid;
+
+	const size_t l_replaced = UTF8_Utils::sanitize(p_text.data(), p_text.size(), l_valid, &p_index);
+
+	p_text.swap(l_valid);
+
+	INHIBIT(SDL_Log("Initial text: %zu bytes, %zu code points, %zu characters", p_text.size(), p_index.m_count, p_index.m_graphemes);)
+
+	if (l_replaced > 0)
+	{
+		SDL_LogWarn(0, "Replaced %zu malformed UTF-8 bytes in the initial text.", l_replaced);
+	}
+}
+
 const bool initResources(const int argc, char** const argv)
 {
 	// 1. Initialize the TTF-based resource library.
@@ -315,3 +442,71 @@ const int initKeyboard(int argc, char** const argv)
     }
 }
 
+const bool compileLayoutFile(const std::string& p_source, const std::string& p_destination)
+{
+	// 1. Load the description and compile it, reporting the line of the first error, if any.
+	// 2. Write the binary image to the destination file.
+
+	std::string l_description;
+	std::vector<char> l_image;
+	std::string l_error;
+
+	if (loadTextFile(p_source, l_description) == false) return false;
+
+	if (CLayout::compile(l_description, l_image, l_error) == false)
+	{
+		SDL_LogError(0, "Could not compile layout %s: %s", p_source.c_str(), l_error.c_str());
+		return false;
+	}
+
+	SDL_RWops* l_file = SDL_RWFromFile(p_destination.c_str(), "wb");
+
+	if (l_file == nullptr)
+	{
+		SDL_LogError(0, "Could not create layout file %s: %s", p_destination.c_str(), SDL_GetError());
+		return false;
+	}
+
+	const bool l_written = (SDL_RWwrite(l_file, l_image.data(), 1, l_image.size()) == l_image.size());
+	SDL_RWclose(l_file);
+
+	if (l_written == false) SDL_LogError(0, "Could not write layout file %s: %s", p_destination.c_str(), SDL_GetError());
+
+	return l_written;
+}
+
+const bool convertBackgroundFile(const std::string& p_source, const std::string& p_destination, const std::string& p_size, const std::vector<std::string>& p_options)
+{
+	// 1. Read the size of the screen (WIDTHxHEIGHT).
+	// 2. Read the options: the encoding (raw by default) and the pixel format of the screen (XRGB8888 by default).
+	// 3. Convert the image.
+
+	char* l_end(nullptr);
+	const long l_width = strtol(p_size.c_str(), &l_end, 10);
+	const long l_height = (*l_end == 'x') ? strtol(l_end + 1, &l_end, 10) : 0;
+
+	if (*l_end != '\0' || l_width <= 0 || l_height <= 0 || l_width > BACKGROUND_MAX_SIZE || l_height > BACKGROUND_MAX_SIZE)
+	{
+		SDL_LogError(0, "Invalid background size %s (expected WIDTHxHEIGHT)", p_size.c_str());
+		return false;
+	}
+
+	Background_Utils::ECompression l_compression = Background_Utils::ECompression::NONE;
+	Uint32 l_format = SDL_PIXELFORMAT_XRGB8888;
+
+	for (const std::string& l_option : p_options)
+	{
+		if (l_option == "raw") l_compression = Background_Utils::ECompression::NONE;
+		else if (l_option == "qoi") l_compression = Background_Utils::ECompression::QOI;
+		else if (l_option == "xrgb8888") l_format = SDL_PIXELFORMAT_XRGB8888;
+		else if (l_option == "argb8888") l_format = SDL_PIXELFORMAT_ARGB8888;
+		else if (l_option == "rgb565") l_format = SDL_PIXELFORMAT_RGB565;
+		else
+		{
+			SDL_LogError(0, "Unknown background option %s (expected raw, qoi, xrgb8888, argb8888 or rgb565)", l_option.c_str());
+			return false;
+		}
+	}
+
+	return Background_Utils::convert(p_source, p_destination, static_cast<int>(l_width), static_cast<int>(l_height), l_format, l_compression);
+}
@@ -54,6 +54,39 @@ void initJoystick(void);
  */
 const bool initScreen(void);
 
+/**
+ * @brief        Loads the contents of a text file.
+ * @param p_path The path of the file.
+ * @param p_text Output: the contents of the file.
+ * @return       TRUE if the file was loaded; otherwise, FALSE.
+ */
+const bool loadTextFile(const std::string& p_path, std::string& p_text);
+
+/**
+ * @brief         Replaces the malformed UTF-8 sequences of a text, so the caret and the renderer only see valid text.
+ * @param p_text  The text to sanitize.
+ * @param p_index Output: the code point index of the sanitized text (built in the same pass).
+ */
+void sanitizeText(std::string& p_text, UTF8_Utils::SCodepointIndex& p_index);
+
+/**
+ * @brief               Compiles a layout description into a binary layout file (--compile-layout).
+ * @param p_source      The path of the description.
+ * @param p_destination The path of the binary file.
+ * @return              TRUE if the layout was compiled and written; otherwise, FALSE.
+ */
+const bool compileLayoutFile(const std::string& p_source, const std::string& p_destination);
+
+/**
+ * @brief               Prepares a background for a screen from an image (--convert-bg).
+ * @param p_source      The path of the image (PNG, JPEG or any other format SDL_image reads).
+ * @param p_destination The path of the prepared background.
+ * @param p_size        The size of the screen, as WIDTHxHEIGHT.
+ * @param p_options     The encoding (raw or qoi) and the pixel format of the screen (xrgb8888, argb8888 or rgb565).
+ * @return              TRUE if the background was written; otherwise, FALSE.
+ */
+const bool convertBackgroundFile(const std::string& p_source, const std::string& p_destination, const std::string& p_size, const std::vector<std::string>& p_options);
+
 /**
  * @brief      Initializes resources.
  * @param argc The amount of external arguments passed when executed the program.
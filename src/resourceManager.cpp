@@ -8,36 +8,30 @@
 #define shrinkSurface GFX_shrinkSurface
 #endif // _WIN64
 
+#include <algorithm>
 #include <iostream>
-#include <SDL_image.h>
 #include <SDL2_rotozoom.h>
 #include "resourceManager.h"
 #include "def.h"
 #include "screen.h"
 #include "sdlUtils.h"
+#include "resourcePack.h"
+#include "background.h"
 
 namespace
 {
     /**
-     * @brief      Loads an icon from the specified path.
-     * @param path The path to the icon file.
-     * @return     Pointer to the loaded SDL Surface, or a nullptr if loading fails.
+     * @brief Fonts tried, in order, for the characters the main font does not provide (the ones not installed in the
+     *        folder of the resources are skipped).
      */
-    SDL_Surface* LoadIcon(const char* path) 
+    const char* const s_fallbackFonts[] =
     {
-        // 1. Load the image with the provided path.
-        // 2. Check whether and image was properly loaded.
-        // 3. Return the pointer (a valid one or a null pointer).
-
-        SDL_Surface* l_image = IMG_Load(path);
-
-        if(l_image == nullptr)
-        {
-            SDL_LogError(0, "LoadIcon: %s", IMG_GetError());
-        }
-
-        return l_image;
-    }
+        "NotoSans-Regular.ttf",
+        "NotoSansSymbols-Regular.ttf",
+        "NotoSansSymbols2-Regular.ttf",
+        "NotoSansCJK-Regular.ttc",
+        "unifont.ttf"
+    };
 } // namespace
 
 CResourceManager& CResourceManager::instance(void)
@@ -50,7 +44,7 @@ CResourceManager& CResourceManager::instance(void)
 }
 
 CResourceManager::CResourceManager(void) :
-    m_font(nullptr), m_surfaces() 
+    m_font(nullptr), m_surfaces(), m_backgroundThread(nullptr), m_backgroundPath(), m_capturePath(), m_backgroundDim(0), m_backgroundBlur(0), m_loadedBackground(nullptr), m_backgroundEvent(static_cast<Uint32>(-1)), m_emojiFont(0), m_fontChain(), m_fontAtlas(), m_sdfFont(), m_sdfFontLoaded(false), m_bitmapFont(), m_bitmapFontMode(false)
 { 
     // Nothing to do here. Let us the object be properly instantiated.
 	// And create all resources when needed, elsewhere.
@@ -58,13 +52,27 @@ CResourceManager::CResourceManager(void) :
 
 const bool CResourceManager::init(const int argc, char** const argv)
 {
+	// 0. Mount the resource pack, if there is one: the resources below are served from it, unless a loose file
+	//    overrides them.
 	// 1. Try to get the background image path from the command line arguments.
-	// 2. If not provided, use the default one.
-	// 3. Load the background image and assign it to the proper slot in the array.
-	// 4. Load the font and assign it to the corresponding member.
-	// 5. If any of the loading operation fails, return FALSE. Otherwise, return TRUE.
+	// 2. If not provided, use the default one (prepared, if it was converted; see Background_Utils).
+	// 3. Capture the screen as the background, if asked, here: before the keyboard draws over it. Otherwise (or if it
+	//    cannot be captured), load the background on a thread, so the keyboard is drawn over a solid color meanwhile,
+	//    and assign it to the proper slot in the array when the main loop receives it (see adoptBackground). Without a
+	//    thread, load it here. The background is blurred and darkened as asked either way (once: a loaded background
+	//    is cached with its effects, see Background_Utils::loadWithEffects).
+	// 4. In bitmap font mode, expand the built-in font, scaled like the TTF font would be, and draw all text with it:
+	//    no font file is read and SDL_ttf is not needed.
+	// 5. If the embedded atlas was rasterized at the size of the font, text is drawn from it and the font is deferred
+	//    to the first character the atlas lacks. Otherwise, load the font and assign it to the corresponding member.
+	// 6. Build the rest of the fallback chain, deferred: the fallback fonts at the same size, and the colour emoji font
+	//    (the ones that are not installed are skipped when they are first needed).
+	// 7. If any of the mandatory loading operations fails, return FALSE. Otherwise, return TRUE.
+	// Note: the distance field of the main font is loaded when it is first needed (see getSdfFont).
+
+    CResourcePack::instance().mount(RES_DIR RESOURCEPACK_NAME);
 
-    const char* l_backgroundPath = (argc > 1) ? argv[1] : "background_default.png";
+    const char* l_backgroundPath = (argc > 1) ? argv[1] : "background_default" BACKGROUND_EXT;
     std::string l_shortPath;
     if (l_backgroundPath[0] == '/' || l_backgroundPath[0] == '\\') {
         l_shortPath = l_backgroundPath;
@@ -72,25 +80,97 @@ const bool CResourceManager::init(const int argc, char** const argv)
         l_shortPath = RES_DIR;
         l_shortPath.append(l_backgroundPath);
     }
-    m_surfaces[T_SURFACE_BACKGROUND] = LoadIcon(l_shortPath.c_str());
-    m_font = SDL_Utils::loadFont(RES_DIR "DejaVuSans.ttf", static_cast<int>(FONT_SIZE * Globals::g_Screen.getAdjustedPpuY()));
+    if (argc <= 1) {
+        SDL_RWops* l_prepared = CResourcePack::instance().open(l_shortPath);
+        if (l_prepared != nullptr) SDL_RWclose(l_prepared);
+        else l_shortPath = RES_DIR "background_default.png";
+    }
+    m_backgroundPath = l_shortPath;
+
+    if (!m_capturePath.empty())
+    {
+        m_surfaces[T_SURFACE_BACKGROUND] = Background_Utils::blur(Background_Utils::capture(m_capturePath, Globals::g_Screen.m_logicalWidth, Globals::g_Screen.m_logicalHeight, m_backgroundDim), m_backgroundBlur);
+    }
+
+    if (m_surfaces[T_SURFACE_BACKGROUND] == nullptr)
+    {
+        m_backgroundEvent = SDL_RegisterEvents(1);
+
+        if (m_backgroundEvent != static_cast<Uint32>(-1))
+        {
+            m_backgroundThread = SDL_CreateThread(loadBackground, "background", this);
+        }
+
+        if (m_backgroundThread == nullptr)
+        {
+            m_surfaces[T_SURFACE_BACKGROUND] = Background_Utils::loadWithEffects(m_backgroundPath, Globals::g_Screen.m_logicalWidth, Globals::g_Screen.m_logicalHeight, m_backgroundBlur, m_backgroundDim);
+        }
+    }
+
+    if (m_bitmapFontMode)
+    {
+        const int l_scale = std::max(1, static_cast<int>(FONT_SIZE * Globals::g_Screen.getAdjustedPpuY() / BITMAPFONT_GLYPH_SIZE + 0.5f));
+
+        if (!m_bitmapFont.init(l_scale))
+        {
+            SDL_LogError(0, "Could not expand the bitmap font: %s", SDL_GetError());
+            return false;
+        }
+
+        m_fontChain.setBitmapFont(&m_bitmapFont);
+        return true;
+    }
+
+    const int l_fontSize = static_cast<int>(FONT_SIZE * Globals::g_Screen.getAdjustedPpuY());
+
+    if (m_fontAtlas.isLoaded() && m_fontAtlas.getSize() == l_fontSize)
+    {
+        m_fontChain.setAtlas(&m_fontAtlas);
+        m_fontChain.add(RES_DIR "DejaVuSans.ttf", l_fontSize);
+    }
+    else
+    {
+        m_font = SDL_Utils::loadFont(RES_DIR "DejaVuSans.ttf", l_fontSize);
+
+        if(m_font == nullptr)
+        {
+            SDL_LogError(0, "Could not load keyboard's font: %s", TTF_GetError());
+            return false;
+        }
+
+        m_fontChain.add(m_font, RES_DIR "DejaVuSans.ttf");
+    }
 
-    if(m_font == nullptr)
+    for (const char* l_name : s_fallbackFonts)
     {
-        SDL_LogError(0, "Could not load keyboard's font: %s", TTF_GetError());
-        return false;
+        m_fontChain.add(std::string(RES_DIR) + l_name, l_fontSize);
     }
 
+    m_emojiFont = static_cast<unsigned int>(m_fontChain.getFontCount());
+    m_fontChain.add(RES_DIR "NotoColorEmoji.ttf", EMOJI_FONT_SIZE, true);
+
     return true;
 }
 
 void CResourceManager::sdlCleanup(void)
 {
-	// 1. Free all surfaces in the array.
-	// 2. Free the TTF font.
-	// 3. Set all pointers to nullptr.
+	// 1. Wait for the background thread, if it is still running, and free the background it loaded, if the main loop
+	//    did not take it.
+	// 2. Free all surfaces in the array.
+	// 3. Empty the fallback chain and free the TTF fonts.
+	// 4. Set all pointers to nullptr.
 
     INHIBIT(SDL_Log("Cleaning up resources ...");)
+
+    if (m_backgroundThread != nullptr)
+    {
+        SDL_WaitThread(m_backgroundThread, nullptr);
+        m_backgroundThread = nullptr;
+    }
+
+    SDL_Surface* l_loadedBackground = static_cast<SDL_Surface*>(SDL_AtomicSetPtr(&m_loadedBackground, nullptr));
+
+    if (l_loadedBackground != nullptr) SDL_FreeSurface(l_loadedBackground);
     
     // Free surfaces
     for (int l_i = 0; l_i < NB_SURFACES; ++l_i)
@@ -102,7 +182,13 @@ void CResourceManager::sdlCleanup(void)
         }
     }
 
-    // Free font
+    // Free fonts
+    m_fontChain.clear();
+    m_sdfFont.clear();
+    m_sdfFontLoaded = false;
+    m_bitmapFont.clear();
+    m_emojiFont = 0;
+
     if (m_font != nullptr)
     {
         TTF_CloseFont(m_font);
@@ -110,6 +196,23 @@ void CResourceManager::sdlCleanup(void)
     }
 }
 
+const CSdfFont& CResourceManager::getSdfFont(void)
+{
+    // Load the distance field at the first call (generated on first run), once. There is none in bitmap font mode.
+
+    if (!m_sdfFontLoaded && !m_bitmapFontMode)
+    {
+        m_sdfFontLoaded = true;
+
+        if (!m_sdfFont.load(RES_DIR "DejaVuSans.ttf"))
+        {
+            SDL_LogWarn(0, "No distance field for the keyboard's font; text is drawn at a single size");
+        }
+    }
+
+    return m_sdfFont;
+}
+
 SDL_Surface* CResourceManager::getSurface(const T_SURFACE p_surface) const  
 {  
    // 1. Check whether the surface type is valid.  
@@ -124,3 +227,43 @@ SDL_Surface* CResourceManager::getSurface(const T_SURFACE p_surface) const
 
    return m_surfaces[p_surface];  
 }
+
+const bool CResourceManager::adoptBackground(const SDL_Event& p_event)
+{
+    // 1. Ignore any other event.
+    // 2. Wait for the thread, which is done, and take the background it loaded (if it could), replacing the solid
+    //    color.
+
+    if (p_event.type != m_backgroundEvent || m_backgroundThread == nullptr) return false;
+
+    SDL_WaitThread(m_backgroundThread, nullptr);
+    m_backgroundThread = nullptr;
+
+    SDL_Surface* l_background = static_cast<SDL_Surface*>(SDL_AtomicSetPtr(&m_loadedBackground, nullptr));
+
+    if (l_background != nullptr)
+    {
+        if (m_surfaces[T_SURFACE_BACKGROUND] != nullptr) SDL_FreeSurface(m_surfaces[T_SURFACE_BACKGROUND]);
+        m_surfaces[T_SURFACE_BACKGROUND] = l_background;
+    }
+
+    return true;
+}
+
+int CResourceManager::loadBackground(void* p_manager)
+{
+    // 1. Load the background (decoding and scaling it, if it is not a prepared one), blurred and darkened as asked.
+    // 2. Hand it to the main loop, and wake it up with the event.
+
+    CResourceManager* l_manager = static_cast<CResourceManager*>(p_manager);
+    SDL_Surface* l_background = Background_Utils::loadWithEffects(l_manager->m_backgroundPath, Globals::g_Screen.m_logicalWidth, Globals::g_Screen.m_logicalHeight, l_manager->m_backgroundBlur, l_manager->m_backgroundDim);
+
+    SDL_AtomicSetPtr(&l_manager->m_loadedBackground, l_background);
+
+    SDL_Event l_event;
+    SDL_zero(l_event);
+    l_event.type = l_manager->m_backgroundEvent;
+    SDL_PushEvent(&l_event);
+
+    return 0;
+}
@@ -4,8 +4,14 @@
 #ifndef _RESOURCEMANAGER_H_
 #define _RESOURCEMANAGER_H_
 
+#include <string>
+#include <vector>
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include "fontChain.h"
+#include "sdfFont.h"
+#include "bitmapFont.h"
+#include "fontAtlas.h"
 
 /**
  * @brief Macro that indicates the number of surface resources to load.
@@ -21,6 +27,14 @@
    */
 #define FONT_SIZE 8
 
+/**
+ * @brief Macro that indicates the size of the colour emoji font to load (colour bitmap fonts only have this size;
+ *        their glyphs are scaled to the size of the text when drawn).
+ *
+ * @param X Specifies the size, in pixels, of the font to load.
+ */
+#define EMOJI_FONT_SIZE 109
+
 /**
  * @class Singleton used to manage resources.
  * @brief Manages resources such as surfaces and fonts.
@@ -54,6 +68,39 @@ class CResourceManager
      */
     const bool init(const int p_argumentCount, char** const p_argumentValues);
 
+    /**
+     * @brief         Selects the bitmap font mode, before initialization: all text is drawn with the font built in
+     *                SDL2_gfx, and no TTF font is loaded (so SDL_ttf does not need to be initialized).
+     * @param p_state TRUE to select the bitmap font mode; otherwise, FALSE.
+     */
+    inline void setBitmapFontMode(const bool p_state) { m_bitmapFontMode = p_state; }
+
+    /**
+     * @brief        Selects, before initialization, a framebuffer (device or dump) whose screen is captured as the
+     *               background, instead of an image (see Background_Utils::capture).
+     * @param p_path The path of the framebuffer (empty to load the image).
+     */
+    inline void setBackgroundCapture(const std::string& p_path) { m_capturePath = p_path; }
+
+    /**
+     * @brief           Sets, before initialization, how much the background is darkened, so the keyboard stands out.
+     * @param p_percent How much to darken it, in percent (0 leaves it as it is).
+     */
+    inline void setBackgroundDim(const int p_percent) { m_backgroundDim = p_percent; }
+
+    /**
+     * @brief          Sets, before initialization, how much the background is blurred, so the keyboard stays readable
+     *                 over busy images (see Background_Utils::blur).
+     * @param p_radius The radius of the blur, in pixels (0 leaves it sharp).
+     */
+    inline void setBackgroundBlur(const int p_radius) { m_backgroundBlur = p_radius; }
+
+    /**
+     * @brief  Indicates whether all text is drawn with the built-in bitmap font.
+     * @return TRUE in bitmap font mode; otherwise, FALSE.
+     */
+    inline bool isBitmapFontMode(void) const { return m_bitmapFontMode; }
+
     /**
      * @brief Cleans up all resources.
      */
@@ -66,12 +113,42 @@ class CResourceManager
      */
     SDL_Surface* getSurface(const T_SURFACE p_surface) const;
 
+    /**
+     * @brief         Takes the background loaded by the background thread when the thread tells it is done: it becomes
+     *                the background surface (see getSurface), and the thread is waited for.
+     * @param p_event The event received by the main loop.
+     * @return        TRUE if the event was the one of the background thread (the screen must be redrawn over the new
+     *                background); otherwise, FALSE.
+     */
+    const bool adoptBackground(const SDL_Event& p_event);
+
     /**
      * @brief  Gets the loaded TTF font.
-     * @return Pointer to the TTF font.
+     * @return Pointer to the TTF font (nullptr if text is drawn from the embedded atlas, and the font is deferred to the
+     *         font chain).
      */
     inline TTF_Font* getFont(void) const { return m_font; }
 
+    /**
+     * @brief  Gets the index of the colour emoji font in the font chain (opened the first time an emoji is drawn).
+     * @return The index, or the amount of fonts of the chain if there is none (e.g. in bitmap font mode).
+     */
+    inline unsigned int getEmojiFontIndex(void) const { return m_emojiFont; }
+
+    /**
+     * @brief  Gets the fallback chain of fonts used to draw text: the main font, the installed fallback fonts and the
+     *         colour emoji font.
+     * @return Reference to the chain.
+     */
+    inline const CFontChain& getFontChain(void) const { return m_fontChain; }
+
+    /**
+     * @brief  Gets the distance field of the main font, which draws it at any size. It is loaded (or generated) at the
+     *         first call, so runs that only draw text from the embedded atlas never read it.
+     * @return Reference to the distance field (empty if it could not be generated, or in bitmap font mode).
+     */
+    const CSdfFont& getSdfFont(void);
+
     private:
 
     /**
@@ -91,15 +168,77 @@ class CResourceManager
      */
     CResourceManager(const CResourceManager&& p_source) = delete;
 
+    /**
+     * @brief           Loads the background, on the background thread, and tells the main loop it is done.
+     * @param p_manager The resource manager.
+     * @return          0.
+     */
+    static int loadBackground(void* p_manager);
+
     /**
      * @brief Array of surfaces to load.
      */
     SDL_Surface* m_surfaces[NB_SURFACES];
 
+    /**
+     * @brief Thread loading the background (nullptr when none is running), and the path it loads.
+     */
+    SDL_Thread* m_backgroundThread;
+    std::string m_backgroundPath;
+
+    /**
+     * @brief The framebuffer captured as the background (empty if none), how much the background is darkened, in
+     *        percent, and the radius of its blur, in pixels.
+     */
+    std::string m_capturePath;
+    int m_backgroundDim;
+    int m_backgroundBlur;
+
+    /**
+     * @brief The background loaded by the thread, until the main loop takes it (accessed atomically).
+     */
+    void* m_loadedBackground;
+
+    /**
+     * @brief Type of the event the thread pushes when it is done ((Uint32)-1 if none could be registered).
+     */
+    Uint32 m_backgroundEvent;
+
     /**
      * @brief Pointer to the TTF font.
      */
     TTF_Font* m_font;
+
+    /**
+     * @brief Index of the colour emoji font in the font chain.
+     */
+    unsigned int m_emojiFont;
+
+    /**
+     * @brief Fallback chain of fonts.
+     */
+    CFontChain m_fontChain;
+
+    /**
+     * @brief Glyphs of the main font embedded in the program.
+     */
+    CFontAtlas m_fontAtlas;
+
+    /**
+     * @brief Distance field of the main font, and whether it was loaded yet.
+     */
+    CSdfFont m_sdfFont;
+    bool m_sdfFontLoaded;
+
+    /**
+     * @brief Built-in bitmap font (expanded in bitmap font mode only).
+     */
+    CBitmapFont m_bitmapFont;
+
+    /**
+     * @brief Whether all text is drawn with the bitmap font.
+     */
+    bool m_bitmapFontMode;
 };
 
 #endif // _RESOURCEMANAGER_H_
@@ -0,0 +1,306 @@
+/**
+ * @file  resourcePack.cpp
+ * @brief Implementation file for the CResourcePack class.
+ */
+
+#ifndef _WIN64
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif // _WIN64
+
+#include <algorithm>
+#include <cstring>
+#include "resourcePack.h"
+#include "def.h"
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of the resource pack.
+     */
+    const char s_magic[4] = { 'V', 'K', 'R', 'P' };
+
+    /**
+     * @brief Version of the resource pack format.
+     */
+    constexpr Uint32 s_version = 1;
+
+    /**
+     * @brief Size of the header of the pack: magic, version, amount of resources and padding.
+     */
+    constexpr size_t s_headerSize = sizeof(s_magic) + 3 * sizeof(Uint32);
+
+    /**
+     * @brief         Compares the name of a record with a name, for the binary search of the index.
+     * @param p_entry The record.
+     * @param p_key   The name looked for.
+     * @return        TRUE if the record goes before the name; otherwise, FALSE.
+     */
+    bool isBefore(const CResourcePack::SEntry& p_entry, const std::string& p_key)
+    {
+        return std::strncmp(p_entry.m_name, p_key.c_str(), RESOURCEPACK_NAME_SIZE) < 0;
+    }
+}
+
+CResourcePack& CResourcePack::instance(void)
+{
+    // 1. Create the static instance of the resource pack.
+    // 2. Return the singleton.
+
+    static CResourcePack l_singleton;
+    return l_singleton;
+}
+
+CResourcePack::CResourcePack(void) :
+    m_image(nullptr),
+    m_size(0),
+    m_entries(nullptr),
+    m_entryCount(0),
+    m_mapping(nullptr),
+    m_buffer()
+{
+    // Nothing to do here. Resources are loose files until a pack is mounted.
+}
+
+CResourcePack::~CResourcePack(void)
+{
+    unmount();
+}
+
+const bool CResourcePack::mount(const std::string& p_path)
+{
+    // 1. Map the pack (read it, where mapping is not supported). The descriptor is not needed afterwards.
+    // 2. Check it and point the index to it.
+
+    unmount();
+
+#ifdef _WIN64
+    size_t l_size(0);
+    char* l_data = static_cast<char*>(SDL_LoadFile(p_path.c_str(), &l_size));
+
+    if (l_data == nullptr) return false;
+
+    m_buffer.assign(l_data, l_data + l_size);
+    SDL_free(l_data);
+
+    const char* l_image = m_buffer.data();
+#else
+    const int l_file = ::open(p_path.c_str(), O_RDONLY);
+    struct stat l_status;
+
+    if (l_file < 0 || fstat(l_file, &l_status) != 0 || l_status.st_size <= 0)
+    {
+        if (l_file >= 0) close(l_file);
+        return false;
+    }
+
+    const size_t l_size = static_cast<size_t>(l_status.st_size);
+    void* l_mapping = mmap(nullptr, l_size, PROT_READ, MAP_SHARED, l_file, 0);
+    close(l_file);
+
+    if (l_mapping == MAP_FAILED)
+    {
+        SDL_LogError(0, "Could not map resource pack %s", p_path.c_str());
+        return false;
+    }
+
+    m_mapping = l_mapping;
+    m_size = l_size;
+
+    const char* l_image = static_cast<const char*>(l_mapping);
+#endif // _WIN64
+
+    if (check(l_image, l_size) == false)
+    {
+        SDL_LogError(0, "Invalid resource pack %s", p_path.c_str());
+        unmount();
+        return false;
+    }
+
+    Uint32 l_count(0);
+    std::memcpy(&l_count, l_image + sizeof(s_magic) + sizeof(Uint32), sizeof(l_count));
+
+    m_image = l_image;
+    m_size = l_size;
+    m_entries = reinterpret_cast<const SEntry*>(l_image + s_headerSize);
+    m_entryCount = l_count;
+
+    return true;
+}
+
+void CResourcePack::unmount(void)
+{
+#ifndef _WIN64
+    if (m_mapping != nullptr)
+    {
+        munmap(m_mapping, m_size);
+        m_mapping = nullptr;
+    }
+#endif // _WIN64
+
+    m_buffer.clear();
+    m_image = nullptr;
+    m_size = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+}
+
+const bool CResourcePack::find(const std::string& p_name, const char*& p_data, size_t& p_size) const
+{
+    // Binary search of the index, sorted by name.
+
+    if (m_entries == nullptr || p_name.size() >= RESOURCEPACK_NAME_SIZE) return false;
+
+    const SEntry* l_end = m_entries + m_entryCount;
+    const SEntry* l_found = std::lower_bound(m_entries, l_end, p_name, isBefore);
+
+    if (l_found == l_end || std::strncmp(l_found->m_name, p_name.c_str(), RESOURCEPACK_NAME_SIZE) != 0) return false;
+
+    p_data = m_image + l_found->m_offset;
+    p_size = l_found->m_size;
+
+    return true;
+}
+
+SDL_RWops* CResourcePack::open(const std::string& p_path) const
+{
+    // 1. Open the file itself: an override in the folder of the resources, or any other file.
+    // 2. Otherwise, serve the packed resource of the same name, in place.
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_path.c_str(), "rb");
+
+    if (l_file != nullptr || m_entries == nullptr) return l_file;
+
+    const size_t l_folderLength = std::strlen(RES_DIR);
+    const char* l_data(nullptr);
+    size_t l_size(0);
+
+    if (p_path.compare(0, l_folderLength, RES_DIR) != 0 || !find(p_path.substr(l_folderLength), l_data, l_size)) return nullptr;
+
+    SDL_ClearError();
+
+    return SDL_RWFromConstMem(l_data, static_cast<int>(l_size));
+}
+
+const bool CResourcePack::create(const std::string& p_destination, const std::vector<std::string>& p_files)
+{
+    // 1. Read every file, and name it after its file name. Names must be unique and fit in the index.
+    // 2. Sort the index by name, and place the resources after it, each aligned.
+    // 3. Write the header, the index and the resources, padded to their alignment.
+
+    std::vector<SEntry> l_entries;
+    std::vector<std::vector<char>> l_resources;
+
+    for (const std::string& l_path : p_files)
+    {
+        const size_t l_slash = l_path.find_last_of("/\\");
+        const std::string l_name = (l_slash == std::string::npos) ? l_path : l_path.substr(l_slash + 1);
+        size_t l_size(0);
+        char* l_data = static_cast<char*>(SDL_LoadFile(l_path.c_str(), &l_size));
+
+        if (l_data == nullptr || l_name.empty() || l_name.size() >= RESOURCEPACK_NAME_SIZE)
+        {
+            SDL_LogError(0, "Could not pack %s", l_path.c_str());
+            if (l_data != nullptr) SDL_free(l_data);
+            return false;
+        }
+
+        SEntry l_entry{};
+        std::memcpy(l_entry.m_name, l_name.c_str(), l_name.size());
+        l_entry.m_offset = static_cast<Uint32>(l_resources.size());
+        l_entry.m_size = static_cast<Uint32>(l_size);
+        l_entries.push_back(l_entry);
+        l_resources.emplace_back(l_data, l_data + l_size);
+        SDL_free(l_data);
+    }
+
+    std::sort(l_entries.begin(), l_entries.end(), [](const SEntry& p_a, const SEntry& p_b) { return std::strncmp(p_a.m_name, p_b.m_name, RESOURCEPACK_NAME_SIZE) < 0; });
+
+    for (size_t l_i = 1; l_i < l_entries.size(); ++l_i)
+    {
+        if (std::strncmp(l_entries[l_i - 1].m_name, l_entries[l_i].m_name, RESOURCEPACK_NAME_SIZE) == 0)
+        {
+            SDL_LogError(0, "Resource %s is packed twice", l_entries[l_i].m_name);
+            return false;
+        }
+    }
+
+    // The offsets hold the index of each resource until they are placed
+    std::vector<size_t> l_order(l_entries.size());
+    size_t l_offset = s_headerSize + l_entries.size() * sizeof(SEntry);
+
+    for (size_t l_i = 0; l_i < l_entries.size(); ++l_i)
+    {
+        l_order[l_i] = l_entries[l_i].m_offset;
+        l_offset = (l_offset + RESOURCEPACK_ALIGNMENT - 1) / RESOURCEPACK_ALIGNMENT * RESOURCEPACK_ALIGNMENT;
+        l_entries[l_i].m_offset = static_cast<Uint32>(l_offset);
+        l_offset += l_entries[l_i].m_size;
+    }
+
+    if (l_offset > 0xFFFFFFFFu)
+    {
+        SDL_LogError(0, "The resources do not fit in a pack");
+        return false;
+    }
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_destination.c_str(), "wb");
+
+    if (l_file == nullptr)
+    {
+        SDL_LogError(0, "Could not create resource pack %s: %s", p_destination.c_str(), SDL_GetError());
+        return false;
+    }
+
+    const Uint32 l_header[3] = { s_version, static_cast<Uint32>(l_entries.size()), 0 };
+    const std::vector<char> l_padding(RESOURCEPACK_ALIGNMENT, 0);
+    size_t l_written = s_headerSize + l_entries.size() * sizeof(SEntry);
+    bool l_valid = SDL_RWwrite(l_file, s_magic, 1, sizeof(s_magic)) == sizeof(s_magic)
+                && SDL_RWwrite(l_file, l_header, 1, sizeof(l_header)) == sizeof(l_header)
+                && (l_entries.empty() || SDL_RWwrite(l_file, l_entries.data(), sizeof(SEntry), l_entries.size()) == l_entries.size());
+
+    for (size_t l_i = 0; l_valid && l_i < l_entries.size(); ++l_i)
+    {
+        const std::vector<char>& l_resource = l_resources[l_order[l_i]];
+        const size_t l_gap = l_entries[l_i].m_offset - l_written;
+
+        l_valid = (l_gap == 0 || SDL_RWwrite(l_file, l_padding.data(), 1, l_gap) == l_gap)
+               && (l_resource.empty() || SDL_RWwrite(l_file, l_resource.data(), 1, l_resource.size()) == l_resource.size());
+        l_written = l_entries[l_i].m_offset + l_resource.size();
+    }
+
+    SDL_RWclose(l_file);
+
+    if (!l_valid) SDL_LogError(0, "Could not write resource pack %s: %s", p_destination.c_str(), SDL_GetError());
+
+    return l_valid;
+}
+
+const bool CResourcePack::check(const char* p_image, const size_t p_size)
+{
+    // 1. Check the magic, the version, and that the index fits.
+    // 2. Check that every name is terminated and every resource fits.
+
+    Uint32 l_header[3] = { 0, 0, 0 };
+
+    if (p_size < s_headerSize || std::memcmp(p_image, s_magic, sizeof(s_magic)) != 0) return false;
+
+    std::memcpy(l_header, p_image + sizeof(s_magic), sizeof(l_header));
+
+    if (l_header[0] != s_version || l_header[1] > (p_size - s_headerSize) / sizeof(SEntry)) return false;
+
+    const SEntry* l_entries = reinterpret_cast<const SEntry*>(p_image + s_headerSize);
+
+    for (Uint32 l_i = 0; l_i < l_header[1]; ++l_i)
+    {
+        const SEntry& l_entry = l_entries[l_i];
+
+        if (l_entry.m_name[RESOURCEPACK_NAME_SIZE - 1] != '\0') return false;
+        if (l_entry.m_offset > p_size || l_entry.m_size > p_size - l_entry.m_offset) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file  resourcePack.h
+ * @brief Header file for the CResourcePack class, which serves the resources of the keyboard from a single file.
+ */
+#ifndef _RESOURCEPACK_H_
+#define _RESOURCEPACK_H_
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the name of the resource pack, in the folder of the resources.
+ *
+ * @param X The name of the file.
+ */
+#define RESOURCEPACK_NAME "resources.vkp"
+
+/**
+ * @brief Macro that indicates the size of the name of a resource in the index (terminator included).
+ *
+ * @param X The size, in bytes.
+ */
+#define RESOURCEPACK_NAME_SIZE 48
+
+/**
+ * @brief Macro that indicates the alignment of the resources in the pack (a page, so each resource starts on its own
+ *        page and reading it only faults in the pages it spans).
+ *
+ * @param X The alignment, in bytes.
+ */
+#define RESOURCEPACK_ALIGNMENT 4096
+
+/**
+ * @class Singleton used to load resources from the resource pack.
+ * @brief Maps the resource pack once, and serves each resource packed in it to SDL as a read-only memory stream over
+ *        the mapping: no file is opened per resource, nothing is copied, and the pages are shared through the page
+ *        cache with any other process mapping the pack.
+ *
+ * The pack is made of a header (magic, version and amount of resources), an index of fixed-size records (name, offset
+ * and size of each resource, sorted by name) and the resources, aligned. A loose file in the folder of the resources
+ * overrides the packed resource of the same name, so single resources can be replaced without rebuilding the pack.
+ */
+class CResourcePack
+{
+    public:
+
+    /**
+     * @struct SEntry
+     * @brief  A record of the index, as it is written to the pack.
+     */
+    struct SEntry
+    {
+        char m_name[RESOURCEPACK_NAME_SIZE];    /**< Name of the resource, relative to the folder of the resources */
+        Uint32 m_offset;                        /**< Offset of the resource from the start of the pack */
+        Uint32 m_size;                          /**< Size of the resource, in bytes */
+        Uint32 m_reserved[2];                   /**< Padding, always 0 */
+    };
+
+    /**
+     * @brief  Gets the singleton instance of the resource pack.
+     * @return Reference to the unique resource pack instance.
+     */
+    static CResourcePack& instance(void);
+
+    /**
+     * @brief        Maps a resource pack (read it, where mapping is not supported), replacing the mounted one.
+     * @param p_path The path of the pack.
+     * @return       TRUE if the pack was mapped and is valid; otherwise, FALSE (resources are loose files only).
+     */
+    const bool mount(const std::string& p_path);
+
+    /**
+     * @brief Unmaps the resource pack. Streams opened over it must have been closed.
+     */
+    void unmount(void);
+
+    /**
+     * @brief        Finds a packed resource.
+     * @param p_name The name of the resource, relative to the folder of the resources.
+     * @param p_data Output: the resource, in the mapping.
+     * @param p_size Output: the size of the resource, in bytes.
+     * @return       TRUE if the pack has the resource; otherwise, FALSE.
+     */
+    const bool find(const std::string& p_name, const char*& p_data, size_t& p_size) const;
+
+    /**
+     * @brief        Opens a resource for reading: the file itself if it exists (an override, or a file out of the
+     *               folder of the resources), or else the packed resource of the same name.
+     * @param p_path The path of the resource.
+     * @return       The stream (to be closed by the caller, or by the SDL function it is passed to), or nullptr if
+     *               the resource exists nowhere.
+     */
+    SDL_RWops* open(const std::string& p_path) const;
+
+    /**
+     * @brief               Writes a resource pack with a set of files, each named after its file name.
+     * @param p_destination The path of the pack.
+     * @param p_files       The paths of the files.
+     * @return              TRUE if the pack was written; otherwise, FALSE.
+     */
+    static const bool create(const std::string& p_destination, const std::vector<std::string>& p_files);
+
+    private:
+
+    /**
+     * @brief Constructor for the resource pack, empty.
+     */
+    CResourcePack(void);
+
+    /**
+     * @brief Destructor for the resource pack, which unmaps it.
+     */
+    ~CResourcePack(void);
+
+    /**
+     * @brief          Copy constructor for the resource pack (forbidden).
+     * @param p_source The source resource pack to copy.
+     */
+    CResourcePack(const CResourcePack& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the resource pack (forbidden).
+     * @param p_source The source resource pack to move resources from.
+     */
+    CResourcePack(const CResourcePack&& p_source) = delete;
+
+    /**
+     * @brief         Checks the header and the index of a pack.
+     * @param p_image The pack.
+     * @param p_size  The size of the pack, in bytes.
+     * @return        TRUE if the pack is valid; otherwise, FALSE.
+     */
+    static const bool check(const char* p_image, const size_t p_size);
+
+    /**
+     * @brief The pack (nullptr if none is mounted), and its size.
+     */
+    const char* m_image;
+    size_t m_size;
+
+    /**
+     * @brief The index of the pack, and its amount of records.
+     */
+    const SEntry* m_entries;
+    size_t m_entryCount;
+
+    /**
+     * @brief The mapping of the pack (nullptr where mapping is not supported).
+     */
+    void* m_mapping;
+
+    /**
+     * @brief The pack, read into memory where mapping is not supported.
+     */
+    std::vector<char> m_buffer;
+};
+
+#endif // _RESOURCEPACK_H_
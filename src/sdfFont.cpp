@@ -0,0 +1,535 @@
+/**
+ * @file  sdfFont.cpp
+ * @brief Implementation file for the CSdfFont class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <SDL_ttf.h>
+#include "sdfFont.h"
+#include "def.h"
+#include "resourcePack.h"
+#include "sdlUtils.h"
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    /**
+     * @brief Magic bytes at the start of an atlas file.
+     */
+    const char s_magic[4] = { 'V', 'K', 'S', 'D' };
+
+    /**
+     * @brief Version of the atlas file format.
+     */
+    constexpr Uint32 s_version = 1;
+
+    /**
+     * @brief Ranges of code points put in the atlas (the ones the font does not provide are skipped).
+     */
+    const Uint32 s_ranges[][2] =
+    {
+        { 0x0020, 0x007E },     // Basic Latin
+        { 0x00A0, 0x017F },     // Latin-1 Supplement, Latin Extended-A
+        { 0x0370, 0x03FF },     // Greek
+        { 0x0400, 0x045F },     // Cyrillic
+        { 0x2010, 0x205E },     // General Punctuation
+        { 0x20A0, 0x20BF },     // Currency Symbols
+        { 0x2100, 0x214F },     // Letterlike Symbols
+        { 0x2190, 0x21FF },     // Arrows
+        { 0x2200, 0x22FF },     // Mathematical Operators
+        { 0x2600, 0x26FF },     // Miscellaneous Symbols
+        { 0x2700, 0x27BF }      // Dingbats
+    };
+
+    /**
+     * @brief  Counts the code points of the ranges, the most glyphs an atlas can have.
+     * @return The amount of code points.
+     */
+    size_t maxGlyphs(void)
+    {
+        size_t l_count(0);
+
+        for (const auto& l_range : s_ranges) l_count += l_range[1] - l_range[0] + 1;
+
+        return l_count;
+    }
+
+    /**
+     * @brief          Blends a color over a row of 32-bit pixels, each one with its own opacity. All the channels
+     *                 (whatever their order) are blended towards the ones of the color: out = (p * (256 - a) + c * a) >> 8,
+     *                 with the opacity a scaled to [0, 256]. Blocks of 4 pixels are blended at once with SSE2 or NEON.
+     * @param p_pixels The pixels.
+     * @param p_alphas The opacity of each pixel.
+     * @param p_count  The amount of pixels.
+     * @param p_color  The color, mapped to the format of the pixels.
+     */
+    void blendRow(Uint32* p_pixels, const Uint8* p_alphas, const int p_count, const Uint32 p_color)
+    {
+        int l_i(0);
+
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i l_zero = _mm_setzero_si128();
+        const __m128i l_color = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(p_color)), l_zero);
+        const __m128i l_full = _mm_set1_epi16(256);
+
+        for (; l_i + 4 <= p_count; l_i += 4)
+        {
+            Uint32 l_alphas(0);
+            std::memcpy(&l_alphas, p_alphas + l_i, sizeof(l_alphas));
+
+            if (l_alphas == 0) continue;
+
+            // Spread each opacity over the 4 channels of its pixel, and scale it from [0, 255] to [0, 256]
+            __m128i l_alpha = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(l_alphas)), l_zero);
+            l_alpha = _mm_unpacklo_epi16(l_alpha, l_alpha);
+            l_alpha = _mm_add_epi16(l_alpha, _mm_srli_epi16(l_alpha, 7));
+            const __m128i l_low = _mm_unpacklo_epi32(l_alpha, l_alpha);
+            const __m128i l_high = _mm_unpackhi_epi32(l_alpha, l_alpha);
+
+            const __m128i l_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_pixels + l_i));
+            const __m128i l_pixelsLow = _mm_unpacklo_epi8(l_pixels, l_zero);
+            const __m128i l_pixelsHigh = _mm_unpackhi_epi8(l_pixels, l_zero);
+
+            const __m128i l_resultLow = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(l_pixelsLow, _mm_sub_epi16(l_full, l_low)), _mm_mullo_epi16(l_color, l_low)), 8);
+            const __m128i l_resultHigh = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(l_pixelsHigh, _mm_sub_epi16(l_full, l_high)), _mm_mullo_epi16(l_color, l_high)), 8);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p_pixels + l_i), _mm_packus_epi16(l_resultLow, l_resultHigh));
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const uint16x8_t l_color = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(p_color)));
+        const uint16x8_t l_full = vdupq_n_u16(256);
+
+        for (; l_i + 4 <= p_count; l_i += 4)
+        {
+            Uint32 l_alphas(0);
+            std::memcpy(&l_alphas, p_alphas + l_i, sizeof(l_alphas));
+
+            if (l_alphas == 0) continue;
+
+            // Spread each opacity over the 4 channels of its pixel, and scale it from [0, 255] to [0, 256]
+            const uint8x8_t l_spread = vreinterpret_u8_u32(vdup_n_u32(l_alphas));
+            static const uint8_t s_lowLanes[8] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+            static const uint8_t s_highLanes[8] = { 2, 2, 2, 2, 3, 3, 3, 3 };
+            uint16x8_t l_low = vmovl_u8(vtbl1_u8(l_spread, vld1_u8(s_lowLanes)));
+            uint16x8_t l_high = vmovl_u8(vtbl1_u8(l_spread, vld1_u8(s_highLanes)));
+            l_low = vaddq_u16(l_low, vshrq_n_u16(l_low, 7));
+            l_high = vaddq_u16(l_high, vshrq_n_u16(l_high, 7));
+
+            const uint8x16_t l_pixels = vld1q_u8(reinterpret_cast<const uint8_t*>(p_pixels + l_i));
+            const uint16x8_t l_resultLow = vshrq_n_u16(vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(l_pixels)), vsubq_u16(l_full, l_low)), l_color, l_low), 8);
+            const uint16x8_t l_resultHigh = vshrq_n_u16(vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(l_pixels)), vsubq_u16(l_full, l_high)), l_color, l_high), 8);
+
+            vst1q_u8(reinterpret_cast<uint8_t*>(p_pixels + l_i), vcombine_u8(vmovn_u16(l_resultLow), vmovn_u16(l_resultHigh)));
+        }
+#endif
+
+        for (; l_i < p_count; ++l_i)
+        {
+            const Uint32 l_alpha = p_alphas[l_i] + (p_alphas[l_i] >> 7);
+
+            if (l_alpha == 0) continue;
+
+            Uint32 l_result(0);
+
+            for (unsigned int l_shift = 0; l_shift < 32; l_shift += 8)
+            {
+                const Uint32 l_pixel = (p_pixels[l_i] >> l_shift) & 0xFF;
+                const Uint32 l_color = (p_color >> l_shift) & 0xFF;
+                l_result |= (((l_pixel * (256 - l_alpha) + l_color * l_alpha) >> 8) & 0xFF) << l_shift;
+            }
+
+            p_pixels[l_i] = l_result;
+        }
+    }
+}
+
+CSdfFont::CSdfFont(void) :
+    m_atlasHeight(0),
+    m_lineHeight(0)
+{
+    // Nothing to do here. The atlas is loaded by the resource manager.
+}
+
+const bool CSdfFont::load(const std::string& p_path)
+{
+    // 1. Free the current atlas, and load the one of the font from the cache, if it belongs to this font file.
+    // 2. Otherwise, generate it and cache it for the next runs.
+
+    clear();
+
+    const std::string l_cachePath = p_path + SDFFONT_ATLAS_EXT;
+    Uint32 l_size(0);
+    Uint32 l_hash(0);
+    const bool l_fingerprinted = SDL_Utils::getFingerprint(p_path, l_size, l_hash);
+
+    if (l_fingerprinted && loadAtlas(l_cachePath, l_size, l_hash)) return true;
+
+    INHIBIT(SDL_Log("Generating the distance field of font %s", p_path.c_str());)
+
+    if (!generate(p_path)) return false;
+
+    if (l_fingerprinted) saveAtlas(l_cachePath, l_size, l_hash);
+
+    return true;
+}
+
+void CSdfFont::clear(void)
+{
+    m_glyphs.clear();
+    m_atlas.clear();
+    m_atlasHeight = 0;
+    m_lineHeight = 0;
+}
+
+const bool CSdfFont::covers(const std::string& p_text) const
+{
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        if (getGlyph(UTF8_Utils::decode(p_text, l_position, l_length)) == nullptr) return false;
+    }
+
+    return true;
+}
+
+int CSdfFont::measure(const std::string& p_text, const float p_size) const
+{
+    // Add up the advances at the size of the atlas, and scale the sum.
+
+    int l_advance(0);
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        const SGlyph* l_glyph = getGlyph(UTF8_Utils::decode(p_text, l_position, l_length));
+
+        if (l_glyph != nullptr) l_advance += l_glyph->m_advance;
+    }
+
+    return static_cast<int>(std::ceil(l_advance * p_size / SDFFONT_SIZE));
+}
+
+int CSdfFont::getHeight(const float p_size) const
+{
+    return static_cast<int>(std::ceil(m_lineHeight * p_size / SDFFONT_SIZE));
+}
+
+const bool CSdfFont::draw(const std::string& p_text, const int p_x, const int p_y, const float p_size, const SDL_Color& p_color, SDL_Surface* p_destination) const
+{
+    // 1. Check the destination, and lock it.
+    // 2. For each glyph, find its rectangle at the given size, clipped to the destination.
+    // 3. For each row of the rectangle, sample the field bilinearly at each pixel and turn the distance (in pixels of
+    //    the destination) into an opacity: 0.5 on the outline, ramping over one pixel.
+    // 4. Blend the color over the row, and move the pen.
+
+    if (p_destination == nullptr || p_destination->format->BytesPerPixel != 4 || m_glyphs.empty() || p_size <= 0.0f) return false;
+    if (SDL_MUSTLOCK(p_destination) && SDL_LockSurface(p_destination) != 0) return false;
+
+    const float l_scale = p_size / SDFFONT_SIZE;
+    const Uint32 l_color = SDL_MapRGBA(p_destination->format, p_color.r, p_color.g, p_color.b, 255);
+    const SDL_Rect& l_clip = p_destination->clip_rect;
+    // Opacity per unit of the field: 127 units are SDFFONT_SPREAD pixels of the atlas, l_scale pixels each
+    const float l_slope = 255.0f * SDFFONT_SPREAD * l_scale / 127.0f;
+    std::vector<Uint8> l_alphas;
+    std::vector<int> l_columns;
+    float l_pen = static_cast<float>(p_x);
+    size_t l_length(0);
+
+    for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+    {
+        const SGlyph* l_glyph = getGlyph(UTF8_Utils::decode(p_text, l_position, l_length));
+
+        if (l_glyph == nullptr) continue;
+
+        const int l_left = static_cast<int>(std::floor(l_pen + l_glyph->m_offsetX * l_scale));
+        const int l_top = p_y + static_cast<int>(std::floor(l_glyph->m_offsetY * l_scale));
+        const int l_width = static_cast<int>(std::ceil(l_glyph->m_width * l_scale));
+        const int l_height = static_cast<int>(std::ceil(l_glyph->m_height * l_scale));
+        const int l_firstX = std::max(l_left, static_cast<int>(l_clip.x));
+        const int l_lastX = std::min(l_left + l_width, l_clip.x + l_clip.w);
+        const int l_firstY = std::max(l_top, static_cast<int>(l_clip.y));
+        const int l_lastY = std::min(l_top + l_height, l_clip.y + l_clip.h);
+
+        l_pen += l_glyph->m_advance * l_scale;
+
+        if (l_firstX >= l_lastX || l_firstY >= l_lastY) continue;
+
+        // Position of each column in the field, in 1/256 of a pixel, clamped so both samples stay in the glyph
+        const int l_count = l_lastX - l_firstX;
+        const int l_maxX = (l_glyph->m_width - 1) << 8;
+        const int l_maxY = (l_glyph->m_height - 1) << 8;
+        l_columns.resize(l_count);
+        l_alphas.resize(l_count);
+
+        for (int l_x = 0; l_x < l_count; ++l_x)
+        {
+            const int l_u = static_cast<int>(((l_firstX + l_x - l_left + 0.5f) / l_scale - 0.5f) * 256.0f);
+            l_columns[l_x] = std::min(std::max(l_u, 0), l_maxX);
+        }
+
+        for (int l_y = l_firstY; l_y < l_lastY; ++l_y)
+        {
+            const int l_v = std::min(std::max(static_cast<int>(((l_y - l_top + 0.5f) / l_scale - 0.5f) * 256.0f), 0), l_maxY);
+            const int l_row = l_v >> 8;
+            const int l_fractionY = l_v & 0xFF;
+            const Uint8* l_top0 = m_atlas.data() + (l_glyph->m_y + l_row) * SDFFONT_ATLAS_WIDTH + l_glyph->m_x;
+            const Uint8* l_top1 = l_top0 + (l_row + 1 < l_glyph->m_height ? SDFFONT_ATLAS_WIDTH : 0);
+
+            for (int l_x = 0; l_x < l_count; ++l_x)
+            {
+                const int l_column = l_columns[l_x] >> 8;
+                const int l_fractionX = l_columns[l_x] & 0xFF;
+                const int l_next = l_column + 1 < l_glyph->m_width ? 1 : 0;
+                const int l_upper = l_top0[l_column] * (256 - l_fractionX) + l_top0[l_column + l_next] * l_fractionX;
+                const int l_lower = l_top1[l_column] * (256 - l_fractionX) + l_top1[l_column + l_next] * l_fractionX;
+                const float l_field = (l_upper * (256 - l_fractionY) + l_lower * l_fractionY) / 65536.0f;
+                const float l_alpha = 127.5f + (l_field - 128.0f) * l_slope;
+
+                l_alphas[l_x] = static_cast<Uint8>(l_alpha <= 0.0f ? 0 : (l_alpha >= 255.0f ? 255 : l_alpha));
+            }
+
+            Uint32* l_pixels = reinterpret_cast<Uint32*>(static_cast<Uint8*>(p_destination->pixels) + l_y * p_destination->pitch) + l_firstX;
+            blendRow(l_pixels, l_alphas.data(), l_count, l_color);
+        }
+    }
+
+    if (SDL_MUSTLOCK(p_destination)) SDL_UnlockSurface(p_destination);
+
+    return true;
+}
+
+const bool CSdfFont::generate(const std::string& p_path)
+{
+    // 1. Open the font at the size of the atlas.
+    // 2. For each covered character, render its glyph and find the bounding box of its pixels, grown by the spread.
+    // 3. Pack the box in the atlas (left to right, in shelves) and compute the field of each of its pixels: the
+    //    distance to the nearest pixel on the other side of the outline, within the spread, positive inside.
+
+    TTF_Font* l_font = TTF_OpenFontRW(CResourcePack::instance().open(p_path), 1, SDFFONT_SIZE);
+
+    if (l_font == nullptr)
+    {
+        SDL_LogWarn(0, "Could not open font %s for its distance field: %s", p_path.c_str(), TTF_GetError());
+        return false;
+    }
+
+    clear();
+    m_lineHeight = TTF_FontHeight(l_font);
+
+    std::vector<Uint8> l_coverage;
+    int l_shelfX(0);
+    int l_shelfY(0);
+    int l_shelfHeight(0);
+
+    for (const auto& l_range : s_ranges)
+    {
+        for (Uint32 l_codepoint = l_range[0]; l_codepoint <= l_range[1]; ++l_codepoint)
+        {
+            int l_advance(0);
+
+            if (!TTF_GlyphIsProvided32(l_font, l_codepoint) || TTF_GlyphMetrics32(l_font, l_codepoint, nullptr, nullptr, nullptr, nullptr, &l_advance) != 0) continue;
+
+            SGlyph l_glyph{ l_codepoint, 0, 0, 0, 0, 0, 0, static_cast<Sint16>(l_advance), 0 };
+            SDL_Surface* l_rendered = TTF_RenderGlyph32_Blended(l_font, l_codepoint, SDL_Color{ 255, 255, 255, 255 });
+            SDL_Surface* l_surface = l_rendered != nullptr ? SDL_ConvertSurfaceFormat(l_rendered, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+
+            if (l_rendered != nullptr) SDL_FreeSurface(l_rendered);
+
+            // Coverage of the glyph, and its bounding box (spaces have none, but keep their advance)
+            const int l_surfaceWidth = l_surface != nullptr ? l_surface->w : 0;
+            const int l_surfaceHeight = l_surface != nullptr ? l_surface->h : 0;
+            int l_minX(l_surfaceWidth), l_minY(l_surfaceHeight), l_maxX(-1), l_maxY(-1);
+            l_coverage.assign(static_cast<size_t>(l_surfaceWidth) * l_surfaceHeight, 0);
+
+            if (l_surface != nullptr)
+            {
+                SDL_LockSurface(l_surface);
+
+                for (int l_y = 0; l_y < l_surfaceHeight; ++l_y)
+                {
+                    const Uint32* l_row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(l_surface->pixels) + l_y * l_surface->pitch);
+
+                    for (int l_x = 0; l_x < l_surfaceWidth; ++l_x)
+                    {
+                        const Uint8 l_alpha = static_cast<Uint8>(l_row[l_x] >> 24);
+                        l_coverage[l_y * l_surfaceWidth + l_x] = l_alpha;
+
+                        if (l_alpha == 0) continue;
+
+                        l_minX = std::min(l_minX, l_x);
+                        l_maxX = std::max(l_maxX, l_x);
+                        l_minY = std::min(l_minY, l_y);
+                        l_maxY = std::max(l_maxY, l_y);
+                    }
+                }
+
+                SDL_UnlockSurface(l_surface);
+                SDL_FreeSurface(l_surface);
+            }
+
+            if (l_maxX < 0)
+            {
+                m_glyphs[l_codepoint] = l_glyph;
+                continue;
+            }
+
+            l_glyph.m_width = static_cast<Sint16>(l_maxX - l_minX + 1 + 2 * SDFFONT_SPREAD);
+            l_glyph.m_height = static_cast<Sint16>(l_maxY - l_minY + 1 + 2 * SDFFONT_SPREAD);
+            l_glyph.m_offsetX = static_cast<Sint16>(l_minX - SDFFONT_SPREAD);
+            l_glyph.m_offsetY = static_cast<Sint16>(l_minY - SDFFONT_SPREAD);
+
+            if (l_glyph.m_width > SDFFONT_ATLAS_WIDTH) continue;
+
+            if (l_shelfX + l_glyph.m_width > SDFFONT_ATLAS_WIDTH)
+            {
+                l_shelfX = 0;
+                l_shelfY += l_shelfHeight;
+                l_shelfHeight = 0;
+            }
+
+            l_glyph.m_x = static_cast<Sint16>(l_shelfX);
+            l_glyph.m_y = static_cast<Sint16>(l_shelfY);
+            l_shelfX += l_glyph.m_width;
+            l_shelfHeight = std::max(l_shelfHeight, static_cast<int>(l_glyph.m_height));
+            m_atlasHeight = std::max(m_atlasHeight, l_shelfY + l_shelfHeight);
+            m_atlas.resize(static_cast<size_t>(m_atlasHeight) * SDFFONT_ATLAS_WIDTH, 0);
+
+            // Field of each pixel of the box: search the nearest pixel on the other side of the outline
+            for (int l_y = 0; l_y < l_glyph.m_height; ++l_y)
+            {
+                for (int l_x = 0; l_x < l_glyph.m_width; ++l_x)
+                {
+                    const int l_sourceX = l_glyph.m_offsetX + l_x;
+                    const int l_sourceY = l_glyph.m_offsetY + l_y;
+                    const auto l_inside = [&](const int p_x, const int p_y) { return p_x >= 0 && p_y >= 0 && p_x < l_surfaceWidth && p_y < l_surfaceHeight && l_coverage[p_y * l_surfaceWidth + p_x] >= 128; };
+                    const bool l_isInside = l_inside(l_sourceX, l_sourceY);
+                    int l_nearest = (SDFFONT_SPREAD + 1) * (SDFFONT_SPREAD + 1);
+
+                    for (int l_dy = -SDFFONT_SPREAD; l_dy <= SDFFONT_SPREAD; ++l_dy)
+                    {
+                        for (int l_dx = -SDFFONT_SPREAD; l_dx <= SDFFONT_SPREAD; ++l_dx)
+                        {
+                            const int l_distance = l_dx * l_dx + l_dy * l_dy;
+
+                            if (l_distance < l_nearest && l_inside(l_sourceX + l_dx, l_sourceY + l_dy) != l_isInside) l_nearest = l_distance;
+                        }
+                    }
+
+                    const float l_distance = std::min(std::sqrt(static_cast<float>(l_nearest)) - 0.5f, static_cast<float>(SDFFONT_SPREAD));
+                    const float l_field = 128.0f + (l_isInside ? l_distance : -l_distance) * 127.0f / SDFFONT_SPREAD;
+
+                    m_atlas[(l_glyph.m_y + l_y) * SDFFONT_ATLAS_WIDTH + l_glyph.m_x + l_x] = static_cast<Uint8>(std::min(255.0f, std::max(0.0f, l_field + 0.5f)));
+                }
+            }
+
+            m_glyphs[l_codepoint] = l_glyph;
+        }
+    }
+
+    TTF_CloseFont(l_font);
+
+    return !m_glyphs.empty();
+}
+
+const bool CSdfFont::loadAtlas(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash)
+{
+    // 1. Read the header and check its magic, version, fingerprint and the parameters of the field.
+    // 2. Check the amount of glyphs against the ranges, and the height of the field against the size of the file,
+    //    before allocating anything (a stale or damaged cache is generated again).
+    // 3. Read the glyphs and the field, and check that every glyph lies in it.
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_path.c_str(), "rb");
+
+    if (l_file == nullptr) return false;
+
+    char l_magic[sizeof(s_magic)];
+    Uint32 l_header[9];
+    const Uint32 l_expected[6] = { s_version, p_size, p_hash, SDFFONT_SIZE, SDFFONT_SPREAD, SDFFONT_ATLAS_WIDTH };
+    bool l_valid = SDL_RWread(l_file, l_magic, 1, sizeof(l_magic)) == sizeof(l_magic)
+                && SDL_RWread(l_file, l_header, 1, sizeof(l_header)) == sizeof(l_header)
+                && std::memcmp(l_magic, s_magic, sizeof(s_magic)) == 0
+                && std::memcmp(l_header, l_expected, sizeof(l_expected)) == 0;
+
+    std::vector<SGlyph> l_glyphs;
+
+    if (l_valid)
+    {
+        // The rest of the header: amount of glyphs, height of the atlas and height of a line
+        const Sint64 l_fileSize = SDL_RWsize(l_file);
+        const Uint64 l_dataSize = static_cast<Uint64>(l_header[6]) * sizeof(SGlyph) + static_cast<Uint64>(l_header[7]) * SDFFONT_ATLAS_WIDTH;
+
+        l_valid = l_header[6] <= maxGlyphs() && l_header[7] > 0 && l_fileSize >= 0
+               && static_cast<Uint64>(l_fileSize) == sizeof(l_magic) + sizeof(l_header) + l_dataSize;
+    }
+
+    if (l_valid)
+    {
+        l_glyphs.resize(l_header[6]);
+        m_atlasHeight = static_cast<int>(l_header[7]);
+        m_lineHeight = static_cast<int>(l_header[8]);
+        m_atlas.resize(static_cast<size_t>(m_atlasHeight) * SDFFONT_ATLAS_WIDTH);
+        l_valid = SDL_RWread(l_file, l_glyphs.data(), sizeof(SGlyph), l_glyphs.size()) == l_glyphs.size()
+               && SDL_RWread(l_file, m_atlas.data(), 1, m_atlas.size()) == m_atlas.size();
+    }
+
+    SDL_RWclose(l_file);
+
+    for (const SGlyph& l_glyph : l_glyphs)
+    {
+        if (!l_valid) break;
+
+        l_valid = l_glyph.m_x >= 0 && l_glyph.m_y >= 0 && l_glyph.m_width >= 0 && l_glyph.m_height >= 0 && l_glyph.m_x + l_glyph.m_width <= SDFFONT_ATLAS_WIDTH && l_glyph.m_y + l_glyph.m_height <= m_atlasHeight;
+        m_glyphs[l_glyph.m_codepoint] = l_glyph;
+    }
+
+    if (!l_valid || m_glyphs.empty())
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void CSdfFont::saveAtlas(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash) const
+{
+    // Write the header, the glyphs and the field. The cache is optional, so a failure is only a warning.
+
+    SDL_RWops* l_file = SDL_RWFromFile(p_path.c_str(), "wb");
+
+    if (l_file == nullptr)
+    {
+        SDL_LogWarn(0, "Could not create atlas file %s: %s", p_path.c_str(), SDL_GetError());
+        return;
+    }
+
+    std::vector<SGlyph> l_glyphs;
+    l_glyphs.reserve(m_glyphs.size());
+
+    for (const auto& l_glyph : m_glyphs) l_glyphs.push_back(l_glyph.second);
+
+    const Uint32 l_header[9] = { s_version, p_size, p_hash, SDFFONT_SIZE, SDFFONT_SPREAD, SDFFONT_ATLAS_WIDTH, static_cast<Uint32>(l_glyphs.size()), static_cast<Uint32>(m_atlasHeight), static_cast<Uint32>(m_lineHeight) };
+    const bool l_written = SDL_RWwrite(l_file, s_magic, 1, sizeof(s_magic)) == sizeof(s_magic)
+                        && SDL_RWwrite(l_file, l_header, 1, sizeof(l_header)) == sizeof(l_header)
+                        && SDL_RWwrite(l_file, l_glyphs.data(), sizeof(SGlyph), l_glyphs.size()) == l_glyphs.size()
+                        && SDL_RWwrite(l_file, m_atlas.data(), 1, m_atlas.size()) == m_atlas.size();
+    SDL_RWclose(l_file);
+
+    if (!l_written) SDL_LogWarn(0, "Could not write atlas file %s: %s", p_path.c_str(), SDL_GetError());
+}
+
+const CSdfFont::SGlyph* CSdfFont::getGlyph(const Uint32 p_codepoint) const
+{
+    const auto l_found = m_glyphs.find(p_codepoint);
+
+    return l_found != m_glyphs.end() ? &l_found->second : nullptr;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file  sdfFont.h
+ * @brief Header file for the CSdfFont class, which draws text at any size from a signed distance field atlas.
+ */
+#ifndef _SDFFONT_H_
+#define _SDFFONT_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the size the glyphs of the atlas are rendered at, and how far from their outline
+ *        (in pixels of that size) the distance field reaches.
+ *
+ * @param X The size, in points, or the distance, in pixels.
+ */
+#define SDFFONT_SIZE 24
+#define SDFFONT_SPREAD 3
+
+/**
+ * @brief Macro that indicates the width of the atlas (its height depends on the glyphs).
+ *
+ * @param X The width, in pixels.
+ */
+#define SDFFONT_ATLAS_WIDTH 1024
+
+/**
+ * @brief Macro that indicates the extension of the file where the atlas of a font is cached, next to the font.
+ *
+ * @param X The extension.
+ */
+#define SDFFONT_ATLAS_EXT ".sdf"
+
+/**
+ * @class CSdfFont
+ * @brief Font drawn from a signed distance field: one 8-bit atlas, generated once per font and cached on disk, holds
+ *        the distance from each pixel of the glyphs to their outline, so text of any size is drawn from it, sharp.
+ *
+ * The atlas covers the scripts and symbols of the layouts (Latin, Greek, Cyrillic, punctuation, arrows...), and a text
+ * with any other character must be drawn by other means (see covers). Drawing samples the field bilinearly for each
+ * pixel and blends the color over the destination, several pixels at once when SIMD instructions are available.
+ */
+class CSdfFont
+{
+    public:
+
+    /**
+     * @brief Constructor for the font, empty.
+     */
+    CSdfFont(void);
+
+    /**
+     * @brief          Copy constructor for the font (forbidden).
+     * @param p_source The source font to copy.
+     */
+    CSdfFont(const CSdfFont& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the font (forbidden).
+     * @param p_source The source font to move resources from.
+     */
+    CSdfFont(const CSdfFont&& p_source) = delete;
+
+    /**
+     * @brief        Loads the atlas of a font from its cache or, if there is none for this font file, generates it and
+     *               caches it.
+     * @param p_path The path of the font file.
+     * @return       TRUE if the atlas was loaded or generated; otherwise, FALSE.
+     */
+    const bool load(const std::string& p_path);
+
+    /**
+     * @brief Frees the atlas.
+     */
+    void clear(void);
+
+    /**
+     * @brief  Indicates whether the font has an atlas.
+     * @return TRUE if it has an atlas; otherwise, FALSE.
+     */
+    inline bool isLoaded(void) const { return !m_glyphs.empty(); }
+
+    /**
+     * @brief        Checks whether the atlas has every character of a text.
+     * @param p_text The text.
+     * @return       TRUE if the text can be drawn; otherwise, FALSE.
+     */
+    const bool covers(const std::string& p_text) const;
+
+    /**
+     * @brief        Measures a text drawn at a given size.
+     * @param p_text The text.
+     * @param p_size The size, in points (like the size a TTF font is opened with).
+     * @return       The width, in pixels.
+     */
+    int measure(const std::string& p_text, const float p_size) const;
+
+    /**
+     * @brief        Gets the height of a line drawn at a given size.
+     * @param p_size The size, in points.
+     * @return       The height, in pixels.
+     */
+    int getHeight(const float p_size) const;
+
+    /**
+     * @brief               Draws a text over a surface (characters missing from the atlas are skipped).
+     * @param p_text        The text.
+     * @param p_x           The left of the text.
+     * @param p_y           The top of the line.
+     * @param p_size        The size, in points.
+     * @param p_color       The color of the text.
+     * @param p_destination The surface to draw on (32 bits per pixel).
+     * @return              TRUE if the text was drawn; otherwise, FALSE (e.g. the surface has another depth).
+     */
+    const bool draw(const std::string& p_text, const int p_x, const int p_y, const float p_size, const SDL_Color& p_color, SDL_Surface* p_destination) const;
+
+    private:
+
+    /**
+     * @struct SGlyph
+     * @brief  A glyph of the atlas, as it is written to the cache file.
+     */
+    struct SGlyph
+    {
+        Uint32 m_codepoint;     /**< The code point */
+        Sint16 m_x;             /**< Left of the field in the atlas */
+        Sint16 m_y;             /**< Top of the field in the atlas */
+        Sint16 m_width;         /**< Width of the field */
+        Sint16 m_height;        /**< Height of the field */
+        Sint16 m_offsetX;       /**< Left of the field relative to the pen */
+        Sint16 m_offsetY;       /**< Top of the field relative to the top of the line */
+        Sint16 m_advance;       /**< Advance of the pen */
+        Sint16 m_reserved;      /**< Padding, always 0 */
+    };
+
+    /**
+     * @brief        Generates the atlas, rendering every covered character and computing its distance field.
+     * @param p_path The path of the font file.
+     * @return       TRUE if the atlas was generated; otherwise, FALSE.
+     */
+    const bool generate(const std::string& p_path);
+
+    /**
+     * @brief        Loads the cached atlas, if it matches the fingerprint of the font file and its glyph count and
+     *               height match the ranges of code points and the size of the file.
+     * @param p_path The path of the cache file.
+     * @param p_size The size of the font file.
+     * @param p_hash The hash of the head of the font file.
+     * @return       TRUE if the atlas was loaded; otherwise, FALSE.
+     */
+    const bool loadAtlas(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash);
+
+    /**
+     * @brief        Writes the atlas to its cache file.
+     * @param p_path The path of the cache file.
+     * @param p_size The size of the font file.
+     * @param p_hash The hash of the head of the font file.
+     */
+    void saveAtlas(const std::string& p_path, const Uint32 p_size, const Uint32 p_hash) const;
+
+    /**
+     * @brief             Gets the glyph of a code point.
+     * @param p_codepoint The code point.
+     * @return            Pointer to the glyph, or nullptr if it is not in the atlas.
+     */
+    const SGlyph* getGlyph(const Uint32 p_codepoint) const;
+
+    /**
+     * @brief The glyphs of the atlas, by code point.
+     */
+    std::unordered_map<Uint32, SGlyph> m_glyphs;
+
+    /**
+     * @brief The distance field of the glyphs: 128 on the outline, higher inside.
+     */
+    std::vector<Uint8> m_atlas;
+
+    /**
+     * @brief The height of the atlas, in pixels.
+     */
+    int m_atlasHeight;
+
+    /**
+     * @brief The height of a line at SDFFONT_SIZE, in pixels.
+     */
+    int m_lineHeight;
+};
+
+#endif // _SDFFONT_H_
@@ -14,6 +14,7 @@
 #include <SDL_image.h>
 #include "def.h"
 #include "resourceManager.h"
+#include "resourcePack.h"
 #include "screen.h"
 
 bool SDL_Utils::isSupportedImageExt(const std::string& p_filename) 
@@ -83,13 +84,13 @@ void SDL_Utils::applySurface(const Sint16 p_x, const Sint16 p_y, SDL_Surface* p_
 
 TTF_Font *SDL_Utils::loadFont(const std::string &p_font, const int p_size)
 {
-	// 1. Open the font file with the specified size.
+	// 1. Open the font file (or the packed font, see CResourcePack) with the specified size.
 	// 2. If the font file cannot be opened, log an error message.
 	// 3. Return the loaded font (a null pointer if the loading operation fails).
 
     INHIBIT(SLD_Log("SDL_utils::loadFont(%s,%s)", p_font, p_size);)
 
-    TTF_Font* l_font = TTF_OpenFont(p_font.c_str(), p_size);
+    TTF_Font* l_font = TTF_OpenFontRW(CResourcePack::instance().open(p_font), 1, p_size);
     
     if (l_font == nullptr)
     {
@@ -175,6 +176,42 @@ SDL_Surface* SDL_Utils::createImage(const int p_width, const int p_height, const
     return l_surface;
 }
 
+const bool SDL_Utils::getFingerprint(const std::string& p_path, Uint32& p_size, Uint32& p_hash, const bool p_whole)
+{
+    // 1. Open the file (or the packed file) and get its size.
+    // 2. Hash its head with FNV-1a (for a font, it holds the table directory, with the checksum of each table), or
+    //    the whole file, a block at a time.
+
+    SDL_RWops* l_file = CResourcePack::instance().open(p_path);
+
+    if (l_file == nullptr) return false;
+
+    const Sint64 l_size = SDL_RWsize(l_file);
+    char l_block[4096];
+    size_t l_read(0);
+
+    p_hash = 2166136261u;
+
+    do
+    {
+        l_read = SDL_RWread(l_file, l_block, 1, sizeof(l_block));
+
+        for (size_t l_i = 0; l_i < l_read; ++l_i)
+        {
+            p_hash = (p_hash ^ static_cast<Uint8>(l_block[l_i])) * 16777619u;
+        }
+    }
+    while (p_whole && l_read == sizeof(l_block));
+
+    SDL_RWclose(l_file);
+
+    if (l_size <= 0) return false;
+
+    p_size = static_cast<Uint32>(l_size);
+
+    return true;
+}
+
 void SDL_Utils::renderAll(void)
 {
     // 1. If there are no windows to render, return.
@@ -147,6 +147,19 @@ namespace SDL_Utils
      */
     SDL_Surface* createImage(const int p_width, const int p_height, const Uint32 p_color);
 
+    /**
+     * @brief         Gets the fingerprint of a file (or a packed file), which tells whether data cached from it (e.g. the
+     *                coverage of a font, or a blurred background) belongs to it.
+     * @param p_path  The path of the file.
+     * @param p_size  Output: the size of the file, in bytes.
+     * @param p_hash  Output: the FNV-1a hash of the head of the file, or of the whole file.
+     * @param p_whole TRUE to hash the whole file (e.g. an image, which can change anywhere at the same size); FALSE,
+     *                to hash its first 4 KiB only (enough for a font, whose table directory has the checksum of each
+     *                table) (optional).
+     * @return        TRUE if the file could be read; otherwise, FALSE.
+     */
+    const bool getFingerprint(const std::string& p_path, Uint32& p_size, Uint32& p_hash, const bool p_whole = false);
+
     /**
      * @brief Renders all opened windows.
      */
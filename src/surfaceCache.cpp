@@ -0,0 +1,96 @@
+/**
+ * @file  surfaceCache.cpp
+ * @brief Implementation file for the CSurfaceCache class.
+ */
+
+#include "surfaceCache.h"
+
+CSurfaceCache::CSurfaceCache(const size_t p_budget) :
+    m_budget(p_budget),
+    m_size(0)
+{
+    // Nothing to do here. Surfaces are added on demand.
+}
+
+CSurfaceCache::~CSurfaceCache(void)
+{
+    // Free all the surfaces.
+
+    clear();
+}
+
+SDL_Surface* CSurfaceCache::get(const Uint32 p_key)
+{
+    // 1. Find the surface.
+    // 2. Move it to the front of the list (splicing keeps the iterators of the index valid).
+
+    const auto l_found = m_index.find(p_key);
+
+    if (l_found == m_index.end()) return nullptr;
+
+    m_entries.splice(m_entries.begin(), m_entries, l_found->second);
+    return l_found->second->m_surface;
+}
+
+SDL_Surface* CSurfaceCache::put(const Uint32 p_key, SDL_Surface* p_surface)
+{
+    // 1. Free the surface with the same key, if any.
+    // 2. Add the surface at the front of the list, and account for its pixels.
+    // 3. Free the least recently used surfaces while the budget is exceeded.
+
+    if (p_surface == nullptr) return nullptr;
+
+    const auto l_found = m_index.find(p_key);
+
+    if (l_found != m_index.end())
+    {
+        m_size -= l_found->second->m_bytes;
+        SDL_FreeSurface(l_found->second->m_surface);
+        m_entries.erase(l_found->second);
+        m_index.erase(l_found);
+    }
+
+    const size_t l_bytes = static_cast<size_t>(p_surface->pitch) * p_surface->h;
+
+    m_entries.push_front(SEntry{ p_key, p_surface, l_bytes });
+    m_index[p_key] = m_entries.begin();
+    m_size += l_bytes;
+
+    evict();
+
+    return p_surface;
+}
+
+void CSurfaceCache::setBudget(const size_t p_budget)
+{
+    // Keep the budget, and apply it right away.
+
+    m_budget = p_budget;
+    evict();
+}
+
+void CSurfaceCache::clear(void)
+{
+    // Free all the surfaces.
+
+    for (SEntry& l_entry : m_entries) SDL_FreeSurface(l_entry.m_surface);
+
+    m_entries.clear();
+    m_index.clear();
+    m_size = 0;
+}
+
+void CSurfaceCache::evict(void)
+{
+    // Free from the back of the list, keeping the front one.
+
+    while (m_size > m_budget && m_entries.size() > 1)
+    {
+        const SEntry& l_entry = m_entries.back();
+
+        m_size -= l_entry.m_bytes;
+        SDL_FreeSurface(l_entry.m_surface);
+        m_index.erase(l_entry.m_key);
+        m_entries.pop_back();
+    }
+}
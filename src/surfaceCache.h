@@ -0,0 +1,118 @@
+/**
+ * @file  surfaceCache.h
+ * @brief Header file for the CSurfaceCache class, a least-recently-used cache of surfaces under a memory budget.
+ */
+#ifndef _SURFACECACHE_H_
+#define _SURFACECACHE_H_
+
+#include <list>
+#include <unordered_map>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the default memory budget of a surface cache (owners that know the size of their
+ *        surfaces derive a larger one from it, e.g. CKeyboard from the size of the keyboard).
+ *
+ * @param X The budget, in bytes.
+ */
+#define SURFACECACHE_DEFAULT_BUDGET (4 * 1024 * 1024)
+
+/**
+ * @class CSurfaceCache
+ * @brief Owns surfaces that are expensive to build (e.g. baked keyboards and glyphs), keyed by an integer.
+ *
+ * When the pixels of the cached surfaces exceed the budget, the least recently used ones are freed. The surface
+ * just added is never freed, so a surface returned by get() or put() stays valid until the next call to put().
+ */
+class CSurfaceCache
+{
+    public:
+
+    /**
+     * @brief          Constructor for the cache.
+     * @param p_budget The memory budget, in bytes.
+     */
+    explicit CSurfaceCache(const size_t p_budget = SURFACECACHE_DEFAULT_BUDGET);
+
+    /**
+     * @brief Destructor for the cache, which frees the surfaces.
+     */
+    ~CSurfaceCache(void);
+
+    /**
+     * @brief          Copy constructor for the cache (forbidden).
+     * @param p_source The source cache to copy.
+     */
+    CSurfaceCache(const CSurfaceCache& p_source) = delete;
+
+    /**
+     * @brief          Move constructor for the cache (forbidden).
+     * @param p_source The source cache to move resources from.
+     */
+    CSurfaceCache(const CSurfaceCache&& p_source) = delete;
+
+    /**
+     * @brief       Gets a surface, marking it as the most recently used.
+     * @param p_key The key of the surface.
+     * @return      The surface, or nullptr if it is not cached.
+     */
+    SDL_Surface* get(const Uint32 p_key);
+
+    /**
+     * @brief           Adds a surface (replacing the one with the same key, if any), and frees the least recently used
+     *                  ones while the budget is exceeded.
+     * @param p_key     The key of the surface.
+     * @param p_surface The surface. The cache takes its ownership (nullptr is ignored).
+     * @return          The surface.
+     */
+    SDL_Surface* put(const Uint32 p_key, SDL_Surface* p_surface);
+
+    /**
+     * @brief          Sets the memory budget, freeing the least recently used surfaces if it is exceeded.
+     * @param p_budget The budget, in bytes.
+     */
+    void setBudget(const size_t p_budget);
+
+    /**
+     * @brief  Gets the memory used by the cached surfaces.
+     * @return The size of their pixels, in bytes.
+     */
+    inline size_t getSize(void) const { return m_size; }
+
+    /**
+     * @brief Frees all the surfaces.
+     */
+    void clear(void);
+
+    private:
+
+    /**
+     * @struct SEntry
+     * @brief  A cached surface.
+     */
+    struct SEntry
+    {
+        Uint32 m_key;
+        SDL_Surface* m_surface;
+        size_t m_bytes;
+    };
+
+    /**
+     * @brief Frees the least recently used surfaces, except the most recently used one, while the budget is exceeded.
+     */
+    void evict(void);
+
+    /**
+     * @brief The cached surfaces, the most recently used first, and their index by key.
+     */
+    std::list<SEntry> m_entries;
+    std::unordered_map<Uint32, std::list<SEntry>::iterator> m_index;
+
+    /**
+     * @brief The memory budget, and the memory used, in bytes.
+     */
+    size_t m_budget;
+    size_t m_size;
+};
+
+#endif // _SURFACECACHE_H_
@@ -0,0 +1,124 @@
+/**
+ * @file  textBuffer.cpp
+ * @brief Implementation file for the CTextBuffer class.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "textBuffer.h"
+
+CTextBuffer::CTextBuffer(const std::string& p_text) :
+    m_buffer(p_text.begin(), p_text.end()),
+    m_gapStart(p_text.size()),
+    m_gapEnd(p_text.size()),
+    m_view(p_text),
+    m_viewDirty(false)
+{
+    // The gap starts empty at the end of the text, where the caret is placed initially.
+}
+
+void CTextBuffer::insert(const size_t p_position, const std::string& p_text)
+{
+    // 1. Move the gap to the insertion position and make sure it can hold the text.
+    // 2. Copy the text at the start of the gap and shrink the gap accordingly.
+    // 3. Flag the contiguous copy as outdated.
+
+    moveGap(p_position);
+    reserveGap(p_text.size());
+
+    std::memcpy(m_buffer.data() + m_gapStart, p_text.data(), p_text.size());
+    m_gapStart += p_text.size();
+    m_viewDirty = true;
+}
+
+void CTextBuffer::erase(const size_t p_position, const size_t p_length)
+{
+    // 1. Move the gap to the end of the range to erase (the usual case is a backspace at the caret).
+    // 2. Widen the gap backwards to swallow the range.
+    // 3. Flag the contiguous copy as outdated.
+
+    const size_t l_length = std::min(p_length, size() - std::min(p_position, size()));
+
+    moveGap(p_position + l_length);
+    m_gapStart -= l_length;
+    m_viewDirty = true;
+}
+
+std::string CTextBuffer::substr(const size_t p_position, const size_t p_length) const
+{
+    // 1. Clamp the range to the text.
+    // 2. Copy the part before the gap and the part after the gap.
+
+    const size_t l_start = std::min(p_position, size());
+    const size_t l_end = l_start + std::min(p_length, size() - l_start);
+    const size_t l_gapLength = m_gapEnd - m_gapStart;
+
+    std::string l_text;
+    l_text.reserve(l_end - l_start);
+
+    if (l_start < m_gapStart)
+    {
+        l_text.append(m_buffer.data() + l_start, std::min(l_end, m_gapStart) - l_start);
+    }
+
+    if (l_end > m_gapStart)
+    {
+        const size_t l_from = std::max(l_start, m_gapStart);
+        l_text.append(m_buffer.data() + l_from + l_gapLength, l_end - l_from);
+    }
+
+    return l_text;
+}
+
+const std::string& CTextBuffer::str(void) const
+{
+    // Rebuild the contiguous copy only if the text changed since the last call.
+
+    if (m_viewDirty)
+    {
+        m_view.assign(m_buffer.data(), m_gapStart);
+        m_view.append(m_buffer.data() + m_gapEnd, m_buffer.size() - m_gapEnd);
+        m_viewDirty = false;
+    }
+
+    return m_view;
+}
+
+void CTextBuffer::moveGap(const size_t p_position)
+{
+    // Move the bytes between the gap and the position to the other side of the gap.
+    // The cost is the distance moved, not the size of the text.
+
+    const size_t l_position = std::min(p_position, size());
+
+    if (l_position < m_gapStart)
+    {
+        const size_t l_count = m_gapStart - l_position;
+        std::memmove(m_buffer.data() + m_gapEnd - l_count, m_buffer.data() + l_position, l_count);
+        m_gapStart -= l_count;
+        m_gapEnd -= l_count;
+    }
+    else if (l_position > m_gapStart)
+    {
+        const size_t l_count = l_position - m_gapStart;
+        std::memmove(m_buffer.data() + m_gapStart, m_buffer.data() + m_gapEnd, l_count);
+        m_gapStart += l_count;
+        m_gapEnd += l_count;
+    }
+}
+
+void CTextBuffer::reserveGap(const size_t p_length)
+{
+    // 1. Early exit if the gap is big enough.
+    // 2. Otherwise, double the storage (at least TEXTBUFFER_MIN_GAP bytes of gap), so growing is amortized.
+    // 3. Move the text after the gap to the end of the new storage.
+
+    if (m_gapEnd - m_gapStart >= p_length) return;
+
+    const size_t l_tailLength = m_buffer.size() - m_gapEnd;
+    const size_t l_newSize = std::max(2 * m_buffer.size(), size() + p_length + TEXTBUFFER_MIN_GAP);
+
+    m_buffer.resize(l_newSize);
+    std::memmove(m_buffer.data() + l_newSize - l_tailLength, m_buffer.data() + m_gapEnd, l_tailLength);
+    m_gapEnd = l_newSize - l_tailLength;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file  textBuffer.h
+ * @brief Header file for the CTextBuffer class, a gap buffer used to store the input text.
+ */
+#ifndef _TEXTBUFFER_H_
+#define _TEXTBUFFER_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Macro that indicates the minimum size of the gap, in bytes, when the buffer grows.
+ *
+ * @param X The size of the gap.
+ */
+#define TEXTBUFFER_MIN_GAP 64
+
+/**
+ * @class CTextBuffer
+ * @brief Gap buffer that keeps free space at the caret, so inserting or erasing there is O(1) amortized.
+ *
+ * Moving the edit position costs the distance moved, which is small for caret-local edits. A contiguous copy
+ * of the text is only built (and cached) when it is requested for rendering or output.
+ */
+class CTextBuffer
+{
+    public:
+
+    /**
+     * @brief        Constructor for the CTextBuffer class.
+     * @param p_text The initial text.
+     */
+    CTextBuffer(const std::string& p_text = std::string());
+
+    /**
+     * @brief  Gets the size of the text.
+     * @return The size, in bytes.
+     */
+    inline size_t size(void) const { return m_buffer.size() - (m_gapEnd - m_gapStart); }
+
+    /**
+     * @brief  Checks whether the text is empty.
+     * @return TRUE if the text is empty; otherwise, FALSE.
+     */
+    inline bool empty(void) const { return size() == 0; }
+
+    /**
+     * @brief         Gets a byte of the text.
+     * @param p_index The position of the byte (it must be lower than the size).
+     * @return        The byte at the given position.
+     */
+    inline char at(const size_t p_index) const { return m_buffer[p_index < m_gapStart ? p_index : p_index + (m_gapEnd - m_gapStart)]; }
+
+    /**
+     * @brief            Inserts text at a given position, moving the gap there first.
+     * @param p_position The position, in bytes.
+     * @param p_text     The text to insert.
+     */
+    void insert(const size_t p_position, const std::string& p_text);
+
+    /**
+     * @brief            Erases text at a given position, by widening the gap.
+     * @param p_position The position, in bytes.
+     * @param p_length   The amount of bytes to erase.
+     */
+    void erase(const size_t p_position, const size_t p_length);
+
+    /**
+     * @brief            Copies a part of the text.
+     * @param p_position The position, in bytes.
+     * @param p_length   The amount of bytes to copy (clamped to the end of the text).
+     * @return           The copied text.
+     */
+    std::string substr(const size_t p_position, const size_t p_length = std::string::npos) const;
+
+    /**
+     * @brief  Gets a contiguous view of the whole text, built only when the text changed since the last call.
+     * @return Reference to the text.
+     */
+    const std::string& str(void) const;
+
+    private:
+
+    /**
+     * @brief            Moves the gap to a given position.
+     * @param p_position The position, in bytes.
+     */
+    void moveGap(const size_t p_position);
+
+    /**
+     * @brief          Grows the buffer so the gap can hold, at least, the given amount of bytes.
+     * @param p_length The amount of bytes.
+     */
+    void reserveGap(const size_t p_length);
+
+    /**
+     * @brief The storage: text before the gap, the gap and text after the gap.
+     */
+    std::vector<char> m_buffer;
+
+    /**
+     * @brief Position of the first byte of the gap.
+     */
+    size_t m_gapStart;
+
+    /**
+     * @brief Position of the first byte after the gap.
+     */
+    size_t m_gapEnd;
+
+    /**
+     * @brief Cached contiguous copy of the text.
+     */
+    mutable std::string m_view;
+
+    /**
+     * @brief Indicates whether the cached copy must be rebuilt.
+     */
+    mutable bool m_viewDirty;
+};
+
+#endif // _TEXTBUFFER_H_
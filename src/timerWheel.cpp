@@ -0,0 +1,142 @@
+/**
+ * @file  timerWheel.cpp
+ * @brief Implementation file for the CTimerWheel class.
+ */
+
+#include <algorithm>
+#include "timerWheel.h"
+
+CTimerWheel::CTimerWheel(void) :
+    m_currentTick(SDL_GetTicks() / TIMERWHEEL_RESOLUTION),
+    m_nextId(1),
+    m_count(0)
+{
+    // Nothing to do here. Timers are added when needed.
+}
+
+SDL_TimerID CTimerWheel::addTimer(const Uint32 p_interval, SDL_TimerCallback p_callback, void* p_param)
+{
+    // 1. Build the timer with a new identifier and a deadline relative to the current ticks.
+    // 2. Insert it in the slot of its deadline.
+    // 3. Return the identifier.
+
+    const STimer l_timer{ m_nextId++, SDL_GetTicks() + p_interval, p_interval, p_callback, p_param };
+    schedule(l_timer);
+
+    if (m_nextId <= 0) m_nextId = 1;
+
+    return l_timer.m_id;
+}
+
+void CTimerWheel::removeTimer(const SDL_TimerID p_id)
+{
+    // 1. Ignore invalid identifiers.
+    // 2. Look for the timer in the slots and erase it.
+    // 3. If it is being called right now, disable it so it is not called nor rescheduled.
+
+    if (p_id == 0) return;
+
+    for (std::vector<STimer>& l_slot : m_slots)
+    {
+        for (std::vector<STimer>::iterator l_iterator = l_slot.begin(); l_iterator != l_slot.end(); ++l_iterator)
+        {
+            if (l_iterator->m_id == p_id)
+            {
+                l_slot.erase(l_iterator);
+                --m_count;
+                return;
+            }
+        }
+    }
+
+    for (STimer& l_timer : m_firing)
+    {
+        if (l_timer.m_id == p_id) l_timer.m_callback = nullptr;
+    }
+}
+
+const bool CTimerWheel::advance(const Uint32 p_now)
+{
+    // 1. Visit the slots from the last processed tick up to the current one (each slot once at most).
+    // 2. Move the timers whose deadline has passed out of their slot.
+    // 3. Call them, in order, and reschedule the ones whose callback returns a new interval.
+    // 4. Return whether any callback was called.
+
+    const Uint32 l_nowTick = p_now / TIMERWHEEL_RESOLUTION;
+    const Uint32 l_ticks = std::min<Uint32>(l_nowTick - m_currentTick + 1, TIMERWHEEL_SLOTS);
+
+    for (Uint32 l_i = 0; l_i < l_ticks; ++l_i)
+    {
+        std::vector<STimer>& l_slot = m_slots[(m_currentTick + l_i) & (TIMERWHEEL_SLOTS - 1)];
+
+        for (size_t l_index = 0; l_index < l_slot.size();)
+        {
+            if (SDL_TICKS_PASSED(p_now, l_slot[l_index].m_deadline))
+            {
+                m_firing.push_back(l_slot[l_index]);
+                l_slot.erase(l_slot.begin() + l_index);
+                --m_count;
+            }
+            else
+            {
+                ++l_index;
+            }
+        }
+    }
+
+    m_currentTick = l_nowTick;
+
+    std::sort(m_firing.begin(), m_firing.end(), [](const STimer& p_a, const STimer& p_b) { return static_cast<Sint32>(p_a.m_deadline - p_b.m_deadline) < 0; });
+
+    const bool l_fired = !m_firing.empty();
+
+    for (size_t l_index = 0; l_index < m_firing.size(); ++l_index)
+    {
+        STimer l_timer = m_firing[l_index];
+
+        if (l_timer.m_callback == nullptr) continue;
+
+        l_timer.m_interval = l_timer.m_callback(l_timer.m_interval, l_timer.m_param);
+
+        if (l_timer.m_interval > 0 && m_firing[l_index].m_callback != nullptr)
+        {
+            l_timer.m_deadline = p_now + l_timer.m_interval;
+            schedule(l_timer);
+        }
+    }
+
+    m_firing.clear();
+    return l_fired;
+}
+
+const int CTimerWheel::getTimeout(const Uint32 p_now) const
+{
+    // 1. If there are no timers, indicate that the loop can wait indefinitely (-1).
+    // 2. Otherwise, return the time left until the earliest deadline (0 if already passed).
+
+    if (m_count == 0) return -1;
+
+    Sint32 l_timeout = SDL_MAX_SINT32;
+
+    for (const std::vector<STimer>& l_slot : m_slots)
+    {
+        for (const STimer& l_timer : l_slot)
+        {
+            l_timeout = std::min(l_timeout, static_cast<Sint32>(l_timer.m_deadline - p_now));
+        }
+    }
+
+    return std::max<Sint32>(0, l_timeout);
+}
+
+void CTimerWheel::schedule(const STimer& p_timer)
+{
+    // Insert the timer in the slot of its deadline, or in the current one if the deadline falls in an already
+    // processed tick, so it is not skipped until the wheel turns around.
+
+    const Uint32 l_deadlineTick = p_timer.m_deadline / TIMERWHEEL_RESOLUTION;
+    const Uint32 l_tick = static_cast<Sint32>(l_deadlineTick - m_currentTick) < 0 ? m_currentTick : l_deadlineTick;
+
+    m_slots[l_tick & (TIMERWHEEL_SLOTS - 1)].push_back(p_timer);
+    ++m_count;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file  timerWheel.h
+ * @brief Header file for the CTimerWheel class, which runs timers on the main thread.
+ */
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include <vector>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates the amount of slots in the timer wheel.
+ *
+ * @param X The amount of slots. It must be a power of two.
+ */
+#define TIMERWHEEL_SLOTS 64
+
+/**
+ * @brief Macro that indicates the time span covered by each slot of the timer wheel.
+ *
+ * @param X The span, in milliseconds.
+ */
+#define TIMERWHEEL_RESOLUTION 10
+
+/**
+ * @class CTimerWheel
+ * @brief Hashed timer wheel driven by the main loop, used instead of SDL timers (which run on their own thread).
+ *
+ * Callbacks follow the SDL_TimerCallback contract: they receive the interval and the user parameter,
+ * and return the next interval to keep the timer running, or 0 to stop it.
+ */
+class CTimerWheel
+{
+    public:
+
+    /**
+     * @brief Constructor for the CTimerWheel class.
+     */
+    CTimerWheel(void);
+
+    /**
+     * @brief            Adds a timer.
+     * @param p_interval The amount of milliseconds until the callback is called.
+     * @param p_callback The function to call.
+     * @param p_param    The parameter to pass to the callback.
+     * @return           The identifier of the timer (never 0).
+     */
+    SDL_TimerID addTimer(const Uint32 p_interval, SDL_TimerCallback p_callback, void* p_param);
+
+    /**
+     * @brief      Removes a timer, if it is still running.
+     * @param p_id The identifier of the timer (0 is ignored).
+     */
+    void removeTimer(const SDL_TimerID p_id);
+
+    /**
+     * @brief       Calls the callbacks of all timers whose deadline has passed, rescheduling the ones that keep running.
+     * @param p_now The current ticks.
+     * @return      TRUE if any callback was called; otherwise, FALSE.
+     */
+    const bool advance(const Uint32 p_now);
+
+    /**
+     * @brief       Gets the amount of milliseconds until the next deadline, to use as the main-loop timeout.
+     * @param p_now The current ticks.
+     * @return      The timeout in milliseconds, or -1 if there are no timers.
+     */
+    const int getTimeout(const Uint32 p_now) const;
+
+    private:
+
+    /**
+     * @struct STimer
+     * @brief  A scheduled timer.
+     */
+    struct STimer
+    {
+        SDL_TimerID m_id;
+        Uint32 m_deadline;
+        Uint32 m_interval;
+        SDL_TimerCallback m_callback;
+        void* m_param;
+    };
+
+    /**
+     * @brief         Inserts a timer in the slot of its deadline.
+     * @param p_timer The timer to insert.
+     */
+    void schedule(const STimer& p_timer);
+
+    /**
+     * @brief The slots of the wheel, each one holding the timers whose deadline falls in it (modulo the wheel span).
+     */
+    std::vector<STimer> m_slots[TIMERWHEEL_SLOTS];
+
+    /**
+     * @brief The timers being called by advance (so they can be removed from within a callback).
+     */
+    std::vector<STimer> m_firing;
+
+    /**
+     * @brief The last tick (ticks divided by the resolution) processed by advance.
+     */
+    Uint32 m_currentTick;
+
+    /**
+     * @brief The identifier to give to the next timer.
+     */
+    SDL_TimerID m_nextId;
+
+    /**
+     * @brief The amount of scheduled timers.
+     */
+    size_t m_count;
+};
+
+#endif // _TIMERWHEEL_H_
@@ -0,0 +1,340 @@
+/**
+ * @file  utf8.cpp
+ * @brief Implementation file for the UTF8_Utils namespace.
+ */
+
+#include <cstring>
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    /**
+     * @brief Size, in bytes, of the blocks checked at once for ASCII text.
+     */
+    constexpr size_t s_blockSize = 16;
+
+    /**
+     * @struct SByteView
+     * @brief  Read-only view of raw bytes, with the interface the UTF8_Utils templates expect.
+     */
+    struct SByteView
+    {
+        const char* m_data;
+        size_t m_size;
+
+        inline size_t size(void) const { return m_size; }
+        inline char at(const size_t p_index) const { return m_data[p_index]; }
+    };
+
+    /**
+     * @brief        Checks whether a block of s_blockSize bytes is ASCII (no byte has the high bit set).
+     * @param p_data The block.
+     * @return       TRUE if all the bytes are ASCII; otherwise, FALSE.
+     */
+    inline bool isAsciiBlock(const char* p_data)
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_data))) == 0;
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+        return vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p_data))) < 0x80;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const uint8x16_t l_block = vld1q_u8(reinterpret_cast<const uint8_t*>(p_data));
+        const uint8x8_t l_merged = vorr_u8(vget_low_u8(l_block), vget_high_u8(l_block));
+        return (vget_lane_u64(vreinterpret_u64_u8(l_merged), 0) & 0x8080808080808080ULL) == 0;
+#else
+        Uint64 l_words[2];
+        std::memcpy(l_words, p_data, sizeof(l_words));
+        return ((l_words[0] | l_words[1]) & 0x8080808080808080ULL) == 0;
+#endif
+    }
+
+    /**
+     * @brief        Gets the index of the lowest bit set.
+     * @param p_mask The mask (it must not be 0).
+     * @return       The index of the bit.
+     */
+    inline unsigned int lowestBit(const Uint64 p_mask)
+    {
+#ifdef _MSC_VER
+        unsigned long l_index(0);
+        _BitScanForward64(&l_index, p_mask);
+        return static_cast<unsigned int>(l_index);
+#else
+        return static_cast<unsigned int>(__builtin_ctzll(p_mask));
+#endif
+    }
+
+    /**
+     * @brief Sorted ranges of code points that extend the previous grapheme.
+     *
+     * It covers the combining marks of the scripts the fonts support, the joiners, the variation selectors,
+     * the emoji skin tone modifiers and the tag characters. Looking a code point up is a binary search over a
+     * fixed amount of ranges, so it takes a bounded amount of steps.
+     */
+    const Uint32 s_extendRanges[][2] =
+    {
+        { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 },
+        { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x0610, 0x061A }, { 0x064B, 0x065F }, { 0x0670, 0x0670 },
+        { 0x06D6, 0x06DC }, { 0x06DF, 0x06E4 }, { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0900, 0x0903 },
+        { 0x093A, 0x094F }, { 0x0951, 0x0957 }, { 0x0962, 0x0963 }, { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A },
+        { 0x0E47, 0x0E4E }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200C, 0x200D }, { 0x20D0, 0x20FF },
+        { 0x302A, 0x302F }, { 0x3099, 0x309A }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0x1F3FB, 0x1F3FF },
+        { 0xE0020, 0xE007F }, { 0xE0100, 0xE01EF }
+    };
+}
+
+bool UTF8_Utils::isGraphemeExtend(const Uint32 p_codepoint)
+{
+    // 1. Early exit for the most common case: code points below the first range.
+    // 2. Binary search of the range that could contain the code point.
+
+    if (p_codepoint < s_extendRanges[0][0]) return false;
+
+    size_t l_low(0);
+    size_t l_high(sizeof(s_extendRanges) / sizeof(s_extendRanges[0]));
+
+    while (l_low < l_high)
+    {
+        const size_t l_middle = (l_low + l_high) / 2;
+
+        if (p_codepoint > s_extendRanges[l_middle][1])
+        {
+            l_low = l_middle + 1;
+        }
+        else if (p_codepoint < s_extendRanges[l_middle][0])
+        {
+            l_high = l_middle;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool UTF8_Utils::isEmoji(const std::string& p_grapheme)
+{
+    // 1. Check the first code point against the pictographic planes (U+1F000 to U+1FAFF).
+    // 2. Otherwise, look for the emoji variation selector (U+FE0F, encoded as EF B8 8F).
+
+    size_t l_length(0);
+    const Uint32 l_first = p_grapheme.empty() ? 0 : decode(p_grapheme, 0, l_length);
+
+    if (l_first >= 0x1F000 && l_first <= 0x1FAFF) return true;
+
+    return p_grapheme.find("\xEF\xB8\x8F") != std::string::npos;
+}
+
+void UTF8_Utils::encode(const Uint32 p_codepoint, std::string& p_output)
+{
+    // Invalid code points (surrogates or out of range) are encoded as the replacement character.
+
+    const Uint32 l_codepoint = (p_codepoint > 0x10FFFF || (p_codepoint >= 0xD800 && p_codepoint <= 0xDFFF)) ? REPLACEMENT_CHARACTER : p_codepoint;
+
+    if (l_codepoint < 0x80)
+    {
+        p_output.push_back(static_cast<char>(l_codepoint));
+    }
+    else if (l_codepoint < 0x800)
+    {
+        p_output.push_back(static_cast<char>(0xC0 | (l_codepoint >> 6)));
+        p_output.push_back(static_cast<char>(0x80 | (l_codepoint & 0x3F)));
+    }
+    else if (l_codepoint < 0x10000)
+    {
+        p_output.push_back(static_cast<char>(0xE0 | (l_codepoint >> 12)));
+        p_output.push_back(static_cast<char>(0x80 | ((l_codepoint >> 6) & 0x3F)));
+        p_output.push_back(static_cast<char>(0x80 | (l_codepoint & 0x3F)));
+    }
+    else
+    {
+        p_output.push_back(static_cast<char>(0xF0 | (l_codepoint >> 18)));
+        p_output.push_back(static_cast<char>(0x80 | ((l_codepoint >> 12) & 0x3F)));
+        p_output.push_back(static_cast<char>(0x80 | ((l_codepoint >> 6) & 0x3F)));
+        p_output.push_back(static_cast<char>(0x80 | (l_codepoint & 0x3F)));
+    }
+}
+
+size_t UTF8_Utils::sanitize(const char* p_data, const size_t p_size, std::string& p_output, SCodepointIndex* p_index)
+{
+    // 1. Reserve the output, which is only longer than the input when bytes are replaced, and the index.
+    // 2. Copy whole blocks of ASCII bytes (one code point and one grapheme each, except the first one after a
+    //    zero-width joiner), sampling the index inside the block, if asked.
+    // 3. Otherwise, decode one code point: copy it if valid, or write the replacement character for the malformed byte.
+    //    It starts a grapheme unless it extends the previous one, as in nextGrapheme.
+    // 4. Return the amount of replaced bytes.
+
+    static const char s_replacement[] = "\xEF\xBF\xBD";
+
+    const SByteView l_view{ p_data, p_size };
+    size_t l_position(0);
+    size_t l_count(0);
+    size_t l_graphemes(0);
+    size_t l_replaced(0);
+    Uint32 l_previous(0);
+    bool l_pendingIndicator(false);
+
+    p_output.clear();
+    p_output.reserve(p_size);
+    if (p_index != nullptr)
+    {
+        p_index->m_offsets.clear();
+        p_index->m_offsets.reserve(p_size / UTF8_INDEX_STRIDE + 1);
+    }
+
+    while (l_position < p_size)
+    {
+        if (p_size - l_position >= s_blockSize && isAsciiBlock(p_data + l_position))
+        {
+            if (p_index != nullptr)
+            {
+                for (size_t l_sample = (l_count + UTF8_INDEX_STRIDE - 1) / UTF8_INDEX_STRIDE * UTF8_INDEX_STRIDE; l_sample < l_count + s_blockSize; l_sample += UTF8_INDEX_STRIDE)
+                {
+                    p_index->m_offsets.push_back(p_output.size() + l_sample - l_count);
+                }
+            }
+
+            l_graphemes += (l_previous == ZERO_WIDTH_JOINER) ? s_blockSize - 1 : s_blockSize;
+            l_previous = static_cast<unsigned char>(p_data[l_position + s_blockSize - 1]);
+            l_pendingIndicator = false;
+
+            p_output.append(p_data + l_position, s_blockSize);
+            l_position += s_blockSize;
+            l_count += s_blockSize;
+            continue;
+        }
+
+        if (p_index != nullptr && l_count % UTF8_INDEX_STRIDE == 0) p_index->m_offsets.push_back(p_output.size());
+
+        size_t l_length(0);
+        const Uint32 l_codepoint = decode(l_view, l_position, l_length);
+
+        if (l_codepoint == REPLACEMENT_CHARACTER && l_length == 1)
+        {
+            p_output.append(s_replacement, sizeof(s_replacement) - 1);
+            ++l_replaced;
+        }
+        else
+        {
+            p_output.append(p_data + l_position, l_length);
+        }
+
+        if (l_count == 0 || (!isGraphemeExtend(l_codepoint) && l_previous != ZERO_WIDTH_JOINER && !(l_pendingIndicator && isRegionalIndicator(l_codepoint))))
+        {
+            ++l_graphemes;
+            l_pendingIndicator = isRegionalIndicator(l_codepoint);
+        }
+        else
+        {
+            l_pendingIndicator = false;
+        }
+
+        l_previous = l_codepoint;
+        l_position += l_length;
+        ++l_count;
+    }
+
+    if (p_index != nullptr)
+    {
+        p_index->m_count = l_count;
+        p_index->m_graphemes = l_graphemes;
+    }
+
+    return l_replaced;
+}
+
+size_t UTF8_Utils::codepointOffset(const std::string& p_text, const SCodepointIndex& p_index, const size_t p_codepoint)
+{
+    // Start from the closest sampled offset and walk the remaining code points.
+
+    if (p_codepoint >= p_index.m_count) return p_text.size();
+
+    size_t l_offset = p_index.m_offsets[p_codepoint / UTF8_INDEX_STRIDE];
+
+    for (size_t l_i = p_codepoint % UTF8_INDEX_STRIDE; l_i > 0; --l_i) l_offset = nextCodepoint(p_text, l_offset);
+
+    return l_offset;
+}
+
+size_t UTF8_Utils::find(const std::string& p_text, const std::string& p_pattern, const size_t p_from)
+{
+    // 1. Handle the trivial cases: an empty pattern, or not enough text left.
+    // 2. Compare the first and last bytes of the pattern with 16 candidate positions at once, and verify the
+    //    candidates whose both bytes match.
+    // 3. Scan the remaining positions with memchr on the first byte, and verify each candidate.
+
+    const size_t l_length = p_pattern.size();
+    const size_t l_size = p_text.size();
+
+    if (l_length == 0) return p_from <= l_size ? p_from : std::string::npos;
+    if (p_from > l_size || l_size - p_from < l_length) return std::string::npos;
+
+    const char* l_data = p_text.data();
+    const char* l_pattern = p_pattern.data();
+    const size_t l_last = l_size - l_length;
+    size_t l_position = p_from;
+
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i l_first = _mm_set1_epi8(l_pattern[0]);
+    const __m128i l_lastByte = _mm_set1_epi8(l_pattern[l_length - 1]);
+
+    for (; l_position <= l_last && l_last - l_position >= s_blockSize - 1; l_position += s_blockSize)
+    {
+        const __m128i l_starts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_data + l_position));
+        const __m128i l_ends = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_data + l_position + l_length - 1));
+        Uint64 l_mask = static_cast<Uint64>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(l_starts, l_first), _mm_cmpeq_epi8(l_ends, l_lastByte))));
+
+        for (; l_mask != 0; l_mask &= l_mask - 1)
+        {
+            const size_t l_candidate = l_position + lowestBit(l_mask);
+            if (std::memcmp(l_data + l_candidate, l_pattern, l_length) == 0) return l_candidate;
+        }
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t l_first = vdupq_n_u8(static_cast<uint8_t>(l_pattern[0]));
+    const uint8x16_t l_lastByte = vdupq_n_u8(static_cast<uint8_t>(l_pattern[l_length - 1]));
+
+    for (; l_position <= l_last && l_last - l_position >= s_blockSize - 1; l_position += s_blockSize)
+    {
+        const uint8x16_t l_starts = vld1q_u8(reinterpret_cast<const uint8_t*>(l_data + l_position));
+        const uint8x16_t l_ends = vld1q_u8(reinterpret_cast<const uint8_t*>(l_data + l_position + l_length - 1));
+        const uint8x16_t l_matches = vandq_u8(vceqq_u8(l_starts, l_first), vceqq_u8(l_ends, l_lastByte));
+
+        // Narrow each 8-bit lane to 4 bits, so the 16 results fit in a 64-bit mask
+        Uint64 l_mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(l_matches), 4)), 0);
+
+        for (; l_mask != 0; l_mask &= ~(static_cast<Uint64>(0xF) << (lowestBit(l_mask) & ~3u)))
+        {
+            const size_t l_candidate = l_position + (lowestBit(l_mask) >> 2);
+            if (std::memcmp(l_data + l_candidate, l_pattern, l_length) == 0) return l_candidate;
+        }
+    }
+#endif
+
+    while (l_position <= l_last)
+    {
+        const char* l_found = static_cast<const char*>(std::memchr(l_data + l_position, l_pattern[0], l_last - l_position + 1));
+
+        if (l_found == nullptr) break;
+
+        l_position = static_cast<size_t>(l_found - l_data);
+
+        if (std::memcmp(l_data + l_position, l_pattern, l_length) == 0) return l_position;
+
+        ++l_position;
+    }
+
+    return std::string::npos;
+}
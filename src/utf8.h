@@ -0,0 +1,335 @@
+/**
+ * @file  utf8.h
+ * @brief Utility functions to decode UTF-8 text and find character and grapheme boundaries.
+ */
+#ifndef _UTF8_H_
+#define _UTF8_H_
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+/**
+ * @brief Macro that indicates every how many code points the code point index keeps a byte offset.
+ *
+ * @param X The stride, in code points.
+ */
+#define UTF8_INDEX_STRIDE 64
+
+/**
+ * @namespace UTF8_Utils
+ * @brief     Namespace containing utility functions for UTF-8 text.
+ *
+ * The template functions work with any text type exposing size() and at(), such as std::string and CTextBuffer.
+ */
+namespace UTF8_Utils
+{
+    /**
+     * @brief Replacement character used for malformed sequences.
+     */
+    static constexpr Uint32 REPLACEMENT_CHARACTER = 0xFFFD;
+
+    /**
+     * @brief Zero-width joiner, which glues the next character to the current grapheme.
+     */
+    static constexpr Uint32 ZERO_WIDTH_JOINER = 0x200D;
+
+    /**
+     * @brief Length of a UTF-8 sequence indexed by the 5 upper bits of its lead byte (0 for continuation and invalid bytes).
+     */
+    static constexpr unsigned char s_sequenceLengths[32] =
+    {
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xxxxxxx
+        0, 0, 0, 0, 0, 0, 0, 0,                         // 10xxxxxx
+        2, 2, 2, 2,                                     // 110xxxxx
+        3, 3,                                           // 1110xxxx
+        4,                                              // 11110xxx
+        0                                               // 11111xxx
+    };
+
+    /**
+     * @brief        Gets the length of the UTF-8 sequence starting with a given byte.
+     * @param p_lead The lead byte.
+     * @return       The length, in bytes (0 if the byte cannot start a sequence).
+     */
+    inline unsigned int sequenceLength(const unsigned char p_lead) { return s_sequenceLengths[p_lead >> 3]; }
+
+    /**
+     * @brief        Checks whether a byte is a continuation byte (10xxxxxx).
+     * @param p_byte The byte.
+     * @return       TRUE if it is a continuation byte; otherwise, FALSE.
+     */
+    inline bool isContinuation(const unsigned char p_byte) { return (p_byte & 0xC0) == 0x80; }
+
+    /**
+     * @brief             Checks whether a code point extends the previous grapheme (combining marks, joiners, variation selectors, skin tones...).
+     * @param p_codepoint The code point.
+     * @return            TRUE if it does not start a new grapheme; otherwise, FALSE.
+     */
+    bool isGraphemeExtend(const Uint32 p_codepoint);
+
+    /**
+     * @brief             Checks whether a code point is a regional indicator (they form flags in pairs).
+     * @param p_codepoint The code point.
+     * @return            TRUE if it is a regional indicator; otherwise, FALSE.
+     */
+    inline bool isRegionalIndicator(const Uint32 p_codepoint) { return p_codepoint >= 0x1F1E6 && p_codepoint <= 0x1F1FF; }
+
+    /**
+     * @brief            Checks whether a grapheme is an emoji, to be drawn from a colour font: it starts with a code point
+     *                   of the pictographic planes (flags included), or it asks for the emoji presentation (U+FE0F).
+     * @param p_grapheme The grapheme.
+     * @return           TRUE if it is an emoji; otherwise, FALSE.
+     */
+    bool isEmoji(const std::string& p_grapheme);
+
+    /**
+     * @struct SCodepointIndex
+     * @brief  Sampled index of code points: the byte offset of every UTF8_INDEX_STRIDE-th code point of a text, and
+     *         the amount of code points and graphemes (characters) of the text.
+     */
+    struct SCodepointIndex
+    {
+        /**
+         * @brief Byte offset of code points 0, UTF8_INDEX_STRIDE, 2 * UTF8_INDEX_STRIDE...
+         */
+        std::vector<size_t> m_offsets;
+
+        /**
+         * @brief Amount of code points in the text.
+         */
+        size_t m_count;
+
+        /**
+         * @brief Amount of graphemes in the text (as counted by countGraphemes).
+         */
+        size_t m_graphemes;
+    };
+
+    /**
+     * @brief          Validates UTF-8 text, replacing malformed sequences, and builds its code point index in the same pass.
+     *
+     * Blocks of 16 ASCII bytes are detected with SIMD instructions (SSE2 or NEON, when available) and copied as is;
+     * only the rest of the bytes are decoded one code point at a time.
+     *
+     * @param p_data   The text to validate.
+     * @param p_size   The size of the text, in bytes.
+     * @param p_output Output: the valid text, where each malformed byte is replaced by REPLACEMENT_CHARACTER.
+     * @param p_index  Output: the code point index of the valid text (optional).
+     * @return         The amount of replaced bytes.
+     */
+    size_t sanitize(const char* p_data, const size_t p_size, std::string& p_output, SCodepointIndex* p_index = nullptr);
+
+    /**
+     * @brief             Gets the byte offset of a code point, walking at most UTF8_INDEX_STRIDE code points from the index.
+     * @param p_text      The text the index was built for.
+     * @param p_index     The code point index.
+     * @param p_codepoint The position of the code point, in code points.
+     * @return            The byte offset (the size of the text if the position is beyond its end).
+     */
+    size_t codepointOffset(const std::string& p_text, const SCodepointIndex& p_index, const size_t p_codepoint);
+
+    /**
+     * @brief           Finds the first occurrence of a pattern in a text, starting at a given position.
+     *
+     * Candidates are filtered comparing the first and last bytes of the pattern with 16 positions at once (SSE2 or
+     * NEON, when available) and verified with memcmp; the rest of the text is scanned with memchr. Since UTF-8 is
+     * self-synchronizing, a valid pattern only matches at character boundaries of a valid text.
+     *
+     * @param p_text    The text.
+     * @param p_pattern The pattern.
+     * @param p_from    The position where the search starts, in bytes.
+     * @return          The position of the occurrence, or std::string::npos if not found.
+     */
+    size_t find(const std::string& p_text, const std::string& p_pattern, const size_t p_from = 0);
+
+    /**
+     * @brief             Encodes a code point as UTF-8.
+     * @param p_codepoint The code point.
+     * @param p_output    The string to append the bytes to.
+     */
+    void encode(const Uint32 p_codepoint, std::string& p_output);
+
+    /**
+     * @brief            Decodes the code point at a given position.
+     * @param p_text     The text.
+     * @param p_position The position of the lead byte.
+     * @param p_length   Output: the length of the sequence, in bytes (1 for malformed sequences).
+     * @return           The code point, or REPLACEMENT_CHARACTER if the sequence is malformed.
+     */
+    template <typename T>
+    Uint32 decode(const T& p_text, const size_t p_position, size_t& p_length)
+    {
+        // 1. Get the length of the sequence from the lead byte.
+        // 2. Check that it fits in the text and that the following bytes are continuation bytes.
+        // 3. Accumulate the payload bits and reject overlong forms, surrogates and out-of-range values.
+
+        static constexpr Uint32 s_leadMasks[5] = { 0, 0x7F, 0x1F, 0x0F, 0x07 };
+        static constexpr Uint32 s_minimums[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+        const unsigned char l_lead = static_cast<unsigned char>(p_text.at(p_position));
+        const unsigned int l_length = sequenceLength(l_lead);
+
+        p_length = 1;
+
+        if (l_length == 0 || p_position + l_length > p_text.size()) return REPLACEMENT_CHARACTER;
+
+        Uint32 l_codepoint = l_lead & s_leadMasks[l_length];
+
+        for (unsigned int l_i = 1; l_i < l_length; ++l_i)
+        {
+            const unsigned char l_byte = static_cast<unsigned char>(p_text.at(p_position + l_i));
+
+            if (!isContinuation(l_byte)) return REPLACEMENT_CHARACTER;
+
+            l_codepoint = (l_codepoint << 6) | (l_byte & 0x3F);
+        }
+
+        if (l_codepoint < s_minimums[l_length] || l_codepoint > 0x10FFFF || (l_codepoint >= 0xD800 && l_codepoint <= 0xDFFF)) return REPLACEMENT_CHARACTER;
+
+        p_length = l_length;
+        return l_codepoint;
+    }
+
+    /**
+     * @brief            Gets the position of the code point following the one at a given position.
+     * @param p_text     The text.
+     * @param p_position The position of the current code point.
+     * @return           The position of the next code point (the size of the text at the end).
+     */
+    template <typename T>
+    size_t nextCodepoint(const T& p_text, const size_t p_position)
+    {
+        size_t l_length(0);
+
+        if (p_position >= p_text.size()) return p_text.size();
+
+        decode(p_text, p_position, l_length);
+        return p_position + l_length;
+    }
+
+    /**
+     * @brief            Gets the position of the code point preceding a given position.
+     * @param p_text     The text.
+     * @param p_position The position.
+     * @return           The position of the previous code point (0 at the start).
+     */
+    template <typename T>
+    size_t previousCodepoint(const T& p_text, const size_t p_position)
+    {
+        // Skip back over continuation bytes (at most 3), and fall back to a single byte if the sequence is malformed.
+
+        if (p_position == 0) return 0;
+
+        size_t l_start = p_position - 1;
+
+        while (l_start > 0 && p_position - l_start < 4 && isContinuation(static_cast<unsigned char>(p_text.at(l_start)))) --l_start;
+
+        size_t l_length(0);
+        decode(p_text, l_start, l_length);
+
+        return (l_start + l_length == p_position) ? l_start : p_position - 1;
+    }
+
+    /**
+     * @brief            Gets the position of the grapheme following the one at a given position.
+     * @param p_text     The text.
+     * @param p_position The position of the current grapheme.
+     * @return           The position of the next grapheme (the size of the text at the end).
+     */
+    template <typename T>
+    size_t nextGrapheme(const T& p_text, const size_t p_position)
+    {
+        // 1. Skip the first code point of the grapheme.
+        // 2. Keep skipping code points that extend it, the ones glued by a zero-width joiner and the second regional indicator of a flag.
+
+        const size_t l_size = p_text.size();
+
+        if (p_position >= l_size) return l_size;
+
+        size_t l_length(0);
+        Uint32 l_previous = decode(p_text, p_position, l_length);
+        size_t l_position = p_position + l_length;
+        bool l_pendingIndicator = isRegionalIndicator(l_previous);
+
+        while (l_position < l_size)
+        {
+            const Uint32 l_codepoint = decode(p_text, l_position, l_length);
+            const bool l_pairsIndicator = l_pendingIndicator && isRegionalIndicator(l_codepoint);
+
+            if (!isGraphemeExtend(l_codepoint) && l_previous != ZERO_WIDTH_JOINER && !l_pairsIndicator) break;
+
+            l_pendingIndicator = false;
+            l_previous = l_codepoint;
+            l_position += l_length;
+        }
+
+        return l_position;
+    }
+
+    /**
+     * @brief            Gets the position of the grapheme preceding a given position.
+     * @param p_text     The text.
+     * @param p_position The position (a grapheme boundary).
+     * @return           The position of the previous grapheme (0 at the start).
+     */
+    template <typename T>
+    size_t previousGrapheme(const T& p_text, const size_t p_position)
+    {
+        // 1. Step back one code point.
+        // 2. While it extends a grapheme, or it is glued by a zero-width joiner, step back again.
+        // 3. If it is the second regional indicator of a flag (an odd amount of indicators precedes it), step back again.
+
+        size_t l_position = previousCodepoint(p_text, p_position);
+        size_t l_length(0);
+
+        while (l_position > 0)
+        {
+            const Uint32 l_codepoint = decode(p_text, l_position, l_length);
+            const size_t l_previousPosition = previousCodepoint(p_text, l_position);
+            const Uint32 l_previous = decode(p_text, l_previousPosition, l_length);
+
+            if (isGraphemeExtend(l_codepoint) || l_previous == ZERO_WIDTH_JOINER)
+            {
+                l_position = l_previousPosition;
+                continue;
+            }
+
+            if (isRegionalIndicator(l_codepoint) && isRegionalIndicator(l_previous))
+            {
+                size_t l_count(0);
+                size_t l_scan(l_position);
+
+                while (l_scan > 0)
+                {
+                    l_scan = previousCodepoint(p_text, l_scan);
+                    if (!isRegionalIndicator(decode(p_text, l_scan, l_length))) break;
+                    ++l_count;
+                }
+
+                if (l_count % 2 == 1) l_position = l_previousPosition;
+            }
+
+            break;
+        }
+
+        return l_position;
+    }
+
+    /**
+     * @brief        Counts the graphemes of a text.
+     * @param p_text The text.
+     * @return       The amount of graphemes.
+     */
+    template <typename T>
+    size_t countGraphemes(const T& p_text)
+    {
+        size_t l_count(0);
+
+        for (size_t l_position = 0; l_position < p_text.size(); l_position = nextGrapheme(p_text, l_position)) ++l_count;
+
+        return l_count;
+    }
+}
+
+#endif // _UTF8_H_
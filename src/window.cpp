@@ -7,18 +7,20 @@
 #include "window.h"
 #include "def.h"
 #include "sdlUtils.h"
-#include "keyboard.h"
+#include "inputMapper.h"
+#include "resourceManager.h"
 #include <string> 
 #include <map>
 
 /**
- * @brief Macros that indicate initial and usual durations of the timer used to check keyholds.
+ * @brief Macros that indicate initial and usual durations, in milliseconds, of the timer used to check keyholds.
  */
-#define KEYHOLD_TIMER_INITIAL_DURATION  6
-#define KEYHOLD_TIMER_POSTINIT_DURATION 2
+#define KEYHOLD_TIMER_INITIAL_DURATION  (6 * MS_PER_FRAME)
+#define KEYHOLD_TIMER_POSTINIT_DURATION (2 * MS_PER_FRAME)
 
 CWindow::CWindow(void):
     m_timer(0),
+    m_repeatDue(false),
     m_lastPressed(SDLK_0),
 	m_isJoyButtonDown(false),
     m_returnValue(0)
@@ -38,32 +40,36 @@ CWindow::~CWindow(void)
 const int CWindow::execute(void)
 {
     // 1. Start a loop to control frame's update and rendering processes.
-    // 2. Start a loop to check for SDL events by polling and addressing the events to handle.
-    // 3. Check for these events: key down, quit, joystick-button down/up, axis/hat motions.
-    // 4. When the joystick button is up, treat it as an unsupported event and handle it appropriately.
-    // 5. If a key is being held, indicate whether rendering must be done.
-    // 6. Do rendering, if applicable (note: SDL timers run in their own thread, so results may vary per platform).
-    // 7. Cap the rendering frame rate, when appropriate.
+    // 2. Wait for an SDL event, or until the next timer deadline, and then poll the remaining events to handle them.
+    // 3. Check for these events: key down/up, quit, joystick-button down/up, axis/hat motions.
+    // 4. When the joystick button is up, treat it as an unsupported event and handle it appropriately. When the
+    //    background thread is done, redraw the window over the new background.
+    // 5. Run the timers whose deadline has passed (caret blinking, key repetition, etc.) on this thread.
+    // 6. If a key is being held, indicate whether rendering must be done.
+    // 7. Do rendering, if applicable.
     // 8. Return the execution value when the the loop ends (1 = success, 0 = fail).
 
     m_returnValue = 0;
-    Uint32 l_time(0);
     SDL_Event l_event;
     bool l_loop(true);
     bool l_render(true);
 
     while (l_loop)
     {
-        l_time = SDL_GetTicks();
+        bool l_hasEvent = SDL_WaitEventTimeout(&l_event, l_render ? 0 : m_timers.getTimeout(SDL_GetTicks())) != 0;
 
-        while (SDL_PollEvent(&l_event))
+        while (l_hasEvent)
         {
             switch (l_event.type)
             {
             case SDL_KEYDOWN:
-                l_render = this->keyPress(l_event);
+                l_render = this->keyPress(l_event) || l_render;
                 if (m_returnValue) l_loop = false;
                 break;
+            case SDL_KEYUP:
+                this->keyRelease(l_event);
+                l_render = true;
+                break;
             case SDL_QUIT:
                 return m_returnValue;
                 break;
@@ -72,16 +78,14 @@ const int CWindow::execute(void)
                 break;
             case SDL_JOYBUTTONUP:
                 m_isJoyButtonDown = false;
-                // Releasing the actual SELECT button remasks the password.
-                if (l_event.jbutton.button == 6) { // SELECT button
+                // Releasing the actual SELECT button remasks the password and ends the SELECT combos.
+                if (CInputMapper::instance().getButton(l_event.jbutton.button).m_key == MYKEY_SELECT) {
                     SDL_Event l_keyEvent;
                     l_keyEvent.key.keysym.sym = MYKEY_SELECT;
-                    if (!Globals::g_windows.empty()) {
-                        CKeyboard* kb = dynamic_cast<CKeyboard*>(Globals::g_windows.back());
-                        if (kb) kb->keyRelease(l_keyEvent);
-                    }
+                    this->keyRelease(l_keyEvent);
                 }
                 this->handleUnsupportedEvent();
+                l_render = true;
                 break;
             case SDL_JOYAXISMOTION:
                 handleJoyAxisMotion(l_event, l_render, l_loop);
@@ -90,31 +94,39 @@ const int CWindow::execute(void)
                 handleJoyHatMotion(l_event, l_render, l_loop);
                 break;
             default:
-                this->handleUnsupportedEvent();
+                if (CResourceManager::instance().adoptBackground(l_event))
+                {
+                    this->backgroundChanged();
+                }
+                else
+                {
+                    this->handleUnsupportedEvent();
+                }
+                l_render = true;
                 break;
             }
+
+            l_hasEvent = SDL_PollEvent(&l_event) != 0;
         }
 
+        l_render = m_timers.advance(SDL_GetTicks()) || l_render;
+        if (m_returnValue) l_loop = false;
+
         if (l_loop)
         {
             l_render = this->keyHold() || l_render;
         }
 
-#if CARETTICKS == false
-        // Render if necessary (always render for the TSP, because of multithreading issues with SDL-timer handlers).
+        // Render if necessary (timers run in this thread, so their changes are always rendered here).
         if (l_render && l_loop)
-#endif
         {
+            INHIBIT(const Uint32 l_renderStart = SDL_GetTicks();)
             SDL_Utils::renderAll();
             SDL_UpdateWindowSurface(Globals::g_sdlwindow);
 
             l_render = false;
-            INHIBIT(SDL.Log("Render time: %s ms", SDL_GetTicks() - l_time);)
+            INHIBIT(SDL_Log("Render time: %u ms", SDL_GetTicks() - l_renderStart);)
         }
-
-        // Cap the framerate
-        l_time = MS_PER_FRAME - (SDL_GetTicks() - l_time);
-        if (l_time <= MS_PER_FRAME) SDL_Delay(l_time);
     }
 
     return m_returnValue;
@@ -122,69 +134,21 @@ const int CWindow::execute(void)
 
 void CWindow::handleJoyButtonDown(const SDL_Event& p_event, bool& p_render, bool& p_loop)
 {
-    // 1. Check for a button-down event and map it, appropriately.
-    // 2. Check for all buttons, except the START one (so it can be used by other apps if needed).
-    // 3. Indicate that the loop must end, when it corresponds.
+    // 1. Look up the action bound to the button in the controller map (a single array index).
+    // 2. Flag whether the action must repeat while the button is held.
+    // 3. Send the mapped key press, if the button is bound.
+    // 4. Indicate that the loop must end, when it corresponds.
 
     INHIBIT(SDL_Log("Button %d", p_event.jbutton.button);)
 
-    SDL_Event l_keyEvent;
-    m_isJoyButtonDown = false;
+    const CInputMapper::SBinding& l_binding = CInputMapper::instance().getButton(p_event.jbutton.button);
+    m_isJoyButtonDown = l_binding.m_hold;
 
-    switch (p_event.jbutton.button)
+    if (l_binding.m_key != SDLK_UNKNOWN)
     {
-    case 1: // A
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_OPEN;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 2: // Y
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_SYSTEM;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 3: // X
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_OPERATION;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 4: // L
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_CARETLEFT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 5: // R
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_CARETRIGHT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 6: // SELECT (Trimui Smart Pro)
-        m_isJoyButtonDown = true;
-        l_keyEvent.key.keysym.sym = MYKEY_SELECT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 7: // Start
-        l_keyEvent.key.keysym.sym = MYKEY_START;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case 0: // B
-        l_keyEvent.key.keysym.sym = MYKEY_TRANSFER;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-#ifdef _WIN64
-
-    case 10: // Menu in XBox Controller
-
-#else
-
-    case 8: // Menu in TSP
-
-#endif
-        l_keyEvent.key.keysym.sym = MYKEY_PARENT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    default:
-        break;
+        SDL_Event l_keyEvent;
+        l_keyEvent.key.keysym.sym = l_binding.m_key;
+        p_render = this->keyPress(l_keyEvent) || p_render;
     }
 
     if (m_returnValue) p_loop = false;
@@ -192,37 +156,19 @@ void CWindow::handleJoyButtonDown(const SDL_Event& p_event, bool& p_render, bool
 
 void CWindow::handleJoyAxisMotion(const SDL_Event& p_event, bool& p_render, bool& p_loop)
 {
-    // 1. Check for a axis-motion event and map it, appropriately.   
-    // 2. Indicate that the loop must end, when it corresponds.
+    // 1. Look up the action bound to the axis, if moved past the press threshold.
+    // 2. Send the mapped key press, if any.
+    // 3. Indicate that the loop must end, when it corresponds.
 
-    INHIBIT(SDL_Log("Axis C %d, %d", p_event.caxis.axis, p_event.caxis.value);)
     INHIBIT(SDL_Log("Axis J %d, %d", p_event.jaxis.axis, p_event.jaxis.value);)
 
-    SDL_Event l_keyEvent;
-
-#ifdef _WIN64
-
-    if (p_event.caxis.axis == 4) // LT in XBox Controller
-
-#else
+    const SDL_Keycode l_key = CInputMapper::instance().getAxis(p_event.jaxis.axis, p_event.jaxis.value);
 
-    if (p_event.caxis.axis == 2) // L2 in TSP
-
-#endif
-    {
-        if (p_event.caxis.value > 30000)
-        {
-            l_keyEvent.key.keysym.sym = MYKEY_PAGEDOWN;
-            p_render = this->keyPress(l_keyEvent);
-        }
-    }
-    else if (p_event.caxis.axis == 5)
+    if (l_key != SDLK_UNKNOWN)
     {
-        if (p_event.caxis.value > 30000)
-        {
-            l_keyEvent.key.keysym.sym = MYKEY_PAGEUP;
-            p_render = this->keyPress(l_keyEvent);
-        }
+        SDL_Event l_keyEvent;
+        l_keyEvent.key.keysym.sym = l_key;
+        p_render = this->keyPress(l_keyEvent) || p_render;
     }
 
     if (m_returnValue) p_loop = false;
@@ -230,35 +176,20 @@ void CWindow::handleJoyAxisMotion(const SDL_Event& p_event, bool& p_render, bool
 
 void CWindow::handleJoyHatMotion(const SDL_Event& p_event, bool& p_render, bool& p_loop)
 {
-    // 1. Check for a hat-motion event and map it, appropriately.   
-    // 2. Indicate that the loop must end, when it corresponds.
+    // 1. Look up the action bound to the hat value (centered and diagonals are usually unbound).
+    // 2. Flag whether the action must repeat while the hat is held, and send the mapped key press, if any.
+    // 3. Indicate that the loop must end, when it corresponds.
 
     INHIBIT(SDL_Log("Axis J %d, %d", p_event.jhat.hat, p_event.jhat.value);)
 
-    SDL_Event l_keyEvent;
-    m_isJoyButtonDown = true;
+    const CInputMapper::SBinding& l_binding = CInputMapper::instance().getHat(p_event.jhat.value);
+    m_isJoyButtonDown = l_binding.m_hold;
 
-    switch (p_event.jhat.value)
+    if (l_binding.m_key != SDLK_UNKNOWN)
     {
-    case SDL_HAT_UP:
-        l_keyEvent.key.keysym.sym = MYKEY_UP;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case SDL_HAT_DOWN:
-        l_keyEvent.key.keysym.sym = MYKEY_DOWN;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case SDL_HAT_LEFT:
-        l_keyEvent.key.keysym.sym = MYKEY_LEFT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    case SDL_HAT_RIGHT:
-        l_keyEvent.key.keysym.sym = MYKEY_RIGHT;
-        p_render = this->keyPress(l_keyEvent);
-        break;
-    default:
-        m_isJoyButtonDown = false;
-        break;
+        SDL_Event l_keyEvent;
+        l_keyEvent.key.keysym.sym = l_binding.m_key;
+        p_render = this->keyPress(l_keyEvent) || p_render;
     }
 
     if (m_returnValue) p_loop = false;
@@ -266,11 +197,16 @@ void CWindow::handleJoyHatMotion(const SDL_Event& p_event, bool& p_render, bool&
 
 const bool CWindow::keyPress(const SDL_Event& p_event)
 {
-    // 1. Reset timer, if running.
+    // 1. Stop the key-hold timer, if running.
     // 2. Update the last-pressed key.
     // 3. Return false, by default.
 
-    if (m_timer) m_timer = 0;
+    if (m_timer)
+    {
+        m_timers.removeTimer(m_timer);
+        m_timer = 0;
+    }
+
     m_lastPressed = p_event.key.keysym.sym;
     return false;
 }
@@ -278,9 +214,8 @@ const bool CWindow::keyPress(const SDL_Event& p_event)
 const bool CWindow::tick(const Uint8 p_held)
 {
     // 1. Check if a key is held (the passed parameter is evaluated as TRUE).
-    //    a. If the timer is not running, set its initial duration.
-    //    b. If the timer is running, decrement it.
-    //    c. When timer reaches zero, return TRUE to indicate that a key press has happened and set new duration.
+    //    a. If the timer is not running, start it with its initial duration.
+    //    b. If the timer is running and has elapsed, return TRUE to indicate that a key press has happened.
     // 2. If a key is not held (the passed parameter is evaluated as FALSE), stop the timer if it is running.
     // 3. Return the the output that indicates whether a key is pressed or not.
 
@@ -288,22 +223,30 @@ const bool CWindow::tick(const Uint8 p_held)
 
     if (p_held > 0)
     {
-        if (m_timer > 0)
+        if (m_timer == 0)
         {
-            --m_timer;
-
-            if (m_timer == 0)
-            {
-                l_return = true;
-                m_timer = KEYHOLD_TIMER_POSTINIT_DURATION;
-            }
+            m_repeatDue = false;
+            m_timer = m_timers.addTimer(KEYHOLD_TIMER_INITIAL_DURATION, keyRepeat, this);
         }
-        else
+        else if (m_repeatDue)
         {
-            m_timer = KEYHOLD_TIMER_INITIAL_DURATION;
+            m_repeatDue = false;
+            l_return = true;
         }
     }
-    else if (m_timer > 0) m_timer = 0;
+    else if (m_timer > 0)
+    {
+        m_timers.removeTimer(m_timer);
+        m_timer = 0;
+    }
 
     return l_return;
 }
+
+Uint32 CWindow::keyRepeat(Uint32, void* p_param)
+{
+    // Flag the repetition, so the next call to tick reports it, and keep repeating at the usual duration.
+
+    static_cast<CWindow*>(p_param)->m_repeatDue = true;
+    return KEYHOLD_TIMER_POSTINIT_DURATION;
+}
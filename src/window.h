@@ -6,6 +6,7 @@
 #define _WINDOW_H_
 
 #include <SDL.h>
+#include "timerWheel.h"
 
 /**
  * @class CWindow
@@ -82,6 +83,12 @@ class CWindow
      */
     virtual const bool keyPress(const SDL_Event& p_event);
 
+    /**
+     * @brief         Manages SDL key-release events (nothing by default).
+     * @param p_event The SDL event.
+     */
+    virtual void keyRelease(const SDL_Event& p_event) {}
+
     /**
      * @brief  Manages SDL key-hold events.
      * @return TRUE if the key hold was handled; otherwise, FALSE.
@@ -89,9 +96,9 @@ class CWindow
     virtual const bool keyHold(void) = 0;
 
     /**
-     * @brief        Handles timer ticks.
+     * @brief        Handles key repetition while a key is held.
      * @param p_held Indicates if the key is held.
-     * @return       TRUE if the tick was handled; otherwise, FALSE.
+     * @return       TRUE if the key must be repeated in this iteration; otherwise, FALSE.
      */
     const bool tick(const Uint8 p_held);
 
@@ -101,9 +108,24 @@ class CWindow
     virtual void handleUnsupportedEvent(void) = 0;
 
     /**
-     * @brief Timer for key hold.
+     * @brief Manages the arrival of the background, loaded while the window was already shown (nothing by default).
+     */
+    virtual void backgroundChanged(void) {}
+
+    /**
+     * @brief Timers of the window, driven by the main loop (on the main thread).
+     */
+    CTimerWheel m_timers;
+
+    /**
+     * @brief Timer for key hold (0 if not running).
+     */
+    SDL_TimerID m_timer;
+
+    /**
+     * @brief Indicates whether the key-hold timer has elapsed since the last repetition.
      */
-    unsigned int m_timer;
+    bool m_repeatDue;
 
     /**
      * @brief The last pressed key.
@@ -122,6 +144,14 @@ class CWindow
 
     private:
 
+    /**
+     * @brief            Callback of the key-hold timer.
+     * @param p_interval The current interval of the timer.
+     * @param p_param    The window.
+     * @return           The interval until the next repetition.
+     */
+    static Uint32 keyRepeat(Uint32 p_interval, void* p_param);
+
     /**
      * @brief          Copy constructor for the CWindow class (forbidden).
      * @param p_source The source window to copy.
@@ -0,0 +1,304 @@
+/**
+ * @file  atlasgen.cpp
+ * @brief Build tool that pre-rasterizes the glyphs of the keyboard into a header compiled into the program (see
+ *        CFontAtlas and the Makefile).
+ *
+ * Usage: atlasgen <font file> <size> <output header> [<text file>...]
+ *
+ * The atlas has the printable ASCII characters (footer, buttons and typed text) and every character of the text files
+ * (e.g. layout descriptions) the font provides, rendered at the given size. Each glyph is trimmed to its ink and
+ * packed in shelves, as 8-bit coverage.
+ *
+ * @note This file should be compiled using C++11, for the machine running the build.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+namespace
+{
+    /**
+     * @brief Width of the atlas, in pixels (its height depends on the glyphs).
+     */
+    constexpr int s_atlasWidth = 512;
+
+    /**
+     * @struct SGlyph
+     * @brief  A rasterized glyph, trimmed to its ink.
+     */
+    struct SGlyph
+    {
+        Uint32 m_codepoint;             /**< The code point */
+        int m_x;                        /**< Left of the glyph in the atlas */
+        int m_y;                        /**< Top of the glyph in the atlas */
+        int m_width;                    /**< Width of the glyph */
+        int m_height;                   /**< Height of the glyph */
+        int m_offsetX;                  /**< Left of the glyph relative to the pen */
+        int m_offsetY;                  /**< Top of the glyph relative to the top of the line */
+        int m_advance;                  /**< Advance of the pen */
+        std::vector<Uint8> m_pixels;    /**< Coverage of the glyph, row by row */
+    };
+
+    /**
+     * @brief              Adds the code points of a UTF-8 text to a set (malformed sequences are skipped).
+     * @param p_text       The text.
+     * @param p_codepoints The set.
+     */
+    void collect(const std::string& p_text, std::set<Uint32>& p_codepoints)
+    {
+        for (size_t l_position = 0; l_position < p_text.size();)
+        {
+            const Uint8 l_lead = static_cast<Uint8>(p_text[l_position]);
+            const size_t l_length = l_lead < 0x80 ? 1 : l_lead < 0xC2 ? 0 : l_lead < 0xE0 ? 2 : l_lead < 0xF0 ? 3 : l_lead < 0xF5 ? 4 : 0;
+
+            if (l_length == 0 || l_position + l_length > p_text.size())
+            {
+                ++l_position;
+                continue;
+            }
+
+            Uint32 l_codepoint = l_length == 1 ? l_lead : l_lead & (0x7F >> l_length);
+            bool l_valid = true;
+
+            for (size_t l_i = 1; l_i < l_length; ++l_i)
+            {
+                const Uint8 l_byte = static_cast<Uint8>(p_text[l_position + l_i]);
+                l_valid = l_valid && (l_byte & 0xC0) == 0x80;
+                l_codepoint = (l_codepoint << 6) | (l_byte & 0x3F);
+            }
+
+            if (l_valid) p_codepoints.insert(l_codepoint);
+
+            l_position += l_valid ? l_length : 1;
+        }
+    }
+
+    /**
+     * @brief             Rasterizes a glyph and trims it to its ink.
+     * @param p_font      The font.
+     * @param p_codepoint The code point.
+     * @param p_glyph     Output: the glyph (without its position in the atlas).
+     * @return            TRUE if the glyph was rendered; otherwise, FALSE.
+     */
+    bool rasterize(TTF_Font* p_font, const Uint32 p_codepoint, SGlyph& p_glyph)
+    {
+        // 1. Render the glyph shaded, white on black: its palette goes from the background to the foreground, so the
+        //    index of each pixel is its coverage. The surface is as tall as the line; it starts at the pen, or at the
+        //    left of the glyph if it reaches left of the pen.
+        // 2. Find the box of its ink, and copy it.
+
+        int l_minX(0), l_maxX(0), l_minY(0), l_maxY(0), l_advance(0);
+
+        if (TTF_GlyphMetrics32(p_font, p_codepoint, &l_minX, &l_maxX, &l_minY, &l_maxY, &l_advance) != 0) return false;
+
+        SDL_Surface* l_surface = TTF_RenderGlyph32_Shaded(p_font, p_codepoint, SDL_Color{ 255, 255, 255, 255 }, SDL_Color{ 0, 0, 0, 255 });
+
+        if (l_surface == nullptr) return false;
+
+        const Uint8* l_pixels = static_cast<const Uint8*>(l_surface->pixels);
+        int l_left(l_surface->w), l_top(l_surface->h), l_right(0), l_bottom(0);
+
+        for (int l_y = 0; l_y < l_surface->h; ++l_y)
+        {
+            for (int l_x = 0; l_x < l_surface->w; ++l_x)
+            {
+                if (l_pixels[l_y * l_surface->pitch + l_x] == 0) continue;
+
+                l_left = std::min(l_left, l_x);
+                l_right = std::max(l_right, l_x + 1);
+                l_top = std::min(l_top, l_y);
+                l_bottom = std::max(l_bottom, l_y + 1);
+            }
+        }
+
+        p_glyph.m_codepoint = p_codepoint;
+        p_glyph.m_advance = l_advance;
+        p_glyph.m_pixels.clear();
+
+        if (l_right <= l_left)
+        {
+            // No ink (e.g. a space): only the advance matters.
+            p_glyph.m_width = p_glyph.m_height = p_glyph.m_offsetX = p_glyph.m_offsetY = 0;
+        }
+        else
+        {
+            p_glyph.m_width = l_right - l_left;
+            p_glyph.m_height = l_bottom - l_top;
+            p_glyph.m_offsetX = l_left + std::min(0, l_minX);
+            p_glyph.m_offsetY = l_top;
+
+            for (int l_y = l_top; l_y < l_bottom; ++l_y)
+            {
+                p_glyph.m_pixels.insert(p_glyph.m_pixels.end(), l_pixels + l_y * l_surface->pitch + l_left, l_pixels + l_y * l_surface->pitch + l_right);
+            }
+        }
+
+        SDL_FreeSurface(l_surface);
+
+        return true;
+    }
+
+    /**
+     * @brief          Packs the glyphs in shelves, tallest first.
+     * @param p_glyphs The glyphs, whose position is set.
+     * @return         The height of the atlas, in pixels.
+     */
+    int pack(std::vector<SGlyph>& p_glyphs)
+    {
+        std::vector<SGlyph*> l_order;
+
+        for (SGlyph& l_glyph : p_glyphs) l_order.push_back(&l_glyph);
+
+        std::stable_sort(l_order.begin(), l_order.end(), [](const SGlyph* p_a, const SGlyph* p_b) { return p_a->m_height > p_b->m_height; });
+
+        int l_x(0), l_y(0), l_shelfHeight(0);
+
+        for (SGlyph* l_glyph : l_order)
+        {
+            if (l_x + l_glyph->m_width > s_atlasWidth)
+            {
+                l_x = 0;
+                l_y += l_shelfHeight;
+                l_shelfHeight = 0;
+            }
+
+            l_glyph->m_x = l_x;
+            l_glyph->m_y = l_y;
+            l_x += l_glyph->m_width;
+            l_shelfHeight = std::max(l_shelfHeight, l_glyph->m_height);
+        }
+
+        return l_y + l_shelfHeight;
+    }
+
+    /**
+     * @brief            Writes the atlas as a header.
+     * @param p_path     The path of the header.
+     * @param p_font     The path of the font file, for the record.
+     * @param p_size     The size the glyphs were rendered at, in points.
+     * @param p_height   The height of a line, in pixels.
+     * @param p_lineSkip The distance between lines, in pixels.
+     * @param p_glyphs   The packed glyphs, sorted by code point.
+     * @param p_rows     The height of the atlas, in pixels.
+     * @return           TRUE if the header was written; otherwise, FALSE.
+     */
+    bool write(const std::string& p_path, const std::string& p_font, const int p_size, const int p_height, const int p_lineSkip, const std::vector<SGlyph>& p_glyphs, const int p_rows)
+    {
+        FILE* l_file = std::fopen(p_path.c_str(), "w");
+
+        if (l_file == nullptr) return false;
+
+        std::vector<Uint8> l_atlas(static_cast<size_t>(s_atlasWidth) * std::max(1, p_rows), 0);
+
+        for (const SGlyph& l_glyph : p_glyphs)
+        {
+            for (int l_y = 0; l_y < l_glyph.m_height; ++l_y)
+            {
+                std::copy_n(l_glyph.m_pixels.begin() + l_y * l_glyph.m_width, l_glyph.m_width, l_atlas.begin() + (l_glyph.m_y + l_y) * s_atlasWidth + l_glyph.m_x);
+            }
+        }
+
+        std::fprintf(l_file, "// Generated by tools/atlasgen from %s at %i points: do not edit.\n\n", p_font.c_str(), p_size);
+        std::fprintf(l_file, "constexpr int s_atlasSize = %i;\n", p_size);
+        std::fprintf(l_file, "constexpr int s_atlasLineHeight = %i;\n", p_height);
+        std::fprintf(l_file, "constexpr int s_atlasLineSkip = %i;\n", p_lineSkip);
+        std::fprintf(l_file, "constexpr int s_atlasWidth = %i;\n\n", s_atlasWidth);
+        std::fprintf(l_file, "constexpr CFontAtlas::SGlyph s_atlasGlyphs[] =\n{\n");
+
+        for (const SGlyph& l_glyph : p_glyphs)
+        {
+            std::fprintf(l_file, "    { 0x%04X, %i, %i, %i, %i, %i, %i, %i },\n", static_cast<unsigned int>(l_glyph.m_codepoint), l_glyph.m_x, l_glyph.m_y, l_glyph.m_width, l_glyph.m_height, l_glyph.m_offsetX, l_glyph.m_offsetY, l_glyph.m_advance);
+        }
+
+        std::fprintf(l_file, "};\n\nconstexpr Uint8 s_atlasPixels[] =\n{");
+
+        for (size_t l_i = 0; l_i < l_atlas.size(); ++l_i)
+        {
+            std::fprintf(l_file, "%s%u,", (l_i % 32 == 0) ? "\n    " : "", static_cast<unsigned int>(l_atlas[l_i]));
+        }
+
+        std::fprintf(l_file, "\n};\n");
+
+        return std::fclose(l_file) == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // 1. Open the font at the given size.
+    // 2. Collect the printable ASCII characters and the characters of the text files the font provides.
+    // 3. Rasterize, pack and write them.
+
+    if (argc < 4)
+    {
+        std::fprintf(stderr, "Usage: %s <font file> <size> <output header> [<text file>...]\n", argv[0]);
+        return 1;
+    }
+
+    const int l_size = std::atoi(argv[2]);
+
+    if (l_size <= 0 || TTF_Init() != 0)
+    {
+        std::fprintf(stderr, "Invalid size, or SDL_ttf could not be initialized\n");
+        return 1;
+    }
+
+    TTF_Font* l_font = TTF_OpenFont(argv[1], l_size);
+
+    if (l_font == nullptr)
+    {
+        std::fprintf(stderr, "Could not open %s: %s\n", argv[1], TTF_GetError());
+        TTF_Quit();
+        return 1;
+    }
+
+    std::set<Uint32> l_codepoints;
+
+    for (Uint32 l_codepoint = 0x20; l_codepoint < 0x7F; ++l_codepoint) l_codepoints.insert(l_codepoint);
+
+    for (int l_i = 4; l_i < argc; ++l_i)
+    {
+        std::ifstream l_file(argv[l_i], std::ios::binary);
+
+        if (!l_file)
+        {
+            std::fprintf(stderr, "Could not read %s\n", argv[l_i]);
+            continue;
+        }
+
+        collect(std::string(std::istreambuf_iterator<char>(l_file), std::istreambuf_iterator<char>()), l_codepoints);
+    }
+
+    std::vector<SGlyph> l_glyphs;
+
+    for (const Uint32 l_codepoint : l_codepoints)
+    {
+        SGlyph l_glyph;
+
+        if (l_codepoint < 0x20 || (l_codepoint >= 0x7F && l_codepoint < 0xA0)) continue;
+        if (!TTF_GlyphIsProvided32(l_font, l_codepoint) || !rasterize(l_font, l_codepoint, l_glyph)) continue;
+
+        l_glyphs.push_back(l_glyph);
+    }
+
+    const int l_rows = pack(l_glyphs);
+    const bool l_written = write(argv[3], argv[1], l_size, TTF_FontHeight(l_font), TTF_FontLineSkip(l_font), l_glyphs, l_rows);
+
+    std::printf("%s: %u glyphs, %i x %i pixels\n", argv[3], static_cast<unsigned int>(l_glyphs.size()), s_atlasWidth, l_rows);
+
+    TTF_CloseFont(l_font);
+    TTF_Quit();
+
+    if (!l_written) std::fprintf(stderr, "Could not write %s\n", argv[3]);
+
+    return l_written ? 0 : 1;
+}
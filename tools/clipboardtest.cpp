@@ -0,0 +1,114 @@
+/**
+ * @file  clipboardtest.cpp
+ * @brief Checks of the persisted clipboard (see CClipboard and the Makefile).
+ *
+ * Usage: clipboardtest <directory for temporary files>
+ *
+ * Checks that existing files which are not clipboard files are left untouched, that a new file is sized and gets
+ * the text, and that a text longer than the capacity is cut before a 3-byte character straddling it. Prints each
+ * failed check and returns 1 if any failed.
+ *
+ * @note This file should be compiled using C++11, for the machine running the build.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "../src/clipboard.h"
+#include "../src/utf8.h"
+
+namespace
+{
+    /**
+     * @brief Amount of failed checks.
+     */
+    int s_failures(0);
+
+    /**
+     * @brief             Reports a failed check.
+     * @param p_condition The result of the check.
+     * @param p_what      The description of the check.
+     */
+    void check(const bool p_condition, const char* p_what)
+    {
+        if (!p_condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", p_what);
+            ++s_failures;
+        }
+    }
+
+    /**
+     * @brief        Reads a whole file.
+     * @param p_path The path of the file.
+     * @return       The content of the file.
+     */
+    std::string readFile(const std::string& p_path)
+    {
+        std::ifstream l_file(p_path, std::ios::binary);
+        std::ostringstream l_content;
+
+        l_content << l_file.rdbuf();
+        return l_content.str();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // 1. Write files which are not clipboard files (of another size, and of the size of one without its magic), and
+    //    check that they are rejected and left untouched.
+    // 2. Map a new (empty) file, and check that it is sized.
+    // 3. Set a text whose last 3-byte character straddles the capacity, and check that it is left out whole, in
+    //    memory and in the file.
+
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <directory for temporary files>\n", argv[0]);
+        return 1;
+    }
+
+    const std::string l_directory(argv[1]);
+    const std::string l_otherPath = l_directory + "/clipboardtest.other";
+    const std::string l_clipboardPath = l_directory + "/clipboardtest.clipboard";
+    const std::string l_other("Not a clipboard: a line of some unrelated file\n");
+    const std::string l_unmarked(CLIPBOARD_FILE_SIZE, 'x');
+
+    std::ofstream(l_otherPath, std::ios::binary) << l_other;
+    std::ofstream(l_clipboardPath, std::ios::binary).close();
+
+    CClipboard& l_clipboard = CClipboard::instance();
+
+    check(!l_clipboard.init(l_otherPath), "an unrelated file is rejected");
+    check(readFile(l_otherPath) == l_other, "an unrelated file is left untouched");
+
+    std::ofstream(l_otherPath, std::ios::binary) << l_unmarked;
+
+    check(!l_clipboard.init(l_otherPath), "a file without magic is rejected");
+    check(readFile(l_otherPath) == l_unmarked, "a file without magic is left untouched");
+
+    check(l_clipboard.init(l_clipboardPath), "a new file is mapped");
+    check(readFile(l_clipboardPath).size() == CLIPBOARD_FILE_SIZE, "a new file is sized");
+
+    // The capacity is the size of the file without its header (magic and length)
+    const size_t l_capacity = CLIPBOARD_FILE_SIZE - 8;
+    const std::string l_character("\xE2\x82\xAC");
+    const std::string l_text = std::string(l_capacity - 1, 'x') + l_character + "tail";
+
+    l_clipboard.set(l_text);
+
+    const std::string& l_stored = l_clipboard.get();
+    std::string l_sanitized;
+
+    check(l_stored == std::string(l_capacity - 1, 'x'), "a character straddling the capacity is left out whole");
+    check(UTF8_Utils::sanitize(l_stored.data(), l_stored.size(), l_sanitized) == 0, "the cut text is valid UTF-8");
+    check(readFile(l_clipboardPath).compare(8, l_stored.size(), l_stored) == 0, "the cut text is written to the file");
+
+    unlink(l_otherPath.c_str());
+    unlink(l_clipboardPath.c_str());
+
+    if (s_failures == 0) std::printf("All clipboard checks passed\n");
+
+    return (s_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file  textbench.cpp
+ * @brief Microbenchmark of the text model of the keyboard (see CTextBuffer, UTF8_Utils::sanitize and the Makefile).
+ *
+ * Usage: textbench [<text size in KiB>] [<amount of edits>]
+ *
+ * Types and erases characters at a caret in the middle of a text (1 MiB and 100000 edits by default), as holding a
+ * key does, with the gap buffer and with a plain string, and prints the time each took. Then validates a text of
+ * mixed ASCII and multibyte characters with a few malformed bytes (8 times that size), as the initial text is, with
+ * the sanitizer (which also builds the code point index) and with a loop decoding every code point, checks the index
+ * against the text, and prints the time and throughput of each.
+ *
+ * @note This file should be compiled using C++11, for the machine running the build.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../src/textBuffer.h"
+#include "../src/utf8.h"
+
+namespace
+{
+    /**
+     * @brief         Measures the time a run of edits takes.
+     * @param p_edits The edits.
+     * @return        The time, in milliseconds.
+     */
+    template <typename T> double measure(const T& p_edits)
+    {
+        const std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+
+        p_edits();
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - l_start).count();
+    }
+
+    /**
+     * @brief         Types characters at a caret, erasing every third one, as typeChar and pressBackspace do.
+     * @param p_text  The text (CTextBuffer or std::string).
+     * @param p_caret The position of the caret, in bytes.
+     * @param p_count The amount of edits.
+     */
+    template <typename T> void edit(T& p_text, size_t p_caret, const long p_count)
+    {
+        const std::string l_character("a");
+
+        for (long l_i = 0; l_i < p_count; ++l_i)
+        {
+            if (l_i % 3 == 2)
+            {
+                --p_caret;
+                p_text.erase(p_caret, 1);
+            }
+            else
+            {
+                p_text.insert(p_caret, l_character);
+                ++p_caret;
+            }
+        }
+    }
+
+    /**
+     * @brief          Validates a text one code point at a time, replacing malformed bytes, for comparison.
+     * @param p_text   The text.
+     * @param p_output Output: the valid text.
+     * @return         The amount of replaced bytes.
+     */
+    size_t decodeAll(const std::string& p_text, std::string& p_output)
+    {
+        size_t l_replaced(0);
+        size_t l_length(0);
+
+        p_output.clear();
+        p_output.reserve(p_text.size());
+
+        for (size_t l_position = 0; l_position < p_text.size(); l_position += l_length)
+        {
+            const Uint32 l_codepoint = UTF8_Utils::decode(p_text, l_position, l_length);
+
+            if (l_codepoint == UTF8_Utils::REPLACEMENT_CHARACTER && l_length == 1) ++l_replaced;
+
+            UTF8_Utils::encode(l_codepoint, p_output);
+        }
+
+        return l_replaced;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // 1. Build the text, and place the caret in its middle.
+    // 2. Run the same edits on the gap buffer and on a string, and check that both end with the same text.
+    // 3. Build a larger text, mostly ASCII lines with accented letters, CJK characters, emoji and malformed bytes.
+    // 4. Validate it with the sanitizer and with the decoding loop, and check that both agree, and that the index
+    //    gives the amount of characters and the offset of sampled code points.
+
+    const long l_size = (argc > 1) ? std::strtol(argv[1], nullptr, 10) * 1024 : 1024 * 1024;
+    const long l_count = (argc > 2) ? std::strtol(argv[2], nullptr, 10) : 100000;
+
+    if (l_size <= 0 || l_count <= 0)
+    {
+        std::fprintf(stderr, "Usage: %s [<text size in KiB>] [<amount of edits>]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string l_initial(static_cast<size_t>(l_size), 'x');
+    const size_t l_caret = l_initial.size() / 2;
+
+    CTextBuffer l_buffer(l_initial);
+    std::string l_string(l_initial);
+
+    const double l_bufferTime = measure([&]() { edit(l_buffer, l_caret, l_count); });
+    const double l_stringTime = measure([&]() { edit(l_string, l_caret, l_count); });
+
+    if (l_buffer.str() != l_string)
+    {
+        std::fprintf(stderr, "The gap buffer and the string differ\n");
+        return 1;
+    }
+
+    std::printf("%ld edits at the caret of a %ld KiB text\n", l_count, l_size / 1024);
+    std::printf("  CTextBuffer: %10.2f ms\n", l_bufferTime);
+    std::printf("  std::string: %10.2f ms\n", l_stringTime);
+
+    static const char* const s_lines[] = { "server.listen_address = 0.0.0.0:8080 # default port\n", "Caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e, na\xC3\xAFve fa\xC3\xA7" "ade\n", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E \xF0\x9F\x98\x80\n", "truncated \xE6\x97 and stray \x80\xFF bytes\n" };
+    const size_t l_lineCount = sizeof(s_lines) / sizeof(s_lines[0]);
+    std::string l_text;
+
+    for (size_t l_i = 0; l_text.size() < static_cast<size_t>(l_size) * 8; ++l_i) l_text.append(s_lines[(l_i % 16 == 15) ? l_i % l_lineCount : 0]);
+
+    std::string l_sanitized, l_decoded;
+    size_t l_sanitizedCount(0), l_decodedCount(0);
+    UTF8_Utils::SCodepointIndex l_index;
+
+    const double l_sanitizeTime = measure([&]() { l_sanitizedCount = UTF8_Utils::sanitize(l_text.data(), l_text.size(), l_sanitized, &l_index); });
+    const double l_decodeTime = measure([&]() { l_decodedCount = decodeAll(l_text, l_decoded); });
+
+    if (l_sanitized != l_decoded || l_sanitizedCount != l_decodedCount)
+    {
+        std::fprintf(stderr, "The sanitizer and the decoding loop differ\n");
+        return 1;
+    }
+
+    size_t l_codepoint(0);
+
+    for (size_t l_offset = 0; l_offset < l_sanitized.size(); l_offset = UTF8_Utils::nextCodepoint(l_sanitized, l_offset), ++l_codepoint)
+    {
+        if (l_codepoint % 997 == 0 && UTF8_Utils::codepointOffset(l_sanitized, l_index, l_codepoint) != l_offset) l_codepoint = l_sanitized.size() + 1;
+    }
+
+    if (l_codepoint != l_index.m_count || l_index.m_graphemes != UTF8_Utils::countGraphemes(l_sanitized))
+    {
+        std::fprintf(stderr, "The code point index does not match the text\n");
+        return 1;
+    }
+
+    const double l_megabytes = l_text.size() / (1024.0 * 1024.0);
+
+    std::printf("Validation of a %.1f MiB text (%zu malformed bytes)\n", l_megabytes, l_sanitizedCount);
+    std::printf("  sanitize:    %10.2f ms (%.0f MiB/s)\n", l_sanitizeTime, l_megabytes * 1000.0 / l_sanitizeTime);
+    std::printf("  decode loop: %10.2f ms (%.0f MiB/s)\n", l_decodeTime, l_megabytes * 1000.0 / l_decodeTime);
+
+    return 0;
+}